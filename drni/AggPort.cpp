@@ -17,12 +17,17 @@ limitations under the License.
 #include "stdafx.h"
 #include "AggPort.h"
 #include "Aggregator.h"
+#include "Snapshot.h"
 
 // const unsigned char defaultPortState = 0x43; 
 
 AggPort::AggPort(unsigned char version, unsigned short systemNum, unsigned short portNum)
-	: Aggregator(version, systemNum, portNum)
 {
+	actorAdminSystem.id = 0;
+	actorOperSystem.id = 0;
+	actorLacpVersion = version;
+	partnerLacpVersion = 0;
+	changeActorSystem = false;
 	portOperational = false;                                       // Set by Receive State Machine based on ISS.Operational
 	LacpEnabled = true;                                            //TODO:  what changes LacpEnabled?
 	newPartner = false;
@@ -32,6 +37,7 @@ AggPort::AggPort(unsigned char version, unsigned short systemNum, unsigned short
 	Ready = false;                   // Set by Selection;          Reset by: Selection;         Used by: MuxSM
 	policy_coupledMuxControl = false;
 	changeActorDistributing = false;
+	operationalTime = -1;
 
 	pRxLacpFrame = nullptr;
 	pIss = nullptr;
@@ -81,6 +87,10 @@ AggPort::AggPort(unsigned char version, unsigned short systemNum, unsigned short
 	portOperConversationMask.reset();
 	distributionConversationMask.reset();
 	collectionConversationMask.reset();
+	convMasksCurrent = false;
+	convMaskPortNum = 0;
+	convMaskUpdateAll = true;
+	changeForwarding = true;
 
 	/*
 	// AX-2014 only
@@ -93,10 +103,16 @@ AggPort::AggPort(unsigned char version, unsigned short systemNum, unsigned short
 
 	changePartnerOperDistAlg = false;
 	changeActorAdmin = false;
+	changeActorAdminPortKey = false;
 	changePartnerAdmin = false;
 	changeAdminLinkNumberID = false;
 	changePortLinkState = false;
 
+	RxSmState = LacpRxSM::RxSmStates::NO_STATE;       // State machines are initialized by reset()
+	MuxSmState = LacpMuxSM::MuxSmStates::NO_STATE;
+	PerSmState = LacpPeriodicSM::PerSmStates::NO_STATE;
+	TxSmState = LacpTxSM::TxSmStates::NO_STATE;
+
 	//  cout << "AggPort Constructor called." << endl;
 	//	SimLog::logFile << "AggPort Constructor called." << endl;
 }
@@ -140,6 +156,10 @@ void AggPort::reset()
 	portOperConversationMask.reset();
 	distributionConversationMask.reset();
 	collectionConversationMask.reset();
+	convMasksCurrent = false;
+	convMaskPortNum = 0;
+	convMaskUpdateAll = true;
+	changeForwarding = true;
 	actorDWC = false;
 
 	/*
@@ -149,12 +169,10 @@ void AggPort::reset()
 	/**/
 }
 
-void AggPort::timerTick()
+void AggPort::assignActorSystem(sysId id)
 {
-	AggPort::LacpRxSM::timerTick(*this);
-	AggPort::LacpMuxSM::timerTick(*this);
-	AggPort::LacpPeriodicSM::timerTick(*this);
-	AggPort::LacpTxSM::timerTick(*this);
+	actorAdminSystem = id;
+	actorOperSystem = id;
 }
 
 void AggPort::run(bool singleStep)
@@ -165,6 +183,196 @@ void AggPort::run(bool singleStep)
 	AggPort::LacpTxSM::run(*this, singleStep);
 }
 
+int AggPort::nextEventTime() const
+{
+	bool pending = pRxLacpFrame || (NTT && portOperational) || PortMoved || changeActorSystem ||
+		changeActorDistributing || changePartnerOperDistAlg || changeActorAdmin ||
+		changeAdminLinkNumberID || changePortLinkState;
+
+	if (pending || (pIss && (portOperational != pIss->getOperational())))    // If flag set or ISS operational changed
+		return (SimLog::Time);                                          //    then state machines need to run now
+
+	int nextTime = currentWhileTimer.expiry();     // RxSM
+	nextTime = std::min(nextTime, waitWhileTimer.expiry());        // MuxSM
+	nextTime = std::min(nextTime, waitToRestoreTimer.expiry());    // MuxSM
+	nextTime = std::min(nextTime, periodicTimer.expiry());         // PeriodicSM
+	nextTime = std::min(nextTime, txLimitTimer.expiry());          // TxSM
+	nextTime = std::min(nextTime, LACP_txWhen.expiry());           // TxSM
+	return (nextTime);
+}
+
+const Histogram& AggPort::getDistributingDelay() const
+{
+	return (distributingDelay);
+}
+
+void AggPort::clearStats()
+{
+	distributingDelay.clear();
+}
+
+void AggPort::saveState(Snapshot& snap) const
+{
+	snap.put(actorAdminSystem);
+	snap.put(actorOperSystem);
+	snap.put(actorLacpVersion);
+	snap.put(partnerLacpVersion);
+	snap.put(portSelected);
+	snap.put(portOperational);
+	snap.put(LacpEnabled);
+	snap.put(newPartner);
+	snap.put(PortMoved);
+	snap.put(ReadyN);
+	snap.put(Ready);
+	snap.put(policy_coupledMuxControl);
+	snap.put(isNonRevertive);
+	Frame::saveFrame(snap, pRxLacpFrame);
+	snap.put(aggregationPortIdentifier);
+	snap.put(actorPort);
+	snap.put(actorAdminPortKey);
+	snap.put(actorOperPortKey);
+	snap.put(actorAdminPortState);
+	snap.put(actorOperPortState);
+	snap.put(partnerAdminSystem);
+	snap.put(partnerOperSystem);
+	snap.put(partnerAdminPort);
+	snap.put(partnerOperPort);
+	snap.put(partnerAdminKey);
+	snap.put(partnerOperKey);
+	snap.put(partnerAdminPortState);
+	snap.put(partnerOperPortState);
+	snap.put(NTT);
+	snap.put(LacpTxEnabled);
+	snap.put(actorPortAggregatorIdentifier);
+	snap.put(actorPortAggregatorIndex);
+	snap.put(individualAggregationPort);
+	snap.put(lacpDestinationAddress);
+	snap.put(waitToRestoreTime);
+	snap.put(wtrRevertive);
+	snap.put(wtrWaiting);
+	snap.put(actorAttached);
+	snap.put(actorDWC);
+	snap.put(adminLinkNumberID);
+	snap.put(LinkNumberID);
+	snap.put(partnerLinkNumberID);
+	snap.put(compOperConversationMask);
+	snap.put(portOperConversationMask);
+	snap.put(distributionConversationMask);
+	snap.put(collectionConversationMask);
+	snap.put(convMasksCurrent);
+	snap.put(convMaskPortNum);
+	snap.put(convMaskUpdateAll);
+	snap.put(actorOperConversationLinkListDigest);
+	snap.put(partnerOperConversationLinkListDigest);
+	snap.put(actorOperConversationServiceMappingDigest);
+	snap.put(partnerOperConversationServiceMappingDigest);
+	snap.put(actorOperPortAlgorithm);
+	snap.put(partnerOperPortAlgorithm);
+	snap.put(changeActorSystem);
+	snap.put(changeActorDistributing);
+	snap.put(changePartnerOperDistAlg);
+	snap.put(changeActorAdmin);
+	snap.put(changeActorAdminPortKey);
+	snap.put(changePartnerAdmin);
+	snap.put(changeAdminLinkNumberID);
+	snap.put(changePortLinkState);
+	snap.put(operationalTime);
+	// distributingDelay is a statistic (see Stats.h), so is not saved
+	snap.put(RxSmState);
+	snap.put(currentWhileTimer);
+	snap.put(MuxSmState);
+	snap.put(waitWhileTimer);
+	snap.put(waitToRestoreTimer);
+	snap.put(PerSmState);
+	snap.put(periodicTimer);
+	snap.put(TxSmState);
+	snap.put(txCount);
+	snap.put(txLimitTimer);
+	snap.put(LACP_txWhen);
+	snap.put(txOpportunity);
+}
+
+void AggPort::restoreState(Snapshot& snap)
+{
+	snap.get(actorAdminSystem);
+	snap.get(actorOperSystem);
+	snap.get(actorLacpVersion);
+	snap.get(partnerLacpVersion);
+	snap.get(portSelected);
+	snap.get(portOperational);
+	snap.get(LacpEnabled);
+	snap.get(newPartner);
+	snap.get(PortMoved);
+	snap.get(ReadyN);
+	snap.get(Ready);
+	snap.get(policy_coupledMuxControl);
+	snap.get(isNonRevertive);
+	pRxLacpFrame = Frame::restoreFrame(snap);
+	snap.get(aggregationPortIdentifier);
+	snap.get(actorPort);
+	snap.get(actorAdminPortKey);
+	snap.get(actorOperPortKey);
+	snap.get(actorAdminPortState);
+	snap.get(actorOperPortState);
+	snap.get(partnerAdminSystem);
+	snap.get(partnerOperSystem);
+	snap.get(partnerAdminPort);
+	snap.get(partnerOperPort);
+	snap.get(partnerAdminKey);
+	snap.get(partnerOperKey);
+	snap.get(partnerAdminPortState);
+	snap.get(partnerOperPortState);
+	snap.get(NTT);
+	snap.get(LacpTxEnabled);
+	snap.get(actorPortAggregatorIdentifier);
+	snap.get(actorPortAggregatorIndex);
+	snap.get(individualAggregationPort);
+	snap.get(lacpDestinationAddress);
+	snap.get(waitToRestoreTime);
+	snap.get(wtrRevertive);
+	snap.get(wtrWaiting);
+	snap.get(actorAttached);
+	snap.get(actorDWC);
+	snap.get(adminLinkNumberID);
+	snap.get(LinkNumberID);
+	snap.get(partnerLinkNumberID);
+	snap.get(compOperConversationMask);
+	snap.get(portOperConversationMask);
+	snap.get(distributionConversationMask);
+	snap.get(collectionConversationMask);
+	snap.get(convMasksCurrent);
+	snap.get(convMaskPortNum);
+	snap.get(convMaskUpdateAll);
+	snap.get(actorOperConversationLinkListDigest);
+	snap.get(partnerOperConversationLinkListDigest);
+	snap.get(actorOperConversationServiceMappingDigest);
+	snap.get(partnerOperConversationServiceMappingDigest);
+	snap.get(actorOperPortAlgorithm);
+	snap.get(partnerOperPortAlgorithm);
+	snap.get(changeActorSystem);
+	snap.get(changeActorDistributing);
+	snap.get(changePartnerOperDistAlg);
+	snap.get(changeActorAdmin);
+	snap.get(changeActorAdminPortKey);
+	snap.get(changePartnerAdmin);
+	snap.get(changeAdminLinkNumberID);
+	snap.get(changePortLinkState);
+	snap.get(operationalTime);
+	// distributingDelay is a statistic (see Stats.h), so is not saved
+	snap.get(RxSmState);
+	snap.get(currentWhileTimer);
+	snap.get(MuxSmState);
+	snap.get(waitWhileTimer);
+	snap.get(waitToRestoreTimer);
+	snap.get(PerSmState);
+	snap.get(periodicTimer);
+	snap.get(TxSmState);
+	snap.get(txCount);
+	snap.get(txLimitTimer);
+	snap.get(LACP_txWhen);
+	snap.get(txOpportunity);
+}
+
 
 /**/
 /*
@@ -390,7 +598,7 @@ void AggPort::set_aAggPortWTRTime(unsigned short wtr)
 {
 	waitToRestoreTime = wtr & 0x7fff;
 	wtrRevertive = ((wtr & 0x8000) == 0);
-	if (SimLog::Debug > 4)
+	if (SimLog::Trace<4>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << actorAdminSystem.addrMid
 			<< ":" << actorPort.num << " setting WTR to 0x" << wtr << dec
@@ -418,13 +626,13 @@ bool AggPort::get_aAggPortEnableLongPDUXmit()
 	return (enableLongLacpduXmit);
 }
 
-void AggPort::set_aAggPortPartnerAdminConversationMask(std::bitset<4096> mask)  // No managed object for this in standard
+void AggPort::set_aAggPortPartnerAdminConversationMask(ConvMask mask)  // No managed object for this in standard
 {
 	partnerAdminConversationMask = mask;
 	changePartnerAdmin = true;            //TODO:  should this be tied to updateMask somehow, rather than tied to PartnerAdmin LAGID changes?
 }
 
-std::bitset<4096> AggPort::get_aAggPortPartnerAdminConversationMask()
+ConvMask AggPort::get_aAggPortPartnerAdminConversationMask()
 {
 	return(partnerAdminConversationMask);
 }
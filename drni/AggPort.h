@@ -17,12 +17,22 @@ limitations under the License.
 #pragma once
 #include "Mac.h"
 #include "Aggregator.h"
+#include "ConvMask.h"
+#include "Timer.h"
+#include "Stats.h"
 #include "Lacpdu.h"
 
 class Lacpdu;
 
 
-class AggPort : public Aggregator
+/*
+*   Class AggPort implements an Aggregation Port.  It is not an Aggregator:  the Aggregators are a separate pool in LinkAgg
+*       (LinkAgg::pAggregators), which usually has one Aggregator for each Aggregation Port (with the same index, which the
+*       Selection Logic treats as the port's own Aggregator) but can be smaller when fewer LAGs are configured.
+*       An Aggregation Port has its own copy of the actor System ID and LACP version (assigned along with its Aggregators).
+*/
+
+class AggPort
 {
 	friend class LinkAgg;
 
@@ -33,10 +43,20 @@ public:
 	AggPort& operator= (const AggPort&) = delete;      // Disable assignment operator
 
 	shared_ptr<Iss> pIss;
+	sysId actorAdminSystem;
+	sysId actorOperSystem;
+	unsigned char actorLacpVersion;
+	unsigned char partnerLacpVersion;
 
+	void assignActorSystem(sysId id);
 	void reset();
-	void timerTick();
 	void run(bool singleStep);
+	int nextEventTime() const;                      // SimLog::Time if change flags set or frames pending, else next timer expiry
+
+	const Histogram& getDistributingDelay() const;  // Time from port operational to distributing, each time the link comes up
+	void clearStats();
+	void saveState(Snapshot& snap) const;              // Copy Aggregation Port variables to or from a Snapshot
+	void restoreState(Snapshot& snap);
 
 private:
 	static const int fastPeriodicTime = 2000;
@@ -48,6 +68,7 @@ private:
 	static const int txLimitInterval = 80;       // TxSM: Standard says should be the same as fastPeriodicTime
 	static const int txLimit = 10;               // TxSM: Standard says should be 10
 	static const int WTRLimit = 32768;           //         i.e. 0x8000 meaning set MSB of a 16bit value
+	static const unsigned short collectorMaxDelay = 20;   // TxSM: Standard says this is a constant
 
 	enum selectedVals { UNSELECTED, SELECTED, STANDBY };
 	selectedVals portSelected;    // Set by Selection;          Reset by: Selection, RxSM;   Used by: MuxSM
@@ -92,18 +113,18 @@ private:
 	unsigned short adminLinkNumberID;
 	unsigned short LinkNumberID;
 	unsigned short partnerLinkNumberID;
-	std::bitset<4096> compOperConversationMask;
-	std::bitset<4096> portOperConversationMask;
-	std::bitset<4096> distributionConversationMask;
-	std::bitset<4096> collectionConversationMask;
+	bool convMasksCurrent;                   // Conversation masks set by updateConversationMasks (not cleared since)
+	unsigned short convMaskPortNum;          // Port Number used for masks (zero if port could not carry conversations)
+	bool convMaskUpdateAll;                  // Set by updateConversationMasks if all Conversation IDs need updating for this port
+	bool changeForwarding;                   // Conversation masks changed since the LinkAgg last published its Forwarding
 
 	/*
 	//  AX-2014 only (Conversation Mask TLV stuff)
 	bool enableLongLacpduXmit;
 	bool longLacpduXmit;
 	int currentWhileLongLacpTimer;
-	std::bitset<4096> partnerAdminConversationMask;
-	std::bitset<4096> partnerOperConversationMask;
+	ConvMask partnerAdminConversationMask;
+	ConvMask partnerOperConversationMask;
 	bool actorPartnerSync;
 	bool partnerActorPartnerSync;
 	bool partnerDWC;
@@ -118,6 +139,7 @@ private:
 	LagAlgorithms actorOperPortAlgorithm;
 	LagAlgorithms partnerOperPortAlgorithm;
 
+	bool changeActorSystem;           // Signals that management has changed the Aggregation Port ActorAdminSystem
 	bool changeActorDistributing;         // Signal that actor.distributing has changed and Aggregator Operationl may need to change
 	bool changePartnerOperDistAlg;    // Signal from RxSM or MuxSM that a Partner distribution algorithm value has changed
 	bool changeActorAdmin;            // Signals that management has changed an Aggregation Port ActorAdmin value
@@ -126,6 +148,8 @@ private:
 	bool changeAdminLinkNumberID;     // Signals that management has changed the Aggregaton Port Link Number
 	bool changePortLinkState;
 
+	int operationalTime;              // Time portOperational became TRUE (-1 once distributingDelay recorded)
+
 public:
 	/*
 	*   802.1AX Standard managed objects access routines
@@ -178,8 +202,8 @@ public:
 	//  Ax-2014 only
 	void set_aAggPortEnableLongPDUXmit(bool enable);
 	bool get_aAggPortEnableLongPDUXmit();
-	void set_aAggPortPartnerAdminConversationMask(std::bitset<4096> mask);  // No managed object for this in standard
-	std::bitset<4096> get_aAggPortPartnerAdminConversationMask();
+	void set_aAggPortPartnerAdminConversationMask(ConvMask mask);  // No managed object for this in standard
+	ConvMask get_aAggPortPartnerAdminConversationMask();
 	/**/
 private:
 
@@ -196,7 +220,6 @@ private:
 		static int runRxSM(AggPort& port, bool singleStep);
 		/**/
 		static void reset(AggPort& port);
-		static void timerTick(AggPort& port);
 		static int run(AggPort& port, bool singleStep);
 
 	private:
@@ -229,7 +252,7 @@ private:
 	};
 
 	LacpRxSM::RxSmStates RxSmState;
-	int currentWhileTimer;
+	Timer currentWhileTimer;
 
 
 //	static class LacpMuxSM
@@ -245,7 +268,6 @@ private:
 		static int runMuxSM(AggPort& port, bool singleStep);
 		/**/
 		static void reset(AggPort& port);
-		static void timerTick(AggPort& port);
 		static int run(AggPort& port, bool singleStep);
 
 	private:
@@ -269,8 +291,8 @@ private:
 	};
 
 	LacpMuxSM::MuxSmStates MuxSmState;
-	int waitWhileTimer;
-	int waitToRestoreTimer;
+	Timer waitWhileTimer;
+	Timer waitToRestoreTimer;
 
 //	static class LacpPeriodicSM
 	class LacpPeriodicSM
@@ -285,7 +307,6 @@ private:
 		static int runPeriodicSM(AggPort& port, bool singleStep);
 		/**/
 		static void reset(AggPort& port);
-		static void timerTick(AggPort& port);
 		static int run(AggPort& port, bool singleStep);
 
 	private:
@@ -297,7 +318,7 @@ private:
 	};
 
 	LacpPeriodicSM::PerSmStates PerSmState;
-	int periodicTimer;
+	Timer periodicTimer;
 
 
 
@@ -314,7 +335,6 @@ private:
 		static int runTxSM(AggPort& port, bool singleStep);
 		/**/
 		static void reset(AggPort& port);
-		static void timerTick(AggPort& port);
 		static int run(AggPort& port, bool singleStep);
 
 	private:
@@ -331,10 +351,18 @@ private:
 
 	LacpTxSM::TxSmStates TxSmState;
 	int txCount;
-	int txLimitTimer;
-	int LACP_txWhen;
+	Timer txLimitTimer;
+	Timer LACP_txWhen;
 	bool txOpportunity;
 
+	//  The conversation masks (512 octets each) and statistics are declared after all of the state machine variables,
+	//     so the variables that the state machines test on every run are together in a few cache lines.
+	ConvMask compOperConversationMask;
+	ConvMask portOperConversationMask;
+	ConvMask distributionConversationMask;
+	ConvMask collectionConversationMask;
+	Histogram distributingDelay;
+
 
 
 };
@@ -17,6 +17,8 @@ limitations under the License.
 #include "stdafx.h"
 #include "Aggregator.h"
 #include "Mac.h"
+#include "Snapshot.h"
+#include "LinkMapCache.h"
 
 
 Aggregator::Aggregator(unsigned char version, unsigned short systemNum, unsigned short portNum)
@@ -40,9 +42,11 @@ Aggregator::Aggregator(unsigned char version, unsigned short systemNum, unsigned
 	aggregatorReady = false;
 
 	selectedconvLinkMap = Aggregator::convLinkMaps::EIGHT_LINK_SPREAD;
+	adminLinkMapId = LinkMapCache::newAdminMapId();
 	actorPortAlgorithm = LagAlgorithms::UNSPECIFIED;
 	actorAdminConversationLinkListDigest.fill(0);
-	actorConversationLinkListDigest = convLinkMapEightLinkSpreadDigest;
+	adminLinkMapDigestStale = true;
+	actorConversationLinkListDigest = linkMapDigest(selectedconvLinkMap);
 	actorAdminConversationServiceMappingDigest.fill(0);
 	actorConversationServiceMappingDigest.fill(0);
 	partnerAdminPortAlgorithm = LagAlgorithms::UNSPECIFIED;
@@ -53,8 +57,13 @@ Aggregator::Aggregator(unsigned char version, unsigned short systemNum, unsigned
 	partnerConversationServiceMappingDigest.fill(0);
 	adminDiscardWrongConversation = adminValues::AUTO;
 	operDiscardWrongConversation = false;
+	pConversations = nullptr;
+	updateAllConversations = true;
+	changeForwarding = true;
 
 	changeActorSystem = false;
+	changeActorAdminKey = false;
+	changeDistributing = false;
 
 	changeActorDistAlg = false;
 	changeConvLinkList = false;
@@ -63,6 +72,9 @@ Aggregator::Aggregator(unsigned char version, unsigned short systemNum, unsigned
 	changeLinkState = false;
 	changeAggregationLinks = false;
 	changeCSDC = false;
+	differentPortAlgorithms = false;
+	differentConversationServiceDigests = false;
+	differentPortConversationDigests = false;
 
 	updateDistRelayAggState = false;
 	operDrniId.id = 0;
@@ -132,8 +144,10 @@ void Aggregator::reset()
 	differentPortConversationDigests = false;
 	operDiscardWrongConversation = false;
 	activeLagLinks.clear();
-	conversationLinkVector.fill(0);
-	conversationPortVector.fill(0);
+	pConversations = nullptr;
+	changedConversations.clear();
+	updateAllConversations = true;
+	changeForwarding = true;
 
 	changeActorDistAlg = false;
 	changeConvLinkList = false;
@@ -144,6 +158,20 @@ void Aggregator::reset()
 	changeCSDC = false;
 }
 
+int Aggregator::nextEventTime() const
+{
+	bool pending = (!requests.empty() && getEnabled()) || !indications.empty() ||
+		changeActorSystem || changeActorAdminKey || changeDistributing ||
+		changeActorDistAlg || changeConvLinkList || changePartnerAdminDistAlg || changeDistAlg ||
+		changeLinkState || changeAggregationLinks || changeCSDC || changeDrniSolo;
+		// updateDistRelayAggState is only cleared by a Distributed Relay, so it is checked by DistributedRelay::nextEventTime
+
+	if (pending)
+		return (SimLog::Time);
+	else
+		return (SimLog::EndOfTime);
+}
+
 bool Aggregator::digestIsNull(std::array<unsigned char, 16>& digest)
 {
 	bool nullDigest = true;
@@ -161,6 +189,169 @@ void Aggregator::assignActorSystem(sysId id)
 	aggregatorMacAddress = (actorAdminSystem.addr & 0x0fffffffff000) + (aggregatorIdentifier & 0x0fff);
 }
 
+void Aggregator::saveState(Snapshot& snap, const std::vector<shared_ptr<AggPort>>& ports) const
+{
+	IssQ::saveState(snap);
+	std::array<unsigned short, 4096> egressPorts;             // Position in ports (plus one) of each conversationEgressPort
+	if (pConversations)
+	{
+		std::map<const AggPort*, unsigned short> portIndex;
+		for (size_t i = 0; i < ports.size(); i++)
+			portIndex[ports[i].get()] = (unsigned short)(i + 1);
+		for (int cid = 0; cid < 4096; cid++)
+			egressPorts[cid] = pConversations->conversationEgressPort[cid] ? portIndex[pConversations->conversationEgressPort[cid]] : 0;
+	}
+
+	snap.put(actorAdminSystem);
+	snap.put(actorOperSystem);
+	snap.put(actorLacpVersion);
+	snap.put(partnerLacpVersion);
+	snap.put(operational);
+	snap.put(aggregatorMacAddress);
+	snap.put(aggregatorIdentifier);
+	snap.put(aggregatorIndividual);
+	snap.put(aggregatorLoopback);
+	snap.put(actorAdminAggregatorKey);
+	snap.put(actorOperAggregatorKey);
+	snap.put(partnerSystem);
+	snap.put(partnerOperAggregatorKey);
+	snap.put(receiveState);
+	snap.put(transmitState);
+	snap.put(lagPorts);
+	snap.put(selectedLagPorts);
+	snap.put(collectorMaxDelay);
+	snap.put(aggregatorReady);
+	snap.put(changeActorSystem);
+	snap.put(changeActorAdminKey);
+	snap.put(changeDistributing);
+	snap.put(changeActorDistAlg);
+	snap.put(changeConvLinkList);
+	snap.put(changePartnerAdminDistAlg);
+	snap.put(changeDistAlg);
+	snap.put(changeLinkState);
+	snap.put(changeAggregationLinks);
+	snap.put(changeCSDC);
+	snap.put(updateDistRelayAggState);
+	snap.put(operDrniId);
+	snap.put(operDrniKey);
+	snap.put(drniSolo);
+	snap.put(changeDrniSolo);
+	snap.put(drniPartnerSystemId);
+	snap.put(drniPartnerKey);
+	snap.put(adminDiscardWrongConversation);
+	snap.put(operDiscardWrongConversation);
+	snap.put(actorAdminConversationLinkListDigest);
+	snap.put(actorConversationLinkListDigest);
+	snap.put(partnerAdminConversationLinkListDigest);
+	snap.put(partnerConversationLinkListDigest);
+	snap.put(actorAdminConversationServiceMappingDigest);
+	snap.put(actorConversationServiceMappingDigest);
+	snap.put(partnerAdminConversationServiceMappingDigest);
+	snap.put(partnerConversationServiceMappingDigest);
+	snap.put(actorPortAlgorithm);
+	snap.put(partnerAdminPortAlgorithm);
+	snap.put(partnerPortAlgorithm);
+	snap.put(adminConversationLinkMap);
+	snap.put(differentConversationServiceDigests);
+	snap.put(differentPortAlgorithms);
+	snap.put(differentPortConversationDigests);
+	snap.put(activeLagLinks);
+	snap.put((size_t)(pConversations != nullptr));
+	if (pConversations)
+	{
+		snap.putVector(*pConversations->pConversationLinkVector);
+		snap.putVector(pConversations->conversationPortVector);
+		snap.putVector(egressPorts);
+	}
+	snap.put(changedConversations);
+	snap.put(updateAllConversations);
+	snap.put(selectedconvLinkMap);
+}
+
+void Aggregator::restoreState(Snapshot& snap, const std::vector<shared_ptr<AggPort>>& ports)
+{
+	IssQ::restoreState(snap);
+	std::array<unsigned short, 4096> egressPorts;
+
+	snap.get(actorAdminSystem);
+	snap.get(actorOperSystem);
+	snap.get(actorLacpVersion);
+	snap.get(partnerLacpVersion);
+	snap.get(operational);
+	snap.get(aggregatorMacAddress);
+	snap.get(aggregatorIdentifier);
+	snap.get(aggregatorIndividual);
+	snap.get(aggregatorLoopback);
+	snap.get(actorAdminAggregatorKey);
+	snap.get(actorOperAggregatorKey);
+	snap.get(partnerSystem);
+	snap.get(partnerOperAggregatorKey);
+	snap.get(receiveState);
+	snap.get(transmitState);
+	snap.get(lagPorts);
+	snap.get(selectedLagPorts);
+	snap.get(collectorMaxDelay);
+	snap.get(aggregatorReady);
+	snap.get(changeActorSystem);
+	snap.get(changeActorAdminKey);
+	snap.get(changeDistributing);
+	snap.get(changeActorDistAlg);
+	snap.get(changeConvLinkList);
+	snap.get(changePartnerAdminDistAlg);
+	snap.get(changeDistAlg);
+	snap.get(changeLinkState);
+	snap.get(changeAggregationLinks);
+	snap.get(changeCSDC);
+	snap.get(updateDistRelayAggState);
+	snap.get(operDrniId);
+	snap.get(operDrniKey);
+	snap.get(drniSolo);
+	snap.get(changeDrniSolo);
+	snap.get(drniPartnerSystemId);
+	snap.get(drniPartnerKey);
+	snap.get(adminDiscardWrongConversation);
+	snap.get(operDiscardWrongConversation);
+	snap.get(actorAdminConversationLinkListDigest);
+	snap.get(actorConversationLinkListDigest);
+	snap.get(partnerAdminConversationLinkListDigest);
+	snap.get(partnerConversationLinkListDigest);
+	snap.get(actorAdminConversationServiceMappingDigest);
+	snap.get(actorConversationServiceMappingDigest);
+	snap.get(partnerAdminConversationServiceMappingDigest);
+	snap.get(partnerConversationServiceMappingDigest);
+	snap.get(actorPortAlgorithm);
+	snap.get(partnerAdminPortAlgorithm);
+	snap.get(partnerPortAlgorithm);
+	snap.get(adminConversationLinkMap);
+	adminLinkMapId = LinkMapCache::newAdminMapId();           // Restored map may differ from any map the cache has seen
+	adminLinkMapDigestStale = true;
+	snap.get(differentConversationServiceDigests);
+	snap.get(differentPortAlgorithms);
+	snap.get(differentPortConversationDigests);
+	snap.get(activeLagLinks);
+	size_t hasConversations = 0;
+	snap.get(hasConversations);
+	if (hasConversations)
+	{
+		if (!pConversations)
+			pConversations = make_unique<ConversationVectors>();
+		shared_ptr<std::array<unsigned short, 4096>> pLinkVector = make_shared<std::array<unsigned short, 4096>>();
+		snap.getVector(*pLinkVector);
+		pConversations->pConversationLinkVector = pLinkVector;
+		snap.getVector(pConversations->conversationPortVector);
+		snap.getVector(egressPorts);
+	}
+	else
+	{
+		pConversations = nullptr;
+	}
+	snap.get(changedConversations);
+	snap.get(updateAllConversations);
+	snap.get(selectedconvLinkMap);
+	for (int cid = 0; pConversations && (cid < 4096); cid++)
+		pConversations->conversationEgressPort[cid] = ((egressPorts[cid] > 0) && (egressPorts[cid] <= ports.size())) ? ports[egressPorts[cid] - 1].get() : nullptr;
+}
+
 /*
  *   802.1AX Standard managed objects access routines
  */
@@ -272,7 +463,7 @@ bool Aggregator::get_aAggAggregateOrIndividual()
 	return (!aggregatorIndividual);
 }
 
-std::list<unsigned short> Aggregator::get_aAggPortList()   
+IdList Aggregator::get_aAggPortList()   
 {
 	return (selectedLagPorts);  // List of Aggregation Port Identifiers attached to this aggregator  //TODO:  currently list includes selected or attached
 }
@@ -358,7 +549,8 @@ void Aggregator::set_aAggConversationAdminLink(unsigned short cid, std::list<uns
 		{
 			adminConversationLinkMap.insert(make_pair(cid, linkNumberList));   //    then insert the new map entry
 		}
-		// recalculate Digest
+		adminLinkMapId = LinkMapCache::newAdminMapId();   // Tables cached for the old map no longer apply
+		adminLinkMapDigestStale = true;            //   Digest recalculated when the change is processed
 		changeConvLinkList = true;                 //   and set flag so change is processed
 		changeActorDistAlg = true;                 //   and set flag so change is processed
 	}
@@ -393,14 +585,10 @@ void Aggregator::printConversationAdminLink()
 }
 
 
-void Aggregator::set_aAggConversationListDigest(std::array<unsigned char, 16> digest)
-{
-	actorAdminConversationLinkListDigest = digest;
-	changeActorDistAlg = true;                 //   and set flag so change is processed
-}
-
 std::array<unsigned char, 16>Aggregator::get_aAggConversationListDigest()
 {
+	if (adminLinkMapDigestStale)
+		updateActorConversationLinkListDigest();
 	return (actorAdminConversationLinkListDigest);
 }
 
@@ -408,7 +596,7 @@ std::array<unsigned char, 16>Aggregator::get_aAggConversationListDigest()
 
 unsigned short Aggregator::get_conversationLink(unsigned short cid)
 {
-	return (conversationLinkVector[cid]);
+	return (pConversations ? (*pConversations->pConversationLinkVector)[cid] : 0);
 }
 
 LagAlgorithms Aggregator::get_aAggPartnerPortAlgorithm()
@@ -419,22 +607,7 @@ LagAlgorithms Aggregator::get_aAggPartnerPortAlgorithm()
 void Aggregator::set_convLinkMap(Aggregator::convLinkMaps choice)
 {
 	selectedconvLinkMap = choice;
-	switch (selectedconvLinkMap)
-	{
-	case Aggregator::convLinkMaps::ADMIN_TABLE:
-		actorConversationLinkListDigest = actorAdminConversationLinkListDigest;
-		break;
-	case Aggregator::convLinkMaps::ACTIVE_STANDBY:
-		actorConversationLinkListDigest = convLinkMapActiveStandbyDigest;
-		break;
-	case Aggregator::convLinkMaps::EVEN_ODD:
-		actorConversationLinkListDigest = convLinkMapEvenOddDigest;
-		break;
-	case Aggregator::convLinkMaps::EIGHT_LINK_SPREAD:
-		actorConversationLinkListDigest = convLinkMapEightLinkSpreadDigest;
-		break;
-	}
-	// recalculate Digest
+	updateActorConversationLinkListDigest();
 	changeActorDistAlg = true;                 //   and set flag so change is processed
 }
 
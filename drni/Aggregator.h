@@ -16,21 +16,20 @@ limitations under the License.
 
 #pragma once
 #include "Mac.h"
+#include "IdList.h"
+
+class AggPort;
 
 const unsigned short defaultActorKey = 0xa000;            // Change least significant byte to port number to make unique in system
 const unsigned short defaultPartnerKey = 0x0070;
 const unsigned short unusedAggregatorKey = 0x0911;
 const unsigned short defaultDrniKey = 0x010;
 const unsigned short defaultIrpKey = 0x020;
-static const std::array<unsigned char, 16> convLinkMapActiveStandbyDigest = { "ACTIVE_STANDBY " };
-static const std::array<unsigned char, 16> convLinkMapEvenOddDigest = { "EVEN_ODD       " };
-static const std::array<unsigned char, 16> convLinkMapEightLinkSpreadDigest = { "8_LINK_SPREAD  " };
-//TODO:: calculate the real MD5 signatures of the fixed adminConversationLinkMaps
 
 /**/
 union portId
 {
-	unsigned long id;
+	unsigned int id;                     // 32 bits, so num and pri cover all of it (unsigned long is 64 bits on some platforms)
 	struct
 	{
 		unsigned short num;
@@ -98,6 +97,9 @@ public:
 	virtual unsigned long long getMacAddress() const;
 	void assignActorSystem(sysId id);
 	void reset();
+	virtual int nextEventTime() const;      // SimLog::Time if frames queued or change flags set, else EndOfTime
+	void saveState(Snapshot& snap, const std::vector<shared_ptr<AggPort>>& ports) const;   // Copy to or from a Snapshot, with
+	void restoreState(Snapshot& snap, const std::vector<shared_ptr<AggPort>>& ports);      //    AggPort pointers saved as positions in ports
 
 	// public LACPv2 variables
 //	enum portAlgorithms { NONE = 0, UNSPECIFIED = 0x0080c200, C_VID, S_VID, I_SID, TE_SID, ECMP_FLOW_HASH };
@@ -115,8 +117,8 @@ protected:
 	unsigned short partnerOperAggregatorKey;
 	bool receiveState;
 	bool transmitState;
-	std::list<unsigned short> lagPorts;              // List of Aggregation Port index for all ports attached or selected
-	std::list<unsigned short> selectedLagPorts;      // List of Aggregation Port Identifiers for all ports attached or selected
+	IdList lagPorts;                                 // List of Aggregation Port index for all ports attached or selected
+	IdList selectedLagPorts;                         // List of Aggregation Port Identifiers for all ports attached or selected
 	unsigned short collectorMaxDelay;
 
 	bool aggregatorReady;
@@ -132,6 +134,7 @@ protected:
 	bool changeLinkState;                     //
 	bool changeAggregationLinks;              //
 	bool changeCSDC;                          //
+	bool changeForwarding;                    // Egress ports changed since the LinkAgg last published its Forwarding
 
 	bool updateDistRelayAggState;
 	sysId operDrniId;
@@ -145,7 +148,8 @@ protected:
 	// private LACPv2 variables
 	adminValues adminDiscardWrongConversation;
 	bool operDiscardWrongConversation;
-	std::array<unsigned char, 16> actorAdminConversationLinkListDigest;           // Admin value set by management
+	std::array<unsigned char, 16> actorAdminConversationLinkListDigest;           // MD5 digest of adminConversationLinkMap
+	bool adminLinkMapDigestStale;                                                 // adminConversationLinkMap changed since digest computed
 	std::array<unsigned char, 16> actorConversationLinkListDigest;                // value in use selected by selectedconvLinkMap
 	std::array<unsigned char, 16> partnerAdminConversationLinkListDigest;         // Admin value set by management; used when actorOperPortState.defaulted
 	std::array<unsigned char, 16> partnerConversationLinkListDigest;              // value in use (default or as received from partner LACPDU)
@@ -157,23 +161,38 @@ protected:
 	LagAlgorithms partnerAdminPortAlgorithm;
 	LagAlgorithms partnerPortAlgorithm;
 	std::map<unsigned short, std::list<unsigned short>> adminConversationLinkMap;      // map of lists of Link Numbers keyed by CID
+	unsigned long long adminLinkMapId;                        // Identifies the contents of adminConversationLinkMap in LinkMapCache
 	bool differentConversationServiceDigests;
 	bool differentPortAlgorithms;
 	bool differentPortConversationDigests;
-	std::list<unsigned short> activeLagLinks;  // contains Link Number ID if AggPort attached and distributing, else Link Number = 0
-	std::array<unsigned short, 4096> conversationLinkVector;  // Contains LinkNumberID of AggPort for each Conversation ID.
-	std::array<unsigned short, 4096> conversationPortVector;  // Contains PortNumber of AggPort for each Conversation ID.
+	IdList activeLagLinks;                     // contains Link Number ID if AggPort attached and distributing, else Link Number = 0
+	//  The per Conversation ID vectors are 48K octets, far more than the rest of the Aggregator, and are only used once the
+	//     LAG has active links.  They are held out of line so the control state of Aggregators and AggPorts stays compact.
+	struct ConversationVectors
+	{
+		shared_ptr<const std::array<unsigned short, 4096>> pConversationLinkVector;  // LinkNumberID of AggPort for each Conversation ID
+		                                                                             //    (an immutable table shared through LinkMapCache)
+		std::array<unsigned short, 4096> conversationPortVector;  // Contains PortNumber of AggPort for each Conversation ID.
+		std::array<AggPort*, 4096> conversationEgressPort;        // AggPort distributing each Conversation ID (null while updating masks)
+	};
+	unique_ptr<ConversationVectors> pConversations;           // Allocated while the LAG has active links;  null means all zero
+	std::vector<unsigned short> changedConversations;         // Conversation IDs with new conversationPortVector entry since masks updated
+	bool updateAllConversations;                              // Conversation masks need to be updated for all Conversation IDs
 	convLinkMaps selectedconvLinkMap;
 
 
 	static bool digestIsNull(std::array<unsigned char, 16>& digest);
+	static std::array<unsigned char, 16> conversationLinkListDigest(const std::map<unsigned short, std::list<unsigned short>>& linkMap);
+	static std::array<unsigned char, 16> linkMapDigest(convLinkMaps linkMap);   // Digest of a fixed map (computed once)
+	static std::map<unsigned short, std::list<unsigned short>> fixedLinkMap(convLinkMaps linkMap);   // Admin table equivalent to a fixed map
+	void updateActorConversationLinkListDigest();             // Digest of the selected map (admin table digest computed only if stale)
 
-	void updateConversationLinkVector(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector);
-	void linkMap_EvenOdd(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector);
-	void linkMap_ActiveStandby(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector);
-	void linkMap_EightLinkSpread(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector);
-	void linkMap_AdminTable(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector);
-	bool isInList(unsigned short val, const std::list<unsigned short>& thisList);
+	shared_ptr<const std::array<unsigned short, 4096>> conversationLinkTable(const IdList& links);   // From LinkMapCache, computed if not there
+	void updateConversationLinkVector(const IdList& links, std::array<unsigned short, 4096>& convLinkVector);
+	void linkMap_EvenOdd(const IdList& links, std::array<unsigned short, 4096>& convLinkVector);
+	void linkMap_ActiveStandby(const IdList& links, std::array<unsigned short, 4096>& convLinkVector);
+	void linkMap_EightLinkSpread(const IdList& links, std::array<unsigned short, 4096>& convLinkVector);
+	void linkMap_AdminTable(const IdList& links, std::array<unsigned short, 4096>& convLinkVector);
 
 
 	/*
@@ -198,7 +217,7 @@ public:
 	void set_aCollectorMaxDelay(unsigned short delay);
 	unsigned short get_aAggCollectorMaxDelay();
 	bool get_aAggAggregateOrIndividual();
-	std::list<unsigned short> get_aAggPortList();             // List of Aggregation Port Identifiers attached to this aggregator  //TODO:  currently list includes selected or attached
+	IdList get_aAggPortList();                                // List of Aggregation Port Identifiers attached to this aggregator  //TODO:  currently list includes selected or attached
 	//TODO:   maybe add all statistics counter attributes
 
 	// Version 2 attributes
@@ -218,8 +237,7 @@ public:
 	adminValues get_aAggAdminDiscardWrongConversation();
 	bool get_aAggOperDiscardWrongConversation();    // not in standard
 
-	void set_aAggConversationListDigest(std::array<unsigned char, 16> digest);
-	std::array<unsigned char, 16> get_aAggConversationListDigest();
+	std::array<unsigned char, 16> get_aAggConversationListDigest();       // MD5 digest of aAggConversationAdminLink[]
 
 	
 	// Not in standard:
@@ -0,0 +1,709 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Benchmark.h"
+#include "Snapshot.h"
+#include "Sweep.h"
+#include "Partition.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+
+
+Topology::Topology(std::string topologyName)
+	: name(topologyName)
+{
+	lags = 0;
+}
+
+Topology::~Topology()
+{
+	Devices.clear();
+}
+
+size_t Topology::addBridge(int numMacs)
+{
+	unique_ptr<Device> pDev = make_unique<Device>(numMacs);
+	pDev->createBridge(CVlanEthertype);
+	Devices.push_back(move(pDev));
+	return (Devices.size() - 1);
+}
+
+size_t Topology::addStation(int numMacs)
+{
+	unique_ptr<Device> pDev = make_unique<Device>(numMacs);
+	pDev->createEndStation();
+	Devices.push_back(move(pDev));
+	stations.push_back(Devices.size() - 1);
+	return (Devices.size() - 1);
+}
+
+void Topology::addLink(size_t devA, int macA, size_t devB, int macB)
+{
+	Link thisLink;
+	thisLink.devA = devA;
+	thisLink.macA = macA;
+	thisLink.devB = devB;
+	thisLink.macB = macB;
+	links.push_back(thisLink);
+}
+
+void Topology::configDistRelay(size_t dev, int drniMacIndex, unsigned short firstLinkNum)
+{
+	//  Make a Distributed Relay with two DRNI Aggregation Ports and two Intra-Relay Ports, starting at drniMacIndex
+	Bridge& bridge = (Bridge&)*(Devices[dev]->pComponents[0]);  // Assumes Bridge is first component in device.
+	LinkAgg& lag = (LinkAgg&)*(Devices[dev]->pComponents[1]);   // Assumes LinkAgg is second component in device.
+
+	int numDrniPorts = 2;
+	int numIrp = 2;
+	sysId adminDrniId;
+	adminDrniId.id = 0;                        // DRNI uses ID from DRNI System with the lowest ID
+
+	//  Key for Aggregator supporting DRNI needs to be unique in system.
+	unsigned short aggKey = (defaultActorKey & 0xf000) | 0x0800 | ((drniMacIndex + 1) & 0x07ff);
+	lag.pAggregators[drniMacIndex]->set_aAggActorAdminKey(aggKey);
+
+	shared_ptr<DistributedRelay> pDR = make_shared<DistributedRelay>(adminDrniId.id, aggKey);
+	lag.pDistRelays[drniMacIndex] = pDR;
+	lag.configDistRelay(drniMacIndex, numDrniPorts, numIrp, adminDrniId, aggKey, firstLinkNum);
+
+	bridge.bPorts[drniMacIndex]->pIss = pDR;
+	for (int px = drniMacIndex + 1; px < drniMacIndex + numDrniPorts + numIrp; px++)
+		bridge.bPorts[px]->pIss = nullptr;
+}
+
+void Topology::connect(size_t link, unsigned short delay)
+{
+	Mac::Connect(Devices[links[link].devA]->pMacs[links[link].macA], Devices[links[link].devB]->pMacs[links[link].macB], delay);
+}
+
+void Topology::disconnect(size_t link)
+{
+	Mac::Disconnect(Devices[links[link].devA]->pMacs[links[link].macA]);
+}
+
+void Topology::connectAll(unsigned short delay)
+{
+	for (size_t link = 0; link < links.size(); link++)
+		connect(link, delay);
+}
+
+void Topology::connectDevice(size_t dev, unsigned short delay)
+{
+	for (size_t link = 0; link < links.size(); link++)
+		if ((links[link].devA == dev) || (links[link].devB == dev))
+			connect(link, delay);
+}
+
+int Topology::countLags() const
+{
+	return (lags);
+}
+
+int Topology::countOperationalAggregators() const
+{
+	int count = 0;
+
+	for (auto& pDev : Devices)
+	{
+		LinkAgg& lag = (LinkAgg&)*(pDev->pComponents[1]);   // Assumes LinkAgg is second component in device.
+		for (auto& pAgg : lag.pAggregators)
+			if (pAgg->getOperational())
+				count++;
+	}
+	return (count);
+}
+
+unsigned long long Topology::countTxFrames() const
+{
+	unsigned long long count = 0;
+
+	for (auto& pDev : Devices)
+		for (auto& pMac : pDev->pMacs)
+			count += pMac->getTxFrameCount();
+	return (count);
+}
+
+unique_ptr<Topology> Topology::leafSpine(int spines, int leaves, int linksPerSpine, int stationsPerLeaf)
+{
+	std::stringstream name;
+	name << "leafSpine-" << spines << "x" << leaves << "x" << linksPerSpine << "-" << stationsPerLeaf;
+	unique_ptr<Topology> pNet = make_unique<Topology>(name.str());
+
+	//  Spine Bridge Mac (leaf * linksPerSpine) + i connects to leaf Bridge Mac (spine * linksPerSpine) + i
+	//  End Station Macs 0 and 1 connect to consecutive leaf Bridge Macs following the uplinks
+	int uplinks = spines * linksPerSpine;
+	for (int spine = 0; spine < spines; spine++)
+		pNet->addBridge(leaves * linksPerSpine);
+	for (int leaf = 0; leaf < leaves; leaf++)
+	{
+		size_t leafDev = pNet->addBridge(uplinks + (2 * stationsPerLeaf));
+		for (int spine = 0; spine < spines; spine++)
+			for (int i = 0; i < linksPerSpine; i++)
+				pNet->addLink(leafDev, (spine * linksPerSpine) + i, spine, (leaf * linksPerSpine) + i);
+		for (int stn = 0; stn < stationsPerLeaf; stn++)
+		{
+			size_t stnDev = pNet->addStation(2);
+			pNet->addLink(stnDev, 0, leafDev, uplinks + (2 * stn));
+			pNet->addLink(stnDev, 1, leafDev, uplinks + (2 * stn) + 1);
+		}
+	}
+	pNet->lags = (leaves * spines) + (leaves * stationsPerLeaf);
+	return (pNet);
+}
+
+unique_ptr<Topology> Topology::ring(int bridges, int linksPerHop)
+{
+	std::stringstream name;
+	name << "ring-" << bridges << "x" << linksPerHop;
+	unique_ptr<Topology> pNet = make_unique<Topology>(name.str());
+
+	//  Bridge Mac linksPerHop + i connects to Mac i of the next Bridge in the ring
+	for (int brg = 0; brg < bridges; brg++)
+		pNet->addBridge(2 * linksPerHop);
+	for (int brg = 0; brg < bridges; brg++)
+		for (int i = 0; i < linksPerHop; i++)
+			pNet->addLink(brg, linksPerHop + i, (brg + 1) % bridges, i);
+	pNet->lags = bridges;
+	return (pNet);
+}
+
+unique_ptr<Topology> Topology::portalMesh(int portals, int stationsPerPortal)
+{
+	std::stringstream name;
+	name << "portalMesh-" << portals << "-" << stationsPerPortal;
+	unique_ptr<Topology> pNet = make_unique<Topology>(name.str());
+
+	//  Each System of a Portal has a block of four Macs for each Distributed Relay:  two DRNI Aggregation Ports
+	//     and two Intra-Relay Ports.  Block b of a Portal links to Portal b (or b + 1 if b >= this Portal),
+	//     and blocks (portals - 1) and above are for the End Stations dual-homed to the Portal.
+	int blocks = (portals - 1) + stationsPerPortal;
+	for (int portal = 0; portal < portals; portal++)
+	{
+		size_t sysA = pNet->addBridge(4 * blocks);
+		size_t sysB = pNet->addBridge(4 * blocks);
+		pNet->portals.push_back(std::make_pair(sysA, sysB));
+		for (int block = 0; block < blocks; block++)
+		{
+			pNet->configDistRelay(sysA, 4 * block, 1);
+			pNet->configDistRelay(sysB, 4 * block, 3);
+			pNet->addLink(sysA, (4 * block) + 2, sysB, (4 * block) + 2);     // Intra-Relay Link
+		}
+	}
+	for (int portal = 0; portal < portals; portal++)
+	{
+		for (int peer = portal + 1; peer < portals; peer++)
+		{
+			int block = peer - 1;           // Block of this Portal that links to peer
+			int peerBlock = portal;         // Block of peer that links to this Portal
+			pNet->addLink(pNet->portals[portal].first, 4 * block, pNet->portals[peer].first, 4 * peerBlock);
+			pNet->addLink(pNet->portals[portal].second, 4 * block, pNet->portals[peer].second, 4 * peerBlock);
+		}
+		for (int stn = 0; stn < stationsPerPortal; stn++)
+		{
+			int block = (portals - 1) + stn;
+			size_t stnDev = pNet->addStation(2);
+			pNet->addLink(stnDev, 0, pNet->portals[portal].first, 4 * block);
+			pNet->addLink(stnDev, 1, pNet->portals[portal].second, 4 * block);
+		}
+	}
+	pNet->lags = ((portals * (portals - 1)) / 2) + (portals * stationsPerPortal) + (portals * blocks);
+	return (pNet);
+}
+
+
+
+void Benchmark::run(int scale, std::ostream& results)
+{
+	int saveDebug = SimLog::Debug;
+	std::streambuf* pCoutBuf = cout.rdbuf();
+	std::streambuf* pConsoleBuf = SimLog::console.rdbuf();
+
+	SimLog::Debug = 0;                         // No logging
+	cout.rdbuf(nullptr);                       // Discard console messages (e.g. from Mac::Connect)
+	SimLog::console.rdbuf(nullptr);
+
+	writeHeader(results);
+	{
+		unique_ptr<Topology> pNet = Topology::leafSpine(4, 16 * scale, 2, 4);
+		writeResult(results, coldStart(*pNet, 1000));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::leafSpine(4, 16 * scale, 2, 4);
+		writeResult(results, linkFlapStorm(*pNet, 64 * scale, 5));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::ring(16 * scale, 2);
+		writeResult(results, coldStart(*pNet, 1000));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::ring(16 * scale, 2);
+		writeResult(results, partitionedColdStart(*pNet, 1000, 4));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::portalMesh(4, 2 * scale);
+		writeResult(results, coldStart(*pNet, 1000));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::portalMesh(4, 2 * scale);
+		writeResult(results, portalFailover(*pNet, 4, 250));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::leafSpine(1, 4 * scale, 2, 4);   // Single spine so no loops
+		writeResult(results, sustainedTraffic(*pNet, 1000));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::leafSpine(1, 4 * scale, 2, 4);   // Single spine so no loops
+		writeResult(results, trafficMix(*pNet, 1000, 0.25));
+	}
+	{
+		unique_ptr<Topology> pNet = Topology::portalMesh(4, 2 * scale);
+		writeResult(results, snapshotFork(*pNet, 8 * scale));
+	}
+	writeResult(results, perturbationSweep([scale]() { return (Topology::portalMesh(4, 2 * scale)); }, std::thread::hardware_concurrency()));
+
+	cout.rdbuf(pCoutBuf);
+	SimLog::console.rdbuf(pConsoleBuf);
+	SimLog::Debug = saveDebug;
+}
+
+void Benchmark::converge(Topology& net, Simulation& sim)
+{
+	//  Connect all Links and run until LAGs are up
+	for (auto& pDev : net.Devices)
+	{
+		pDev->reset();
+	}
+	net.connectAll();
+	sim.run(SimLog::Time + ConvergeTime);
+}
+
+Benchmark::Result::Result(const std::vector<unique_ptr<Device>>& netDevices)
+	: stats(netDevices)
+{
+	devices = 0;
+	links = 0;
+	lags = 0;
+	ticks = 0;
+	activeTicks = 0;
+	wallSeconds = 0;
+	ticksPerSecond = 0;
+	frames = 0;
+	framesPerSecond = 0;
+	operationalAggregators = 0;
+	peakMemoryKB = 0;
+}
+
+void Benchmark::Result::add(const Result& other)
+{
+	ticks += other.ticks;
+	activeTicks += other.activeTicks;
+	wallSeconds += other.wallSeconds;
+	frames += other.frames;
+	ticksPerSecond = (wallSeconds > 0) ? (ticks / wallSeconds) : 0;
+	framesPerSecond = (wallSeconds > 0) ? (frames / wallSeconds) : 0;
+	operationalAggregators = other.operationalAggregators;
+	peakMemoryKB = std::max(peakMemoryKB, other.peakMemoryKB);
+	stats.distributingDelay.merge(other.stats.distributingDelay);
+	stats.queueResidence.merge(other.stats.queueResidence);
+	stats.testFrames.merge(other.stats.testFrames);
+}
+
+Benchmark::Result Benchmark::measure(Topology& net, Simulation& sim, std::string workload, int endTime)
+{
+	int startTime = SimLog::Time;
+	unsigned long long startActive = sim.getActiveTicks();
+	NetStats::clear(net.Devices);
+	unsigned long long startFrames = net.countTxFrames();
+
+	auto startWall = std::chrono::steady_clock::now();
+	sim.run(endTime);
+	auto endWall = std::chrono::steady_clock::now();
+
+	Result result(net.Devices);
+
+	result.topology = net.name;
+	result.workload = workload;
+	result.devices = net.Devices.size();
+	result.links = net.links.size();
+	result.lags = net.countLags();
+	result.ticks = SimLog::Time - startTime;
+	result.activeTicks = sim.getActiveTicks() - startActive;
+	result.wallSeconds = std::chrono::duration<double>(endWall - startWall).count();
+	result.frames = net.countTxFrames() - startFrames;
+	result.ticksPerSecond = (result.wallSeconds > 0) ? (result.ticks / result.wallSeconds) : 0;
+	result.framesPerSecond = (result.wallSeconds > 0) ? (result.frames / result.wallSeconds) : 0;
+	result.operationalAggregators = net.countOperationalAggregators();
+	result.peakMemoryKB = peakMemoryKB();
+
+	return (result);
+}
+
+Benchmark::Result Benchmark::coldStart(Topology& net, int duration)
+{
+	//  Measure from reset, with all Links connected at once, until duration Time increments later
+	Simulation sim(net.Devices);
+	int start = SimLog::Time;
+
+	sim.schedule(start + 1, [&]() {
+		for (auto& pDev : net.Devices)
+		{
+			pDev->reset();
+		}
+		net.connectAll();
+	});
+	return (measure(net, sim, "coldStart", start + duration));
+}
+
+Benchmark::Result Benchmark::partitionedColdStart(Topology& net, int duration, unsigned int partitions)
+{
+	//  As coldStart, but with the Devices split into consecutive blocks, each run by a Partition in its own thread.
+	//     A Link between Devices in different blocks is connected through a MemoryTransport between their Partitions.
+	//     The Devices are moved into the Partitions for the run and back into the Topology afterwards.
+	size_t nDevices = net.Devices.size();
+	partitions = std::max(1u, std::min(partitions, (unsigned int)nDevices));
+	int start = SimLog::Time;
+
+	NetStats::clear(net.Devices);
+	unsigned long long startFrames = net.countTxFrames();
+	std::vector<size_t> owner(nDevices);
+	for (size_t dev = 0; dev < nDevices; dev++)
+	{
+		owner[dev] = (dev * partitions) / nDevices;
+		net.Devices[dev]->reset();
+	}
+
+	std::vector<std::vector<unique_ptr<Device>>> blocks(partitions);
+	std::vector<unique_ptr<Partition>> parts;
+	for (unsigned int p = 0; p < partitions; p++)
+		parts.push_back(make_unique<Partition>(blocks[p], 1));
+	std::map<std::pair<size_t, size_t>, std::pair<size_t, size_t>> neighbours;   // Neighbour index in each of a pair of Partitions
+	std::vector<size_t> cutLinks;
+	for (size_t link = 0; link < net.links.size(); link++)
+	{
+		size_t partA = owner[net.links[link].devA];
+		size_t partB = owner[net.links[link].devB];
+		if (partA == partB)
+		{
+			net.connect(link);
+			continue;
+		}
+		auto pair = std::make_pair(std::min(partA, partB), std::max(partA, partB));
+		if (neighbours.find(pair) == neighbours.end())
+		{
+			shared_ptr<Transport> pEndA;
+			shared_ptr<Transport> pEndB;
+			MemoryTransport::createPair(pEndA, pEndB);
+			neighbours[pair] = std::make_pair(parts[pair.first]->addNeighbour(pEndA), parts[pair.second]->addNeighbour(pEndB));
+		}
+		size_t neighbourA = (partA == pair.first) ? neighbours[pair].first : neighbours[pair].second;
+		size_t neighbourB = (partB == pair.first) ? neighbours[pair].first : neighbours[pair].second;
+		parts[partA]->connectRemote(net.Devices[net.links[link].devA]->pMacs[net.links[link].macA], neighbourA, (unsigned short)link, 5);
+		parts[partB]->connectRemote(net.Devices[net.links[link].devB]->pMacs[net.links[link].macB], neighbourB, (unsigned short)link, 5);
+		cutLinks.push_back(link);
+	}
+	for (size_t dev = 0; dev < nDevices; dev++)
+		blocks[owner[dev]].push_back(std::move(net.Devices[dev]));
+
+	auto startWall = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (unsigned int p = 0; p < partitions; p++)
+	{
+		workers.push_back(std::thread([&parts, p, start, duration]() {
+			SimLog::Time = start;
+			SimLog::logFile.rdbuf(nullptr);                // Partitions in other threads would interleave output
+			SimLog::console.rdbuf(nullptr);
+			parts[p]->run(start + duration);
+		}));
+	}
+	for (auto& worker : workers)
+		worker.join();
+	auto endWall = std::chrono::steady_clock::now();
+
+	unsigned long long activeTicks = 0;
+	for (auto& pPart : parts)
+		activeTicks += pPart->getSimulation().getActiveTicks();
+	parts.clear();
+	std::vector<size_t> next(partitions, 0);
+	for (size_t dev = 0; dev < nDevices; dev++)
+		net.Devices[dev] = std::move(blocks[owner[dev]][next[owner[dev]]++]);
+	SimLog::Time = start + duration;
+
+	Result result(net.Devices);
+	result.topology = net.name;
+	result.workload = "partitionedColdStart";
+	result.devices = nDevices;
+	result.links = net.links.size();
+	result.lags = net.countLags();
+	result.ticks = duration;
+	result.activeTicks = activeTicks;
+	result.wallSeconds = std::chrono::duration<double>(endWall - startWall).count();
+	result.frames = net.countTxFrames() - startFrames;
+	result.ticksPerSecond = (result.wallSeconds > 0) ? (result.ticks / result.wallSeconds) : 0;
+	result.framesPerSecond = (result.wallSeconds > 0) ? (result.frames / result.wallSeconds) : 0;
+	result.operationalAggregators = net.countOperationalAggregators();
+	result.peakMemoryKB = peakMemoryKB();
+
+	for (auto link : cutLinks)                             // Remote Links end with the Partitions
+	{
+		Mac::Disconnect(net.Devices[net.links[link].devA]->pMacs[net.links[link].macA]);
+		Mac::Disconnect(net.Devices[net.links[link].devB]->pMacs[net.links[link].macB]);
+	}
+	return (result);
+}
+
+Benchmark::Result Benchmark::linkFlapStorm(Topology& net, int flaps, int interval, unsigned int seed)
+{
+	//  After convergence, every interval Time increments disconnect a randomly chosen Link and reconnect it
+	//     half an interval later.  Measure until ConvergeTime after the last flap.
+	Simulation sim(net.Devices);
+	std::minstd_rand random(seed);
+
+	converge(net, sim);
+
+	int start = SimLog::Time;
+	for (int flap = 0; flap < flaps; flap++)
+	{
+		size_t link = random() % net.links.size();
+		sim.schedule(start + (flap * interval), [&net, link]() { net.disconnect(link); });
+		sim.schedule(start + (flap * interval) + std::max(1, interval / 2), [&net, link]() { net.connect(link); });
+	}
+	return (measure(net, sim, "linkFlapStorm", start + (flaps * interval) + ConvergeTime));
+}
+
+Benchmark::Result Benchmark::portalFailover(Topology& net, int failovers, int interval)
+{
+	//  After convergence, every interval Time increments disconnect all Links of the second System of a Portal
+	//     (in turn), and reconnect them half an interval later.  Measure until ConvergeTime after the last failover.
+	Simulation sim(net.Devices);
+
+	converge(net, sim);
+
+	int start = SimLog::Time;
+	for (int failover = 0; (failover < failovers) && !net.portals.empty(); failover++)
+	{
+		size_t dev = net.portals[failover % net.portals.size()].second;
+		sim.schedule(start + (failover * interval), [&net, dev]() { net.Devices[dev]->disconnect(); });
+		sim.schedule(start + (failover * interval) + (interval / 2), [&net, dev]() { net.connectDevice(dev); });
+	}
+	return (measure(net, sim, "portalFailover", start + (failovers * interval) + ConvergeTime));
+}
+
+Benchmark::Result Benchmark::sustainedTraffic(Topology& net, int duration)
+{
+	//  After convergence, every End Station transmits a test frame every Time increment for duration Time increments,
+	//     addressed to the next End Station.  The Bridges flood frames until they learn the destination,
+	//     so the Topology must not have loops.
+	Simulation sim(net.Devices);
+
+	converge(net, sim);
+
+	std::vector<unsigned long long> destinations;
+	for (size_t i = 0; i < net.stations.size(); i++)
+	{
+		EndStn& next = (EndStn&)*(net.Devices[net.stations[(i + 1) % net.stations.size()]]->pComponents[0]);
+		destinations.push_back(next.SystemId.addr);
+	}
+
+	int start = SimLog::Time;
+	for (int time = start; time < start + duration; time++)
+	{
+		sim.schedule(time, [&net, &destinations]() {
+			for (size_t i = 0; i < net.stations.size(); i++)
+			{
+				EndStn& station = (EndStn&)*(net.Devices[net.stations[i]]->pComponents[0]);  // Assumes EndStation is first component in device.
+				station.generateTestFrame(nullptr, destinations[i]);
+			}
+		});
+	}
+	return (measure(net, sim, "sustainedTraffic", start + duration));
+}
+
+Benchmark::Result Benchmark::trafficMix(Topology& net, int duration, double rate)
+{
+	//  After convergence, every End Station offers a flow of rate frames per Time increment, in Poisson bursts of
+	//     four frames, to the next End Station.  Frames step through 61 VLANs and 8 priorities, so the flow
+	//     spreads over many Conversation IDs.  The Topology must not have loops.
+	Simulation sim(net.Devices);
+
+	converge(net, sim);
+
+	int start = SimLog::Time;
+	for (size_t i = 0; i < net.stations.size(); i++)
+	{
+		EndStn& station = (EndStn&)*(net.Devices[net.stations[i]]->pComponents[0]);  // Assumes EndStation is first component in device.
+		EndStn& next = (EndStn&)*(net.Devices[net.stations[(i + 1) % net.stations.size()]]->pComponents[0]);
+		FlowProfile profile(next.SystemId.addr, rate);
+		profile.firstVid = 1;
+		profile.countVid = 61;
+		profile.countPriority = 8;
+		profile.burst = 4;
+		profile.timing = FlowProfile::Timing::POISSON;
+		profile.start = start;
+		profile.stop = start + duration;
+		profile.seed = (unsigned int)(i + 1);
+		station.traffic.addFlow(profile);
+	}
+	Result result = measure(net, sim, "trafficMix", start + duration);
+
+	for (auto stn : net.stations)
+		((EndStn&)*(net.Devices[stn]->pComponents[0])).traffic.clearFlows();
+	return (result);
+}
+
+Benchmark::Result Benchmark::snapshotFork(Topology& net, int forks)
+{
+	//  After convergence, save a Snapshot.  For each fork restore the Snapshot, disconnect a Link (a different one
+	//     for each fork), and run until ConvergeTime later.  The Result totals all forks.
+	Snapshot converged;
+	{
+		Simulation sim(net.Devices);
+		converge(net, sim);
+	}
+	converged.save(net.Devices);
+
+	Result total(net.Devices);
+	total.topology = net.name;
+	total.workload = "snapshotFork";
+	total.devices = net.Devices.size();
+	total.links = net.links.size();
+	total.lags = net.countLags();
+	for (int fork = 0; (fork < forks) && !net.links.empty(); fork++)
+	{
+		auto startWall = std::chrono::steady_clock::now();
+		converged.restore(net.Devices);
+		auto endWall = std::chrono::steady_clock::now();
+
+		Simulation sim(net.Devices);
+		size_t link = fork % net.links.size();
+		sim.schedule(SimLog::Time, [&net, link]() { net.disconnect(link); });
+		Result result = measure(net, sim, total.workload, SimLog::Time + ConvergeTime);
+		result.wallSeconds += std::chrono::duration<double>(endWall - startWall).count();
+		total.add(result);
+	}
+	return (total);
+}
+
+Benchmark::Result Benchmark::perturbationSweep(std::function<unique_ptr<Topology>()> build, unsigned int threads)
+{
+	//  Converge a network once and save a Snapshot.  Then run a Sweep of perturbations from the Snapshot:  disconnect
+	//     each Link, fail each Portal System, and change the Gateway algorithm and Wait To Restore Time of each Portal.
+	//     Each perturbation is run until ConvergeTime later.  The Result totals all perturbations.
+	unique_ptr<Topology> pNet = build();
+	Snapshot converged;
+	{
+		Simulation sim(pNet->Devices);
+		converge(*pNet, sim);
+	}
+	converged.save(pNet->Devices);
+
+	Sweep sweep(build, converged);
+	for (size_t link = 0; link < pNet->links.size(); link++)
+	{
+		sweep.add("link " + std::to_string(link), [link](Topology& net, Simulation& sim) {
+			sim.schedule(SimLog::Time, [&net, link]() { net.disconnect(link); });
+		});
+	}
+	for (size_t portal = 0; portal < pNet->portals.size(); portal++)
+	{
+		size_t dev = pNet->portals[portal].second;
+		sweep.add("failover " + std::to_string(portal), [dev](Topology& net, Simulation& sim) {
+			sim.schedule(SimLog::Time, [&net, dev]() { net.Devices[dev]->disconnect(); });
+			sim.schedule(SimLog::Time + (ConvergeTime / 2), [&net, dev]() { net.connectDevice(dev); });
+		});
+		sweep.add("gatewayAlgorithm " + std::to_string(portal), [dev](Topology& net, Simulation& sim) {
+			LinkAgg& lag = (LinkAgg&)*(net.Devices[dev]->pComponents[1]);   // Assumes LinkAgg is second component in device.
+			for (auto& pDR : lag.pDistRelays)
+				if (pDR) pDR->set_homeAdminGatewayAlgorithm(LagAlgorithms::S_VID);
+		});
+		sweep.add("waitToRestore " + std::to_string(portal), [dev](Topology& net, Simulation& sim) {
+			LinkAgg& lag = (LinkAgg&)*(net.Devices[dev]->pComponents[1]);
+			for (auto& pPort : lag.pAggPorts)
+				pPort->set_aAggPortWTRTime(ConvergeTime / 4);
+			sim.schedule(SimLog::Time, [&net, dev]() { net.Devices[dev]->disconnect(); });
+			sim.schedule(SimLog::Time + 10, [&net, dev]() { net.connectDevice(dev); });
+		});
+	}
+
+	auto startWall = std::chrono::steady_clock::now();
+	std::vector<unique_ptr<Result>> results = sweep.run(ConvergeTime, threads);
+	auto endWall = std::chrono::steady_clock::now();
+
+	Result total(pNet->Devices);
+	total.topology = pNet->name;
+	total.workload = "perturbationSweep";
+	total.devices = pNet->Devices.size();
+	total.links = pNet->links.size();
+	total.lags = pNet->countLags();
+	for (auto& pResult : results)
+	{
+		if (pResult)
+			total.add(*pResult);
+	}
+	total.wallSeconds = std::chrono::duration<double>(endWall - startWall).count();   // Elapsed, not the sum of the threads
+	total.ticksPerSecond = (total.wallSeconds > 0) ? (total.ticks / total.wallSeconds) : 0;
+	total.framesPerSecond = (total.wallSeconds > 0) ? (total.frames / total.wallSeconds) : 0;
+
+	return (total);
+}
+
+void Benchmark::writeHeader(std::ostream& results)
+{
+	results << "topology,workload,devices,links,lags,ticks,activeTicks,wallSeconds,ticksPerSecond,"
+		<< "frames,framesPerSecond,operationalAggregators,peakMemoryKB,"
+		<< "distributingDelayMean,distributingDelayMax,queueResidenceMean,queueResidenceMax,"
+		<< "testFramesReceived,testFramesLost,testFramesDuplicated,testFramesReordered,longestGap,"
+		<< "testLatencyMean,testLatencyMax" << endl;
+}
+
+void Benchmark::writeResult(std::ostream& results, const Result& result)
+{
+	results << result.topology << "," << result.workload << "," << result.devices << "," << result.links << ","
+		<< result.lags << "," << result.ticks << "," << result.activeTicks << "," << result.wallSeconds << ","
+		<< (unsigned long long)result.ticksPerSecond << "," << result.frames << ","
+		<< (unsigned long long)result.framesPerSecond << "," << result.operationalAggregators << ","
+		<< result.peakMemoryKB << ","
+		<< result.stats.distributingDelay.mean() << "," << result.stats.distributingDelay.max() << ","
+		<< result.stats.queueResidence.mean() << "," << result.stats.queueResidence.max() << ","
+		<< result.stats.testFrames.received << "," << result.stats.testFrames.lost << ","
+		<< result.stats.testFrames.duplicated << "," << result.stats.testFrames.reordered << ","
+		<< result.stats.testFrames.longestGap << ","
+		<< result.stats.testFrames.latency.mean() << "," << result.stats.testFrames.latency.max() << endl;
+}
+
+size_t Benchmark::peakMemoryKB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return (counters.PeakWorkingSetSize / 1024);
+	return (0);
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return ((size_t)usage.ru_maxrss);        // Kilobytes on Linux
+	return (0);
+#endif
+}
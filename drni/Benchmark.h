@@ -0,0 +1,140 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include "Device.h"
+#include "Simulation.h"
+
+
+/*
+*   Class Topology builds a network of Devices with a regular, parameterised structure for benchmarking:
+*       -- leafSpine:  every leaf Bridge has a LAG to every spine Bridge, and End Stations attached to each leaf with a LAG.
+*              With more than one spine the network has loops, so it is only suitable for control plane workloads.
+*       -- ring:  Bridges in a ring, with a LAG between neighbors (control plane workloads only).
+*       -- portalMesh:  DRNI Portals (pairs of Bridges) with a DRNI to DRNI LAG between every pair of Portals, and
+*              End Stations dual-homed to each Portal.
+*   The Links are recorded but not connected when the Topology is built, so a workload can schedule when they come up.
+*/
+
+class Topology
+{
+public:
+	Topology(std::string topologyName);
+	~Topology();
+	Topology(Topology& copySource) = delete;             // Disable copy constructor
+	Topology& operator= (const Topology&) = delete;      // Disable assignment operator
+
+	struct Link
+	{
+		size_t devA;
+		int macA;
+		size_t devB;
+		int macB;
+	};
+
+	std::string name;
+	std::vector<unique_ptr<Device>> Devices;
+	std::vector<Link> links;
+	std::vector<size_t> stations;                        // Device index of each End Station
+	std::vector<std::pair<size_t, size_t>> portals;      // Device indexes of the two Systems of each DRNI Portal
+
+	void connect(size_t link, unsigned short delay = 5);
+	void disconnect(size_t link);
+	void connectAll(unsigned short delay = 5);
+	void connectDevice(size_t dev, unsigned short delay = 5);   // Connect all Links of a Device
+	int countLags() const;                               // Number of LAGs that will be formed when all Links are connected
+	int countOperationalAggregators() const;
+	unsigned long long countTxFrames() const;            // Frames delivered by all Macs in the Topology
+
+	static unique_ptr<Topology> leafSpine(int spines, int leaves, int linksPerSpine, int stationsPerLeaf);
+	static unique_ptr<Topology> ring(int bridges, int linksPerHop);
+	static unique_ptr<Topology> portalMesh(int portals, int stationsPerPortal);
+
+private:
+	int lags;
+
+	size_t addBridge(int numMacs);
+	size_t addStation(int numMacs);
+	void addLink(size_t devA, int macA, size_t devB, int macB);
+	void configDistRelay(size_t dev, int drniMacIndex, unsigned short firstLinkNum);
+};
+
+
+/*
+*   Class Benchmark runs standard workloads on Topologies of increasing size and reports, for each run:
+*       the wall time, simulated Time increments per second, frames per second, and the peak memory of the process.
+*   Results are written as comma separated values with a header line, so they can be compared between releases.
+*       They include the convergence and frame loss statistics (NetStats) gathered during the measured part of the run.
+*   The snapshotFork workload converges once and then starts each of several Link failures from a Snapshot of the 
+*       converged network (see Snapshot.h), so its wall time includes restoring the Snapshot for each failure.
+*       The perturbationSweep workload runs a Sweep (see Sweep.h) of failures and administrative changes from a Snapshot
+*       in parallel threads, so its wall time is the elapsed time of the whole Sweep.
+*   The trafficMix workload offers each End Station's traffic generator (see TrafficGen.h) a Poisson flow spread
+*       over many VLANs and priorities, so its loss, reordering and latency show how evenly the LAGs distribute it.
+*   The partitionedColdStart workload splits the Topology into Partitions (see Partition.h), each run in its own thread
+*       and exchanging Frames through MemoryTransports, so its wall time is also elapsed time.  Its activeTicks is the
+*       total over all Partitions.
+*   It is run with "drni -benchmark [scale]" where scale (default 1) multiplies the size of every Topology.
+*   Logging is turned off while the workloads run (SimLog::Debug = 0), and console messages are discarded.
+*/
+
+class Benchmark
+{
+public:
+	struct Result
+	{
+		std::string topology;
+		std::string workload;
+		size_t devices;
+		size_t links;
+		int lags;
+		int ticks;                                   // Simulated Time increments
+		unsigned long long activeTicks;              // Time increments in which state machines were run
+		double wallSeconds;
+		double ticksPerSecond;
+		unsigned long long frames;                   // Frames delivered by Macs
+		double framesPerSecond;
+		int operationalAggregators;                  // At end of run
+		size_t peakMemoryKB;                         // Peak resident memory of the process so far
+		NetStats stats;                              // Accumulated during the run (see Stats.h)
+
+		Result(const std::vector<unique_ptr<Device>>& devices);
+		void add(const Result& other);               // Accumulate another run on the same Topology
+	};
+
+	static const int ConvergeTime = 500;             // Time increments allowed for LAGs to come up before measuring
+
+	static void run(int scale, std::ostream& results);
+
+	static Result coldStart(Topology& net, int duration);
+	static Result partitionedColdStart(Topology& net, int duration, unsigned int partitions);
+	static Result linkFlapStorm(Topology& net, int flaps, int interval, unsigned int seed = 1);
+	static Result portalFailover(Topology& net, int failovers, int interval);
+	static Result sustainedTraffic(Topology& net, int duration);
+	static Result trafficMix(Topology& net, int duration, double rate);
+	static Result snapshotFork(Topology& net, int forks);
+	static Result perturbationSweep(std::function<unique_ptr<Topology>()> build, unsigned int threads);
+
+	static void writeHeader(std::ostream& results);
+	static void writeResult(std::ostream& results, const Result& result);
+	static size_t peakMemoryKB();
+
+	static Result measure(Topology& net, Simulation& sim, std::string workload, int endTime);   // Run sim to endTime
+
+private:
+	static void converge(Topology& net, Simulation& sim);
+};
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Bridge.h"
+#include "Snapshot.h"
 
 
 Bridge::Bridge(unsigned short devNum, unsigned short sysNum, int nPorts)
@@ -40,7 +41,11 @@ Bridge::~Bridge()
 
 void Bridge::reset()
 {
-	//TODO:
+	fdb.clear();
+	for (auto& pPort : bPorts)
+	{
+		pPort->operational = false;
+	}
 }
 
 
@@ -57,24 +62,50 @@ void Bridge::run(bool singleStep)
 {
 	if (!suspended)
 	{
-		for (auto& ingress : bPorts)                            // For each BridgePort that may have an ingress Frame
+		size_t maxBurst = singleStep ? 1 : Iss::MaxBurst;
+
+		for (int i = 0; i < (int)bPorts.size(); i++)            // Flush addresses learned on BridgePorts that are no longer operational
 		{
-			unique_ptr<Frame> thisFrame = nullptr;              //      Check for an ingress Frame
-			if (ingress->pIss)
-			{
-				thisFrame = std::move(ingress->pIss->Indication());
-			}
-			if (thisFrame)                                      //      If there is an ingress frame
+			bool operational = bPorts[i]->pIss && bPorts[i]->pIss->getOperational();
+			if (bPorts[i]->operational && !operational)
+				fdb.flush(i);
+			bPorts[i]->operational = operational;
+		}
+
+		for (int in = 0; in < (int)bPorts.size(); in++)         // For each BridgePort that may have an ingress Frame
+		{
+			auto& ingress = bPorts[in];
+			if (ingress->pIss && ingress->pIss->IndicationBurst(rxBurst, maxBurst))    //      If there are ingress frames
 			{
-				for (auto& egress : bPorts)
+				rxEgress.clear();
+				for (auto& pFrame : rxBurst)                    //   Learn the source and find the egress for each Frame
 				{
-					if ((ingress != egress) &&
+					unsigned short vid = frameVid(*pFrame);
+					if (!(pFrame->MacSA & groupAddressBit))
+						fdb.learn(vid, pFrame->MacSA, in);
+					int out = Fdb::UnknownPort;
+					if (!(pFrame->MacDA & groupAddressBit))
+						out = fdb.lookup(vid, pFrame->MacDA);
+					rxEgress.push_back(out);
+				}
+				for (int out = 0; out < (int)bPorts.size(); out++)
+				{
+					auto& egress = bPorts[out];
+					if ((in != out) &&
 						egress->pIss && egress->pIss->getOperational())  // Then at every other operational BridgePort
 					{
-						unique_ptr<Frame> frameCopy = make_unique<Frame>(*thisFrame);  // Transmit a copy of the frame
-						egress->pIss->Request(move(frameCopy));
+						for (size_t j = 0; j < rxBurst.size(); j++)
+						{
+							if (rxEgress[j] == out)
+								txBurst.push_back(std::move(rxBurst[j]));          // Transmit a learned unicast frame
+							else if (rxEgress[j] == Fdb::UnknownPort)
+								txBurst.push_back(make_unique<Frame>(*rxBurst[j])); //   or a copy of a flooded frame
+						}
+						if (!txBurst.empty())
+							egress->pIss->RequestBurst(txBurst);
 					}
 				}
+				rxBurst.clear();                                // Discards frames filtered at the reception port
 			}
 		}
 	}
@@ -82,12 +113,58 @@ void Bridge::run(bool singleStep)
 
 
 
+void Bridge::saveState(Snapshot& snap) const
+{
+	snap.put(suspended);
+	snap.put(vlanType);
+	snap.put(SystemId);
+	snap.put(bPorts.size());
+	for (auto& pPort : bPorts)
+	{
+		snap.put(pPort->operational);
+	}
+	fdb.saveState(snap);
+}
+
+void Bridge::restoreState(Snapshot& snap)
+{
+	snap.get(suspended);
+	snap.get(vlanType);
+	snap.get(SystemId);
+	if (!snap.match(bPorts.size()))
+		return;
+	for (auto& pPort : bPorts)
+	{
+		snap.get(pPort->operational);
+	}
+	fdb.restoreState(snap);
+}
+
+const Fdb& Bridge::getFdb() const
+{
+	return (fdb);
+}
+
+unsigned short Bridge::frameVid(const Frame& thisFrame) const
+{
+	if ((vlanType != 0) && (thisFrame.getNextEtherType() == vlanType))
+		return (thisFrame.getOuterVid());
+	return (0);
+}
+
+int Bridge::nextEventTime() const
+{
+	return (SimLog::EndOfTime);
+}
+
+
 /**/
 
 
 BridgePort::BridgePort()
 {
 	pIss = nullptr;
+	operational = false;
 
 //	cout << "    BridgePort Constructor called." << endl;
 //	SimLog::logFile << "    BridgePort Constructor called." << endl;
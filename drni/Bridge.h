@@ -16,6 +16,7 @@ limitations under the License.
 
 #pragma once
 #include "Mac.h"
+#include "Fdb.h"
 
 /*
 *   Class BridgePort is a "port" on a Bridge. A "port" is an interface pointing to an ISS Service Access Point.
@@ -33,6 +34,7 @@ public:
 	BridgePort& operator= (const BridgePort&) = delete;      // Disable assignment operator
 
 	shared_ptr<Iss> pIss;
+	bool operational;         // Operational state of pIss when the Bridge last ran (entries are flushed when it goes down)
 
 };
 /**/
@@ -41,8 +43,13 @@ public:
 *   Class Bridge is a system component that can be contained in a Device.
 *       A  Bridge has two or more BridgePorts.
 *
-*       Currently the Bridge is not VLAN-aware, and does not learn addresses, so it simply
-*           replicates a Frame received at one port to be transmitted on all other ports.
+*       The Bridge learns the source address of each Frame received in its Filtering Database (see Fdb.h).
+*           A Frame with an individual destination address that has been learned is transmitted only on the
+*           BridgePort where that address was seen (or discarded if that is the reception port).  Other Frames
+*           (group addresses and unknown destinations) are replicated to be transmitted on all other ports.
+*       A VLAN Bridge (vlanType is CVlanEthertype or SVlanEthertype) learns addresses separately in each VLAN,
+*           using the VLAN Identifier of the outer tag if it is of vlanType (otherwise VLAN 0).  It does not
+*           otherwise filter by VLAN membership.
 *       Currently it does not implement any loop prevention protocols, so beware of
 *           generating data frames in a simulation with Bridges connected in a loop!
 */
@@ -61,8 +68,19 @@ public:
 
 	void reset();
 	void timerTick();
-	void run(bool singleStep);    // Receives a Frame from each BridgePort, replicates
-	                                    //     and transmits the Frame on all other BridgePorts
+	void run(bool singleStep);    // Receives a Frame from each BridgePort, and transmits the Frame on the BridgePort
+	                                    //     where its destination was learned, or on all other BridgePorts
+	const Fdb& getFdb() const;
+	int nextEventTime() const;    // Bridge only reacts to ingress Frames, which is an event at the ISS providing the BridgePort
+	void saveState(Snapshot& snap) const;
+	void restoreState(Snapshot& snap);
 
+private:
+	std::vector<unique_ptr<Frame>> rxBurst;     // Re-used for each burst of ingress Frames
+	std::vector<unique_ptr<Frame>> txBurst;     // Re-used for each burst of egress Frames
+	std::vector<int> rxEgress;                  // Egress BridgePort of each Frame in rxBurst (UnknownPort to flood)
+	Fdb fdb;
+
+	unsigned short frameVid(const Frame& thisFrame) const;   // VLAN in which the Frame's addresses are learned
 };
 /**/
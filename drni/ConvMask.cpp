@@ -0,0 +1,408 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "ConvMask.h"
+
+#if defined(__AVX2__)
+#define CONVMASK_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define CONVMASK_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(CONVMASK_SSE2)
+#include <immintrin.h>
+#endif
+
+
+static int popCount(unsigned long long word)
+{
+#if defined(_MSC_VER) && defined(_M_X64) && defined(CONVMASK_AVX2)   // Every processor with AVX2 has POPCNT
+	return ((int)__popcnt64(word));
+#elif defined(__GNUC__)
+	return (__builtin_popcountll(word));
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return ((int)((word * 0x0101010101010101ULL) >> 56));
+#endif
+}
+
+static int lowestBit(unsigned long long word)           // Index of the lowest bit that is set.  Word must not be zero.
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return ((int)index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)word))
+		return ((int)index);
+	_BitScanForward(&index, (unsigned long)(word >> 32));
+	return ((int)index + 32);
+#else
+	return (__builtin_ctzll(word));
+#endif
+}
+
+
+
+ConvMask::reference& ConvMask::reference::operator= (bool val)
+{
+	if (val)
+		word |= bit;
+	else
+		word &= ~bit;
+	return (*this);
+}
+
+ConvMask::reference& ConvMask::reference::operator= (const reference& other)
+{
+	return (*this = (bool)other);
+}
+
+ConvMask::reference::operator bool() const
+{
+	return ((word & bit) != 0);
+}
+
+bool ConvMask::reference::operator~() const
+{
+	return ((word & bit) == 0);
+}
+
+
+ConvMask::ConvMask()
+{
+	words.fill(0);
+}
+
+bool ConvMask::operator[] (size_t cid) const
+{
+	return (((words[cid >> 6] >> (cid & 0x3f)) & 1) != 0);
+}
+
+ConvMask::reference ConvMask::operator[] (size_t cid)
+{
+	return (reference(words[cid >> 6], 1ULL << (cid & 0x3f)));
+}
+
+bool ConvMask::test(size_t cid) const
+{
+	return ((*this)[cid]);
+}
+
+ConvMask& ConvMask::set()
+{
+	words.fill(~0ULL);
+	return (*this);
+}
+
+ConvMask& ConvMask::set(size_t cid, bool val)
+{
+	(*this)[cid] = val;
+	return (*this);
+}
+
+ConvMask& ConvMask::reset()
+{
+	words.fill(0);
+	return (*this);
+}
+
+ConvMask& ConvMask::reset(size_t cid)
+{
+	(*this)[cid] = false;
+	return (*this);
+}
+
+bool ConvMask::any() const
+{
+	unsigned long long anyBits = 0;
+	for (int i = 0; i < NumWords; i++)
+		anyBits |= words[i];
+	return (anyBits != 0);
+}
+
+bool ConvMask::none() const
+{
+	return (!any());
+}
+
+bool ConvMask::all() const
+{
+	unsigned long long allBits = ~0ULL;
+	for (int i = 0; i < NumWords; i++)
+		allBits &= words[i];
+	return (allBits == ~0ULL);
+}
+
+size_t ConvMask::count() const
+{
+	size_t total = 0;
+	for (int i = 0; i < NumWords; i++)
+		total += popCount(words[i]);
+	return (total);
+}
+
+bool ConvMask::operator== (const ConvMask& other) const
+{
+	unsigned long long diffBits = 0;
+	for (int i = 0; i < NumWords; i++)
+		diffBits |= (words[i] ^ other.words[i]);
+	return (diffBits == 0);
+}
+
+bool ConvMask::operator!= (const ConvMask& other) const
+{
+	return (!(*this == other));
+}
+
+ConvMask& ConvMask::operator&= (const ConvMask& other)
+{
+	for (int i = 0; i < NumWords; i++)
+		words[i] &= other.words[i];
+	return (*this);
+}
+
+ConvMask& ConvMask::operator|= (const ConvMask& other)
+{
+	for (int i = 0; i < NumWords; i++)
+		words[i] |= other.words[i];
+	return (*this);
+}
+
+ConvMask& ConvMask::operator^= (const ConvMask& other)
+{
+	for (int i = 0; i < NumWords; i++)
+		words[i] ^= other.words[i];
+	return (*this);
+}
+
+ConvMask ConvMask::operator~ () const
+{
+	ConvMask result;
+	for (int i = 0; i < NumWords; i++)
+		result.words[i] = ~words[i];
+	return (result);
+}
+
+ConvMask& ConvMask::andNot(const ConvMask& other)
+{
+	for (int i = 0; i < NumWords; i++)
+		words[i] &= ~other.words[i];
+	return (*this);
+}
+
+size_t ConvMask::countDiff(const ConvMask& other) const
+{
+	size_t total = 0;
+	for (int i = 0; i < NumWords; i++)
+		total += popCount(words[i] ^ other.words[i]);
+	return (total);
+}
+
+int ConvMask::nextSet(int cid) const
+{
+	if (cid >= NumBits)
+		return (NumBits);
+
+	int i = cid >> 6;
+	unsigned long long word = words[i] & (~0ULL << (cid & 0x3f));    // Ignore Conversation IDs before cid in the first word
+	while (word == 0)
+	{
+		if (++i >= NumWords)
+			return (NumBits);
+		word = words[i];
+	}
+	return ((i << 6) + lowestBit(word));
+}
+
+void ConvMask::assignEqual(const std::array<unsigned short, 4096>& cidVector, unsigned short value)
+{
+	const unsigned short* pEntry = cidVector.data();
+
+#if defined(CONVMASK_AVX2)
+	const __m256i match = _mm256_set1_epi16((short)value);
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned long long word = 0;
+		for (int j = 0; j < 64; j += 32)                 // Compare 32 entries, pack the results to bytes, and extract 32 bits
+		{
+			__m256i eqLow = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(pEntry + j)), match);
+			__m256i eqHigh = _mm256_cmpeq_epi16(_mm256_loadu_si256((const __m256i*)(pEntry + j + 16)), match);
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(eqLow, eqHigh), 0xD8);   // Pack works per 128 bit lane
+			word |= (unsigned long long)(unsigned int)_mm256_movemask_epi8(packed) << j;
+		}
+		words[i] = word;
+	}
+#elif defined(CONVMASK_SSE2)
+	const __m128i match = _mm_set1_epi16((short)value);
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned long long word = 0;
+		for (int j = 0; j < 64; j += 16)                 // Compare 16 entries, pack the results to bytes, and extract 16 bits
+		{
+			__m128i eqLow = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(pEntry + j)), match);
+			__m128i eqHigh = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(pEntry + j + 8)), match);
+			word |= (unsigned long long)(unsigned int)_mm_movemask_epi8(_mm_packs_epi16(eqLow, eqHigh)) << j;
+		}
+		words[i] = word;
+	}
+#else
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned long long word = 0;
+		for (int j = 0; j < 64; j++)
+			word |= (unsigned long long)(pEntry[j] == value) << j;
+		words[i] = word;
+	}
+#endif
+}
+
+void ConvMask::assignEqual(const std::array<unsigned char, 4096>& cidVector, unsigned char value)
+{
+	const unsigned char* pEntry = cidVector.data();
+
+#if defined(CONVMASK_AVX2)
+	const __m256i match = _mm256_set1_epi8((char)value);
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned int low = (unsigned int)_mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)pEntry), match));
+		unsigned int high = (unsigned int)_mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(pEntry + 32)), match));
+		words[i] = ((unsigned long long)high << 32) | low;
+	}
+#elif defined(CONVMASK_SSE2)
+	const __m128i match = _mm_set1_epi8((char)value);
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned long long word = 0;
+		for (int j = 0; j < 64; j += 16)
+			word |= (unsigned long long)(unsigned int)_mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pEntry + j)), match)) << j;
+		words[i] = word;
+	}
+#else
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned long long word = 0;
+		for (int j = 0; j < 64; j++)
+			word |= (unsigned long long)(pEntry[j] == value) << j;
+		words[i] = word;
+	}
+#endif
+}
+
+
+void ConvMask::fillWhere(std::array<unsigned char, 4096>& cidVector, unsigned char value) const
+{
+	unsigned char* pEntry = cidVector.data();
+
+#if defined(CONVMASK_AVX2)
+	const __m256i fill = _mm256_set1_epi8((char)value);
+	const __m256i byteOfBit = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+		2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+	const __m256i bitInByte = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+#elif defined(CONVMASK_SSE2)
+	const __m128i fill = _mm_set1_epi8((char)value);
+	const __m128i bitInByte = _mm_set1_epi64x((long long)0x8040201008040201ULL);
+#endif
+
+	for (int i = 0; i < NumWords; i++, pEntry += 64)
+	{
+		unsigned long long word = words[i];
+		if (word == 0)                                   // Nothing to change for these 64 Conversation IDs
+			continue;
+		if (word == ~0ULL)
+		{
+			std::fill_n(pEntry, 64, value);
+			continue;
+		}
+
+#if defined(CONVMASK_AVX2)
+		for (int j = 0; j < 64; j += 32)                 // Expand 32 bits to 32 byte masks, and blend in the fill value
+		{
+			__m256i bits = _mm256_shuffle_epi8(_mm256_set1_epi32((int)(unsigned int)(word >> j)), byteOfBit);
+			__m256i select = _mm256_cmpeq_epi8(_mm256_and_si256(bits, bitInByte), bitInByte);
+			__m256i* pBlock = (__m256i*)(pEntry + j);
+			_mm256_storeu_si256(pBlock, _mm256_blendv_epi8(_mm256_loadu_si256(pBlock), fill, select));
+		}
+#elif defined(CONVMASK_SSE2)
+		for (int j = 0; j < 64; j += 16)                 // Expand 16 bits to 16 byte masks, and blend in the fill value
+		{
+			__m128i bits = _mm_unpacklo_epi64(_mm_set1_epi8((char)(word >> j)), _mm_set1_epi8((char)(word >> (j + 8))));
+			__m128i select = _mm_cmpeq_epi8(_mm_and_si128(bits, bitInByte), bitInByte);
+			__m128i* pBlock = (__m128i*)(pEntry + j);
+			__m128i entries = _mm_loadu_si128(pBlock);
+			_mm_storeu_si128(pBlock, _mm_or_si128(_mm_and_si128(select, fill), _mm_andnot_si128(select, entries)));
+		}
+#else
+		while (word != 0)
+		{
+			pEntry[lowestBit(word)] = value;
+			word &= (word - 1);                          // Clear lowest bit that is set
+		}
+#endif
+	}
+}
+
+static unsigned char reverseBits(unsigned char octet)   // Swap bit order so the first Conversation ID is the MSB
+{
+	octet = (unsigned char)(((octet & 0xf0) >> 4) | ((octet & 0x0f) << 4));
+	octet = (unsigned char)(((octet & 0xcc) >> 2) | ((octet & 0x33) << 2));
+	return ((unsigned char)(((octet & 0xaa) >> 1) | ((octet & 0x55) << 1)));
+}
+
+void ConvMask::getOctets(unsigned char* octets, int firstCid, int numCids) const
+{
+	for (int cid = firstCid; cid < firstCid + numCids; cid += 8)
+		*octets++ = reverseBits((unsigned char)(words[cid >> 6] >> (cid & 0x3f)));
+}
+
+void ConvMask::setOctets(const unsigned char* octets, int firstCid, int numCids)
+{
+	for (int cid = firstCid; cid < firstCid + numCids; cid += 8)
+	{
+		unsigned long long& word = words[cid >> 6];
+		int shift = cid & 0x3f;
+		word = (word & ~(0xffULL << shift)) | ((unsigned long long)reverseBits(*octets++) << shift);
+	}
+}
+
+ConvMask operator& (const ConvMask& lhs, const ConvMask& rhs)
+{
+	ConvMask result = lhs;
+	return (result &= rhs);
+}
+
+ConvMask operator| (const ConvMask& lhs, const ConvMask& rhs)
+{
+	ConvMask result = lhs;
+	return (result |= rhs);
+}
+
+ConvMask operator^ (const ConvMask& lhs, const ConvMask& rhs)
+{
+	ConvMask result = lhs;
+	return (result ^= rhs);
+}
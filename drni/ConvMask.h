@@ -0,0 +1,102 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+
+/*
+*   Class ConvMask is a Boolean vector with one element for each of the 4096 Conversation IDs.  It replaces
+*       std::bitset<4096> for the conversation masks of LinkAgg and DRNI (portOperConversationMask, homeGatewayMask, etc.).
+*       It has the same interface as std::bitset for the operations used in the simulation (element access, set, reset,
+*       any, count, comparison, and bitwise operators), and adds operations for the mask updates on the convergence path:
+*           -- assignEqual sets each Conversation ID element true if the corresponding element of a Conversation ID vector
+*                 (e.g. conversationPortVector or homeSelectedGatewayVector) is equal to a value, and false otherwise.
+*           -- andNot clears each element that is true in another mask.
+*           -- countDiff returns the number of Conversation IDs for which two masks differ.
+*           -- fillWhere sets the elements of a Conversation ID vector to a value for the Conversation IDs that are true
+*                 in the mask, leaving the other elements unchanged.
+*           -- nextSet returns the first Conversation ID at or after a given Conversation ID that is true in the mask,
+*                 so a loop can visit only the Conversation IDs in the mask.
+*           -- getOctets and setOctets copy a range of Conversation IDs to or from the octets of a PDU TLV (see PduCodec.h),
+*                 where the first Conversation ID of the range is the most significant bit of the first octet.
+*           -- getWord and setWord access the 64 Conversation IDs of one storage word (word w holds Conversation IDs
+*                 64*w through 64*w+63), so the changes between two masks can be recorded word by word (see ConvMaskDelta).
+*   The mask is stored as 64 bit words so the bitwise operations handle 64 Conversation IDs per operation (or more where
+*       the compiler vectorizes the word loops).  assignEqual and fillWhere use SSE2 or AVX2 when available (x64 always has 
+*       SSE2), and otherwise a portable loop over each 64 bit word.
+*/
+
+class ConvMask
+{
+public:
+	static const int NumBits = 4096;
+	static const int NumWords = NumBits / 64;
+
+	class reference                                           // Proxy to a single element, like std::bitset::reference
+	{
+	public:
+		reference(unsigned long long& word, unsigned long long bit) : word(word), bit(bit) {}
+		reference& operator= (bool val);
+		reference& operator= (const reference& other);
+		operator bool() const;
+		bool operator~() const;
+
+	private:
+		unsigned long long& word;
+		unsigned long long bit;
+	};
+
+	ConvMask();                                               // All Conversation IDs false
+
+	bool operator[] (size_t cid) const;
+	reference operator[] (size_t cid);
+	bool test(size_t cid) const;
+
+	ConvMask& set();                                          // All Conversation IDs true
+	ConvMask& set(size_t cid, bool val = true);
+	ConvMask& reset();                                        // All Conversation IDs false
+	ConvMask& reset(size_t cid);
+	bool any() const;
+	bool none() const;
+	bool all() const;
+	size_t count() const;                                     // Number of Conversation IDs that are true
+
+	bool operator== (const ConvMask& other) const;
+	bool operator!= (const ConvMask& other) const;
+	ConvMask& operator&= (const ConvMask& other);
+	ConvMask& operator|= (const ConvMask& other);
+	ConvMask& operator^= (const ConvMask& other);
+	ConvMask operator~ () const;
+
+	ConvMask& andNot(const ConvMask& other);                  // Clear Conversation IDs that are true in other 
+	size_t countDiff(const ConvMask& other) const;            // Number of Conversation IDs that differ from other
+	int nextSet(int cid) const;                               // First true Conversation ID >= cid, or NumBits if none
+	void assignEqual(const std::array<unsigned short, 4096>& cidVector, unsigned short value);
+	void assignEqual(const std::array<unsigned char, 4096>& cidVector, unsigned char value);
+	void fillWhere(std::array<unsigned char, 4096>& cidVector, unsigned char value) const;
+	void getOctets(unsigned char* octets, int firstCid, int numCids) const;   // firstCid and numCids are multiples of 8
+	void setOctets(const unsigned char* octets, int firstCid, int numCids);
+	unsigned long long getWord(int index) const { return (words[index]); }
+	void setWord(int index, unsigned long long value) { words[index] = value; }
+
+private:
+	std::array<unsigned long long, NumWords> words;
+};
+
+ConvMask operator& (const ConvMask& lhs, const ConvMask& rhs);
+ConvMask operator| (const ConvMask& lhs, const ConvMask& rhs);
+ConvMask operator^ (const ConvMask& lhs, const ConvMask& rhs);
@@ -0,0 +1,136 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "DataPlane.h"
+
+
+
+DataPlane::DataPlane(unsigned int threads)
+	: nextTask(0)
+{
+	phase = 0;
+	phaseTime = SimLog::Time;
+	busyWorkers = 0;
+	stopWorkers = false;
+	nTasks = 0;
+	pTask = nullptr;
+	logFlags = SimLog::logFile.flags();
+
+	for (unsigned int i = 1; i < threads; i++)      // The calling thread is also used to run tasks
+	{
+		workers.push_back(std::thread(&DataPlane::workerLoop, this));
+	}
+}
+
+DataPlane::~DataPlane()
+{
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		stopWorkers = true;
+	}
+	phaseStart.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+unsigned int DataPlane::getThreads() const
+{
+	return ((unsigned int)workers.size() + 1);
+}
+
+void DataPlane::run(size_t tasks, const std::function<void(size_t)>& task)
+{
+	if (workers.empty())                                     // Run serially if single threaded
+	{
+		for (size_t i = 0; i < tasks; i++)
+			task(i);
+		return;
+	}
+
+	while (outputs.size() < tasks)
+		outputs.push_back(make_unique<std::stringbuf>());
+	std::streambuf* pLogBuf = SimLog::logFile.rdbuf();      // Save the calling thread's log stream
+	logFlags = SimLog::logFile.flags();
+
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		nTasks = tasks;
+		pTask = &task;
+		nextTask = 0;
+		busyWorkers = (unsigned int)workers.size();
+		phaseTime = SimLog::Time;
+		phase++;
+	}
+	phaseStart.notify_all();
+
+	runTasks();                                              // Calling thread runs tasks along with the workers
+
+	{
+		std::unique_lock<std::mutex> lock(poolMutex);        // Barrier:  wait for all workers to finish the run
+		phaseDone.wait(lock, [this] { return (busyWorkers == 0); });
+		pTask = nullptr;
+	}
+
+	SimLog::logFile.rdbuf(pLogBuf);                          // Restore the calling thread's log stream
+	SimLog::logFile.flags(logFlags);
+
+	for (size_t i = 0; i < tasks; i++)                       // Copy buffered output in task order
+	{
+		if (outputs[i]->in_avail() > 0)
+			SimLog::logFile << outputs[i]->str();
+		outputs[i]->str("");
+	}
+}
+
+void DataPlane::runTasks()
+{
+	size_t i;
+	while ((i = nextTask++) < nTasks)
+	{
+		SimLog::logFile.rdbuf(outputs[i].get());
+		SimLog::logFile.flags(logFlags);
+
+		(*pTask)(i);
+	}
+}
+
+void DataPlane::workerLoop()
+{
+	unsigned long long lastPhase = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(poolMutex);
+			phaseStart.wait(lock, [this, lastPhase] { return (stopWorkers || (phase != lastPhase)); });
+			if (stopWorkers)
+				return;
+			lastPhase = phase;
+			SimLog::Time = phaseTime;
+		}
+
+		runTasks();
+
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			busyWorkers--;
+		}
+		phaseDone.notify_one();
+	}
+}
@@ -0,0 +1,100 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "ConvMask.h"
+
+
+/*
+*   Struct Forwarding is the state a LinkAgg's data plane (collection and distribution of frames) needs, copied out of
+*       the AggPorts and Aggregators by the control plane (the LACP state machines and CSDC) after they run.
+*       A Forwarding is never changed once published.  The LinkAgg replaces it with a new one when the control plane
+*       changes something in it, so the data plane can read it without locks while the control plane moves on.
+*   The conversation masks and egress tables are large and rarely change, so they are held through shared_ptr and a new
+*       Forwarding shares those of the previous one that have not changed.
+*   Ports and Aggregators are identified by their index in the LinkAgg's pAggPorts and pAggregators.
+*/
+
+struct Forwarding
+{
+	typedef std::array<unsigned short, 4096> EgressTable;    // Index (plus one) of egress port for each Conversation ID, 0 for none
+
+	struct PortEntry
+	{
+		unsigned short aggregatorIndex;                      // Aggregator the port is attached to (its data plane partition)
+		bool distributing;
+		bool discardWrongConversation;
+		LagAlgorithms algorithm;
+		unsigned long long lacpDestinationAddress;           // Frames to this address with an LACPDU go to the control plane
+		shared_ptr<const ConvMask> pCollectionMask;          // Conversation IDs collected when discardWrongConversation
+		shared_ptr<const ConvMask> pDistributionMask;        // Conversation IDs distributed (portOperConversationMask)
+		unsigned short device;                               // For traces:  addrMid of System ID,
+		unsigned short portNumber;                           //    port number,
+		unsigned short linkNumber;                           //    and Link Number ID
+	};
+
+	struct AggregatorEntry
+	{
+		bool enabled;
+		LagAlgorithms algorithm;
+		shared_ptr<const EgressTable> pEgressPorts;          // Null if no Conversation ID is distributed
+		unsigned short device;                               // For traces:  addrMid of System ID
+		unsigned short aggregatorIdentifier;                 //    and Aggregator Identifier
+	};
+
+	std::vector<PortEntry> ports;
+	std::vector<AggregatorEntry> aggregators;
+};
+
+
+/*
+*   Class DataPlane is a pool of threads that runs the data plane of a LinkAgg (see LinkAgg::run) in parallel.
+*       run(tasks, task) calls task(0) through task(tasks - 1), spread across the calling thread and the workers, and
+*       returns when all are done.  The tasks must not touch the same objects (the LinkAgg gives each task the ports
+*       and queues of one Aggregator).
+*   As in Simulation, logFile output of each task is buffered and written in task order after all tasks finish,
+*       and the workers take the SimLog::Time of the calling thread.
+*/
+
+class DataPlane
+{
+public:
+	DataPlane(unsigned int threads);
+	~DataPlane();
+	DataPlane(DataPlane& copySource) = delete;              // Disable copy constructor
+	DataPlane& operator= (const DataPlane&) = delete;       // Disable assignment operator
+
+	void run(size_t tasks, const std::function<void(size_t)>& task);
+	unsigned int getThreads() const;                        // Number of threads running tasks (including the calling thread)
+
+private:
+	std::vector<std::thread> workers;                       // Threads in addition to the calling thread
+	std::vector<unique_ptr<std::stringbuf>> outputs;        // Log output of each task
+	std::mutex poolMutex;
+	std::condition_variable phaseStart;
+	std::condition_variable phaseDone;
+	unsigned long long phase;                               // Incremented to start each run
+	int phaseTime;                                          // SimLog::Time of the calling thread in the current run
+	unsigned int busyWorkers;                               // Workers that have not finished the current run
+	bool stopWorkers;
+	size_t nTasks;
+	const std::function<void(size_t)>* pTask;
+	std::atomic<size_t> nextTask;                           // Next task to be run in the current run
+	std::ios_base::fmtflags logFlags;                       // Format of the logFile at the start of the run
+
+	void runTasks();                                        // Run tasks until there are none left in the current run
+	void workerLoop();
+};
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Device.h"
+#include "Snapshot.h"
 #include "Frame.h"
 #include "LinkAgg.h"
 #include "Aggregator.h"
@@ -23,7 +24,7 @@ limitations under the License.
 
 
 
-unsigned short Device::devCnt = 0;
+std::atomic<unsigned short> Device::devCnt(0);
 
 Device::Device(int numMacs)	
 	: Component(ComponentTypes::DEVICE)
@@ -85,6 +86,10 @@ void Device::reset()                              // Initialize all operational
 
 void Device::timerTick()                          // If not suspended, Tick timers in all Components and Macs
 {   
+	for (auto& pMac : pMacs)                      // Macs receive Frames from their link partners even in a suspended Device
+	{
+		pMac->Receive();
+	}
 	if (!suspended) 
 	{ 
 		for (auto& pComp : pComponents)
@@ -113,6 +118,63 @@ void Device::run(bool singleStep)                 // If not suspended, Make one
 	}
 }
 
+int Device::nextEventTime() const                 // Earliest next event of all Components and Macs
+{
+	int nextTime = SimLog::EndOfTime;
+
+	if (!suspended)
+	{
+		for (auto& pComp : pComponents)
+		{
+			nextTime = std::min(nextTime, pComp->nextEventTime());
+		}
+		for (auto& pMac : pMacs)
+		{
+			nextTime = std::min(nextTime, pMac->nextEventTime());
+		}
+	}
+	return (nextTime);
+}
+
+void Device::saveState(Snapshot& snap) const
+{
+	snap.put(devNum);
+	snap.put(suspended);
+	snap.put(pComponents.size());
+	for (auto& pComp : pComponents)
+	{
+		snap.put((size_t)pComp->getCompType());
+		pComp->saveState(snap);
+	}
+	snap.put(pMacs.size());
+	for (auto& pMac : pMacs)
+	{
+		pMac->saveState(snap);
+	}
+	pDistRelayLink->saveState(snap);
+}
+
+void Device::restoreState(Snapshot& snap)
+{
+	snap.get(devNum);
+	snap.get(suspended);
+	if (!snap.match(pComponents.size()))
+		return;
+	for (auto& pComp : pComponents)
+	{
+		if (!snap.match((size_t)pComp->getCompType()))
+			return;
+		pComp->restoreState(snap);
+	}
+	if (!snap.match(pMacs.size()))
+		return;
+	for (auto& pMac : pMacs)
+	{
+		pMac->restoreState(snap);
+	}
+	pDistRelayLink->restoreState(snap);
+}
+
 void Device::transmit()                           // If not suspended, Transmit a Frame from any Macs in Device with a Frame ready to transmit
 {
 	for (auto& pMac : pMacs)
@@ -131,12 +193,13 @@ void Device::disconnect()                         // Disconnect all Macs in the
 
 
 
-void Device::createBridge(unsigned short type, bool includeDR)
+void Device::createBridge(unsigned short type, bool includeDR, unsigned short numAggregators)
 {
 	/**/
 	unsigned short sysNum = 0;       // This is a single system device
-	int nPorts = pMacs.size();       // Number of Bridge Ports = number of Macs in Device
-	unique_ptr<Bridge> pBridge = make_unique<Bridge>(devNum, sysNum, nPorts);  // Make a Bridge with a BridgePort for each Mac
+	int nPorts = pMacs.size();       // Number of Aggregation Ports = number of Macs in Device
+	int nAggregators = ((numAggregators > 0) && (numAggregators < nPorts)) ? numAggregators : nPorts;
+	unique_ptr<Bridge> pBridge = make_unique<Bridge>(devNum, sysNum, nAggregators);  // Make a Bridge with a BridgePort for each Aggregator
 	pBridge->vlanType = type;							               // Set as MAC, C-VLAN, or S-VLAN Bridge
 
 	unsigned char LacpVersion = 2;
@@ -147,16 +210,20 @@ void Device::createBridge(unsigned short type, bool includeDR)
 
 	for (unsigned short i = 0; i < nPorts; i++)    // For each Mac:
 	{
-//		shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>();    // Create an Aggregator
-		shared_ptr<AggPort> pAggPort = make_shared<AggPort>(pLag->LacpVersion, sysNum, i);    // Create an Aggregation Port/Aggregator pair
-		pAggPort->assignActorSystem(pBridge->SystemId);                       // Assign Aggregation Port/Aggregator to this bridge
-		pBridge->bPorts[i]->pIss = pAggPort;                               // Attach the Aggregation Port/Aggregator to a BridgePort
+		shared_ptr<AggPort> pAggPort = make_shared<AggPort>(pLag->LacpVersion, sysNum, i);    // Create an Aggregation Port
+		pAggPort->assignActorSystem(pBridge->SystemId);                       // Assign Aggregation Port to this bridge
 		pAggPort->pIss = pMacs[i];                                         // Attach the Mac to the Aggregation Port
 		pMacs[i]->updateMacSystemId(pBridge->SystemId.id);                 // Update Mac address/sapId with device type and sysNum
-		pLag->pAggregators.push_back(pAggPort);                              // Put Aggregator in the Device's Lag shim
 		pLag->pAggPorts.push_back(pAggPort);                                 // Put Aggregation Port in the Device's Lag shim
 		pLag->pDistRelays.push_back(nullptr);
 	}
+	for (unsigned short i = 0; i < nAggregators; i++)    // For each Aggregator in the pool:
+	{
+		shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>(pLag->LacpVersion, sysNum, i);    // Create an Aggregator
+		pAggregator->assignActorSystem(pBridge->SystemId);                    // Assign Aggregator to this bridge
+		pBridge->bPorts[i]->pIss = pAggregator;                            // Attach the Aggregator to a BridgePort
+		pLag->pAggregators.push_back(pAggregator);                           // Put Aggregator in the Device's Lag shim
+	}
 	pComponents.push_back(move(pBridge));                             // Put the Bridge in the Device Components vector
 	pComponents.push_back(move(pLag));                                // Put the Link Aggregation shim in the Device Components vector
 
@@ -183,12 +250,13 @@ void Device::createEndStation(bool includeDR)
 	{
 		for (unsigned short i = 0; i < nPorts; i++)    // For each Mac:
 		{
-//			shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>();    // Create an Aggregator
-			shared_ptr<AggPort> pAggPort = make_shared<AggPort>(pLag->LacpVersion, sysNum, i);             // Create an Aggregation Port/Aggregator pair
-			pAggPort->assignActorSystem(pStation->SystemId);                      // Assign Aggregation Port/Aggregator to this End Station
+			shared_ptr<AggPort> pAggPort = make_shared<AggPort>(pLag->LacpVersion, sysNum, i);             // Create an Aggregation Port
+			shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>(pLag->LacpVersion, sysNum, i);    //    and an Aggregator
+			pAggPort->assignActorSystem(pStation->SystemId);                      // Assign Aggregation Port and Aggregator to this End Station
+			pAggregator->assignActorSystem(pStation->SystemId);
 			pAggPort->pIss = pMacs[i];                                         // Attach the Mac to the Aggregation Port
 			pMacs[i]->updateMacSystemId(pStation->SystemId.id);                // Update Mac address/sapId with device type and sysNum
-			pLag->pAggregators.push_back(pAggPort);                              // Put Aggregator in the Device's Lag shim
+			pLag->pAggregators.push_back(pAggregator);                           // Put Aggregator in the Device's Lag shim
 			pLag->pAggPorts.push_back(pAggPort);                                 // Put Aggregation Port in the Device's Lag shim
 			pLag->pDistRelays.push_back(nullptr);
 			if (i == 0)
@@ -196,7 +264,7 @@ void Device::createEndStation(bool includeDR)
 				pStation->pIss = pLag->pAggregators[i];                          // Attach the first Aggregator to the End Station
 
 			} else {
-				pAggPort->set_aAggActorAdminKey(unusedAggregatorKey);          // Set Admin key of other Aggregators to value not shared with any AggPort
+				pAggregator->set_aAggActorAdminKey(unusedAggregatorKey);       // Set Admin key of other Aggregators to value not shared with any AggPort
 			}
 		}
 	} 
@@ -256,13 +324,28 @@ void EndStn::run(bool singleStep)
 {
 	if (!suspended) 
 	{ 
-		//TODO:  Currently run always single steps.  When singleStep is false should iterate until rx queue empty
-		unique_ptr<Frame> pFrame = std::move(pIss->Indication());
-		if (pFrame)
+		size_t maxBurst = singleStep ? 1 : Iss::MaxBurst;     // When not single stepping take all frames waiting (up to a burst)
+
+		if (pIss)
+			pIss->IndicationBurst(rxBurst, maxBurst);
+		for (auto& pFrame : rxBurst)
 		{
 			rxFrameCount++;
 
-			if (SimLog::Debug > 5)
+			const Sdu* pSdu = &pFrame->getNextSdu();           // Find the test Sdu (if any) behind any VLAN tags
+			while ((pSdu->getEtherType() == CVlanEthertype) || (pSdu->getEtherType() == SVlanEthertype))
+				pSdu = &pSdu->getNextSdu();
+			if ((pSdu->getEtherType() == PlaypenEthertypeA) && (pSdu->getSubType() == 1))
+			{
+				const TestSdu& test = *(const TestSdu*)pSdu;
+				bool groupDA = ((pFrame->MacDA >> 40) & 1) != 0;
+				if (!test.flowId)
+					flows[pFrame->MacSA].record(test.scratchPad, test.timeSent);
+				else if ((pFrame->MacDA == SystemId.addr) || groupDA)   // Not flooded copies of another station's flow
+					flows[test.flowId].record(test.scratchPad, test.timeSent);
+			}
+
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << "    EndStation " << hex << SystemId.addr << " received frame ";
 				pFrame->PrintFrameHeader();
@@ -279,16 +362,67 @@ void EndStn::run(bool singleStep)
 
 			}
 		}
+		rxBurst.clear();
+
+		if (pIss && traffic.getFlowCount())
+			traffic.generate(*pIss, SystemId.addr);
 	}
 }
 
-void EndStn::generateTestFrame(shared_ptr<Sdu> pTag)
+int EndStn::nextEventTime() const
+{
+	if (suspended)
+		return (SimLog::EndOfTime);
+	return (traffic.nextEventTime());  // Otherwise End Station only reacts to frames (an event at its ISS) or being told to generate a frame
+}
+
+FlowStats EndStn::getFlowStats() const
+{
+	FlowStats total;
+	for (auto& flow : flows)
+		total.merge(flow.second);
+	return (total);
+}
+
+FlowStats EndStn::getFlowStats(unsigned long long sourceAddr) const
+{
+	auto flow = flows.find(sourceAddr);
+	if (flow == flows.end())
+		return (FlowStats());
+	return (flow->second);
+}
+
+void EndStn::clearStats()
+{
+	rxFrameCount = 0;
+	flows.clear();
+}
+
+void EndStn::saveState(Snapshot& snap) const
+{
+	snap.put(suspended);
+	snap.put(SystemId);
+	snap.put(sequenceNumber);
+	traffic.saveState(snap);
+	// rxFrameCount and flows are statistics (see Stats.h), so are not saved
+}
+
+void EndStn::restoreState(Snapshot& snap)
+{
+	snap.get(suspended);
+	snap.get(SystemId);
+	snap.get(sequenceNumber);
+	traffic.restoreState(snap);
+	// rxFrameCount and flows are statistics (see Stats.h), so are not saved
+}
+
+void EndStn::generateTestFrame(shared_ptr<Sdu> pTag, unsigned long long destination)
 {
 	if (pIss->getOperational())  // Transmit frame only if MAC won't immediately discard
 	{
 		unsigned long long thisSA = SystemId.addr;
-		shared_ptr<Sdu> thisSdu = std::make_shared<TestSdu>(sequenceNumber);
-		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, thisSA, thisSdu);
+		shared_ptr<Sdu> thisSdu = makeSdu<TestSdu>(sequenceNumber, 0, SimLog::Time);
+		unique_ptr<Frame> thisFrame = make_unique<Frame>(destination, thisSA, thisSdu);
 //		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, SystemId.addr, thisSdu);  // Why won't SystemId.addr work?
 		if (pTag) 
 			thisFrame = thisFrame->InsertTag(pTag);
@@ -20,6 +20,7 @@ limitations under the License.
 #include "Frame.h"
 #include "LinkAgg.h"
 #include "DistributedRelay.h"
+#include "TrafficGen.h"
 
 
 /*
@@ -27,8 +28,11 @@ limitations under the License.
 *       An End Station has a single port (Iss interface).
 *
 *       Currently the End Station serves simply as a frame generator and receiver.
-*           It generates test frames with a sequence number.
-*           When a frame is received it is counted and discarded.
+*           It generates test frames with a sequence number, one at a time (generateTestFrame) or as the flows of
+*               its traffic generator (see TrafficGen.h).
+*           When a frame is received it is counted and discarded, after recording the sequence number and latency of
+*               test frames in the FlowStats of their flow.  Frames of a traffic flow are only recorded by the station
+*               they are addressed to (or by all if the destination is a group address), not when flooded elsewhere.
 */
 /**/
 class EndStn : public Component
@@ -46,11 +50,24 @@ public:
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	int nextEventTime() const;
+	void saveState(Snapshot& snap) const;
+	void restoreState(Snapshot& snap);
 
-	void generateTestFrame(shared_ptr<Sdu> pTag = nullptr);
+	void generateTestFrame(shared_ptr<Sdu> pTag = nullptr, unsigned long long destination = defaultDA);
+
+	FlowStats getFlowStats() const;                                   // Test frames received from all sources
+	FlowStats getFlowStats(unsigned long long sourceAddr) const;      // Test frames received from one source (MAC SA),
+	                                                                  //    or one traffic flow (TrafficGen::flowId)
+	void clearStats();
 
 	// protected:
 	shared_ptr<Iss> pIss;
+	TrafficGen traffic;                         // Flows of test frames generated when the End Station is run
+
+private:
+	std::vector<unique_ptr<Frame>> rxBurst;     // Re-used for each burst of received Frames
+	std::map<unsigned long long, FlowStats> flows;     // Test frames received, by source address
 };
 
 
@@ -84,15 +101,19 @@ public:
 	       //   Should I add a restoreDefault() routine?
 	virtual void timerTick() override;                     // If not suspended, Tick timers in all Components and Macs
 	virtual void run(bool singleStep) override;            // If not suspended, Make one or more pass through all state machines in all Components and Macs
+	virtual int nextEventTime() const override;            // Earliest next event of all Components and Macs
+	virtual void saveState(Snapshot& snap) const override;    // Copy state of all Components and Macs to a Snapshot
+	virtual void restoreState(Snapshot& snap) override;       // Copy back from a Snapshot of a Device built the same way
 
 	void transmit();                      // If not suspended, Transmit a Frame from any Macs in Device with a Frame ready to transmit
 	void disconnect();                    // Disconnect all Macs in the Device that are connected to other Macs
 
-	void createBridge(unsigned short type = 0, bool includeDR = false);     // Helper function for creating a Device with a single Bridge Component
+	void createBridge(unsigned short type = 0, bool includeDR = false,      // Helper function for creating a Device with a single Bridge Component
+		unsigned short numAggregators = 0);                                 //    (with one Bridge Port per Aggregator;  0 is one Aggregator per Mac)
 	void createEndStation(bool includeDR = false);                          // Helper function for creating a Device with a single End Station Component
 
 protected:
-	static unsigned short devCnt;
+	static std::atomic<unsigned short> devCnt;      // Atomic so Devices can be created by more than one thread
 	unsigned short devNum;
 
 };
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "DistRelayState.h"
+#include "Snapshot.h"
 #include "DistributedRelay.h"
 
 
@@ -76,5 +77,140 @@ void GwPreference::reset()
 	GpPreferenceMask.set();
 }
 
+bool AggState::sameState(const AggState& other) const
+{
+	return ((AggPortAlgorithm == other.AggPortAlgorithm) &&
+		(AggConvServiceDigest == other.AggConvServiceDigest) &&
+		(AggConvLinkDigest == other.AggConvLinkDigest) &&
+		(AggPartnerSystemId.id == other.AggPartnerSystemId.id) &&
+		(AggPartnerKey == other.AggPartnerKey) &&
+		(AggCscdState.state == other.AggCscdState.state) &&
+		(AggActiveLinks == other.AggActiveLinks));
+}
+
+bool GwState::sameState(const GwState& other) const
+{
+	return ((GwAlgorithm == other.GwAlgorithm) &&
+		(GwConvServiceDigest == other.GwConvServiceDigest) &&
+		(GwAvailableMask == other.GwAvailableMask));
+}
+
+bool GwPreference::sameState(const GwPreference& other) const
+{
+	return (GpPreferenceMask == other.GpPreferenceMask);
+}
+
+void AggState::saveState(Snapshot& snap) const
+{
+	snap.put(AggSequenceNumber);
+	snap.put(AggPortAlgorithm);
+	snap.put(AggConvServiceDigest);
+	snap.put(AggConvLinkDigest);
+	snap.put(AggPartnerSystemId);
+	snap.put(AggPartnerKey);
+	snap.put(AggCscdState);
+	snap.put(reserved);
+	snap.put(AggActiveLinks);
+}
 
+void AggState::restoreState(Snapshot& snap)
+{
+	snap.get(AggSequenceNumber);
+	snap.get(AggPortAlgorithm);
+	snap.get(AggConvServiceDigest);
+	snap.get(AggConvLinkDigest);
+	snap.get(AggPartnerSystemId);
+	snap.get(AggPartnerKey);
+	snap.get(AggCscdState);
+	snap.get(reserved);
+	snap.get(AggActiveLinks);
+}
+
+void GwState::saveState(Snapshot& snap) const
+{
+	snap.put(GwSequenceNumber);
+	snap.put(GwAlgorithm);
+	snap.put(GwConvServiceDigest);
+	snap.put(GwAvailableMask);
+}
+
+void GwState::restoreState(Snapshot& snap)
+{
+	snap.get(GwSequenceNumber);
+	snap.get(GwAlgorithm);
+	snap.get(GwConvServiceDigest);
+	snap.get(GwAvailableMask);
+}
+
+void GwPreference::saveState(Snapshot& snap) const
+{
+	snap.put(GpSequenceNumber);
+	snap.put(GpPreferenceMask);
+}
 
+void GwPreference::restoreState(Snapshot& snap)
+{
+	snap.get(GpSequenceNumber);
+	snap.get(GpPreferenceMask);
+}
+
+
+ConvMaskDelta::ConvMaskDelta()
+{
+	baseSequenceNumber = 0;
+	sequenceNumber = 0;
+}
+
+ConvMaskDelta::~ConvMaskDelta()
+{
+}
+
+bool ConvMaskDelta::compute(const ConvMask& base, const ConvMask& target)
+{
+	changedWords.clear();
+	for (int i = 0; i < ConvMask::NumWords; i++)
+	{
+		if (base.getWord(i) != target.getWord(i))
+		{
+			if (changedWords.size() >= MaxChangedWords)
+				return (false);
+			changedWords.push_back(std::make_pair((unsigned short)i, target.getWord(i)));
+		}
+	}
+	return (true);
+}
+
+void ConvMaskDelta::apply(ConvMask& mask) const
+{
+	for (const auto& word : changedWords)
+		if (word.first < ConvMask::NumWords)
+			mask.setWord(word.first, word.second);
+}
+
+void ConvMaskDelta::saveState(Snapshot& snap) const
+{
+	snap.put(baseSequenceNumber);
+	snap.put(sequenceNumber);
+	snap.put(changedWords.size());
+	for (const auto& word : changedWords)
+	{
+		snap.put(word.first);
+		snap.put(word.second);
+	}
+}
+
+void ConvMaskDelta::restoreState(Snapshot& snap)
+{
+	snap.get(baseSequenceNumber);
+	snap.get(sequenceNumber);
+	size_t count = 0;
+	snap.get(count);
+	changedWords.clear();
+	for (size_t i = 0; (i < count) && snap.good(); i++)
+	{
+		std::pair<unsigned short, unsigned long long> word;
+		snap.get(word.first);
+		snap.get(word.second);
+		changedWords.push_back(word);
+	}
+}
@@ -18,6 +18,7 @@ limitations under the License.
 #include "stdafx.h"
 #include "Mac.h"
 #include "Aggregator.h"
+#include "ConvMask.h"
 
 
 
@@ -72,9 +73,12 @@ public:
 	unsigned short AggPartnerKey;
 	cscdState AggCscdState;
 	unsigned char reserved;                    // to keep on 16 bit boundaries in DRCPDU TLV
-	std::list<unsigned short> AggActiveLinks;  // contains Link Number ID if AggPort attached and distributing, else Link Number = 0
+	IdList AggActiveLinks;                     // contains Link Number ID if AggPort attached and distributing, else Link Number = 0
 
 	void reset();
+	bool sameState(const AggState& other) const;          // True if all but the sequence number are equal
+	void saveState(Snapshot& snap) const;             // Copy to or from a Snapshot (see Snapshot.h)
+	void restoreState(Snapshot& snap);
 };
 
 class GwState
@@ -87,9 +91,12 @@ public:
 	LagAlgorithms GwAlgorithm;
 	std::array<unsigned char, 16> GwConvServiceDigest;
 	// TLV has 16 byte reserved field
-	std::bitset<4096> GwAvailableMask;
+	ConvMask GwAvailableMask;
 
 	void reset();
+	bool sameState(const GwState& other) const;          // True if all but the sequence number are equal
+	void saveState(Snapshot& snap) const;             // Copy to or from a Snapshot (see Snapshot.h)
+	void restoreState(Snapshot& snap);
 };
 
 class GwPreference
@@ -99,7 +106,38 @@ public:
 	~GwPreference();
 
 	unsigned long GpSequenceNumber;
-	std::bitset<4096> GpPreferenceMask;
+	ConvMask GpPreferenceMask;
 
 	void reset();
+	bool sameState(const GwPreference& other) const;          // True if all but the sequence number are equal
+	void saveState(Snapshot& snap) const;             // Copy to or from a Snapshot (see Snapshot.h)
+	void restoreState(Snapshot& snap);
+};
+
+
+/*
+*   Class ConvMaskDelta records the changes to the conversation mask of a Gateway_State (GwAvailableMask) or 
+*       Gateway_Preference (GpPreferenceMask) from the version with baseSequenceNumber to the version with sequenceNumber,
+*       as the index and new value of each 64 bit word of the mask that differs.  When delta encoding is enabled on a 
+*       Distributed Relay (DrcpDeltaEncoding), DrcpTxSM sends a ConvMaskDelta relative to the state the neighbor has 
+*       reflected in place of the whole state TLV, and DrcpRxSM applies it only if it holds the base version.
+*       Changes to anything but the mask (or to more than MaxChangedWords words) are sent as the whole state.
+*/
+
+class ConvMaskDelta
+{
+public:
+	ConvMaskDelta();
+	~ConvMaskDelta();
+
+	static const int MaxChangedWords = 16;     // A delta that changes more words is longer than half the whole state TLV
+
+	unsigned long baseSequenceNumber;          // Sequence number of the state the changes apply to
+	unsigned long sequenceNumber;              // Sequence number of the state after the changes
+	std::vector<std::pair<unsigned short, unsigned long long>> changedWords;   // Index and new value of changed words
+
+	bool compute(const ConvMask& base, const ConvMask& target);   // Returns false if more than MaxChangedWords differ
+	void apply(ConvMask& mask) const;
+	void saveState(Snapshot& snap) const;             // Copy to or from a Snapshot (see Snapshot.h)
+	void restoreState(Snapshot& snap);
 };
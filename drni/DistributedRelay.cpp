@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "DistributedRelay.h"
+#include "Snapshot.h"
 
 DistributedRelay::DistributedRelay(unsigned long long drniSysId, unsigned short drniKey)
 	
@@ -51,7 +52,7 @@ DistributedRelay::DistributedRelay(unsigned long long drniSysId, unsigned short
 	nborGatewayMask.reset();
 
 	std::cout << "Distributed Relay Constructor called for DRNI System " << hex << DrniAggregatorSystemId.id << dec << std::endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "Distributed Relay Constructor called for DRNI System " << hex << DrniAggregatorSystemId.id << dec << endl;
 
 
@@ -61,6 +62,16 @@ DistributedRelay::DistributedRelay(unsigned long long drniSysId, unsigned short
 	drcpDestinationAddress = NearestNonTpmrBridgeDA;
 	HomeDrcpVersion = 2;
 	DrcpEnabled = true;          //TODO:  tie this to point-to-point
+	DrcpDeltaEncoding = false;   // Send whole state TLVs, as in the standard
+
+	RxSmState = DrcpRxSM::RxSmStates::NO_STATE;
+	TxSmState = DrcpTxSM::TxSmStates::NO_TX;          // Leaves NO_TX when IRP operational
+	newNborState = false;
+	newReflectedState = false;
+	DrcpNTT = false;
+	DrcpTxOpportunity = true;      // Nothing limits DRCPDU transmission opportunities (unlike LACP txOpportunity)
+	DrcpTxHold = false;
+	DrcpTimeout = 0;
 
 	/**/
 	reset();
@@ -71,7 +82,7 @@ DistributedRelay::DistributedRelay(unsigned long long drniSysId, unsigned short
 DistributedRelay::~DistributedRelay()
 {
 	//	std::cout << "Distributed Relay Destructor called." << std::endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "Distributed Relay Destructor called." << endl;
 }
 
@@ -95,6 +106,7 @@ void DistributedRelay::reset()
 {
 	//TODO:  anything need to be reset even if Agg or IRP not configured ?
 	drOperational = false;
+	lastTransitionTime = SimLog::Time;
 
 	if (pAggregator && pIss)             // If Aggregator and IRP configured, then reset Distributed Relay
 	{
@@ -130,15 +142,145 @@ void DistributedRelay::reset()
 	differDrni = false;
 }
 
-void DistributedRelay::timerTick()
+int DistributedRelay::nextEventTime() const
 {
-//	if (pAggregator && pIss && !suspended)     // If Aggregator and IRP attached, and not in suspended time then continue
-	if (pAggregator && pIss)     // If Aggregator attached, and not in suspended time then continue
-		{
-//		pIss->timerTick();
-		if (currentWhileTimer > 0) currentWhileTimer--;          // RxSM timer
-		if (DrcpTxWhen > 0) DrcpTxWhen--;						 // TxSM timer
-	}
+	if (!requests.empty() || !indications.empty())                      // If frames waiting to be relayed
+		return (SimLog::Time);                                          //    then need to run now
+	if (!pAggregator || !pIss)                                          // If running as transparent sublayer
+		return (SimLog::EndOfTime);                                     //    then only frames generate events
+	if (pRxDrcpFrame || DrcpNTT || newHomeInfo || newNborState || newReflectedState || pAggregator->updateDistRelayAggState ||
+		(irpOperational != pIss->getOperational()) ||
+		(SimLog::Time <= lastTransitionTime + SimLog::SettleTime))              // If flag set or recent transition
+		return (SimLog::Time);                                          //    then need to run now
+
+	return (std::min(currentWhileTimer.expiry(), DrcpTxWhen.expiry()));
+}
+
+void DistributedRelay::saveState(Snapshot& snap) const
+{
+	IssQ::saveState(snap);
+	snap.put(drOperational);
+	homeAggregatorState.saveState(snap);
+	homeGatewayState.saveState(snap);
+	homeGatewayPreference.saveState(snap);
+	snap.put(lastTxAggSequenceNumber);
+	snap.put(lastTxGwSequenceNumber);
+	snap.put(lastTxGpSequenceNumber);
+	snap.put(reflectedAggSequenceNumber);
+	snap.put(reflectedGwSequenceNumber);
+	snap.put(reflectedGpSequenceNumber);
+	snap.put(DrcpDeltaEncoding);
+	snap.put(DrniAggregatorSystemId);
+	snap.put(DrniAggregatorKey);
+	snap.put(homeAdminClientGatewayControl);
+	snap.put(homeAdminCscdGatewayControl);
+	snap.put(homeAdminGatewayPreference);
+	snap.put(homeAdminGatewayEnable);
+	snap.put(homeAdminGatewayAlgorithm);
+	snap.put(homeGatewayServiceIdMapDigest);
+	snap.put(homeOperAggregatorLinkMap);
+	snap.putVector(homeSelectedGatewayVector);
+	snap.putVector(homeSelectedAggregatorVector);
+	snap.put(drSolo);
+	snap.put(gatewaySyncMask);
+	snap.put(enableIrcData);
+	snap.put(homeAggregatorMask);
+	snap.put(homeGatewayMask);
+	snap.put(nborAggregatorMask);
+	snap.put(nborGatewayMask);
+	snap.put(irpOperational);
+	snap.put(drcpDestinationAddress);
+	snap.put(DrcpEnabled);
+	snap.put(HomeDrcpVersion);
+	snap.put(homeAdminIrpState);
+	snap.put(homeIrpState);
+	snap.put(nborSystemId);
+	snap.put(nborDrniKey);
+	snap.put(nborIrpState);
+	nborAggregatorState.saveState(snap);
+	nborGatewayState.saveState(snap);
+	nborGatewayPreference.saveState(snap);
+	snap.put(reflectedIrpState);
+	Frame::saveFrame(snap, pRxDrcpFrame);
+	snap.put(differDrni);
+	snap.put(currentWhileTimer);
+	snap.put(newHomeInfo);
+	snap.put(newNborState);
+	snap.put(newReflectedState);
+	snap.put(DrcpTxWhen);
+	snap.put(DrcpNTT);
+	snap.put(DrcpTxOpportunity);
+	snap.put(DrcpTxHold);
+	snap.put(DrcpTimeout);
+	snap.put(lastTransitionTime);
+	snap.put(RxSmState);
+	snap.put(TxSmState);
+}
+
+void DistributedRelay::restoreState(Snapshot& snap)
+{
+	IssQ::restoreState(snap);
+	snap.get(drOperational);
+	homeAggregatorState.restoreState(snap);
+	homeGatewayState.restoreState(snap);
+	homeGatewayPreference.restoreState(snap);
+	snap.get(lastTxAggSequenceNumber);
+	snap.get(lastTxGwSequenceNumber);
+	snap.get(lastTxGpSequenceNumber);
+	snap.get(reflectedAggSequenceNumber);
+	snap.get(reflectedGwSequenceNumber);
+	snap.get(reflectedGpSequenceNumber);
+	snap.get(DrcpDeltaEncoding);
+	pTxAggregatorState = nullptr;    // Next DRCPDU makes new copies and sends whole state TLVs
+	pTxGatewayState = nullptr;
+	pTxGatewayPreference = nullptr;
+	pBaseGatewayState = nullptr;
+	pBaseGatewayPreference = nullptr;
+	snap.get(DrniAggregatorSystemId);
+	snap.get(DrniAggregatorKey);
+	snap.get(homeAdminClientGatewayControl);
+	snap.get(homeAdminCscdGatewayControl);
+	snap.get(homeAdminGatewayPreference);
+	snap.get(homeAdminGatewayEnable);
+	snap.get(homeAdminGatewayAlgorithm);
+	snap.get(homeGatewayServiceIdMapDigest);
+	snap.get(homeOperAggregatorLinkMap);
+	snap.getVector(homeSelectedGatewayVector);
+	snap.getVector(homeSelectedAggregatorVector);
+	snap.get(drSolo);
+	snap.get(gatewaySyncMask);
+	snap.get(enableIrcData);
+	snap.get(homeAggregatorMask);
+	snap.get(homeGatewayMask);
+	snap.get(nborAggregatorMask);
+	snap.get(nborGatewayMask);
+	snap.get(irpOperational);
+	snap.get(drcpDestinationAddress);
+	snap.get(DrcpEnabled);
+	snap.get(HomeDrcpVersion);
+	snap.get(homeAdminIrpState);
+	snap.get(homeIrpState);
+	snap.get(nborSystemId);
+	snap.get(nborDrniKey);
+	snap.get(nborIrpState);
+	nborAggregatorState.restoreState(snap);
+	nborGatewayState.restoreState(snap);
+	nborGatewayPreference.restoreState(snap);
+	snap.get(reflectedIrpState);
+	pRxDrcpFrame = Frame::restoreFrame(snap);
+	snap.get(differDrni);
+	snap.get(currentWhileTimer);
+	snap.get(newHomeInfo);
+	snap.get(newNborState);
+	snap.get(newReflectedState);
+	snap.get(DrcpTxWhen);
+	snap.get(DrcpNTT);
+	snap.get(DrcpTxOpportunity);
+	snap.get(DrcpTxHold);
+	snap.get(DrcpTimeout);
+	snap.get(lastTransitionTime);
+	snap.get(RxSmState);
+	snap.get(TxSmState);
 }
 
 void DistributedRelay::run(bool singlestep)
@@ -155,7 +297,7 @@ void DistributedRelay::run(bool singlestep)
 			//TODO:  test to make sure frame received from IRP with irpActive true?
 		if (pTempFrame)                                        // If there is an ingress frame
 		{
-			if (SimLog::Debug > 5)
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex 
 					<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid << dec
@@ -166,7 +308,7 @@ void DistributedRelay::run(bool singlestep)
 			if ((pTempFrame->MacDA == drcpDestinationAddress) &&   // if frame has proper DA and contains an DRCPDU
 				(pTempFrame->getNextEtherType() == DrniEthertype) && (pTempFrame->getNextSubType() == DrcpduSubType))
 			{
-				if (SimLog::Debug > 5)
+				if (SimLog::Trace<5>())
 				{
 					SimLog::logFile << " -- DRCPDU" << dec << endl;
 				}
@@ -181,7 +323,7 @@ void DistributedRelay::run(bool singlestep)
 				//TODO:  use actorOperPortAlgorithm or homeAggregator.State.AggPortAlgorithm ?
 				if (!homeGatewayMask[gwCid] && nborGatewayMask[gwCid])       // if Down frames can be received at this IPP
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- Down to Aggregator" << dec << endl;
 					}
@@ -190,7 +332,7 @@ void DistributedRelay::run(bool singlestep)
 				else if (homeGatewayMask[gwCid] && !nborGatewayMask[gwCid] &&
 					(nborAggregatorMask[portCid] || !agg.operDiscardWrongConversation))   // if Up frames can be received at this IPP
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- Up to Gateway" << dec << endl;
 					}
@@ -198,7 +340,7 @@ void DistributedRelay::run(bool singlestep)
 				}
 				else
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- discard" << dec << endl;
 					}
@@ -224,7 +366,7 @@ void DistributedRelay::run(bool singlestep)
 		}
 		if (pTempFrame)                                 // If there is a Down frame
 		{
-			if (SimLog::Debug > 5)
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 					<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid 
@@ -238,7 +380,7 @@ void DistributedRelay::run(bool singlestep)
 			{
 				if (homeAggregatorMask[portCid] && agg.getOperational())        // If target port is on this Aggregator and Agg operational
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- Down to Aggregator" << dec << endl;
 					}
@@ -247,7 +389,7 @@ void DistributedRelay::run(bool singlestep)
 				else if (homeAggregatorMask[portCid] && !nborAggregatorMask[portCid] &&
 					homeIrpState.ircData)                                   // Else If target port is through IRP and IRC usable for data
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- Down to IRP" << dec << endl;
 					}
@@ -255,7 +397,7 @@ void DistributedRelay::run(bool singlestep)
 				}
 				else
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- discard" << dec << endl;
 					}
@@ -267,7 +409,7 @@ void DistributedRelay::run(bool singlestep)
 		pTempFrame = move(agg.Indication());               // Get Up frame, if available, from Aggregator
 		if (pTempFrame)                                    // If there is a Up frame
 		{
-			if (SimLog::Debug > 5)
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 					<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid 
@@ -281,7 +423,7 @@ void DistributedRelay::run(bool singlestep)
 			{
 				if (homeGatewayMask[gwCid] && !nborGatewayMask[gwCid])                  // if home gateway selected
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- Up to Gateway" << dec << endl;
 					}
@@ -290,7 +432,7 @@ void DistributedRelay::run(bool singlestep)
 				else if (!homeGatewayMask[gwCid] && nborGatewayMask[gwCid] &&           // Else if neighborbor gateway selected
 					homeIrpState.ircData)                                           //    and IRC usable for data
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- Up to IRP" << dec << endl;
 					}
@@ -298,7 +440,7 @@ void DistributedRelay::run(bool singlestep)
 				}
 				else
 				{
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " -- discard" << dec << endl;
 					}
@@ -312,6 +454,8 @@ void DistributedRelay::run(bool singlestep)
 		transitions += DistributedRelay::DrcpRxSM::run(*this, true);
 		runDrniGwAggMachines();
 		transitions += DistributedRelay::DrcpTxSM::run(*this, true);
+		if (transitions)
+			lastTransitionTime = SimLog::Time;
 
 		//TODO:  any Distributed Relay equivalent of update aggregator status?
 		// updateAggregatorStatus();
@@ -338,7 +482,7 @@ void DistributedRelay::run(bool singlestep)
 		}
 		if (pTempFrame)                                 // If there is a Down frame
 		{
-			if (SimLog::Debug > 7)
+			if (SimLog::Trace<7>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 					<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid 
@@ -356,7 +500,7 @@ void DistributedRelay::run(bool singlestep)
 		pTempFrame = move(agg.Indication());               // Get Up frame, if available, from Aggregator
 		if (pTempFrame)                                    // If there is a Up frame
 		{
-			if (SimLog::Debug > 7)
+			if (SimLog::Trace<7>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 					<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid 
@@ -389,7 +533,7 @@ void DistributedRelay::runDrniGwAggMachines()
 	{
 		if (agg.drniPartnerSystemId.id == 0)
 		{
-			if (SimLog::Debug > 7)
+			if (SimLog::Trace<7>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 					<< DrniAggregatorSystemId.addrMid << ":" << agg.actorAdminSystem.addrMid
@@ -405,7 +549,7 @@ void DistributedRelay::runDrniGwAggMachines()
 	{
 		if (agg.drniPartnerSystemId.id != 0)
 		{
-			if (SimLog::Debug > 7)
+			if (SimLog::Trace<7>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 					<< DrniAggregatorSystemId.addrMid << ":" << agg.actorAdminSystem.addrMid
@@ -417,7 +561,7 @@ void DistributedRelay::runDrniGwAggMachines()
 			agg.drniPartnerKey = 0;
 		}
 	}
-	if ((SimLog::Debug > 6) && (enableIrcData !=
+	if ((SimLog::Trace<6>()) && (enableIrcData !=
 		(homeIrpState.ircData && nborIrpState.ircData &&
 		homeIrpState.ircSync && nborIrpState.ircSync &&
 		homeIrpState.drni && nborIrpState.drni)))
@@ -434,7 +578,7 @@ void DistributedRelay::runDrniGwAggMachines()
 	// DRNI Gateway and Aggregator machine
 	//    This version of machine just does one pass through based on state of flags at beginning of execution.
 	//    If flags get set again during execution, won't get processed until next cycle of simulation.
-	if ((SimLog::Debug > 6) &&
+	if ((SimLog::Trace<6>()) &&
 		(newHomeInfo || newNborState || newReflectedState))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
@@ -479,11 +623,11 @@ void DistributedRelay::updateSystemAndKey()
 		agg.operDrniId.id = agg.actorAdminSystem.id;
 		agg.operDrniKey = agg.actorAdminAggregatorKey;
 
-		cout << "Time " << SimLog::Time << ":   Drni:Home " << hex
+		SimLog::console << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
 			<< ":         is DR_SOLO and changing Aggregator Id:Key to " << agg.operDrniId.id << ":" << agg.operDrniKey 
 			<< dec << endl;
-		if (SimLog::Debug > 4)
+		if (SimLog::Trace<4>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid 
@@ -510,19 +654,19 @@ void DistributedRelay::updateSystemAndKey()
 			agg.operDrniKey = agg.actorAdminAggregatorKey;
 		}
 
-		cout << "Time " << SimLog::Time << ":   Drni:Home " << hex
+		SimLog::console << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
 			<< ":         is DR_PAIRED ";
 		if ((agg.actorOperSystem.id != agg.operDrniId.id) || (agg.actorOperAggregatorKey != agg.operDrniKey))
 		{
-			cout << "and changing Aggregator Id:Key to " << agg.operDrniId.id << ":" << agg.operDrniKey;
+			SimLog::console << "and changing Aggregator Id:Key to " << agg.operDrniId.id << ":" << agg.operDrniKey;
 		}
 		else
 		{
-			cout << "and retaining Aggregator Id:Key " << agg.operDrniId.id << ":" << agg.operDrniKey;
+			SimLog::console << "and retaining Aggregator Id:Key " << agg.operDrniId.id << ":" << agg.operDrniKey;
 		}
-		cout	<< dec << endl;
-		if (SimLog::Debug > 4)
+		SimLog::console	<< dec << endl;
+		if (SimLog::Trace<4>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -556,6 +700,12 @@ void DistributedRelay::resetHomeState()
 	lastTxAggSequenceNumber = 0;
 	lastTxGwSequenceNumber = 0;
 	lastTxGpSequenceNumber = 0;
+
+	pTxAggregatorState = nullptr;    // Sequence numbers start over, so cached copies no longer identify the state
+	pTxGatewayState = nullptr;
+	pTxGatewayPreference = nullptr;
+	pBaseGatewayState = nullptr;
+	pBaseGatewayPreference = nullptr;
 }
 
 void DistributedRelay::updateHomeState()
@@ -586,7 +736,7 @@ void DistributedRelay::updateHomeState()
 		if (homeAggregatorState.AggSequenceNumber == lastTxAggSequenceNumber)
 			homeAggregatorState.AggSequenceNumber += 1;
 		
-		if ((SimLog::Debug > 6) )
+		if ((SimLog::Trace<6>()) )
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -629,7 +779,7 @@ void DistributedRelay::updateHomeState()
 		homeAggregatorState.AggActiveLinks = agg.activeLagLinks;
 		DrcpTxHold = true;
 		DrcpNTT = true;
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -638,7 +788,7 @@ void DistributedRelay::updateHomeState()
 	}
 
 	//  Gateway State update
-	std::bitset<4096> newGatewayAvailable;
+	ConvMask newGatewayAvailable;
 	newGatewayAvailable.reset();
 	if (enabled)         // if the Gateway Port ISS to the Distributed Relay client is enabled
 		newGatewayAvailable = homeAdminGatewayEnable;
@@ -658,7 +808,7 @@ void DistributedRelay::updateHomeState()
 		if (homeGatewayState.GwSequenceNumber == lastTxGwSequenceNumber)
 			homeGatewayState.GwSequenceNumber += 1;
 
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -675,7 +825,7 @@ void DistributedRelay::updateHomeState()
 		}
 		else if (homeGatewayState.GwAvailableMask != newGatewayAvailable)                    // otherwise if the gateway available mask changes
 		{
-			gatewaySyncMask &= ~(homeGatewayState.GwAvailableMask ^ newGatewayAvailable);    //   clear sync for any CIDs that changed
+			gatewaySyncMask.andNot(homeGatewayState.GwAvailableMask ^ newGatewayAvailable);     //   clear sync for any CIDs that changed
 		}
 
 		homeGatewayState.GwAvailableMask = newGatewayAvailable;
@@ -684,7 +834,7 @@ void DistributedRelay::updateHomeState()
 		DrcpTxHold = true;
 		DrcpNTT = true;
 
-		if (SimLog::Debug > 7)
+		if (SimLog::Trace<7>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -699,7 +849,7 @@ void DistributedRelay::updateHomeState()
 				SimLog::logFile << homeGatewayState.GwAvailableMask[i] << "  ";
 			SimLog::logFile << dec << endl;
 		}
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -720,7 +870,7 @@ void DistributedRelay::updateHomeState()
 		if (homeGatewayPreference.GpSequenceNumber == lastTxGpSequenceNumber)
 			homeGatewayPreference.GpSequenceNumber += 1;
 
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -731,13 +881,13 @@ void DistributedRelay::updateHomeState()
 
 		if (homeGatewayPreference.GpPreferenceMask != homeAdminGatewayPreference)             // otherwise if the gateway preference mask changes
 		{
-			gatewaySyncMask &= ~(homeGatewayPreference.GpPreferenceMask ^ homeAdminGatewayPreference);  //   clear sync for any CIDs that changed
+			gatewaySyncMask.andNot(homeGatewayPreference.GpPreferenceMask ^ homeAdminGatewayPreference);   //   clear sync for any CIDs that changed
 		}
 
 		homeGatewayPreference.GpPreferenceMask = homeAdminGatewayPreference;
 		DrcpTxHold = true;
 		DrcpNTT = true;
-		if (SimLog::Debug > 7)
+		if (SimLog::Trace<7>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -746,7 +896,7 @@ void DistributedRelay::updateHomeState()
 				SimLog::logFile << homeAdminGatewayPreference[i] << "  ";
 			SimLog::logFile << dec << endl;
 		}
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -782,29 +932,28 @@ void DistributedRelay::updateHomeAggregatorSelection()
 		(homeAggregatorState.AggPartnerKey == nborAggregatorState.AggPartnerKey))
 		//TODO:  should remove test of partner ID and Key since made change that all DRNI Links must have same partner
 	{
-		std::list<unsigned short> drniLagLinks = homeAggregatorState.AggActiveLinks;   // Copy home links list
-//		drniLagLinks.merge(nborAggregatorState.AggActiveLinks);    // Oops -- this clears nbor links list
-		std::list<unsigned short> nborLagLinks = nborAggregatorState.AggActiveLinks;   // Temp copy of nbor links list
-		drniLagLinks.merge(nborLagLinks);                                              // Merge links lists
-		std::array<unsigned short, 4096> drniLinkVector;       // vector of Link Numbers 
-		pAggregator->updateConversationLinkVector(drniLagLinks, drniLinkVector);
-
-		for (int cid = 0; cid < 4096; cid++)
+		IdList drniLagLinks = homeAggregatorState.AggActiveLinks;   // Copy home links list
+		drniLagLinks.merge(nborAggregatorState.AggActiveLinks);     // Merge nbor links (leaves nbor links list unchanged)
+		shared_ptr<const std::array<unsigned short, 4096>> pDrniLinkVector = pAggregator->conversationLinkTable(drniLagLinks);
+		const std::array<unsigned short, 4096>& drniLinkVector = *pDrniLinkVector;   // vector of Link Numbers 
+
+		homeSelectedAggregatorVector.fill(0);
+		ConvMask linkMask;
+		for (auto link : nborAggregatorState.AggActiveLinks)       // Conversation IDs that map to a neighbor link select neighbor
 		{
-			homeSelectedAggregatorVector[cid] = 0;
-
-			for (auto link : nborAggregatorState.AggActiveLinks)
-				if (link == drniLinkVector[cid])
-					homeSelectedAggregatorVector[cid] = nborDrn;
-
-			for (auto link : homeAggregatorState.AggActiveLinks)
-				if (link == drniLinkVector[cid])
-					homeSelectedAggregatorVector[cid] = homeDrn;
-			// Notice that if drniLagLinks ends up with multiple entries of the same link number, the home system is preferred.
-			// But the neighbor will do the same, so each selects a different link.  Will transmit on link on same system as gateway.
-			// Will receive on either (although if DWC set system with gateway may not accept when received on IRC).
+			linkMask.assignEqual(drniLinkVector, link);
+			linkMask.fillWhere(homeSelectedAggregatorVector, nborDrn);
 		}
-		if (SimLog::Debug > 7)
+		for (auto link : homeAggregatorState.AggActiveLinks)       // Conversation IDs that map to a home link select home
+		{
+			linkMask.assignEqual(drniLinkVector, link);
+			linkMask.fillWhere(homeSelectedAggregatorVector, homeDrn);
+		}
+		// Notice that if drniLagLinks ends up with multiple entries of the same link number, the home system is preferred.
+		// But the neighbor will do the same, so each selects a different link.  Will transmit on link on same system as gateway.
+		// Will receive on either (although if DWC set system with gateway may not accept when received on IRC).
+
+		if (SimLog::Trace<7>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -826,7 +975,7 @@ void DistributedRelay::updateHomeAggregatorSelection()
 		homeSelectedAggregatorVector.fill(homeDrn);
 	}
 
-	if (SimLog::Debug > 7)
+	if (SimLog::Trace<7>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -862,107 +1011,93 @@ void DistributedRelay::updateHomeGatewaySelection()
 		 (homeAggregatorState.AggConvServiceDigest == nborAggregatorState.AggConvServiceDigest) &&
 		 (homeAggregatorState.AggConvServiceDigest == nborGatewayState.GwConvServiceDigest)));
 
-	if (SimLog::Debug > 7)
-		SimLog::logFile << "           In updateHomeGatewaySelection:                     ";
-	for (int cid = 0; cid < 4096; cid++)
+	bool algorithmMismatch =
+		((homeGatewayState.GwAlgorithm == LagAlgorithms::UNSPECIFIED) ||
+		 (nborGatewayState.GwAlgorithm != homeGatewayState.GwAlgorithm) ||
+		 (algorithmUsesMap && (nborGatewayState.GwConvServiceDigest != homeGatewayState.GwConvServiceDigest)));
+	bool nborIsLower = (nborSystemId.id < pAggregator->actorAdminSystem.id);
+	const ConvMask& homeAvailable = homeGatewayState.GwAvailableMask;
+	const ConvMask& nborAvailable = nborGatewayState.GwAvailableMask;
+	const ConvMask& homePreferred = homeGatewayPreference.GpPreferenceMask;
+	const ConvMask& nborPreferred = nborGatewayPreference.GpPreferenceMask;
+	ConvMask selectMask;
+
+	//  Which selection rule applies depends on the Conversation ID only through the gateway available and preference masks,
+	//     so the vector is built for all Conversation IDs at once:  fill with the value of the default rule, then fill
+	//     the Conversation IDs selected by each other rule.
+	if (drSolo)                                                    // Solo:  home gateway if it is available
 	{
-		if (drSolo)
-		{
-			if (homeGatewayState.GwAvailableMask[cid])
-			{
-				homeSelectedGatewayVector[cid] = homeDrn;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "A  ";
-			}
-			else
-			{
-				homeSelectedGatewayVector[cid] = 0;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "B  ";
-			}
-		}
-		else if ((homeGatewayState.GwAlgorithm == LagAlgorithms::UNSPECIFIED) ||
-			(nborGatewayState.GwAlgorithm != homeGatewayState.GwAlgorithm) ||
-			(algorithmUsesMap && (nborGatewayState.GwConvServiceDigest != homeGatewayState.GwConvServiceDigest)))
-		{
-			if (nborSystemId.id < pAggregator->actorAdminSystem.id)
-			{
-				homeSelectedGatewayVector[cid] = nborDrn;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "C  ";
-			}
-			else if (homeGatewayState.GwAvailableMask[cid])
-			{
-				homeSelectedGatewayVector[cid] = homeDrn;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "D  ";
-			}
-			else
-			{
-				homeSelectedGatewayVector[cid] = 0;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "E  ";
-			}
-		}
-		else if (!homeGatewayState.GwAvailableMask[cid])
-		{
-			if (!nborGatewayState.GwAvailableMask[cid])
-			{
-				homeSelectedGatewayVector[cid] = 0;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "F  ";
-			}
-			else
-			{
-				homeSelectedGatewayVector[cid] = nborDrn;
-				if ((SimLog::Debug > 7) && (cid < 16))
-					SimLog::logFile << "G  ";
-			}
-		}
-		else if (!nborGatewayState.GwAvailableMask[cid])
-		{
-			homeSelectedGatewayVector[cid] = homeDrn;
-			if ((SimLog::Debug > 7) && (cid < 16))
-				SimLog::logFile << "H  ";
-		}
-		else if (GatewayFollowsAggregator)
+		homeSelectedGatewayVector.fill(0);
+		homeAvailable.fillWhere(homeSelectedGatewayVector, homeDrn);
+	}
+	else if (algorithmMismatch)                                    // Mismatched algorithm:  neighbor if it has the lower System ID,
+	{                                                              //    otherwise home gateway if it is available
+		if (nborIsLower)
 		{
-			homeSelectedGatewayVector[cid] = homeSelectedAggregatorVector[cid];
-			if ((SimLog::Debug > 7) && (cid < 16))
-				SimLog::logFile << "I  ";
+			homeSelectedGatewayVector.fill(nborDrn);
 		}
-		else if (nborGatewayPreference.GpPreferenceMask[cid] &&
-			!homeGatewayPreference.GpPreferenceMask[cid])
+		else
 		{
-			homeSelectedGatewayVector[cid] = nborDrn;
-			if ((SimLog::Debug > 7) && (cid < 16))
-				SimLog::logFile << "J  ";
+			homeSelectedGatewayVector.fill(0);
+			homeAvailable.fillWhere(homeSelectedGatewayVector, homeDrn);
 		}
-		else if (!nborGatewayPreference.GpPreferenceMask[cid] &&
-			homeGatewayPreference.GpPreferenceMask[cid])
+	}
+	else
+	{
+		if (GatewayFollowsAggregator)                              // Gateway follows Aggregator if both gateways available
 		{
-			homeSelectedGatewayVector[cid] = homeDrn;
-			if ((SimLog::Debug > 7) && (cid < 16))
-				SimLog::logFile << "K  ";
+			homeSelectedGatewayVector = homeSelectedAggregatorVector;
 		}
-		else if (nborGatewayPreference.GpPreferenceMask[cid] &&
-			homeGatewayPreference.GpPreferenceMask[cid])
+		else                                                       // Otherwise prefer by mask if both gateways available
 		{
-			homeSelectedGatewayVector[cid] = defaultDrn;
-			if (cid < 16)
-				SimLog::logFile << "L  ";
+			homeSelectedGatewayVector.fill(defaultDrn);            //TODO:  if neither preference is TRUE should the selected gateway be 0 ?
+			selectMask = nborPreferred;
+			selectMask.andNot(homePreferred);
+			selectMask.fillWhere(homeSelectedGatewayVector, nborDrn);
+			selectMask = homePreferred;
+			selectMask.andNot(nborPreferred);
+			selectMask.fillWhere(homeSelectedGatewayVector, homeDrn);
 		}
-		else
+		selectMask = ~(homeAvailable | nborAvailable);             // Only one gateway available, or neither
+		selectMask.fillWhere(homeSelectedGatewayVector, 0);
+		selectMask = nborAvailable;
+		selectMask.andNot(homeAvailable);
+		selectMask.fillWhere(homeSelectedGatewayVector, nborDrn);
+		selectMask = homeAvailable;
+		selectMask.andNot(nborAvailable);
+		selectMask.fillWhere(homeSelectedGatewayVector, homeDrn);
+	}
+
+	if (SimLog::Trace<7>())
+	{
+		SimLog::logFile << "           In updateHomeGatewaySelection:                     ";
+		for (int cid = 0; cid < 16; cid++)                         // Show the rule that selected the gateway of the first 16 CIDs
 		{
-			homeSelectedGatewayVector[cid] = defaultDrn;  //TODO:  if neither preference is TRUE should the selected gateway be 0 ?
-			if (cid < 16)
-				SimLog::logFile << "M  ";
+			char rule;
+			if (drSolo)
+				rule = homeAvailable[cid] ? 'A' : 'B';
+			else if (algorithmMismatch)
+				rule = nborIsLower ? 'C' : (homeAvailable[cid] ? 'D' : 'E');
+			else if (!homeAvailable[cid])
+				rule = nborAvailable[cid] ? 'G' : 'F';
+			else if (!nborAvailable[cid])
+				rule = 'H';
+			else if (GatewayFollowsAggregator)
+				rule = 'I';
+			else if (nborPreferred[cid] && !homePreferred[cid])
+				rule = 'J';
+			else if (!nborPreferred[cid] && homePreferred[cid])
+				rule = 'K';
+			else if (nborPreferred[cid] && homePreferred[cid])
+				rule = 'L';
+			else
+				rule = 'M';
+			SimLog::logFile << rule << "  ";
 		}
-	}
-	if (SimLog::Debug > 7)
 		SimLog::logFile << endl;
+	}
 
-	if (SimLog::Debug > 7)
+	if (SimLog::Trace<7>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -982,10 +1117,10 @@ void DistributedRelay::updateDrniMasks()
 {
 	unsigned char homeDrn = 1;
 	unsigned char nborDrn = 2;
-	std::bitset<4096> tempHomeAggregatorMask;
-	std::bitset<4096> tempHomeGatewayMask;
-	std::bitset<4096> tempNborAggregatorMask;
-	std::bitset<4096> tempNborGatewayMask;
+	ConvMask tempHomeAggregatorMask;
+	ConvMask tempHomeGatewayMask;
+	ConvMask tempNborAggregatorMask;
+	ConvMask tempNborGatewayMask;
 
 	if (drSolo ||                       // if no DRNI or all sequence numbers have been acknowledged
 		((homeAggregatorState.AggSequenceNumber == reflectedAggSequenceNumber) &&
@@ -994,7 +1129,7 @@ void DistributedRelay::updateDrniMasks()
 	{
 		gatewaySyncMask.set();          // set sync mask true for all CIDs
 
-		if (SimLog::Debug > 7)
+		if (SimLog::Trace<7>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -1003,23 +1138,15 @@ void DistributedRelay::updateDrniMasks()
 		}
 	}
 
-	for (int cid = 0; cid < 4096; cid++)
-	{
-		tempHomeAggregatorMask[cid] = (homeSelectedAggregatorVector[cid] == homeDrn);
-		tempNborAggregatorMask[cid] = (homeSelectedAggregatorVector[cid] == nborDrn);
-		if (homeSelectedGatewayVector[cid] != homeDrn)
-			tempHomeGatewayMask[cid] = false;
-		else if (gatewaySyncMask[cid])
-			tempHomeGatewayMask[cid] = true;
-		else
-			tempHomeGatewayMask[cid] = homeGatewayMask[cid];
-		if (homeSelectedGatewayVector[cid] != nborDrn)
-			tempNborGatewayMask[cid] = false;
-		else if (gatewaySyncMask[cid])
-			tempNborGatewayMask[cid] = true;
-		else
-			tempNborGatewayMask[cid] = nborGatewayMask[cid];
-	}
+	//  A gateway mask bit is true if the Conversation ID is selected for that gateway, and either the gateway selection
+	//     is synchronized or the bit was already true.
+	tempHomeAggregatorMask.assignEqual(homeSelectedAggregatorVector, homeDrn);
+	tempNborAggregatorMask.assignEqual(homeSelectedAggregatorVector, nborDrn);
+	tempHomeGatewayMask.assignEqual(homeSelectedGatewayVector, homeDrn);
+	tempHomeGatewayMask &= (gatewaySyncMask | homeGatewayMask);
+	tempNborGatewayMask.assignEqual(homeSelectedGatewayVector, nborDrn);
+	tempNborGatewayMask &= (gatewaySyncMask | nborGatewayMask);
+
 	homeGatewayMask &= tempHomeGatewayMask;
 	nborGatewayMask &= tempNborGatewayMask;
 	homeAggregatorMask &= tempHomeAggregatorMask;
@@ -1030,7 +1157,7 @@ void DistributedRelay::updateDrniMasks()
 	homeAggregatorMask = tempHomeAggregatorMask;
 	nborAggregatorMask = tempNborAggregatorMask;
 
-	if (SimLog::Debug > 7)
+	if (SimLog::Trace<7>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< DrniAggregatorSystemId.addrMid << ":" << pAggregator->actorAdminSystem.addrMid
@@ -1058,24 +1185,24 @@ void DistributedRelay::updateDrniMasks()
 
 /**/
 
-void DistributedRelay::set_homeAdminGatewayEnable(std::bitset<4096> gwEnable)
+void DistributedRelay::set_homeAdminGatewayEnable(ConvMask gwEnable)
 {
 	homeAdminGatewayEnable = gwEnable;
 	newHomeInfo = true;
 }
 
-std::bitset<4096> DistributedRelay::get_homeAdminGatewayEnable()
+ConvMask DistributedRelay::get_homeAdminGatewayEnable()
 {
 	return (homeAdminGatewayEnable);
 }
 
-void DistributedRelay::set_homeAdminGatewayPreference(std::bitset<4096> gwPreference)
+void DistributedRelay::set_homeAdminGatewayPreference(ConvMask gwPreference)
 {
 	homeAdminGatewayPreference = gwPreference;
 	newHomeInfo = true;
 }
 
-std::bitset<4096> DistributedRelay::get_homeAdminGatewayPreference()
+ConvMask DistributedRelay::get_homeAdminGatewayPreference()
 {
 	return (homeAdminGatewayPreference);
 }
@@ -1109,6 +1236,18 @@ bool DistributedRelay::get_homeAdminCscdGatewayControl()
 	return(homeAdminCscdGatewayControl);
 }
 
+void DistributedRelay::set_DrcpDeltaEncoding(bool val)
+{
+	DrcpDeltaEncoding = val;
+	pBaseGatewayState = nullptr;          // Start from whole state TLVs
+	pBaseGatewayPreference = nullptr;
+}
+
+bool DistributedRelay::get_DrcpDeltaEncoding()
+{
+	return(DrcpDeltaEncoding);
+}
+
 
 
 /*
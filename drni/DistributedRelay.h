@@ -16,6 +16,8 @@ limitations under the License.
 
 #pragma once
 #include "Mac.h"
+#include "ConvMask.h"
+#include "Timer.h"
 #include "LinkAgg.h"
 #include "DistRelayState.h"
 #include "Drcpdu.h"
@@ -39,8 +41,10 @@ public:
 
 
 	void reset();
-	void timerTick();
 	void run(bool singleStep);
+	int nextEventTime() const;               // Earliest Time the Distributed Relay needs to run again (SimLog::Time if busy)
+	void saveState(Snapshot& snap) const;    // Copy variables and queued Frames to or from a Snapshot (see Snapshot.h)
+	void restoreState(Snapshot& snap);
 
 	virtual void setEnabled(bool val);
 	bool getOperational() const;
@@ -59,13 +63,20 @@ public:
 	unsigned long reflectedGwSequenceNumber;
 	unsigned long reflectedGpSequenceNumber;
 
+	bool DrcpDeltaEncoding;                                 // Send mask changes as deltas from the state the neighbor reflected
+	shared_ptr<const AggState> pTxAggregatorState;          // Immutable copies of the home state for the last sequence numbers
+	shared_ptr<const GwState> pTxGatewayState;              //    transmitted, shared by all DRCPDUs with that sequence number
+	shared_ptr<const GwPreference> pTxGatewayPreference;    //    (caches, so not part of a Snapshot)
+	shared_ptr<const GwState> pBaseGatewayState;            // Transmitted state the neighbor has reflected (base for deltas)
+	shared_ptr<const GwPreference> pBaseGatewayPreference;
+
 	sysId DrniAggregatorSystemId;
 	unsigned short DrniAggregatorKey;
 
 	bool homeAdminClientGatewayControl;
 	bool homeAdminCscdGatewayControl;
-	std::bitset<4096> homeAdminGatewayPreference;
-	std::bitset<4096> homeAdminGatewayEnable;
+	ConvMask homeAdminGatewayPreference;
+	ConvMask homeAdminGatewayEnable;
 	LagAlgorithms homeAdminGatewayAlgorithm;
 	//TODO:  homeAdminGatewayServiceIdMap;
 	//TODO:  homeOperGatewayServiceIdMap;
@@ -76,13 +87,13 @@ public:
 	std::array<unsigned char, 4096> homeSelectedGatewayVector;       // vector of Distributed Relay Numbers 
 	std::array<unsigned char, 4096> homeSelectedAggregatorVector;       // vector of Distributed Relay Numbers 
 	bool drSolo;
-	std::bitset<4096> gatewaySyncMask;
+	ConvMask gatewaySyncMask;
 
 	bool enableIrcData;
-	std::bitset<4096> homeAggregatorMask;
-	std::bitset<4096> homeGatewayMask;
-	std::bitset<4096> nborAggregatorMask;
-	std::bitset<4096> nborGatewayMask;
+	ConvMask homeAggregatorMask;
+	ConvMask homeGatewayMask;
+	ConvMask nborAggregatorMask;
+	ConvMask nborGatewayMask;
 
 // IntraRelayPort variables
 		bool irpOperational;
@@ -112,18 +123,20 @@ public:
 		bool differDrni;
 
 
-		int currentWhileTimer;
+		Timer currentWhileTimer;
 		bool newHomeInfo;
 		bool newNborState;
 		bool newReflectedState;
 
 
-		int DrcpTxWhen;
+		Timer DrcpTxWhen;
 		bool DrcpNTT;
 		bool DrcpTxOpportunity;
 		bool DrcpTxHold;
 		int DrcpTimeout;
 
+		int lastTransitionTime;      // Time of most recent DRCP state machine transition (used by nextEventTime)
+
 
 	void resetHomeState();
 	void setDefaultDrniSystemParameters();
@@ -146,7 +159,6 @@ public:
 		enum RxSmStates { NO_STATE, INITIALIZE, EXPIRED, DEFAULTED, WAIT_TO_RECEIVE, CURRENT };
 
 		static void reset(DistributedRelay& dr);
-		static void timerTick(DistributedRelay& dr);
 		static int run(DistributedRelay& dr, bool singleStep);
 
 	private:
@@ -176,7 +188,6 @@ public:
 		enum TxSmStates { NO_STATE, NO_TX, FAST_PERIODIC, SLOW_PERIODIC, TX };
 
 		static void reset(DistributedRelay& dr);
-		static void timerTick(DistributedRelay& dr);
 		static int run(DistributedRelay& dr, bool singleStep);
 
 	private:
@@ -192,16 +203,18 @@ public:
 	/**/
 
 
-	void set_homeAdminGatewayEnable(std::bitset<4096> gwEnable);
-	std::bitset<4096> get_homeAdminGatewayEnable();
-	void set_homeAdminGatewayPreference(std::bitset<4096> gwPreference);
-	std::bitset<4096> get_homeAdminGatewayPreference();
+	void set_homeAdminGatewayEnable(ConvMask gwEnable);
+	ConvMask get_homeAdminGatewayEnable();
+	void set_homeAdminGatewayPreference(ConvMask gwPreference);
+	ConvMask get_homeAdminGatewayPreference();
 //	void DistributedRelay::set_homeAdminGatewayAlgorithm(LagAlgorithms alg);
 //	LagAlgorithms DistributedRelay::get_homeAdminGatewayAlgorithm();	
 	void set_homeAdminGatewayAlgorithm(LagAlgorithms alg);
 	LagAlgorithms get_homeAdminGatewayAlgorithm();
 	void set_homeAdminCscdGatewayControl(bool val);
 	bool get_homeAdminCscdGatewayControl();
+	void set_DrcpDeltaEncoding(bool val);
+	bool get_DrcpDeltaEncoding();
 
 
 };
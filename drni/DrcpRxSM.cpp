@@ -25,13 +25,6 @@ void DistributedRelay::DrcpRxSM::reset(DistributedRelay& dr)
 	dr.pRxDrcpFrame = nullptr;
 }
 
-/**/
-void DistributedRelay::DrcpRxSM::timerTick(DistributedRelay& dr)
-{
-	if (dr.currentWhileTimer > 0) dr.currentWhileTimer--;
-}
-/**/
-
 int  DistributedRelay::DrcpRxSM::run(DistributedRelay& dr, bool singleStep)
 {
 	bool transitionTaken = false;
@@ -58,7 +51,7 @@ bool DistributedRelay::DrcpRxSM::step(DistributedRelay& dr)
 		dr.irpOperational = dr.pIss->getOperational();
 	else
 		dr.irpOperational = false;
-	if ((SimLog::Debug > 6) && (dr.irpOperational != oldIrpOperational))
+	if ((SimLog::Trace<6>()) && (dr.irpOperational != oldIrpOperational))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid ;
@@ -106,7 +99,7 @@ bool DistributedRelay::DrcpRxSM::step(DistributedRelay& dr)
 
 DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterInitialize(DistributedRelay& dr)
 {
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -121,7 +114,7 @@ DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterInitiali
 
 DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterExpired(DistributedRelay& dr)
 {
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -139,7 +132,7 @@ DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterExpired(
 
 DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterWaitToReceive(DistributedRelay& dr)
 {
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -153,7 +146,7 @@ DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterWaitToRe
 
 DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterDefaulted(DistributedRelay& dr)
 {
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -168,7 +161,7 @@ DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterDefaulte
 
 DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterDrniCheck(DistributedRelay& dr, Drcpdu& rxDrcpdu)
 {
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -185,7 +178,7 @@ DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterDrniChec
 
 DistributedRelay::DrcpRxSM::RxSmStates DistributedRelay::DrcpRxSM::enterCurrent(DistributedRelay& dr, Drcpdu& rxDrcpdu)
 {
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -233,7 +226,7 @@ void DistributedRelay::DrcpRxSM::recordDefault(DistributedRelay& dr)
 
 void DistributedRelay::DrcpRxSM::compareDrniValues(DistributedRelay& dr, Drcpdu& rxDrcpdu)
 {
-	if ((SimLog::Debug > 4))
+	if ((SimLog::Trace<4>()))
 	{
 		irpState rxDrcpState;
 		rxDrcpState.state = rxDrcpdu.homeIrpState.state;     // Not clear why I have to create a local variable for this, but it works
@@ -244,6 +237,8 @@ void DistributedRelay::DrcpRxSM::compareDrniValues(DistributedRelay& dr, Drcpdu&
 		if (rxDrcpdu.AggregatorStateTlv) SimLog::logFile << "  AggState";
 		if (rxDrcpdu.GatewayStateTlv) SimLog::logFile << "  GwState";
 		if (rxDrcpdu.GatewayPreferenceTlv) SimLog::logFile << "  GwPreference";
+		if (rxDrcpdu.GatewayStateDeltaTlv) SimLog::logFile << "  GwStateDelta";
+		if (rxDrcpdu.GatewayPreferenceDeltaTlv) SimLog::logFile << "  GwPreferenceDelta";
 		SimLog::logFile << dec << endl;
 
 		SimLog::logFile << "    RxHome : " << hex << rxDrcpdu.homeSystemId.id << " : " << rxDrcpdu.DrniAggregatorSystemId.id
@@ -261,29 +256,29 @@ void DistributedRelay::DrcpRxSM::compareDrniValues(DistributedRelay& dr, Drcpdu&
 			<< dec << endl;
 		if (rxDrcpdu.AggregatorStateTlv)
 		{
-			SimLog::logFile << "    RxHome AggPortAlg:  " << hex << rxDrcpdu.homeAggregatorState.AggPortAlgorithm;
+			SimLog::logFile << "    RxHome AggPortAlg:  " << hex << rxDrcpdu.pHomeAggregatorState->AggPortAlgorithm;
 			SimLog::logFile << "    Active Links:  " << dec;
-			for (auto link : rxDrcpdu.homeAggregatorState.AggActiveLinks)
+			for (auto link : rxDrcpdu.pHomeAggregatorState->AggActiveLinks)
 			{
 				SimLog::logFile << link << "  ";
 			}
-			SimLog::logFile << "    Partner SysID:  " << hex << rxDrcpdu.homeAggregatorState.AggPartnerSystemId.id;
-			SimLog::logFile << "    Key:  " << rxDrcpdu.homeAggregatorState.AggPartnerKey;
+			SimLog::logFile << "    Partner SysID:  " << hex << rxDrcpdu.pHomeAggregatorState->AggPartnerSystemId.id;
+			SimLog::logFile << "    Key:  " << rxDrcpdu.pHomeAggregatorState->AggPartnerKey;
 			SimLog::logFile << dec << endl;
 		}
 		if (rxDrcpdu.GatewayStateTlv)
 		{
 				SimLog::logFile << "    RxHome Gateway Available Mask:   ";
 				for (int i = 0; i < 16; i++)
-					SimLog::logFile << rxDrcpdu.homeGatewayState.GwAvailableMask[i] << "  ";
-				SimLog::logFile << "    RxHome GatewayAlg:  " << hex << rxDrcpdu.homeGatewayState.GwAlgorithm;
+					SimLog::logFile << rxDrcpdu.pHomeGatewayState->GwAvailableMask[i] << "  ";
+				SimLog::logFile << "    RxHome GatewayAlg:  " << hex << rxDrcpdu.pHomeGatewayState->GwAlgorithm;
 				SimLog::logFile << dec << endl;
 		}
 		if (rxDrcpdu.GatewayPreferenceTlv)
 		{
 				SimLog::logFile << "    RxHome Gateway Preference Mask:  ";
 				for (int i = 0; i < 16; i++)
-					SimLog::logFile <<  rxDrcpdu.homeGatewayPreference.GpPreferenceMask[i] << "  ";
+					SimLog::logFile <<  rxDrcpdu.pHomeGatewayPreference->GpPreferenceMask[i] << "  ";
 				SimLog::logFile << dec << endl;
 		}
 
@@ -371,7 +366,7 @@ void DistributedRelay::DrcpRxSM::recordReflectedState(DistributedRelay& dr, Drcp
 	{
 		dr.newReflectedState = true;
 		dr.reflectedAggSequenceNumber = rxDrcpdu.nborAggSequence;
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -384,7 +379,7 @@ void DistributedRelay::DrcpRxSM::recordReflectedState(DistributedRelay& dr, Drcp
 	{
 		dr.newReflectedState = true;
 		dr.reflectedGwSequenceNumber = rxDrcpdu.nborGwSequence;
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -397,7 +392,7 @@ void DistributedRelay::DrcpRxSM::recordReflectedState(DistributedRelay& dr, Drcp
 	{
 		dr.newReflectedState = true;
 		dr.reflectedGpSequenceNumber = rxDrcpdu.nborGpSequence;
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -416,7 +411,7 @@ void DistributedRelay::DrcpRxSM::recordReflectedState(DistributedRelay& dr, Drcp
 
 	dr.reflectedIrpState.state = rxDrcpdu.nborIrpState.state;
 
-	if ((debugNTT) && (SimLog::Debug > 6))
+	if ((debugNTT) && (SimLog::Trace<6>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -448,19 +443,20 @@ void DistributedRelay::DrcpRxSM::recordNeighborState(DistributedRelay& dr, Drcpd
 	}
 	if ((rxDrcpdu.homeAggSequence > dr.nborAggregatorState.AggSequenceNumber) &&
 		rxDrcpdu.AggregatorStateTlv &&
-		(rxDrcpdu.homeAggSequence == rxDrcpdu.homeAggregatorState.AggSequenceNumber) ) 
+		(rxDrcpdu.homeAggSequence == rxDrcpdu.pHomeAggregatorState->AggSequenceNumber) ) 
 	{
 //		debugNTT = true;          // redundant with actions when sequence numbers do not match
 //		dr.DrcpNTT = true;
 		dr.DrcpTxHold = true;
-		dr.newNborState = true;
-		dr.nborAggregatorState = rxDrcpdu.homeAggregatorState;
+		if (!dr.nborAggregatorState.sameState(*rxDrcpdu.pHomeAggregatorState))   // Only re-derive masks if state changed
+			dr.newNborState = true;
+		dr.nborAggregatorState = *rxDrcpdu.pHomeAggregatorState;
 
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
-				<< " DrcpRXSM recording Nbor AggState with SequenceNumber = " << dec << rxDrcpdu.homeAggregatorState.AggSequenceNumber
+				<< " DrcpRXSM recording Nbor AggState with SequenceNumber = " << dec << rxDrcpdu.pHomeAggregatorState->AggSequenceNumber
 				<< endl;
 		}
 	}
@@ -472,19 +468,39 @@ void DistributedRelay::DrcpRxSM::recordNeighborState(DistributedRelay& dr, Drcpd
 	}
 	if ((rxDrcpdu.homeGwSequence > dr.nborGatewayState.GwSequenceNumber) &&
 		rxDrcpdu.GatewayStateTlv &&
-		(rxDrcpdu.homeGwSequence == rxDrcpdu.homeGatewayState.GwSequenceNumber)) 
+		(rxDrcpdu.homeGwSequence == rxDrcpdu.pHomeGatewayState->GwSequenceNumber)) 
 	{
 //		debugNTT = true;
 //		dr.DrcpNTT = true;
 		dr.DrcpTxHold = true;
-		dr.newNborState = true;
-		dr.nborGatewayState = rxDrcpdu.homeGatewayState;
+		if (!dr.nborGatewayState.sameState(*rxDrcpdu.pHomeGatewayState))
+			dr.newNborState = true;
+		dr.nborGatewayState = *rxDrcpdu.pHomeGatewayState;
+
+		if ((SimLog::Trace<6>()))
+		{
+			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
+				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
+				<< " DrcpRXSM recording Nbor GwState with SequenceNumber = " << dec << rxDrcpdu.pHomeGatewayState->GwSequenceNumber
+				<< endl;
+		}
+	}
+	else if ((rxDrcpdu.homeGwSequence > dr.nborGatewayState.GwSequenceNumber) &&
+		rxDrcpdu.GatewayStateDeltaTlv &&
+		(rxDrcpdu.homeGwSequence == rxDrcpdu.pHomeGatewayStateDelta->sequenceNumber) &&
+		(rxDrcpdu.pHomeGatewayStateDelta->baseSequenceNumber == dr.nborGatewayState.GwSequenceNumber))   // Have the base state
+	{
+		dr.DrcpTxHold = true;
+		if (!rxDrcpdu.pHomeGatewayStateDelta->changedWords.empty())
+			dr.newNborState = true;
+		dr.nborGatewayState.GwSequenceNumber = rxDrcpdu.pHomeGatewayStateDelta->sequenceNumber;
+		rxDrcpdu.pHomeGatewayStateDelta->apply(dr.nborGatewayState.GwAvailableMask);
 
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
-				<< " DrcpRXSM recording Nbor GwState with SequenceNumber = " << dec << rxDrcpdu.homeGatewayState.GwSequenceNumber
+				<< " DrcpRXSM recording Nbor GwState delta with SequenceNumber = " << dec << rxDrcpdu.pHomeGatewayStateDelta->sequenceNumber
 				<< endl;
 		}
 	}
@@ -496,24 +512,44 @@ void DistributedRelay::DrcpRxSM::recordNeighborState(DistributedRelay& dr, Drcpd
 	}
 	if ((rxDrcpdu.homeGpSequence > dr.nborGatewayPreference.GpSequenceNumber) &&
 		rxDrcpdu.GatewayPreferenceTlv &&
-		(rxDrcpdu.homeGpSequence == rxDrcpdu.homeGatewayPreference.GpSequenceNumber)) 
+		(rxDrcpdu.homeGpSequence == rxDrcpdu.pHomeGatewayPreference->GpSequenceNumber)) 
 	{
 //		debugNTT = true;
 //		dr.DrcpNTT = true;
 		dr.DrcpTxHold = true;
-		dr.newNborState = true;
-		dr.nborGatewayPreference = rxDrcpdu.homeGatewayPreference;
+		if (!dr.nborGatewayPreference.sameState(*rxDrcpdu.pHomeGatewayPreference))
+			dr.newNborState = true;
+		dr.nborGatewayPreference = *rxDrcpdu.pHomeGatewayPreference;
+
+		if ((SimLog::Trace<6>()))
+		{
+			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
+				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
+				<< " DrcpRXSM recording Nbor GwPreference with GpSequenceNumber = " << dec << rxDrcpdu.pHomeGatewayPreference->GpSequenceNumber
+				<< endl;
+		}
+	}
+	else if ((rxDrcpdu.homeGpSequence > dr.nborGatewayPreference.GpSequenceNumber) &&
+		rxDrcpdu.GatewayPreferenceDeltaTlv &&
+		(rxDrcpdu.homeGpSequence == rxDrcpdu.pHomeGatewayPreferenceDelta->sequenceNumber) &&
+		(rxDrcpdu.pHomeGatewayPreferenceDelta->baseSequenceNumber == dr.nborGatewayPreference.GpSequenceNumber))
+	{
+		dr.DrcpTxHold = true;
+		if (!rxDrcpdu.pHomeGatewayPreferenceDelta->changedWords.empty())
+			dr.newNborState = true;
+		dr.nborGatewayPreference.GpSequenceNumber = rxDrcpdu.pHomeGatewayPreferenceDelta->sequenceNumber;
+		rxDrcpdu.pHomeGatewayPreferenceDelta->apply(dr.nborGatewayPreference.GpPreferenceMask);
 
-		if ((SimLog::Debug > 6))
+		if ((SimLog::Trace<6>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
-				<< " DrcpRXSM recording Nbor GwPreference with GpSequenceNumber = " << dec << rxDrcpdu.homeGatewayPreference.GpSequenceNumber
+				<< " DrcpRXSM recording Nbor GwPreference delta with GpSequenceNumber = " << dec << rxDrcpdu.pHomeGatewayPreferenceDelta->sequenceNumber
 				<< endl;
 		}
 	}
 
-	if ((debugNTT) && (SimLog::Debug > 6))
+	if ((debugNTT) && (SimLog::Trace<6>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -569,7 +605,7 @@ void DistributedRelay::DrcpRxSM::updateIrpState(DistributedRelay& dr, Drcpdu& rx
 		dr.DrcpNTT = true;
 	}
 
-	if ((debugNTT) && (SimLog::Debug > 6))
+	if ((debugNTT) && (SimLog::Trace<6>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 			<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
@@ -23,13 +23,6 @@ void DistributedRelay::DrcpTxSM::reset(DistributedRelay& dr)
 
 }
 
-/**/
-void DistributedRelay::DrcpTxSM::timerTick(DistributedRelay& dr)
-{
-
-}
-/**/
-
 int DistributedRelay::DrcpTxSM::run(DistributedRelay& dr, bool singleStep)
 {
 	bool transitionTaken = false;
@@ -138,21 +131,21 @@ bool DistributedRelay::DrcpTxSM::transmitDrcpdu(DistributedRelay& dr)
 	if (dr.pIss && dr.pIss->getOperational())  // Transmit frame only if MAC attached and won't immediately discard
 	{
 		unsigned long long mySA = dr.pIss->getMacAddress();
-		shared_ptr<Drcpdu> pMyDrcpdu = std::make_shared<Drcpdu>();
+		shared_ptr<Drcpdu> pMyDrcpdu = makeSdu<Drcpdu>();
 		prepareDrcpdu(dr, *pMyDrcpdu);
 		unique_ptr<Frame> myFrame = make_unique<Frame>(dr.drcpDestinationAddress, mySA, (shared_ptr<Sdu>)pMyDrcpdu);
 		myFrame->TimeStamp = SimLog::Time;   // May get overwritten at MAC request queue
 		dr.pIss->Request(move(myFrame));
 		success = true;
 
-		if ((SimLog::Debug > 4))
+		if ((SimLog::Trace<4>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Transmit DRCPDU through IRP " << hex << dr.pIss->getMacAddress() << dec << endl;
 		}
 	}
 	else
 	{
-		if ((SimLog::Debug > 9))
+		if ((SimLog::Trace<9>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Can't transmit DRCPDU:  IRP not operational " << hex << dr.pIss->getMacAddress() << dec << endl;
 		}
@@ -162,10 +155,24 @@ bool DistributedRelay::DrcpTxSM::transmitDrcpdu(DistributedRelay& dr)
 	return (success);
 }
 
+/*
+*   makeDelta returns the changes from the base mask to the new mask, or nullptr if the whole state should be sent instead.
+*/
+static shared_ptr<const ConvMaskDelta> makeDelta(unsigned long baseSequence, const ConvMask& baseMask,
+	unsigned long sequence, const ConvMask& mask)
+{
+	shared_ptr<ConvMaskDelta> pDelta = std::allocate_shared<ConvMaskDelta>(PoolAllocator<ConvMaskDelta>());
+	pDelta->baseSequenceNumber = baseSequence;
+	pDelta->sequenceNumber = sequence;
+	if (!pDelta->compute(baseMask, mask))
+		return (nullptr);
+	return (pDelta);
+}
+
 void DistributedRelay::DrcpTxSM::prepareDrcpdu(DistributedRelay& dr, Drcpdu& myDrcpdu)
 {
 	/*
-	if ((SimLog::Debug > 4))
+	if ((SimLog::Trace<4>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex << dr.DrniAggregatorSystemId.addrMid
 			<< ":" << dr.pAggregator->actorAdminSystem.addrMid << dec
@@ -200,8 +207,11 @@ void DistributedRelay::DrcpTxSM::prepareDrcpdu(DistributedRelay& dr, Drcpdu& myD
 	myDrcpdu.AggregatorStateTlv = (dr.homeAggregatorState.AggSequenceNumber != dr.reflectedAggSequenceNumber);
 	if (myDrcpdu.AggregatorStateTlv)
 	{
-		myDrcpdu.homeAggregatorState = dr.homeAggregatorState;
-		if ((SimLog::Debug > 6) &&
+		if (!dr.pTxAggregatorState ||                                              // Copy home state once per sequence number
+			(dr.pTxAggregatorState->AggSequenceNumber != dr.homeAggregatorState.AggSequenceNumber))
+			dr.pTxAggregatorState = std::allocate_shared<AggState>(PoolAllocator<AggState>(), dr.homeAggregatorState);
+		myDrcpdu.pHomeAggregatorState = dr.pTxAggregatorState;
+		if ((SimLog::Trace<6>()) &&
 			(dr.lastTxAggSequenceNumber != dr.homeAggregatorState.AggSequenceNumber))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
@@ -212,33 +222,70 @@ void DistributedRelay::DrcpTxSM::prepareDrcpdu(DistributedRelay& dr, Drcpdu& myD
 		dr.lastTxAggSequenceNumber = dr.homeAggregatorState.AggSequenceNumber;
 	}
 
-	// TLV: Gateway_State (type = 5; length = 552)
+	// TLV: Gateway_State (type = 5; length = 552), or Gateway_State_Delta if only the mask changed since the reflected state
+	if (dr.DrcpDeltaEncoding && dr.pTxGatewayState &&                             // Neighbor has the last transmitted state
+		(dr.pTxGatewayState->GwSequenceNumber == dr.reflectedGwSequenceNumber))
+		dr.pBaseGatewayState = dr.pTxGatewayState;
 	myDrcpdu.GatewayStateTlv = (dr.homeGatewayState.GwSequenceNumber != dr.reflectedGwSequenceNumber);
 	if (myDrcpdu.GatewayStateTlv)
 	{
-		myDrcpdu.homeGatewayState = dr.homeGatewayState;
-		if ((SimLog::Debug > 6) &&
+		if (!dr.pTxGatewayState ||
+			(dr.pTxGatewayState->GwSequenceNumber != dr.homeGatewayState.GwSequenceNumber))
+			dr.pTxGatewayState = std::allocate_shared<GwState>(PoolAllocator<GwState>(), dr.homeGatewayState);
+		myDrcpdu.pHomeGatewayState = dr.pTxGatewayState;
+		if (dr.DrcpDeltaEncoding && dr.pBaseGatewayState &&
+			(dr.pBaseGatewayState->GwSequenceNumber == dr.reflectedGwSequenceNumber) &&
+			(dr.pBaseGatewayState->GwAlgorithm == dr.homeGatewayState.GwAlgorithm) &&
+			(dr.pBaseGatewayState->GwConvServiceDigest == dr.homeGatewayState.GwConvServiceDigest))
+		{
+			myDrcpdu.pHomeGatewayStateDelta = makeDelta(dr.pBaseGatewayState->GwSequenceNumber, dr.pBaseGatewayState->GwAvailableMask,
+				dr.homeGatewayState.GwSequenceNumber, dr.homeGatewayState.GwAvailableMask);
+			myDrcpdu.GatewayStateDeltaTlv = (bool)myDrcpdu.pHomeGatewayStateDelta;
+			myDrcpdu.GatewayStateTlv = !myDrcpdu.GatewayStateDeltaTlv;
+			if (myDrcpdu.GatewayStateDeltaTlv)
+				myDrcpdu.pHomeGatewayState = nullptr;
+		}
+		if ((SimLog::Trace<6>()) &&
 			(dr.lastTxGwSequenceNumber != dr.homeGatewayState.GwSequenceNumber))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
 				<< " DrcpTXSM sending new Gateway State Sequence Number = " << dec << dr.homeGatewayState.GwSequenceNumber
+				<< (myDrcpdu.GatewayStateDeltaTlv ? " as delta" : "")
 				<< dec << endl;
 		}
 		dr.lastTxGwSequenceNumber = dr.homeGatewayState.GwSequenceNumber;
 	}
 
-   // TLV: Gateway_Preference (type = 6; length = 514)
+   // TLV: Gateway_Preference (type = 6; length = 516), or Gateway_Preference_Delta
+	if (dr.DrcpDeltaEncoding && dr.pTxGatewayPreference &&
+		(dr.pTxGatewayPreference->GpSequenceNumber == dr.reflectedGpSequenceNumber))
+		dr.pBaseGatewayPreference = dr.pTxGatewayPreference;
 	myDrcpdu.GatewayPreferenceTlv = (dr.homeGatewayPreference.GpSequenceNumber != dr.reflectedGpSequenceNumber);
 	if (myDrcpdu.GatewayPreferenceTlv)
 	{
-		myDrcpdu.homeGatewayPreference = dr.homeGatewayPreference;
-		if ((SimLog::Debug > 6) &&
+		if (!dr.pTxGatewayPreference ||
+			(dr.pTxGatewayPreference->GpSequenceNumber != dr.homeGatewayPreference.GpSequenceNumber))
+			dr.pTxGatewayPreference = std::allocate_shared<GwPreference>(PoolAllocator<GwPreference>(), dr.homeGatewayPreference);
+		myDrcpdu.pHomeGatewayPreference = dr.pTxGatewayPreference;
+		if (dr.DrcpDeltaEncoding && dr.pBaseGatewayPreference &&
+			(dr.pBaseGatewayPreference->GpSequenceNumber == dr.reflectedGpSequenceNumber))
+		{
+			myDrcpdu.pHomeGatewayPreferenceDelta = makeDelta(dr.pBaseGatewayPreference->GpSequenceNumber, 
+				dr.pBaseGatewayPreference->GpPreferenceMask,
+				dr.homeGatewayPreference.GpSequenceNumber, dr.homeGatewayPreference.GpPreferenceMask);
+			myDrcpdu.GatewayPreferenceDeltaTlv = (bool)myDrcpdu.pHomeGatewayPreferenceDelta;
+			myDrcpdu.GatewayPreferenceTlv = !myDrcpdu.GatewayPreferenceDeltaTlv;
+			if (myDrcpdu.GatewayPreferenceDeltaTlv)
+				myDrcpdu.pHomeGatewayPreference = nullptr;
+		}
+		if ((SimLog::Trace<6>()) &&
 			(dr.lastTxGpSequenceNumber != dr.homeGatewayPreference.GpSequenceNumber))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Drni:Home " << hex
 				<< dr.DrniAggregatorSystemId.addrMid << ":" << dr.pAggregator->actorAdminSystem.addrMid
 				<< " DrcpTXSM sending new Gateway Preference Sequence Number = " << dec << dr.homeGatewayPreference.GpSequenceNumber
+				<< (myDrcpdu.GatewayPreferenceDeltaTlv ? " as delta" : "")
 				<< dec << endl;
 		}
 		dr.lastTxGpSequenceNumber = dr.homeGatewayPreference.GpSequenceNumber;
@@ -16,11 +16,96 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Drcpdu.h"
+#include "Snapshot.h"
+#include "PduCodec.h"
+
+
+enum DrcpduTlvTypes { DRCP_TERMINATOR_TLV = 0, DRNI_SYSTEM_IDENTIFICATION_TLV, NEIGHBOR_DRNI_SYSTEM_IDENTIFICATION_TLV,
+	DRNI_STATE_TLV, AGGREGATOR_STATE_TLV, GATEWAY_STATE_TLV, GATEWAY_PREFERENCE_TLV,
+	GATEWAY_STATE_DELTA_TLV = 0x3e, GATEWAY_PREFERENCE_DELTA_TLV = 0x3f };        // Delta TLVs are simulation specific
+
+static const unsigned short DrniSystemIdentificationLength = 18;   // TLV length does not include the type/length field
+static const unsigned short NeighborSystemIdentificationLength = 8;
+static const unsigned short DrniStateLength = 26;
+static const unsigned short AggregatorStateLength = 52;            // Plus 2 octets per active link
+static const unsigned short GatewayStateLength = 552;
+static const unsigned short GatewayPreferenceLength = 516;
+static const unsigned short DeltaLength = 8;                       // Plus 10 octets per changed mask word
+static const unsigned short MaxTlvLength = 0x3ff;
+
+static void putTlvHeader(PduWriter& pdu, unsigned short type, unsigned short length)
+{
+	drcpduTlvTypeLength header;
+	header.type = type;
+	header.length = length;
+	pdu.put16(header.typeLength);
+}
+
+static void putMask(PduWriter& pdu, const ConvMask& mask)
+{
+	if (unsigned char* pOctets = pdu.reserve(ConvMask::NumBits / 8))
+		mask.getOctets(pOctets, 0, ConvMask::NumBits);
+}
+
+static void getMask(PduReader& pdu, ConvMask& mask)
+{
+	if (const unsigned char* pOctets = pdu.skip(ConvMask::NumBits / 8))
+		mask.setOctets(pOctets, 0, ConvMask::NumBits);
+}
+
+static void putDelta(PduWriter& pdu, unsigned short type, const ConvMaskDelta& delta)
+{
+	putTlvHeader(pdu, type, (unsigned short)(DeltaLength + 10 * delta.changedWords.size()));
+	pdu.put32(delta.baseSequenceNumber);
+	pdu.put32(delta.sequenceNumber);
+	for (const auto& word : delta.changedWords)
+	{
+		pdu.put16(word.first);
+		pdu.put64(word.second);
+	}
+}
+
+static shared_ptr<const ConvMaskDelta> getDelta(PduReader& pdu, unsigned short length)
+{
+	if ((length < DeltaLength) || ((length - DeltaLength) % 10) || 
+		((length - DeltaLength) / 10 > ConvMaskDelta::MaxChangedWords))
+		return (nullptr);
+	shared_ptr<ConvMaskDelta> pDelta = std::allocate_shared<ConvMaskDelta>(PoolAllocator<ConvMaskDelta>());
+	pDelta->baseSequenceNumber = pdu.get32();
+	pDelta->sequenceNumber = pdu.get32();
+	while (pdu.remaining() >= 10)
+	{
+		unsigned short index = pdu.get16();
+		unsigned long long value = pdu.get64();
+		if (index >= ConvMask::NumWords)
+			return (nullptr);
+		pDelta->changedWords.push_back(std::make_pair(index, value));
+	}
+	return (pDelta);
+}
 
 
 Drcpdu::Drcpdu()
 	: Sdu(DrniEthertype, DrcpduSubType)
 {
+	VersionNumber = 1;
+	homeSystemId.id = 0;
+	DrniAggregatorSystemId.id = 0;
+	DrniAggregatorKey = 0;
+	nborSystemId.id = 0;
+	homeAggSequence = 0;
+	homeGwSequence = 0;
+	homeGpSequence = 0;
+	nborAggSequence = 0;
+	nborGwSequence = 0;
+	nborGpSequence = 0;
+	homeIrpState.state = 0;
+	nborIrpState.state = 0;
+	AggregatorStateTlv = false;
+	GatewayStateTlv = false;
+	GatewayPreferenceTlv = false;
+	GatewayStateDeltaTlv = false;
+	GatewayPreferenceDeltaTlv = false;
 }
 
 
@@ -36,3 +121,279 @@ const Drcpdu& Drcpdu::getDrcpdu(Frame& DrcpFrame)        // Returns a constant r
 	return((const Drcpdu&)DrcpFrame.getNextSdu());
 	//	return ((const Drcpdu&)*(DrcpFrame.pNextSdu));
 }
+
+size_t Drcpdu::encode(unsigned char* buffer, size_t bufferSize) const
+{
+	PduWriter pdu(buffer, bufferSize);
+	pdu.put8((unsigned char)subType);
+	pdu.put8(VersionNumber);
+
+	putTlvHeader(pdu, DRNI_SYSTEM_IDENTIFICATION_TLV, DrniSystemIdentificationLength);
+	pdu.put64(homeSystemId.id);
+	pdu.put64(DrniAggregatorSystemId.id);
+	pdu.put16(DrniAggregatorKey);
+
+	putTlvHeader(pdu, NEIGHBOR_DRNI_SYSTEM_IDENTIFICATION_TLV, NeighborSystemIdentificationLength);
+	pdu.put64(nborSystemId.id);
+
+	putTlvHeader(pdu, DRNI_STATE_TLV, DrniStateLength);
+	pdu.put32(homeAggSequence);
+	pdu.put32(homeGwSequence);
+	pdu.put32(homeGpSequence);
+	pdu.put32(nborAggSequence);
+	pdu.put32(nborGwSequence);
+	pdu.put32(nborGpSequence);
+	pdu.put8(homeIrpState.state);
+	pdu.put8(nborIrpState.state);
+
+	if (AggregatorStateTlv && pHomeAggregatorState)
+	{
+		const AggState& state = *pHomeAggregatorState;
+		size_t length = AggregatorStateLength + 2 * state.AggActiveLinks.size();
+		if (length > MaxTlvLength)
+			return (0);
+		putTlvHeader(pdu, AGGREGATOR_STATE_TLV, (unsigned short)length);
+		pdu.put32(state.AggSequenceNumber);
+		pdu.put32(state.AggPortAlgorithm);
+		pdu.putBytes(state.AggConvServiceDigest.data(), state.AggConvServiceDigest.size());
+		pdu.putBytes(state.AggConvLinkDigest.data(), state.AggConvLinkDigest.size());
+		pdu.put64(state.AggPartnerSystemId.id);
+		pdu.put16(state.AggPartnerKey);
+		pdu.put8(state.AggCscdState.state);
+		pdu.put8(state.reserved);
+		for (auto link : state.AggActiveLinks)
+			pdu.put16(link);
+	}
+
+	if (GatewayStateTlv && pHomeGatewayState)
+	{
+		const GwState& state = *pHomeGatewayState;
+		putTlvHeader(pdu, GATEWAY_STATE_TLV, GatewayStateLength);
+		pdu.put32(state.GwSequenceNumber);
+		pdu.put32(state.GwAlgorithm);
+		pdu.putBytes(state.GwConvServiceDigest.data(), state.GwConvServiceDigest.size());
+		pdu.putZeros(16);
+		putMask(pdu, state.GwAvailableMask);
+	}
+
+	if (GatewayPreferenceTlv && pHomeGatewayPreference)
+	{
+		const GwPreference& preference = *pHomeGatewayPreference;
+		putTlvHeader(pdu, GATEWAY_PREFERENCE_TLV, GatewayPreferenceLength);
+		pdu.put32(preference.GpSequenceNumber);
+		putMask(pdu, preference.GpPreferenceMask);
+	}
+
+	if (GatewayStateDeltaTlv && pHomeGatewayStateDelta)
+		putDelta(pdu, GATEWAY_STATE_DELTA_TLV, *pHomeGatewayStateDelta);
+
+	if (GatewayPreferenceDeltaTlv && pHomeGatewayPreferenceDelta)
+		putDelta(pdu, GATEWAY_PREFERENCE_DELTA_TLV, *pHomeGatewayPreferenceDelta);
+
+	putTlvHeader(pdu, DRCP_TERMINATOR_TLV, 0);
+
+	return (pdu.ok() ? pdu.length() : 0);
+}
+
+bool Drcpdu::decode(const unsigned char* buffer, size_t length)
+{
+	PduReader pdu(buffer, length);
+	if (pdu.get8() != DrcpduSubType)
+		return (false);
+	VersionNumber = pdu.get8();
+
+	AggregatorStateTlv = false;
+	GatewayStateTlv = false;
+	GatewayPreferenceTlv = false;
+	pHomeAggregatorState = nullptr;
+	pHomeGatewayState = nullptr;
+	pHomeGatewayPreference = nullptr;
+	GatewayStateDeltaTlv = false;
+	GatewayPreferenceDeltaTlv = false;
+	pHomeGatewayStateDelta = nullptr;
+	pHomeGatewayPreferenceDelta = nullptr;
+
+	int requiredTlvs = 0;                            // Bit for each of the System Identification and DRNI State TLVs
+
+	while (pdu.ok())
+	{
+		drcpduTlvTypeLength header;
+		header.typeLength = pdu.get16();
+		if (!pdu.ok() || (header.type == DRCP_TERMINATOR_TLV))
+			break;
+		const unsigned char* pValue = pdu.skip(header.length);
+		if (!pValue)
+			return (false);
+		PduReader tlv(pValue, header.length);
+
+		switch (header.type)
+		{
+		case DRNI_SYSTEM_IDENTIFICATION_TLV:
+			if (header.length != DrniSystemIdentificationLength)
+				return (false);
+			homeSystemId.id = tlv.get64();
+			DrniAggregatorSystemId.id = tlv.get64();
+			DrniAggregatorKey = tlv.get16();
+			requiredTlvs |= 1;
+			break;
+		case NEIGHBOR_DRNI_SYSTEM_IDENTIFICATION_TLV:
+			if (header.length != NeighborSystemIdentificationLength)
+				return (false);
+			nborSystemId.id = tlv.get64();
+			requiredTlvs |= 2;
+			break;
+		case DRNI_STATE_TLV:
+			if (header.length != DrniStateLength)
+				return (false);
+			homeAggSequence = tlv.get32();
+			homeGwSequence = tlv.get32();
+			homeGpSequence = tlv.get32();
+			nborAggSequence = tlv.get32();
+			nborGwSequence = tlv.get32();
+			nborGpSequence = tlv.get32();
+			homeIrpState.state = tlv.get8();
+			nborIrpState.state = tlv.get8();
+			requiredTlvs |= 4;
+			break;
+		case AGGREGATOR_STATE_TLV:
+		{
+			if ((header.length < AggregatorStateLength) || ((header.length - AggregatorStateLength) % 2))
+				return (false);
+			shared_ptr<AggState> pState = std::allocate_shared<AggState>(PoolAllocator<AggState>());
+			pState->AggSequenceNumber = tlv.get32();
+			pState->AggPortAlgorithm = (LagAlgorithms)tlv.get32();
+			tlv.getBytes(pState->AggConvServiceDigest.data(), pState->AggConvServiceDigest.size());
+			tlv.getBytes(pState->AggConvLinkDigest.data(), pState->AggConvLinkDigest.size());
+			pState->AggPartnerSystemId.id = tlv.get64();
+			pState->AggPartnerKey = tlv.get16();
+			pState->AggCscdState.state = tlv.get8();
+			pState->reserved = tlv.get8();
+			while (tlv.remaining() >= 2)
+				pState->AggActiveLinks.insert(tlv.get16());
+			pHomeAggregatorState = pState;
+			AggregatorStateTlv = true;
+			break;
+		}
+		case GATEWAY_STATE_TLV:
+		{
+			if (header.length != GatewayStateLength)
+				return (false);
+			shared_ptr<GwState> pState = std::allocate_shared<GwState>(PoolAllocator<GwState>());
+			pState->GwSequenceNumber = tlv.get32();
+			pState->GwAlgorithm = (LagAlgorithms)tlv.get32();
+			tlv.getBytes(pState->GwConvServiceDigest.data(), pState->GwConvServiceDigest.size());
+			tlv.skip(16);
+			getMask(tlv, pState->GwAvailableMask);
+			pHomeGatewayState = pState;
+			GatewayStateTlv = true;
+			break;
+		}
+		case GATEWAY_PREFERENCE_TLV:
+		{
+			if (header.length != GatewayPreferenceLength)
+				return (false);
+			shared_ptr<GwPreference> pPreference = std::allocate_shared<GwPreference>(PoolAllocator<GwPreference>());
+			pPreference->GpSequenceNumber = tlv.get32();
+			getMask(tlv, pPreference->GpPreferenceMask);
+			pHomeGatewayPreference = pPreference;
+			GatewayPreferenceTlv = true;
+			break;
+		}
+		case GATEWAY_STATE_DELTA_TLV:
+			pHomeGatewayStateDelta = getDelta(tlv, header.length);
+			if (!pHomeGatewayStateDelta)
+				return (false);
+			GatewayStateDeltaTlv = true;
+			break;
+		case GATEWAY_PREFERENCE_DELTA_TLV:
+			pHomeGatewayPreferenceDelta = getDelta(tlv, header.length);
+			if (!pHomeGatewayPreferenceDelta)
+				return (false);
+			GatewayPreferenceDeltaTlv = true;
+			break;
+		default:                                     // Ignore TLVs from later versions
+			break;
+		}
+	}
+
+	return (requiredTlvs == 7);
+}
+
+template <class T> static void restoreTlv(Snapshot& snap, shared_ptr<const T>& pState)
+{
+	bool present = false;
+	snap.get(present);
+	pState = nullptr;
+	if (present)
+	{
+		shared_ptr<T> pRestored = std::allocate_shared<T>(PoolAllocator<T>());
+		pRestored->restoreState(snap);
+		pState = pRestored;
+	}
+}
+
+void Drcpdu::saveState(Snapshot& snap) const
+{
+	Sdu::saveState(snap);
+	snap.put(VersionNumber);
+	snap.put(homeSystemId);
+	snap.put(DrniAggregatorSystemId);
+	snap.put(DrniAggregatorKey);
+	snap.put(nborSystemId);
+	snap.put(homeAggSequence);
+	snap.put(homeGwSequence);
+	snap.put(homeGpSequence);
+	snap.put(nborAggSequence);
+	snap.put(nborGwSequence);
+	snap.put(nborGpSequence);
+	snap.put(homeIrpState);
+	snap.put(nborIrpState);
+	snap.put(AggregatorStateTlv);
+	snap.put((bool)pHomeAggregatorState);
+	if (pHomeAggregatorState)
+		pHomeAggregatorState->saveState(snap);
+	snap.put(GatewayStateTlv);
+	snap.put((bool)pHomeGatewayState);
+	if (pHomeGatewayState)
+		pHomeGatewayState->saveState(snap);
+	snap.put(GatewayPreferenceTlv);
+	snap.put((bool)pHomeGatewayPreference);
+	if (pHomeGatewayPreference)
+		pHomeGatewayPreference->saveState(snap);
+	snap.put(GatewayStateDeltaTlv);
+	snap.put((bool)pHomeGatewayStateDelta);
+	if (pHomeGatewayStateDelta)
+		pHomeGatewayStateDelta->saveState(snap);
+	snap.put(GatewayPreferenceDeltaTlv);
+	snap.put((bool)pHomeGatewayPreferenceDelta);
+	if (pHomeGatewayPreferenceDelta)
+		pHomeGatewayPreferenceDelta->saveState(snap);
+}
+
+void Drcpdu::restoreState(Snapshot& snap)
+{
+	Sdu::restoreState(snap);
+	snap.get(VersionNumber);
+	snap.get(homeSystemId);
+	snap.get(DrniAggregatorSystemId);
+	snap.get(DrniAggregatorKey);
+	snap.get(nborSystemId);
+	snap.get(homeAggSequence);
+	snap.get(homeGwSequence);
+	snap.get(homeGpSequence);
+	snap.get(nborAggSequence);
+	snap.get(nborGwSequence);
+	snap.get(nborGpSequence);
+	snap.get(homeIrpState);
+	snap.get(nborIrpState);
+	snap.get(AggregatorStateTlv);
+	restoreTlv(snap, pHomeAggregatorState);
+	snap.get(GatewayStateTlv);
+	restoreTlv(snap, pHomeGatewayState);
+	snap.get(GatewayPreferenceTlv);
+	restoreTlv(snap, pHomeGatewayPreference);
+	snap.get(GatewayStateDeltaTlv);
+	restoreTlv(snap, pHomeGatewayStateDelta);
+	snap.get(GatewayPreferenceDeltaTlv);
+	restoreTlv(snap, pHomeGatewayPreferenceDelta);
+}
@@ -32,6 +32,23 @@ union drcpduTlvTypeLength
 };
 
 
+/*
+*     The Distributed Relay Control Protocol Data Unit (Drcpdu) class inherits the Sdu base class.  A Drcpdu is generated
+*         by the DRCP Transmit State Machine (DrcpTxSM) of a DistributedRelay, and consumed by the DRCP Receive State
+*         Machine (DrcpRxSM) of the neighbor DistributedRelay.
+*     The fixed fields are a flat layout.  The Aggregator_State, Gateway_State and Gateway_Preference TLVs are only sent
+*         when the home state has changed (see DrcpTxSM::prepareDrcpdu), so their contents are held out of line and each
+*         pointer is nullptr unless the corresponding TLV boolean is true.  The state objects are immutable and shared by
+*         every DRCPDU sent with the same sequence number, so retransmissions do not copy them.
+*     When the Distributed Relay uses delta encoding (DrcpDeltaEncoding) a change to a Gateway_State or Gateway_Preference
+*         mask can instead be sent as a Gateway_State_Delta or Gateway_Preference_Delta TLV (see ConvMaskDelta).  These
+*         TLV types are specific to the simulation;  a DRCPDU never has both the whole state TLV and its delta.
+*     encode and decode convert between a Drcpdu and its wire format (from the Subtype octet to the end of the PDU,
+*         i.e. the MAC client data following the DRNI EtherType).  Each TLV has a 6 bit type and a 10 bit length
+*         (drcpduTlvTypeLength) giving the number of octets following the type/length field.  encode writes to a buffer
+*         supplied by the caller and decode reads the fields in place, so neither allocates (apart from received state TLVs).
+*/
+
 class Drcpdu : public Sdu
 {
 public:
@@ -40,6 +57,10 @@ public:
 	
 	static const Drcpdu& getDrcpdu(Frame& LacpFrame);      // Returns a constant reference to the Drcpdu
 
+	static const size_t MaxEncodedLength = 1500;           // Longest MAC client data of a frame
+	size_t encode(unsigned char* buffer, size_t bufferSize) const;   // Returns octets written, or 0 if buffer too small
+	bool decode(const unsigned char* buffer, size_t length);         // Returns false if not a valid DRCPDU
+
 	unsigned char VersionNumber;
 
 	// *** Start of d0.4 stuff
@@ -64,16 +85,26 @@ public:
 
 	// TLV: Aggregator_State (type = 4; length = 52 + 2 * number of active links)
 	bool AggregatorStateTlv;             // boolean to indicate whether the vector is included in the DRCPDU
-	AggState homeAggregatorState;
+	shared_ptr<const AggState> pHomeAggregatorState;
 
 	// TLV: Gateway_State (type = 5; length = 552)
 	bool GatewayStateTlv;             // boolean to indicate whether the vector is included in the DRCPDU
-	GwState homeGatewayState;
+	shared_ptr<const GwState> pHomeGatewayState;
 
-	// TLV: Gateway_Preference (type = 6; length = 514)
+	// TLV: Gateway_Preference (type = 6; length = 516)
 	bool GatewayPreferenceTlv;             // boolean to indicate whether the vector is included in the DRCPDU
-	GwPreference homeGatewayPreference;
+	shared_ptr<const GwPreference> pHomeGatewayPreference;
+
+	// TLV: Gateway_State_Delta (type = 0x3e; length = 8 + 10 * number of changed mask words)
+	bool GatewayStateDeltaTlv;             // boolean to indicate whether the delta is included in the DRCPDU
+	shared_ptr<const ConvMaskDelta> pHomeGatewayStateDelta;
+
+	// TLV: Gateway_Preference_Delta (type = 0x3f; length = 8 + 10 * number of changed mask words)
+	bool GatewayPreferenceDeltaTlv;        // boolean to indicate whether the delta is included in the DRCPDU
+	shared_ptr<const ConvMaskDelta> pHomeGatewayPreferenceDelta;
 
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
 
 };
 
@@ -0,0 +1,173 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Fdb.h"
+#include "Snapshot.h"
+
+
+Fdb::Fdb(int ageing)
+	: ageingTime(ageing)
+{
+	mask = 0;
+	used = 0;
+}
+
+Fdb::~Fdb()
+{
+}
+
+unsigned long long Fdb::makeKey(unsigned short vid, unsigned long long addr)
+{
+	return (((unsigned long long)vid << 48) | (addr & 0xffffffffffff));
+}
+
+size_t Fdb::home(unsigned long long key) const
+{
+	return ((size_t)((key * 0x9e3779b97f4a7c15) >> 32) & mask);     // Fibonacci hash spreads sequential addresses
+}
+
+bool Fdb::live(const Entry& entry) const
+{
+	return ((entry.port != UnknownPort) && (SimLog::Time - entry.lastSeen <= ageingTime));
+}
+
+void Fdb::learn(unsigned short vid, unsigned long long addr, int port)
+{
+	unsigned long long key = makeKey(vid, addr);
+	if (key == 0)                                    // Null address is never learned
+		return;
+
+	if ((used + 1) * 4 > entries.size() * 3)         // Make room before probing, so there is always an empty slot
+	{
+		size_t liveCount = size();
+		rehash(((liveCount + 1) * 2 > entries.size()) ? std::max(InitialCapacity, entries.size() * 2) : entries.size());
+	}
+
+	size_t reuse = entries.size();                   // First aged or flushed slot on the probe sequence, if any
+	size_t i = home(key);
+	while (entries[i].key != 0)
+	{
+		if (entries[i].key == key)                   // Address already in table, so refresh entry
+		{
+			entries[i].lastSeen = SimLog::Time;
+			entries[i].port = port;
+			return;
+		}
+		if ((reuse == entries.size()) && !live(entries[i]))
+			reuse = i;
+		i = (i + 1) & mask;
+	}
+	if (reuse == entries.size())                     // No aged slot to re-use, so take the empty slot
+	{
+		reuse = i;
+		used++;
+	}
+	entries[reuse].key = key;
+	entries[reuse].lastSeen = SimLog::Time;
+	entries[reuse].port = port;
+}
+
+int Fdb::lookup(unsigned short vid, unsigned long long addr) const
+{
+	if (entries.empty())
+		return (UnknownPort);
+
+	unsigned long long key = makeKey(vid, addr);
+	for (size_t i = home(key); entries[i].key != 0; i = (i + 1) & mask)
+	{
+		if (entries[i].key == key)
+			return (live(entries[i]) ? entries[i].port : UnknownPort);
+	}
+	return (UnknownPort);
+}
+
+void Fdb::flush(int port)
+{
+	for (auto& entry : entries)
+	{
+		if (entry.port == port)
+			entry.port = UnknownPort;                // Slot stays occupied so probe sequences are not broken
+	}
+}
+
+void Fdb::clear()
+{
+	entries.clear();
+	mask = 0;
+	used = 0;
+}
+
+size_t Fdb::size() const
+{
+	size_t count = 0;
+	for (auto& entry : entries)
+	{
+		if ((entry.key != 0) && live(entry))
+			count++;
+	}
+	return (count);
+}
+
+void Fdb::saveState(Snapshot& snap) const
+{
+	snap.put(ageingTime);
+	snap.put(entries.size());
+	for (auto& entry : entries)
+	{
+		snap.put(entry);
+	}
+	snap.put(mask);
+	snap.put(used);
+}
+
+void Fdb::restoreState(Snapshot& snap)
+{
+	size_t capacity = 0;
+
+	snap.get(ageingTime);
+	snap.get(capacity);
+	entries.clear();
+	for (size_t i = 0; (i < capacity) && snap.good(); i++)
+	{
+		Entry entry;
+		snap.get(entry);
+		entries.push_back(entry);
+	}
+	snap.get(mask);
+	snap.get(used);
+}
+
+void Fdb::rehash(size_t capacity)
+{
+	std::vector<Entry> oldEntries(capacity, Entry{ 0, 0, UnknownPort });
+	oldEntries.swap(entries);
+	mask = capacity - 1;
+	used = 0;
+
+	for (auto& entry : oldEntries)
+	{
+		if ((entry.key != 0) && live(entry))
+		{
+			size_t i = home(entry.key);
+			while (entries[i].key != 0)
+				i = (i + 1) & mask;
+			entries[i] = entry;
+			used++;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+class Snapshot;
+
+/*
+*   Class Fdb is the Filtering Database of a Bridge:  a table of the BridgePort through which each MAC address
+*       was last seen, per VLAN.  It is an open-addressing hash table (linear probing) keyed on the VLAN
+*       Identifier and MAC address, so a lookup usually touches a single cache line.
+*   An entry is learned (or refreshed) from the source address of every Frame received, and ages out when
+*       no Frame has been received from that address for ageingTime.  Ageing is driven by SimLog::Time as
+*       entries are looked up, so the Fdb needs no timer:  an aged entry is ignored by lookup, and its slot is
+*       re-used when a new address is learned.  An entry can also be removed by flushing its BridgePort.
+*   The table starts small and doubles when three-quarters full (after discarding aged entries), so learning
+*       does not allocate memory once the table has grown to the number of active addresses.
+*/
+
+class Fdb
+{
+public:
+	Fdb(int ageing = DefaultAgeingTime);
+	~Fdb();
+	Fdb(Fdb& copySource) = delete;             // Disable copy constructor
+	Fdb& operator= (const Fdb&) = delete;      // Disable assignment operator
+
+	static const int DefaultAgeingTime = 600000;     // 300 seconds (Time increments are 0.5 milliseconds)
+	static const int UnknownPort = -1;
+
+	int ageingTime;
+
+	void learn(unsigned short vid, unsigned long long addr, int port);   // Record that addr in VLAN vid was seen on port
+	int lookup(unsigned short vid, unsigned long long addr) const;       // Port for addr in VLAN vid, or UnknownPort
+	void flush(int port);                                                // Remove all entries learned on port
+	void clear();                                                        // Remove all entries
+	size_t size() const;                                                 // Number of entries that have not aged out
+	void saveState(Snapshot& snap) const;                                // Copy the table to or from a Snapshot
+	void restoreState(Snapshot& snap);
+
+private:
+	struct Entry
+	{
+		unsigned long long key;                      // VLAN Identifier and MAC address (0 if slot never used)
+		int lastSeen;                                // Time a Frame was last received from the address
+		int port;                                    // UnknownPort if entry has been flushed
+	};
+
+	std::vector<Entry> entries;                      // Capacity is a power of two
+	size_t mask;                                     // Capacity - 1
+	size_t used;                                     // Number of slots with a non-zero key (including aged entries)
+
+	static const size_t InitialCapacity = 64;
+
+	static unsigned long long makeKey(unsigned short vid, unsigned long long addr);
+	size_t home(unsigned long long key) const;       // First slot probed for key
+	bool live(const Entry& entry) const;             // True if entry has neither aged out nor been flushed
+	void rehash(size_t capacity);                    // Move live entries to a table of capacity slots
+};
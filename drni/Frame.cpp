@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Frame.h"
+#include "Lacpdu.h"
+#include "Drcpdu.h"
+#include "Snapshot.h"
 
 /**/
 Sdu::Sdu(unsigned short sduEtherType, unsigned short sduSubType)
@@ -42,6 +45,16 @@ Sdu::~Sdu()
 //	cout << "            Sdu Destructor called (" << SimLog::Time << ")" << endl;
 }
 
+void Sdu::saveState(Snapshot& snap) const
+{
+	snap.put(TimeStamp);
+}
+
+void Sdu::restoreState(Snapshot& snap)
+{
+	snap.get(TimeStamp);
+}
+
 const shared_ptr<Sdu> pNullSdu = make_shared<Sdu>(0, 0);
 const Sdu& NullSdu = *pNullSdu;
 
@@ -87,12 +100,13 @@ unsigned short Sdu::getNextSubType() const
 
 
 Frame::Frame(unsigned long long frameDA, unsigned long long frameSA, shared_ptr<Sdu> pframeSdu)
-	: MacDA(frameDA), MacSA(frameSA), pNextSdu(pframeSdu)
+	: MacDA(frameDA), MacSA(frameSA), pNextSdu(std::move(pframeSdu))
 {
 	TimeStamp = SimLog::Time;   // Frame TimeStamp is initially time of construction; may be overwritten when queued
 	VlanIdentifier = 0;
 	Priority = 0;
 	DropEligible = false;
+	setOuterTag();
 //		cout << "Frame constructor called (" << SimLog::Time << ")" << endl;
 }
 
@@ -105,9 +119,23 @@ Frame::Frame(const Frame& CopySource)
 	Priority = CopySource.Priority;
 	DropEligible = CopySource.DropEligible;
 	pNextSdu = CopySource.pNextSdu;           // shallow copy is fine
+	outerEtherType = CopySource.outerEtherType;
+	outerVid = CopySource.outerVid;
+	cachedConvIDs = CopySource.cachedConvIDs; // Sdus are shared, so the cached Conversation IDs remain valid
+	convIDs = CopySource.convIDs;
 //	cout << "Frame copy constructor called (" << SimLog::Time << ")" << endl;
 }
 
+void* Frame::operator new(size_t size)
+{
+	return (Pool::allocate(size));
+}
+
+void Frame::operator delete(void* pFrame, size_t size)
+{
+	Pool::deallocate(pFrame, size);
+}
+
 /*
 Frame::Frame(const Frame&& frameCopy)
 {
@@ -135,11 +163,7 @@ const Sdu& Frame::getNextSdu() const
 
 unsigned short Frame::getNextEtherType() const
 {
-	if (pNextSdu == nullptr)
-	{
-		return (0);
-	}
-	return (pNextSdu->etherType);
+	return (outerEtherType);
 }
 
 unsigned short Frame::getNextSubType() const
@@ -155,7 +179,8 @@ unique_ptr<Frame> Frame::InsertTag(shared_ptr<Sdu> pNewSdu) const
 {
 	unique_ptr<Frame> pNewFrame = make_unique<Frame>(*this);
 	pNewSdu->pNextSdu = pNewFrame->pNextSdu;
-	pNewFrame->pNextSdu = pNewSdu;
+	pNewFrame->pNextSdu = std::move(pNewSdu);
+	pNewFrame->setOuterTag();
 	return (std::move(pNewFrame));
 }
 
@@ -166,6 +191,7 @@ unique_ptr<Frame>  Frame::RemoveTag() const
 	if (this->pNextSdu != nullptr)
 	{
 		pNewFrame->pNextSdu = this->pNextSdu->pNextSdu;
+		pNewFrame->setOuterTag();
 	}
 	//	pTag->pNextSdu = nullptr;
 	return(std::move(pNewFrame));
@@ -194,16 +220,131 @@ pSdu = pSdu->pNextSdu;
 }
 /**/
 
+unsigned short Frame::getOuterVid() const
+{
+	return (outerVid);
+}
+
+bool Frame::getCachedConvID(LagAlgorithms algorithm, unsigned short& convID) const
+{
+	int slot = algorithm - LagAlgorithms::UNSPECIFIED;
+	if ((slot < 0) || (slot >= NumCachedAlgorithms) || !(cachedConvIDs & (1 << slot)))
+		return (false);
+	convID = convIDs[slot];
+	return (true);
+}
+
+void Frame::cacheConvID(LagAlgorithms algorithm, unsigned short convID)
+{
+	int slot = algorithm - LagAlgorithms::UNSPECIFIED;
+	if ((slot >= 0) && (slot < NumCachedAlgorithms))
+	{
+		convIDs[slot] = convID;
+		cachedConvIDs |= (1 << slot);
+	}
+}
+
+void Frame::setOuterTag()
+{
+	outerEtherType = 0;
+	outerVid = 0;
+	if (pNextSdu)
+	{
+		outerEtherType = pNextSdu->etherType;
+		if ((outerEtherType == CVlanEthertype) || (outerEtherType == SVlanEthertype))
+			outerVid = ((VlanTag&)(*pNextSdu)).Vtag.id;
+	}
+	cachedConvIDs = 0;
+}
+
+void Frame::saveFrame(Snapshot& snap, const unique_ptr<Frame>& pFrame)
+{
+	snap.put(pFrame != nullptr);
+	if (!pFrame)
+		return;
+
+	snap.put(pFrame->TimeStamp);
+	snap.put(pFrame->MacDA);
+	snap.put(pFrame->MacSA);
+	snap.put(pFrame->VlanIdentifier);
+	snap.put(pFrame->Priority);
+	snap.put(pFrame->DropEligible);
+
+	size_t count = 0;
+	for (const Sdu* pSdu = pFrame->pNextSdu.get(); pSdu; pSdu = pSdu->pNextSdu.get())
+		count++;
+	snap.put(count);
+	for (const Sdu* pSdu = pFrame->pNextSdu.get(); pSdu; pSdu = pSdu->pNextSdu.get())
+	{
+		snap.put(pSdu->etherType);
+		snap.put(pSdu->subType);
+		pSdu->saveState(snap);
+	}
+}
+
+unique_ptr<Frame> Frame::restoreFrame(Snapshot& snap)
+{
+	bool present = false;
+	snap.get(present);
+	if (!present)
+		return (nullptr);
+
+	unique_ptr<Frame> pFrame = make_unique<Frame>();
+	snap.get(pFrame->TimeStamp);
+	snap.get(pFrame->MacDA);
+	snap.get(pFrame->MacSA);
+	snap.get(pFrame->VlanIdentifier);
+	snap.get(pFrame->Priority);
+	snap.get(pFrame->DropEligible);
+
+	size_t count = 0;
+	snap.get(count);
+	Sdu* pLast = nullptr;
+	for (size_t i = 0; (i < count) && snap.good(); i++)
+	{
+		unsigned short etherType = 0;
+		unsigned short subType = 0;
+		snap.get(etherType);
+		snap.get(subType);
+
+		shared_ptr<Sdu> pSdu;                         // Re-create the Sdu as the derived class it was saved from
+		if ((etherType == CVlanEthertype) || (etherType == SVlanEthertype))
+			pSdu = makeSdu<VlanTag>(etherType);
+		else if (etherType == ITagEthertype)
+			pSdu = makeSdu<ITag>();
+		else if (etherType == Ipv4Ethertype)
+			pSdu = makeSdu<FlowSdu>();
+		else if ((etherType == PlaypenEthertypeA) && (subType == 1))
+			pSdu = makeSdu<TestSdu>();
+		else if ((etherType == SlowProtocolsEthertype) && (subType == LacpduSubType))
+			pSdu = makeSdu<Lacpdu>();
+		else if ((etherType == DrniEthertype) && (subType == DrcpduSubType))
+			pSdu = makeSdu<Drcpdu>();
+		else
+			pSdu = makeSdu<Sdu>(etherType, subType);
+		pSdu->restoreState(snap);
+
+		Sdu* pThis = pSdu.get();
+		if (pLast)
+			pLast->pNextSdu = std::move(pSdu);
+		else
+			pFrame->pNextSdu = std::move(pSdu);
+		pLast = pThis;
+	}
+	pFrame->setOuterTag();
+	return (pFrame);
+}
+
 void Frame::PrintFrameHeader() const
 {
 	SimLog::logFile << hex << MacDA << ":" << MacSA;
-	shared_ptr<Sdu> pSdu = pNextSdu;
+	const Sdu* pSdu = pNextSdu.get();     // Walk the Sdu chain without changing reference counts
 	while (pSdu)
 	{
 		if (pSdu->etherType == CVlanEthertype) SimLog::logFile << ":CVtag=" << ((VlanTag&)(*pSdu)).Vtag.tci;
 		else if (pSdu->etherType == SVlanEthertype) SimLog::logFile << ":SVtag=" << ((VlanTag&)(*pSdu)).Vtag.tci;
 		else SimLog::logFile << ":" << pSdu->etherType << ":" << (short)pSdu->subType;
-		pSdu = pSdu->pNextSdu;
+		pSdu = pSdu->pNextSdu.get();
 	}
 	SimLog::logFile << dec;
 }
@@ -240,8 +381,90 @@ const VlanTag& VlanTag::getVlanTag(Frame& taggedFrame)        // Returns a const
 }
 
 /**/
-TestSdu::TestSdu(int scratchData) 
-	: Sdu(PlaypenEthertypeA, 1), scratchPad(scratchData)
+ITag::ITag(unsigned long serviceId, unsigned short priority, bool dropEligible)
+	: Sdu(ITagEthertype, 0)
+{
+	Itag.tci = 0;
+	Itag.sid = serviceId;
+	Itag.pri = priority;
+	Itag.de = dropEligible;
+}
+
+ITag::~ITag()
+{
+}
+
+const ITag& ITag::getITag(const Sdu& tag)        // Returns a constant reference to an I-Tag found in an Sdu chain
+{
+	// Will generate an error if the EtherType of the Sdu was not validated before calling 
+
+	return((const ITag&)tag);
+}
+
+/**/
+FlowSdu::FlowSdu(unsigned long srcIp, unsigned long dstIp, unsigned short srcPort, unsigned short dstPort, unsigned char ipProtocol)
+	: Sdu(Ipv4Ethertype, 0), sourceIp(srcIp), destinationIp(dstIp), sourcePort(srcPort), destinationPort(dstPort), protocol(ipProtocol)
+{
+}
+
+FlowSdu::~FlowSdu()
+{
+}
+
+const FlowSdu& FlowSdu::getFlowSdu(const Sdu& flowSdu)  // Returns a constant reference to a FlowSdu found in an Sdu chain
+{
+	// Will generate an error if the EtherType of the Sdu was not validated before calling 
+
+	return((const FlowSdu&)flowSdu);
+}
+
+void VlanTag::saveState(Snapshot& snap) const
+{
+	Sdu::saveState(snap);
+	snap.put(Vtag);
+}
+
+void VlanTag::restoreState(Snapshot& snap)
+{
+	Sdu::restoreState(snap);
+	snap.get(Vtag);
+}
+
+void ITag::saveState(Snapshot& snap) const
+{
+	Sdu::saveState(snap);
+	snap.put(Itag);
+}
+
+void ITag::restoreState(Snapshot& snap)
+{
+	Sdu::restoreState(snap);
+	snap.get(Itag);
+}
+
+void FlowSdu::saveState(Snapshot& snap) const
+{
+	Sdu::saveState(snap);
+	snap.put(sourceIp);
+	snap.put(destinationIp);
+	snap.put(sourcePort);
+	snap.put(destinationPort);
+	snap.put(protocol);
+}
+
+void FlowSdu::restoreState(Snapshot& snap)
+{
+	Sdu::restoreState(snap);
+	snap.get(sourceIp);
+	snap.get(destinationIp);
+	snap.get(sourcePort);
+	snap.get(destinationPort);
+	snap.get(protocol);
+}
+
+/**/
+TestSdu::TestSdu(int scratchData, unsigned long long flow, int sent)
+	: Sdu(PlaypenEthertypeA, 1), scratchPad(scratchData), flowId(flow), timeSent(sent)
 {
 //	cout << "    TestSdu Constructor called" << endl;
 
@@ -261,4 +484,20 @@ const TestSdu& TestSdu::getTestSdu(Frame& testFrame)        // Returns a constan
 	//	return ((const TestSdu&)*(testFrame.pNextSdu));
 }
 
-/**/
\ No newline at end of file
+/**/
+
+void TestSdu::saveState(Snapshot& snap) const
+{
+	Sdu::saveState(snap);
+	snap.put(scratchPad);
+	snap.put(flowId);
+	snap.put(timeSent);
+}
+
+void TestSdu::restoreState(Snapshot& snap)
+{
+	Sdu::restoreState(snap);
+	snap.get(scratchPad);
+	snap.get(flowId);
+	snap.get(timeSent);
+}
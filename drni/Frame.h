@@ -15,6 +15,9 @@ limitations under the License.
 */
 
 #pragma once
+#include "Pool.h"
+
+class Snapshot;
 
 /*
 *   The structure of a Frame in this simulation is a Frame header that includes a pointer to the first Sdu in a chain
@@ -27,12 +30,17 @@ limitations under the License.
 *       There is no difference between a "tag", a "Protocol Data Unit (PDU)", and a "Service Data Unit (SDU)" as far as this
 *       simulation is concerned.
 *   A Frame object is instantiated using "std::make_unique<Frame>" and is accessed via a "std::unique_ptr<Frame>" (or a reference).
-*       An object of a class derived from Sdu is created using, for example, "std::make_shared<Lacpdu>" and is accessed via a 
-*       a "std::shared_ptr<Lacpdu>" or "std::shared_ptr<Sdu>" (or a reference). This means there is a single "owner" of any Frame,
+*       An object of a class derived from Sdu is created using, for example, "makeSdu<Lacpdu>" and is accessed via a 
+*       a "std::shared_ptr<Lacpdu>" or "std::shared_ptr<Sdu>" (or a reference).  Both Frames and Sdus are allocated from the
+*       Pool (see Pool.h) rather than the heap, since they are created and destroyed continually. This means there is a single "owner" of any Frame,
 *       and that Frame can be modified by inserting or removing "tags" without affecting other Frames in the simulation.  When a 
 *       Frame is replicated (for example within a Bridge), a "shallow" copy is made.  This means the pointer to the Sdu in the 
 *       Frame header is copied, but the Sdu itself is not copied.  It is therefore critical that Sdus are not modified once they
 *       created, or it could result in unintentional changes to other Frames elsewhere in the simultated network.
+*   A Frame caches the Conversation ID calculated for each distribution algorithm (see LinkAgg::frameConvID), along with a
+*       compact view of the outer tag (its EtherType and VLAN Identifier), so a Frame is classified at most once per algorithm
+*       as it passes through Aggregators, Distributed Relays and Bridges.  The cache relies on the Frame header and its Sdus
+*       not being modified after construction; InsertTag and RemoveTag create a new Frame with an empty cache.
 *   Frames propagate through the simulated network by moving the unique pointer using the "transmit()" method of the Mac
 *       (to move between Devices), and the "indicate()" and "request()" methods of classes derived from the Iss base class 
 *       (to move between Components within a Device).
@@ -52,6 +60,8 @@ public:
 	const Sdu& getNextSdu() const;
 	unsigned short getNextEtherType() const;
 	unsigned short getNextSubType() const;
+	virtual void saveState(Snapshot& snap) const;     // Copy variables to or from a Snapshot (see Snapshot.h)
+	virtual void restoreState(Snapshot& snap);
 
 protected:
 	unsigned short etherType;
@@ -71,6 +81,9 @@ public:
 	//	Frame(const Frame&& frameCopy);     // move constructor
 	~Frame();
 
+	static void* operator new(size_t size);                 // Frames are allocated from the Pool
+	static void operator delete(void* pFrame, size_t size);
+
 	int TimeStamp;
 
 
@@ -99,10 +112,32 @@ public:
 	//	void Frame::PrintSduList() const;
 	void PrintFrameHeader() const;
 
+	unsigned short getOuterVid() const;                         // VLAN Identifier of the outer Sdu if it is a VLAN tag, else 0
+	bool getCachedConvID(LagAlgorithms algorithm, unsigned short& convID) const;  // True if convID for algorithm is cached
+	void cacheConvID(LagAlgorithms algorithm, unsigned short convID);
+
+	static void saveFrame(Snapshot& snap, const unique_ptr<Frame>& pFrame);   // Copy a Frame (or nullptr) and its Sdus to a Snapshot
+	static unique_ptr<Frame> restoreFrame(Snapshot& snap);
+
 protected:
 	std::shared_ptr<Sdu> pNextSdu;
+	unsigned short outerEtherType;                // EtherType of the Sdu pNextSdu points to (0 if none)
+	unsigned short outerVid;                      // VLAN Identifier of that Sdu if it is a C-VLAN or S-VLAN tag
+
+	static const int NumCachedAlgorithms = LagAlgorithms::ECMP_FLOW_HASH - LagAlgorithms::UNSPECIFIED + 1;
+	unsigned char cachedConvIDs;                  // Bit per algorithm (from UNSPECIFIED) with a Conversation ID in convIDs
+	std::array<unsigned short, NumCachedAlgorithms> convIDs;
+
+	void setOuterTag();                           // Update the view of the outer tag and empty the cache
 };
 
+/**/
+template <class T, class... Args>
+shared_ptr<T> makeSdu(Args&&... args)        // Use in place of std::make_shared to allocate an Sdu (and its reference count) from the Pool
+{
+	return (std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...));
+}
+
 /**/
 union vlanControlWord
 {
@@ -125,20 +160,76 @@ public:
 	vlanControlWord Vtag;
 	static const VlanTag& getVlanTag(Frame& taggedFrame);        // Returns a constant reference to the Vlan tag
 
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
+
 };
 
 
 /**/
+union iTagControlWord
+{
+	unsigned long tci;            // I-Tag Information (less the UCA and reserved bits)
+	struct
+	{
+		unsigned long sid : 24;   //  0..23  Backbone Service Instance Identifier (I-SID)
+		unsigned long res :  4;   // 24..27  Reserved and Use Customer Addresses
+		unsigned long de  :  1;   //     28  Drop Eligible
+		unsigned long pri :  3;   // 29..31  Priority
+	};
+};
+
+class ITag : public Sdu
+{
+public:
+	ITag(unsigned long serviceId = 0, unsigned short priority = 0, bool dropEligible = false);
+	~ITag();
+
+	iTagControlWord Itag;
+	static const ITag& getITag(const Sdu& tag);        // Returns a constant reference to an I-Tag found in an Sdu chain
+
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
+};
+
+/*
+*   A FlowSdu carries the fields of an IP header (version 4) and a TCP or UDP header that identify a flow,
+*       so that frames can be distributed by a flow hash (ECMP_FLOW_HASH) rather than by MAC addresses.
+*/
+class FlowSdu : public Sdu
+{
+public:
+	FlowSdu(unsigned long srcIp = 0, unsigned long dstIp = 0, unsigned short srcPort = 0, unsigned short dstPort = 0,
+		unsigned char ipProtocol = UdpProtocol);
+	~FlowSdu();
+
+	unsigned long sourceIp;
+	unsigned long destinationIp;
+	unsigned short sourcePort;
+	unsigned short destinationPort;
+	unsigned char protocol;
+
+	static const FlowSdu& getFlowSdu(const Sdu& flowSdu);  // Returns a constant reference to a FlowSdu found in an Sdu chain
+
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
+};
 
 
 class TestSdu : public Sdu
 {
 public:
-	TestSdu(int scratchData = 0);
+	TestSdu(int scratchData = 0, unsigned long long flow = 0, int sent = 0);
 	~TestSdu();
 
 	static const TestSdu& getTestSdu(Frame& testFrame);        // Returns a constant reference to the Test Sdu
-	int scratchPad;
+	int scratchPad;                                            // Sequence number within the flow
+	unsigned long long flowId;                                 // Flow of a traffic generator (see TrafficGen.h), or zero if
+	                                                           //    the flow is identified by the MAC source address
+	int timeSent;                                              // Time the frame was generated (for latency)
+
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
 };
 /**/
 
@@ -0,0 +1,178 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "FrameQueue.h"
+#include "Snapshot.h"
+
+
+FrameQueue::FrameQueue(size_t queueDepth)
+{
+	head = 0;
+	count = 0;
+	drops = 0;
+	dropEligibleDrops = 0;
+	depth = 0;
+	mask = 0;
+	dropEligibleDepth = 0;
+	setDepth(queueDepth);
+}
+
+FrameQueue::~FrameQueue()
+{
+	clear();
+}
+
+bool FrameQueue::empty() const
+{
+	return (count == 0);
+}
+
+size_t FrameQueue::size() const
+{
+	return (count);
+}
+
+unique_ptr<Frame>& FrameQueue::front()
+{
+	return (ring[head]);
+}
+
+const unique_ptr<Frame>& FrameQueue::front() const
+{
+	return (ring[head]);
+}
+
+bool FrameQueue::push(unique_ptr<Frame> pFrame)
+{
+	if ((count >= depth) || (pFrame && pFrame->DropEligible && (count >= dropEligibleDepth)))
+	{
+		drops++;
+		if (pFrame && pFrame->DropEligible)
+			dropEligibleDrops++;
+		return (false);                            // Frame is discarded when pFrame goes out of scope
+	}
+
+	if (ring.empty())                               // Allocate storage when first needed
+		ring.resize(mask + 1);
+	ring[(head + count) & mask] = std::move(pFrame);
+	count++;
+	return (true);
+}
+
+void FrameQueue::pop()
+{
+	if (count > 0)
+	{
+		ring[head] = nullptr;                       // Release Frame, if it was not moved out of the queue
+		head = (head + 1) & mask;
+		count--;
+	}
+}
+
+void FrameQueue::clear()
+{
+	while (count > 0)
+		pop();
+	head = 0;
+}
+
+size_t FrameQueue::getDepth() const
+{
+	return (depth);
+}
+
+void FrameQueue::setDepth(size_t queueDepth)
+{
+	if (queueDepth < 1)
+		queueDepth = 1;
+
+	size_t capacity = 1;
+	while (capacity < queueDepth)
+		capacity <<= 1;
+
+	std::vector<unique_ptr<Frame>> newRing;         // Move any queued Frames to new storage
+	size_t newCount = 0;
+	if (count > 0)
+	{
+		newRing.resize(capacity);
+		while ((count > 0) && (newCount < queueDepth))
+		{
+			newRing[newCount++] = std::move(ring[head]);
+			pop();
+		}
+		drops += count;                             // Frames that do not fit are discarded
+		clear();
+	}
+
+	ring = std::move(newRing);
+	depth = queueDepth;
+	dropEligibleDepth = queueDepth - (queueDepth / 4);
+	mask = capacity - 1;
+	head = 0;
+	count = newCount;
+}
+
+unsigned long long FrameQueue::getDrops() const
+{
+	return (drops);
+}
+
+unsigned long long FrameQueue::getDropEligibleDrops() const
+{
+	return (dropEligibleDrops);
+}
+
+void FrameQueue::clearDrops()
+{
+	drops = 0;
+	dropEligibleDrops = 0;
+}
+
+void FrameQueue::saveState(Snapshot& snap) const
+{
+	snap.put(depth);
+	snap.put(drops);
+	snap.put(dropEligibleDrops);
+	snap.put(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		Frame::saveFrame(snap, ring[(head + i) & mask]);
+	}
+}
+
+void FrameQueue::restoreState(Snapshot& snap)
+{
+	size_t savedDepth = 0;
+	size_t savedCount = 0;
+
+	clear();
+	snap.get(savedDepth);
+	if (savedDepth != depth)
+		setDepth(savedDepth);
+	snap.get(drops);
+	snap.get(dropEligibleDrops);
+	snap.get(savedCount);
+	savedCount = std::min(savedCount, depth);
+
+	if ((savedCount > 0) && ring.empty())
+		ring.resize(mask + 1);
+	for (size_t i = 0; (i < savedCount) && snap.good(); i++)   // Frames are put directly in the ring rather than pushed, 
+	{                                                          //    so a drop eligible Frame is not discarded when re-queued
+		ring[i] = Frame::restoreFrame(snap);
+	}
+	count = savedCount;
+}
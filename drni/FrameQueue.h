@@ -0,0 +1,68 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Frame.h"
+
+/*
+*   Class FrameQueue is a bounded first-in-first-out queue of Frames, implemented as a ring buffer.
+*       It provides the subset of std::queue used by the simulation (empty, size, front, push, pop) so it can replace
+*       the request and indication queues in IssQ, Mac, and iLink.
+*   The depth (maximum number of Frames) is configurable.  A Frame pushed to a full queue is discarded (tail-drop),
+*       and a Frame with DropEligible set is discarded once the queue is three-quarters full, leaving headroom for Frames
+*       that are not drop eligible.  Discarded Frames are counted.
+*   The ring buffer storage is not allocated until the first Frame is pushed, since most queues (e.g. those of 
+*       Aggregators that are never selected) never carry a Frame.  Once allocated the storage does not change size
+*       unless the depth is changed, so queuing Frames does not allocate memory.
+*/
+
+class FrameQueue
+{
+public:
+	FrameQueue(size_t queueDepth = DefaultDepth);
+	~FrameQueue();
+	FrameQueue(FrameQueue& copySource) = delete;             // Disable copy constructor
+	FrameQueue& operator= (const FrameQueue&) = delete;      // Disable assignment operator
+
+	static const size_t DefaultDepth = 256;
+
+	bool empty() const;
+	size_t size() const;
+	unique_ptr<Frame>& front();
+	const unique_ptr<Frame>& front() const;
+	bool push(unique_ptr<Frame> pFrame);             // Returns false, and discards the Frame, if no room in queue
+	void pop();
+	void clear();                                    // Discards all Frames in queue (not counted as drops)
+
+	size_t getDepth() const;
+	void setDepth(size_t queueDepth);                // Frames beyond the new depth are discarded and counted as drops
+	unsigned long long getDrops() const;             // Number of Frames discarded since created or clearDrops()
+	unsigned long long getDropEligibleDrops() const; // Number of those Frames that were drop eligible
+	void clearDrops();
+
+	void saveState(Snapshot& snap) const;            // Copy depth, drop counts, and queued Frames to or from a Snapshot
+	void restoreState(Snapshot& snap);
+
+private:
+	std::vector<unique_ptr<Frame>> ring;             // Capacity is depth rounded up to a power of two
+	size_t depth;
+	size_t dropEligibleDepth;                          // Drop eligible Frames are discarded when queue holds this many Frames
+	size_t mask;                                       // Capacity - 1
+	size_t head;                                       // Index of Frame at front of queue
+	size_t count;                                      // Number of Frames in queue
+	unsigned long long drops;
+	unsigned long long dropEligibleDrops;
+};
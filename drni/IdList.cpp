@@ -0,0 +1,158 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "IdList.h"
+
+
+IdList::IdList()
+{
+	pIds = inlineIds.data();
+	count = 0;
+	capacity = InlineCapacity;
+}
+
+IdList::IdList(std::initializer_list<unsigned short> ids)
+	: IdList()
+{
+	for (auto id : ids)
+		insert(id);
+}
+
+IdList::IdList(const IdList& other)
+	: IdList()
+{
+	*this = other;
+}
+
+IdList& IdList::operator= (const IdList& other)
+{
+	if (this != &other)
+	{
+		reserve(other.count);
+		std::copy(other.begin(), other.end(), pIds);
+		count = other.count;
+	}
+	return (*this);
+}
+
+IdList::~IdList()
+{
+}
+
+void IdList::reserve(size_t newCapacity)
+{
+	if (newCapacity <= capacity)
+		return;
+	newCapacity = std::max(newCapacity, 2 * capacity);
+	unique_ptr<unsigned short[]> newIds(new unsigned short[newCapacity]);
+	std::copy(begin(), end(), newIds.get());
+	heapIds = std::move(newIds);
+	pIds = heapIds.get();
+	capacity = newCapacity;
+}
+
+void IdList::append(unsigned short id)
+{
+	reserve(count + 1);
+	pIds[count++] = id;
+}
+
+void IdList::insert(unsigned short id)
+{
+	reserve(count + 1);
+	unsigned short* pPos = std::upper_bound(pIds, pIds + count, id);
+	std::copy_backward(pPos, pIds + count, pIds + count + 1);
+	*pPos = id;
+	count++;
+}
+
+void IdList::remove(unsigned short id)
+{
+	unsigned short* pFirst = std::lower_bound(pIds, pIds + count, id);
+	unsigned short* pLast = std::upper_bound(pFirst, pIds + count, id);
+	if (pFirst != pLast)
+	{
+		std::copy(pLast, pIds + count, pFirst);
+		count -= (pLast - pFirst);
+	}
+}
+
+bool IdList::contains(unsigned short id) const
+{
+	return (std::binary_search(begin(), end(), id));
+}
+
+void IdList::merge(const IdList& other)
+{
+	if (other.empty())
+		return;
+	IdList merged;
+	merged.reserve(count + other.count);
+	std::merge(begin(), end(), other.begin(), other.end(), merged.pIds);
+	merged.count = count + other.count;
+	*this = merged;
+}
+
+bool IdList::operator== (const IdList& other) const
+{
+	return ((count == other.count) && std::equal(begin(), end(), other.begin()));
+}
+
+bool IdList::operator!= (const IdList& other) const
+{
+	return (!(*this == other));
+}
+
+IdList IdList::difference(const IdList& a, const IdList& b)
+{
+	IdList result;
+	const_iterator pA = a.begin();
+	const_iterator pB = b.begin();
+	while (pA != a.end())
+	{
+		if ((pB == b.end()) || (*pA < *pB))       // Only in a
+			result.append(*pA++);
+		else if (*pB < *pA)                       // Only in b
+			pB++;
+		else                                      // In both
+		{
+			pA++;
+			pB++;
+		}
+	}
+	return (result);
+}
+
+IdList IdList::symmetricDifference(const IdList& a, const IdList& b)
+{
+	IdList result;
+	const_iterator pA = a.begin();
+	const_iterator pB = b.begin();
+	while ((pA != a.end()) || (pB != b.end()))
+	{
+		if ((pB == b.end()) || ((pA != a.end()) && (*pA < *pB)))
+			result.append(*pA++);
+		else if ((pA == a.end()) || (*pB < *pA))
+			result.append(*pB++);
+		else
+		{
+			pA++;
+			pB++;
+		}
+	}
+	return (result);
+}
@@ -0,0 +1,74 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+
+/*
+*   Class IdList is a sorted list of 16 bit identifiers:  the Aggregation Port indexes and identifiers of a LAG
+*       (Aggregator::lagPorts, selectedLagPorts) and the Link Numbers of its active links (Aggregator::activeLagLinks,
+*       AggState::AggActiveLinks).  It replaces std::list<unsigned short> for these, which allocated a node for every
+*       element and was searched element by element.
+*   The identifiers are held in ascending order in a contiguous array.  Up to InlineCapacity identifiers are held
+*       within the IdList itself, so a typical LAG needs no heap allocation;  a longer list moves to a heap array that
+*       grows by doubling and is kept (not freed) if the list shrinks.
+*   Like the std::list operations it replaces, insert keeps duplicates (e.g. two links with the same Link Number)
+*       and remove removes every element equal to the value.  contains is a binary search.  merge, difference and
+*       symmetricDifference are linear passes over two sorted lists, with duplicates counted (so the difference of
+*       {1, 2, 2} and {2} is {1, 2}).
+*/
+
+class IdList
+{
+public:
+	static const size_t InlineCapacity = 8;
+	typedef const unsigned short* const_iterator;
+
+	IdList();
+	IdList(std::initializer_list<unsigned short> ids);
+	IdList(const IdList& other);
+	IdList& operator= (const IdList& other);
+	~IdList();
+
+	const_iterator begin() const { return (pIds); }
+	const_iterator end() const { return (pIds + count); }
+	size_t size() const { return (count); }
+	bool empty() const { return (count == 0); }
+	unsigned short front() const { return (pIds[0]); }            // Lowest identifier (list must not be empty)
+	unsigned short back() const { return (pIds[count - 1]); }     // Highest identifier (list must not be empty)
+
+	void clear() { count = 0; }
+	void insert(unsigned short id);                               // Add in order (after any equal identifiers)
+	void remove(unsigned short id);                               // Remove all identifiers equal to id
+	bool contains(unsigned short id) const;
+	void merge(const IdList& other);                              // Add all identifiers of other
+
+	bool operator== (const IdList& other) const;
+	bool operator!= (const IdList& other) const;
+
+	static IdList difference(const IdList& a, const IdList& b);           // Identifiers in a that are not in b
+	static IdList symmetricDifference(const IdList& a, const IdList& b);  // Identifiers in only one of a and b
+
+private:
+	unsigned short* pIds;                                         // inlineIds or heapIds
+	size_t count;
+	size_t capacity;
+	std::array<unsigned short, InlineCapacity> inlineIds;
+	unique_ptr<unsigned short[]> heapIds;
+
+	void reserve(size_t newCapacity);
+	void append(unsigned short id);                               // Add at end (caller keeps the order)
+};
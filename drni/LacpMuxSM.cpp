@@ -27,15 +27,6 @@ void AggPort::LacpMuxSM::reset(AggPort& port)
 	port.MuxSmState = enterDetached(port);
 }
 
-/**/
-// void AggPort::LacpMuxSM::timerTickMuxSM(AggPort& port)
-void AggPort::LacpMuxSM::timerTick(AggPort& port)
-{
-	if (port.waitWhileTimer > 0) port.waitWhileTimer--;
-	if (port.waitToRestoreTimer > 0) port.waitToRestoreTimer--;
-}
-/**/
-
 // int AggPort::LacpMuxSM::runMuxSM(AggPort& port, bool singleStep)
 int AggPort::LacpMuxSM::run(AggPort& port, bool singleStep)
 {
@@ -183,7 +174,7 @@ bool AggPort::LacpMuxSM::stepMuxSM(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDetached(AggPort& port)
 {
-	if (SimLog::Debug > 3)
+	if (SimLog::Trace<3>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 		    << " is DETACHED from Aggregator "  << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -230,7 +221,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDetached(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterWaiting(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::Trace<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " is WAITING for Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -244,7 +235,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterWaiting(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttach(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::Trace<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " is ATTACH for Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -261,7 +252,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttachedWtr(AggPort& po
 
 	if (port.MuxSmState != MuxSmStates::ATTACHED_WTR)
 	{
-		if ((SimLog::Debug > 3))
+		if ((SimLog::Trace<3>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 				<< " is ATTACHED_WTR for Aggregator " << port.actorPortAggregatorIdentifier;
@@ -283,7 +274,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttachedWtr(AggPort& po
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttached(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::Trace<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " is ATTACHED to Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -326,7 +317,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttached(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterCollecting(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::Trace<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " is COLLECTING on Aggregator " << port.actorPortAggregatorIdentifier 
@@ -364,7 +355,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterCollecting(AggPort& por
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDistributing(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::Trace<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " is DISTRIBUTING on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -379,7 +370,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDistributing(AggPort& p
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterCollDist(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::Trace<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " is COLL_DIST on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -441,14 +432,19 @@ void AggPort::LacpMuxSM::enableDistributing(AggPort& port)
 	// If were going to add this test would have to set distributing true after calling enableDistributing
 
 	port.changeActorDistributing = true;
+	if (port.operationalTime >= 0)           // Record first time distributing since port became operational
+	{
+		port.distributingDelay.add(SimLog::Time - port.operationalTime);
+		port.operationalTime = -1;
+	}
 
-	if ((SimLog::Debug > 0))
+	if ((SimLog::Trace<0>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " Link Number " << dec << port.LinkNumberID << hex
 			<< " is UP on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
-	cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num 
+	SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num 
 		<< " Link Number " << dec << port.LinkNumberID << hex
 		<< " is UP on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 }
@@ -459,13 +455,13 @@ void AggPort::LacpMuxSM::disableDistributing(AggPort& port)
 	{
 		port.changeActorDistributing = true;  //TODO:  changeActorDistributing is only checked in updatePartnerDistributionAlgorithm
 
-		if ((SimLog::Debug > 0))
+		if ((SimLog::Trace<0>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 				<< " Link Number " << dec << port.LinkNumberID << hex
 				<< " is DOWN on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 		}
-		cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num 
+		SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num 
 			<< " Link Number " << dec << port.LinkNumberID << hex
 			<< " is DOWN on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
@@ -476,14 +472,19 @@ void AggPort::LacpMuxSM::enableCollectingDistributing(AggPort& port)
 	port.changeActorDistributing = true;
 	port.changePartnerOperDistAlg |= !port.actorOperPortState.collecting;
 	port.changePortLinkState |= !port.actorOperPortState.collecting;
+	if (port.operationalTime >= 0)           // Record first time distributing since port became operational
+	{
+		port.distributingDelay.add(SimLog::Time - port.operationalTime);
+		port.operationalTime = -1;
+	}
 
-	if ((SimLog::Debug > 0))
+	if ((SimLog::Trace<0>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " Link Number " << dec << port.LinkNumberID << hex
 			<< " is UP on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
-	cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
+	SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 		<< " Link Number " << dec << port.LinkNumberID << hex
 		<< " is UP on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 
@@ -496,6 +497,8 @@ void AggPort::LacpMuxSM::disableCollectingDistributing(AggPort& port)
 	port.portOperConversationMask.reset();
 	port.distributionConversationMask.reset();
 	port.collectionConversationMask.reset();
+	port.convMasksCurrent = false;        // Masks must be recomputed for all Conversation IDs
+	port.changeForwarding = true;
 	port.actorDWC = false;
 	port.LinkNumberID = port.adminLinkNumberID;
 	port.changePortLinkState = true;
@@ -505,13 +508,13 @@ void AggPort::LacpMuxSM::disableCollectingDistributing(AggPort& port)
 	port.actorPartnerSync = (port.portOperConversationMask == port.partnerOperConversationMask);
 	/**/
 
-	if ((SimLog::Debug > 0))
+	if ((SimLog::Trace<0>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 			<< " Link Number " << dec << port.LinkNumberID << hex
 			<< " is DOWN on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
-	cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
+	SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 		<< " Link Number " << dec << port.LinkNumberID << hex
 		<< " is DOWN on Aggregator " << port.actorAdminSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 
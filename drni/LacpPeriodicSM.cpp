@@ -24,14 +24,6 @@ void AggPort::LacpPeriodicSM::reset(AggPort& port)
 	port.PerSmState = enterNoPeriodic(port);
 }
 
-/**/
-// void AggPort::LacpPeriodicSM::timerTickPeriodicSM(AggPort& port)
-void AggPort::LacpPeriodicSM::timerTick(AggPort& port)
-{
-	if (port.periodicTimer > 0) port.periodicTimer--;
-}
-/**/
-
 // int AggPort::LacpPeriodicSM::runPeriodicSM(AggPort& port, bool singleStep)
 int AggPort::LacpPeriodicSM::run(AggPort& port, bool singleStep)
 {
@@ -125,7 +117,7 @@ AggPort::LacpPeriodicSM::PerSmStates AggPort::LacpPeriodicSM::enterSlowPeriodic(
 AggPort::LacpPeriodicSM::PerSmStates AggPort::LacpPeriodicSM::enterPeriodicTx(AggPort& port)
 {
 	port.NTT = true;
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorOperSystem.addrMid
 			<< ":" << port.actorPort.num << " NTT: Periodic " << dec << endl;
@@ -32,14 +32,6 @@ void AggPort::LacpRxSM::reset(AggPort& port)
 
 }
 
-/**/
-//void AggPort::LacpRxSM::timerTickRxSM(AggPort& port)
-void AggPort::LacpRxSM::timerTick(AggPort& port)
-{
-	if (port.currentWhileTimer > 0) port.currentWhileTimer--;
-}
-/**/
-
 // int  AggPort::LacpRxSM::runRxSM(AggPort& port, bool singleStep)
 int  AggPort::LacpRxSM::run(AggPort& port, bool singleStep)
 {
@@ -76,7 +68,7 @@ bool AggPort::LacpRxSM::stepRxSM(AggPort& port)
 		RxSmStates nextRxSmState = RxSmStates::NO_STATE;
 		bool transitionTaken = false;
 		
-		if (SimLog::Debug > 6 &&
+		if (SimLog::Trace<6>() &&
 			(port.portOperational != port.pIss->getOperational()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
@@ -87,6 +79,8 @@ bool AggPort::LacpRxSM::stepRxSM(AggPort& port)
 				<< dec << endl;
 		}
 
+		if (!port.portOperational && port.pIss->getOperational())
+			port.operationalTime = SimLog::Time;         // Start of time to distributing (see enableDistributing)
 		port.portOperational = port.pIss->getOperational();
 
 		bool globalTransition = (port.RxSmState != RxSmStates::PORT_DISABLED || port.partnerOperPortState.sync) && !port.portOperational && !port.PortMoved;
@@ -153,7 +147,7 @@ AggPort::LacpRxSM::RxSmStates AggPort::LacpRxSM::enterPortDisabled(AggPort& port
 		port.partnerOperPortState.sync = false;
 		port.partnerLacpVersion = 1;     // Not in standard
 
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << "  LacpRxSM enters PORT_DISABLED  (LacpVersion = " 
@@ -170,7 +164,7 @@ AggPort::LacpRxSM::RxSmStates AggPort::LacpRxSM::enterLacpDisabled(AggPort& port
 		port.partnerOperPortState.aggregation = false;
 		port.actorOperPortState.expired = false;
 
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << "  LacpRxSM enters LACP_DISABLED  " << dec << endl;
@@ -197,7 +191,7 @@ AggPort::LacpRxSM::RxSmStates AggPort::LacpRxSM::enterExpired(AggPort& port)
 		}
 		/**/
 
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << "  LacpRxSM enters EXPIRED " << dec << endl;
@@ -212,7 +206,7 @@ AggPort::LacpRxSM::RxSmStates AggPort::LacpRxSM::enterDefaulted(AggPort& port)
 		recordDefault(port);
 		port.actorOperPortState.expired = false;
 
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << "  LacpRxSM enters DEFAULTED " << dec << endl;
@@ -233,7 +227,7 @@ AggPort::LacpRxSM::RxSmStates AggPort::LacpRxSM::enterCurrent(AggPort& port, con
 		else port.currentWhileTimer = port.longTimeout;
 		port.actorOperPortState.expired = false;
 
-		if ((SimLog::Debug > 6) && (port.RxSmState != RxSmStates::CURRENT))
+		if ((SimLog::Trace<6>()) && (port.RxSmState != RxSmStates::CURRENT))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << "  LacpRxSM enters CURRENT " << dec << endl;
@@ -290,7 +284,7 @@ void AggPort::LacpRxSM::updateNTT(AggPort& port, const Lacpdu& rxLacpdu)
 			(rxLacpdu.partnerState.aggregation != port.actorOperPortState.aggregation))
 		{
 			port.NTT = true;
-			if (SimLog::Debug > 6)
+			if (SimLog::Trace<6>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 					<< ":" << port.actorPort.num << " NTT: RxLACPDU partner info doesn't match actor info " << dec << endl;
@@ -300,7 +294,7 @@ void AggPort::LacpRxSM::updateNTT(AggPort& port, const Lacpdu& rxLacpdu)
 
 void AggPort::LacpRxSM::recordPdu(AggPort& port, const Lacpdu& rxLacpdu)
 	{
-		if ((SimLog::Debug > 4))
+		if ((SimLog::Trace<4>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Device:Port " << hex << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 				<< dec << " received LACPDUv" << (short)rxLacpdu.VersionNumber << " sent at time " << rxLacpdu.TimeStamp;
@@ -338,7 +332,7 @@ void AggPort::LacpRxSM::recordPdu(AggPort& port, const Lacpdu& rxLacpdu)
 			recordReceivedConversationMaskTlv(port, rxLacpdu);
 			/**/
 
-			if ((SimLog::Debug > 4))
+			if ((SimLog::Trace<4>()))
 			{
 				if (rxLacpdu.portConversationIdDigestTlv)
 				{
@@ -420,7 +414,7 @@ void AggPort::LacpRxSM::actorAdminChange(AggPort& port)       // Compare actor a
 		port.actorOperPortState.lacpShortTimeout = port.actorAdminPortState.lacpShortTimeout;  // can change without unselecting (but should set NTT)
 
 		port.NTT = true;
-		if (SimLog::Debug > 6)
+		if (SimLog::Trace<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << " NTT: Admin variable changed " << dec << endl;
@@ -514,7 +508,7 @@ void AggPort::LacpRxSM::recordConversationPortDigestTlv(AggPort& port, const Lac
 				//              partner link number changes to match actor
 			}
 
-			if (!digestIsNull(port.partnerOperConversationLinkListDigest))  // if partner digest changing to default
+			if (!Aggregator::digestIsNull(port.partnerOperConversationLinkListDigest))  // if partner digest changing to default
 			{
 				port.partnerOperConversationLinkListDigest.fill(0);         //    then store new value
 				port.changePartnerOperDistAlg |= (port.actorOperPortState.collecting && (port.portSelected == selectedVals::SELECTED));
@@ -559,7 +553,7 @@ void AggPort::LacpRxSM::recordConversationServiceMappingDigestTlv(AggPort& port,
 		}
 		else      // if no TLV (even though partner is v2) then set to defaults
 		{
-			if (!digestIsNull(port.partnerOperConversationServiceMappingDigest))  // if partner digest changing to default
+			if (!Aggregator::digestIsNull(port.partnerOperConversationServiceMappingDigest))  // if partner digest changing to default
 			{
 				port.partnerOperConversationServiceMappingDigest.fill(0);         //    then store new value
 				if (port.actorOperPortState.collecting)       //  If collecting when change to new partner digest 
@@ -575,12 +569,12 @@ void AggPort::LacpRxSM::recordConversationServiceMappingDigestTlv(AggPort& port,
 void AggPort::LacpRxSM::recordReceivedConversationMaskTlv(AggPort& port, const Lacpdu& rxLacpdu)
 	{
 
-		if (rxLacpdu.portConversationMaskTlvs)
+		if (rxLacpdu.portConversationMaskTlvs && rxLacpdu.pActorPortConversationMask)
 		{
 			port.partnerActorPartnerSync = rxLacpdu.actorPortConversationMaskState.actorPartnerSync;
 			port.partnerDWC = rxLacpdu.actorPortConversationMaskState.DWC;      // Not in standard, but should be
 			port.partnerPSI = rxLacpdu.actorPortConversationMaskState.PSI;      //TODO: Not relevant ?
-			port.partnerOperConversationMask = rxLacpdu.actorPortConversationMask;
+			port.partnerOperConversationMask = *rxLacpdu.pActorPortConversationMask;
 			port.actorPartnerSync = (port.partnerOperConversationMask == port.portOperConversationMask);
 			port.updateLocal = (!port.actorPartnerSync || !port.partnerActorPartnerSync);
 		}
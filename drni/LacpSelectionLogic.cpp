@@ -30,6 +30,15 @@ void AggPort::LacpSelection::resetSelection(AggPort& port)
 
 void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators)
 {
+	for (auto& pPort : pAggPorts)
+	{
+		if (pPort->changeActorSystem)                                                // If AggPort ActorSystem identifier has changed
+		{
+			pPort->portSelected = AggPort::selectedVals::UNSELECTED;                 //    then unselect the AggPort
+			pPort->actorOperSystem = pPort->actorAdminSystem;                        //    and set operational System ID to new Admin value
+			pPort->changeActorSystem = false;
+		}
+	}
 	for (unsigned short ax = 0; ax < pAggregators.size(); ax++)
 	{
 		//TODO:  Make sure this doesn't lock up if oper system ID gets out of sync with admin
@@ -38,7 +47,6 @@ void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPor
 		if (agg.changeActorSystem)                                                   // If ActorSystem identifier has changed
 		{
 			clearAggregator(agg, pAggPorts);                                         //    then kick all ports off Aggregator
-			pAggPorts[ax]->portSelected = AggPort::selectedVals::UNSELECTED;         //    and unselect corresponding AggPort
 			agg.actorOperSystem = agg.actorAdminSystem;                              //    Set operational System ID to new Admin value
 			agg.changeActorSystem = false;
 		}
@@ -88,7 +96,7 @@ void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPor
 						pPort->portSelected = AggPort::selectedVals::UNSELECTED;    // clearAggregator already did this for any ports selected or attached
 						// but not that might be "standby" to a dual-homed station
 						pPort->NTT = true;
-						if (SimLog::Debug > 5)
+						if (SimLog::Trace<5>())
 						{
 							SimLog::logFile << "Time " << SimLog::Time
 								<< ":   Device:Aggregator " << hex << agg.actorAdminSystem.addrMid << ":" << agg.aggregatorIdentifier
@@ -103,7 +111,7 @@ void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPor
 		if (agg.drniPartnerSystemId.id && !agg.lagPorts.empty() &&                  // If DRNI Partner constrained and current partner is different
 			((agg.partnerSystem.id != agg.drniPartnerSystemId.id) || (agg.partnerOperAggregatorKey != agg.drniPartnerKey)))
 		{
-			if (SimLog::Debug > 5)
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << agg.actorAdminSystem.addrMid
 					<< ":" << agg.aggregatorIdentifier
@@ -120,9 +128,11 @@ void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPor
 
 void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators)
 {
+	SelectionIndex index(pAggPorts, pAggregators);            // Built only if some port has a new partner or needs selection
+
 	for (unsigned short px = 0; px < pAggPorts.size(); px++)   // walk through AggPort array using px as index
 	{
-		if ((SimLog::Debug > 5) && (pAggPorts[px]->isNonRevertive != (!pAggPorts[px]->wtrRevertive &&
+		if ((SimLog::Trace<5>()) && (pAggPorts[px]->isNonRevertive != (!pAggPorts[px]->wtrRevertive &&
 			(pAggPorts[px]->isNonRevertive || pAggPorts[px]->wtrWaiting))))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
@@ -148,13 +158,13 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 		//      will no longer respond to portOperational and can never enter the PORT_DISABLED state.
 		if (pAggPorts[px]->newPartner)                        // if this port has a new partner
 		{
-			if (SimLog::Debug > 5)
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 					<< pAggPorts[px]->actorAdminSystem.addrMid << ":" << pAggPorts[px]->actorPort.id
 					<< " has new partner   " << pAggPorts[px]->partnerOperSystem.addrMid << ":" << pAggPorts[px]->partnerOperPort.id;
 			}
-			for (unsigned short opx = 0; opx < pAggPorts.size(); opx++)   // walk through AggPort array using opx as index
+			for (unsigned short opx : index.portsWithPartner(*pAggPorts[px]))   // walk through AggPorts with same partner System and Port
 			{
 				if ((opx != px) &&                                        // if there is another port with the same partner info
 					(pAggPorts[opx]->partnerOperSystem.id == pAggPorts[px]->partnerOperSystem.id) &&
@@ -164,13 +174,13 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 					(pAggPorts[opx]->RxSmState == AggPort::LacpRxSM::RxSmStates::PORT_DISABLED))
 				{
 					pAggPorts[opx]->PortMoved = true;                      //    then set port_moved flag for RxSM of the other port
-					if (SimLog::Debug > 5)
+					if (SimLog::Trace<5>())
 					{
 						SimLog::logFile << " that moved from port " << pAggPorts[opx]->actorAdminSystem.addrMid << ":" << pAggPorts[opx]->actorPort.id;
 					}
 				}
 			}
-			if (SimLog::Debug > 5)
+			if (SimLog::Trace<5>())
 			{
 				SimLog::logFile << dec << endl;
 
@@ -210,9 +220,10 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 			pAggregators[pAggPorts[px]->actorPortAggregatorIndex]->lagPorts.remove(px);  // remove AggPort from lagPort list of previously selected Aggregator
 			pAggregators[pAggPorts[px]->actorPortAggregatorIndex]->selectedLagPorts.remove(px);  // remove AggPort from lagPort list of previously selected Aggregator
 
-			unsigned short chosenAggregatorIndex = (unsigned short)pAggPorts.size();   // assume no aggregator chosen yet
+			unsigned short chosenAggregatorIndex = (unsigned short)pAggregators.size();   // assume no aggregator chosen yet
+			bool ownAggregator = (px < pAggregators.size());          // Port has a preferred aggregator (not if Aggregators are a smaller pool)
 
-			if (!pAggPorts[px]->actorOperPortState.aggregation)       // If port is not aggregatable (i.e. is Individual)
+			if (!pAggPorts[px]->actorOperPortState.aggregation && ownAggregator)   // If port is not aggregatable (i.e. is Individual)
 //				&& pAggregators[px]->getEnabled())                     //     and the aggregator is enabled
 			{
 				// This implements a policy that setting an AggPort "Individual" permanently reserves the corresponding Aggregator.
@@ -220,17 +231,17 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				//   or even whether the Aggregator is enabled (only time a AggPort will select a disabled Aggregator).
 				clearAggregator(*pAggregators[px], pAggPorts);        //     Then kick other ports (if any) off own aggregator
 				chosenAggregatorIndex = px;                           //       and make own aggregrator the chosen aggregator
-				if (SimLog::Debug > 8) SimLog::logFile << "Time " << SimLog::Time << "       Individual Port ";
+				if (SimLog::Trace<8>()) SimLog::logFile << "Time " << SimLog::Time << "       Individual Port ";
 			}
 			else if (pAggPorts[px]->partnerOperPortState.aggregation)            // Else if partner is also aggregatable
 			{
-				chosenAggregatorIndex = findMatchingAggregator(px, pAggPorts);   //     Then see if can join an existing LAG
-				if (SimLog::Debug > 8) SimLog::logFile << "Time " << SimLog::Time << "                  Port ";
+				chosenAggregatorIndex = findMatchingAggregator(px, pAggPorts, pAggregators, index);   //     Then see if can join an existing LAG
+				if (SimLog::Trace<8>()) SimLog::logFile << "Time " << SimLog::Time << "                  Port ";
 			}
-			if (SimLog::Debug > 8) SimLog::logFile << hex << pAggPorts[px]->actorAdminSystem.id << ":" << pAggPorts[px]->actorPort.id << dec
+			if (SimLog::Trace<8>()) SimLog::logFile << hex << pAggPorts[px]->actorAdminSystem.id << ":" << pAggPorts[px]->actorPort.id << dec
 				<< " finds matching Aggregator " << chosenAggregatorIndex;
 
-			if (chosenAggregatorIndex > px)                           // if not joining existing LAG or only on higher aggregator
+			if ((chosenAggregatorIndex >= pAggregators.size()) || (chosenAggregatorIndex > px))   // if not joining existing LAG or only on higher aggregator
 			{
 				/*
 				*   This section is what optimizes determinism over minimizing movement of ports among aggregators.
@@ -244,11 +255,11 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				*   TODO:  The code below will kick ports of this port's preferred aggregator only if this port is operational.
 				*   Do we want to claim the aggregator even if this port is not operational if no other ports on it are operational?
 				*/
-				if (allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // If preferred aggregator has matching key
+				if (ownAggregator && allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // If preferred aggregator has matching key
 //					pAggPorts[px]->portOperational && (!pAggPorts[px]->wtrWaiting || pAggPorts[px]->wtrRevertive))    //   and the port is operational and revertive
 					pAggPorts[px]->portOperational && (!pAggPorts[px]->isNonRevertive || pAggPorts[px]->wtrRevertive))    //   and the port is operational and revertive
 		{
-					if (SimLog::Debug > 8)
+					if (SimLog::Trace<8>())
 					{
 						SimLog::logFile << endl << "Time " << SimLog::Time << ":  *** Port " << hex
 							<< pAggPorts[px]->actorAdminSystem.addrMid << ":" << pAggPorts[px]->actorPort.id << dec
@@ -265,7 +276,7 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 					}
 					chosenAggregatorIndex = px;                                //     Make preferred aggregator the chosen aggregator                          
 				}
-				if (SimLog::Debug > 8) SimLog::logFile << "  ... " << chosenAggregatorIndex;
+				if (SimLog::Trace<8>()) SimLog::logFile << "  ... " << chosenAggregatorIndex;
 				/*
 				*   This section will attempt to find an aggregator with no active ports.
 				*   
@@ -278,10 +289,10 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				if (chosenAggregatorIndex >= pAggregators.size() &&            // If have not yet chosen an aggregator
 					pAggPorts[px]->portOperational)                            //   and the port is operational
 				{
-					if (allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // Then if preferred aggregator has matching key
+					if (ownAggregator && allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // Then if preferred aggregator has matching key
 						!activeAggregator(*pAggregators[px], pAggPorts))             //   and preferred aggregator has no active ports
 					{
-						if ((SimLog::Debug > 5) && pAggPorts[px]->isNonRevertive)
+						if ((SimLog::Trace<5>()) && pAggPorts[px]->isNonRevertive)
 						{
 							SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 								<< pAggPorts[px]->actorAdminSystem.addrMid << ":" << pAggPorts[px]->actorPort.id
@@ -294,7 +305,7 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 					}
 					else //TODO:  should I put in a bias toward a previous aggregator, or go right to choosing first available aggregator?
 					{                                                          // Otherwise look for another aggregator with no active ports
-						unsigned short possibleAggregatorIndex = findAvailableAggregator(*pAggPorts[px], pAggPorts, pAggregators);
+						unsigned short possibleAggregatorIndex = findAvailableAggregator(*pAggPorts[px], pAggPorts, pAggregators, index);
 						if (possibleAggregatorIndex < pAggregators.size())             //   If found another aggregator
 						{
 //							if (!pAggPorts[px]->wtrWaiting || pAggPorts[px]->wtrRevertive)  //  and this port is revertive
@@ -305,7 +316,7 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 							}
 							else
 							{                                                          //       Otherwise set this port to revertive, so next cycle can compete 
-								if ((SimLog::Debug > 5) && pAggPorts[px]->isNonRevertive)
+								if ((SimLog::Trace<5>()) && pAggPorts[px]->isNonRevertive)
 								{
 									SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 										<< pAggPorts[px]->actorAdminSystem.addrMid << ":" << pAggPorts[px]->actorPort.id
@@ -318,9 +329,9 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 					}
 
 				}
-				if (SimLog::Debug > 8) SimLog::logFile << "  ... " << chosenAggregatorIndex;
+				if (SimLog::Trace<8>()) SimLog::logFile << "  ... " << chosenAggregatorIndex;
 			}
-			if (SimLog::Debug > 8) SimLog::logFile << dec << endl;
+			if (SimLog::Trace<8>()) SimLog::logFile << dec << endl;
 
 			/*
 			*   If have chosen an aggregator, then update the LAGID etc of that aggregator and put port on aggregator's port list.
@@ -328,8 +339,8 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 			*/
 			if (chosenAggregatorIndex < pAggregators.size())
 			{
-				pAggregators[chosenAggregatorIndex]->partnerSystem.id = pAggPorts[px]->partnerOperSystem.id;      // Update LAGID of aggregator (in case taking over)
-				pAggregators[chosenAggregatorIndex]->partnerOperAggregatorKey = pAggPorts[px]->partnerOperKey;
+				index.setAggregatorPartner(chosenAggregatorIndex,                                               // Update LAGID of aggregator (in case taking over)
+					pAggPorts[px]->partnerOperSystem.id, pAggPorts[px]->partnerOperKey);
 				pAggregators[chosenAggregatorIndex]->aggregatorIndividual =
 					(!pAggPorts[px]->actorOperPortState.aggregation ||
 					 !pAggPorts[px]->partnerOperPortState.aggregation); 
@@ -346,8 +357,8 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				//TODO:  do I need to set actorDWC here as well?  No.  Gets updated when link becomes active and updateConversationMasks
 
 				pAggPorts[px]->portSelected = AggPort::selectedVals::SELECTED;                             // Set SELECTED
-				pAggregators[chosenAggregatorIndex]->lagPorts.push_back(px);                               // Put this port on port list of chosen aggregator
-				pAggregators[chosenAggregatorIndex]->selectedLagPorts.push_back(pAggPorts[px]->actorPortAggregatorIdentifier);  // Put this port on port list of chosen aggregator
+				pAggregators[chosenAggregatorIndex]->lagPorts.insert(px);                                  // Put this port on port list of chosen aggregator
+				pAggregators[chosenAggregatorIndex]->selectedLagPorts.insert(pAggPorts[px]->actorPortAggregatorIdentifier);     // Put this port on port list of chosen aggregator
 				// Should be safe to add to list without checking to see if it is already on list
 				pAggPorts[px]->actorPortAggregatorIndex = chosenAggregatorIndex;                           // Update the selected aggregator index for this port 
 				pAggPorts[px]->actorPortAggregatorIdentifier = pAggregators[chosenAggregatorIndex]->aggregatorIdentifier;
@@ -365,7 +376,7 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				/**/
 
 				// DEBUG:
-				if (SimLog::Debug > 3)
+				if (SimLog::Trace<3>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 						<< pAggPorts[px]->actorAdminSystem.addrMid << ":" << pAggPorts[px]->actorPort.id
@@ -418,7 +429,7 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 
 				if (!aggregatorActive && port.portOperational)   // If aggregator is not active but has enabled ports
 				{
-					if ((SimLog::Debug > 5) && port.isNonRevertive)
+					if ((SimLog::Trace<5>()) && port.isNonRevertive)
 					{
 						SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 							<< port.actorAdminSystem.addrMid << ":" << port.actorPort.id
@@ -456,15 +467,14 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 }
 
 /**/
-int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<shared_ptr<AggPort>>& pAggPorts)
+int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<shared_ptr<AggPort>>& pAggPorts,
+	std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index)
 {
-	std::vector<shared_ptr<AggPort>> pAggregators = pAggPorts;
 	AggPort& thisPort = *pAggPorts[thisIndex];
 	bool foundMatch = false;
-	unsigned short ax = 0;
-	int chosen = pAggPorts.size();   // no aggregator chosen yet
+	int chosen = pAggregators.size();   // no aggregator chosen yet
 
-	for (ax = 0; ax < pAggregators.size(); ax++)     // walk through Aggregator array using ax as index
+	for (unsigned short ax : index.aggregatorsWithLagid(thisPort))     // walk through Aggregators with same LAGID as this port
 	{
 		foundMatch = (matchAggregatorLagid(thisPort, *pAggregators[ax]));  // look for aggregator with same LAGID as this port
 
@@ -474,7 +484,7 @@ int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<sh
 			{                                                                //    Then can only join LAG if all ports are same-port-loopback
 				foundMatch &= pAggregators[ax]->aggregatorLoopback;            //    (but otherwise have to find another aggregator)
 
-				if (SimLog::Debug > 2)
+				if (SimLog::Trace<2>())
 					SimLog::logFile << "Time " << SimLog::Time << ":     Port " << hex << thisPort.actorPort.num << " same-port-loopback foundMatch "
 					<< foundMatch << " agg " << pAggregators[ax]->aggregatorIdentifier << " agg_Loopback " << pAggregators[ax]->aggregatorLoopback
 					<< dec << endl;
@@ -489,7 +499,7 @@ int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<sh
 				}
 				foundMatch &= !pAggregators[ax]->aggregatorLoopback;     // find another if this aggregator chosen by a same-port-looback
 
-				if (SimLog::Debug > 2)
+				if (SimLog::Trace<2>())
 					SimLog::logFile << "Time " << SimLog::Time << ":     Port " << hex << thisPort.actorPort.num << " diff-port-loopback foundMatch "
 					<< foundMatch << " agg " << pAggregators[ax]->aggregatorIdentifier << " agg_Loopback " << pAggregators[ax]->aggregatorLoopback
 					<< dec << endl;
@@ -589,12 +599,11 @@ void LinkAgg::LacpSelection::clearAggregator(Aggregator& agg, std::vector<shared
 
 
 int LinkAgg::LacpSelection::findAvailableAggregator(AggPort& thisPort,
-	std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators)
+	std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index)
 {
 	bool foundAggregator = false;
-	unsigned short ax = 0;
 
-	for (ax = 0; ax < pAggregators.size(); ax++)     // walk through Aggregator array using ax as index
+	for (unsigned short ax : index.aggregatorsWithKey(thisPort))     // walk through Aggregators with same key as this port
 	{
 		Aggregator& agg = *pAggregators[ax];
 		foundAggregator = (allowableAggregator(thisPort, *pAggregators[ax]) &&    // Look for an aggregator with a matching key
@@ -602,10 +611,11 @@ int LinkAgg::LacpSelection::findAvailableAggregator(AggPort& thisPort,
 			((agg.drniPartnerSystemId.id == 0) ||                           //   and there is no DRNI Partner restriction or port partner matches DRNI partner
 			((agg.drniPartnerSystemId.id == thisPort.partnerOperSystem.id) && (agg.drniPartnerKey == thisPort.partnerOperKey))) &&
 			pAggPorts[ax]->actorOperPortState.aggregation);         //   and is not monopolized by an Individual port
-		if (foundAggregator) break;
+		if (foundAggregator) 
+			return (ax);
 	}
 
-	return (ax);
+	return ((int)pAggregators.size());
 }
 
 bool LinkAgg::LacpSelection::activeAggregator(Aggregator& agg,
@@ -624,3 +634,90 @@ bool LinkAgg::LacpSelection::activeAggregator(Aggregator& agg,
 	return (activePorts);
 }
 /**/
+
+
+LinkAgg::LacpSelection::SelectionIndex::SelectionIndex(std::vector<shared_ptr<AggPort>>& pAggPorts, 
+	std::vector<shared_ptr<Aggregator>>& pAggregators)
+	: pAggPorts(pAggPorts), pAggregators(pAggregators)
+{
+	built = false;
+}
+
+bool LinkAgg::LacpSelection::SelectionIndex::Key::operator== (const Key& other) const
+{
+	return ((systemA == other.systemA) && (systemB == other.systemB) && (keyA == other.keyA) && (keyB == other.keyB));
+}
+
+size_t LinkAgg::LacpSelection::SelectionIndex::KeyHash::operator() (const Key& key) const
+{
+	unsigned long long hash = key.systemA * 0x9e3779b97f4a7c15ULL;
+	hash = (hash ^ (hash >> 29) ^ key.systemB) * 0xbf58476d1ce4e5b9ULL;
+	hash = (hash ^ (hash >> 32) ^ ((unsigned long long)key.keyA << 32) ^ key.keyB) * 0x94d049bb133111ebULL;
+	return ((size_t)(hash ^ (hash >> 31)));
+}
+
+LinkAgg::LacpSelection::SelectionIndex::Key LinkAgg::LacpSelection::SelectionIndex::lagidKey(const Aggregator& agg)
+{
+	return (Key{ agg.actorOperSystem.id, agg.partnerSystem.id, agg.actorOperAggregatorKey, agg.partnerOperAggregatorKey });
+}
+
+void LinkAgg::LacpSelection::SelectionIndex::build()
+{
+	for (unsigned short px = 0; px < pAggPorts.size(); px++)       // Ascending order, so each entry is sorted
+	{
+		const AggPort& port = *pAggPorts[px];
+		partnerPorts[Key{ port.partnerOperSystem.id, port.partnerOperPort.id, 0, 0 }].push_back(px);
+	}
+	for (unsigned short ax = 0; ax < pAggregators.size(); ax++)
+	{
+		const Aggregator& agg = *pAggregators[ax];
+		lagidAggregators[lagidKey(agg)].push_back(ax);
+		keyAggregators[Key{ agg.actorOperSystem.id, 0, agg.actorOperAggregatorKey, 0 }].push_back(ax);
+	}
+	built = true;
+}
+
+const std::vector<unsigned short>& LinkAgg::LacpSelection::SelectionIndex::find(const Table& table, const Key& key,
+	const std::vector<unsigned short>& none)
+{
+	auto entry = table.find(key);
+	return ((entry == table.end()) ? none : entry->second);
+}
+
+const std::vector<unsigned short>& LinkAgg::LacpSelection::SelectionIndex::portsWithPartner(const AggPort& port)
+{
+	if (!built) 
+		build();
+	return (find(partnerPorts, Key{ port.partnerOperSystem.id, port.partnerOperPort.id, 0, 0 }, none));
+}
+
+const std::vector<unsigned short>& LinkAgg::LacpSelection::SelectionIndex::aggregatorsWithLagid(const AggPort& port)
+{
+	if (!built)
+		build();
+	return (find(lagidAggregators, Key{ port.actorOperSystem.id, port.partnerOperSystem.id, port.actorOperPortKey, port.partnerOperKey }, none));
+}
+
+const std::vector<unsigned short>& LinkAgg::LacpSelection::SelectionIndex::aggregatorsWithKey(const AggPort& port)
+{
+	if (!built)
+		build();
+	return (find(keyAggregators, Key{ port.actorOperSystem.id, 0, port.actorOperPortKey, 0 }, none));
+}
+
+void LinkAgg::LacpSelection::SelectionIndex::setAggregatorPartner(unsigned short ax, unsigned long long partnerSystem, 
+	unsigned short partnerKey)
+{
+	Aggregator& agg = *pAggregators[ax];
+	if (built && ((agg.partnerSystem.id != partnerSystem) || (agg.partnerOperAggregatorKey != partnerKey)))
+	{
+		std::vector<unsigned short>& oldEntry = lagidAggregators[lagidKey(agg)];           // Move Aggregator to entry for new LAGID
+		oldEntry.erase(std::find(oldEntry.begin(), oldEntry.end(), ax));
+		agg.partnerSystem.id = partnerSystem;
+		agg.partnerOperAggregatorKey = partnerKey;
+		std::vector<unsigned short>& newEntry = lagidAggregators[lagidKey(agg)];
+		newEntry.insert(std::lower_bound(newEntry.begin(), newEntry.end(), ax), ax);
+	}
+	agg.partnerSystem.id = partnerSystem;
+	agg.partnerOperAggregatorKey = partnerKey;
+}
@@ -26,15 +26,6 @@ void AggPort::LacpTxSM::reset(AggPort& port)
 	port.txCount = 0;
 }
 
-/**/
-// void AggPort::LacpTxSM::timerTickTxSM(AggPort& port)
-void AggPort::LacpTxSM::timerTick(AggPort& port)
-{
-	if (port.txLimitTimer > 0) port.txLimitTimer--;
-	if (port.LACP_txWhen > 0) port.LACP_txWhen--;
-}
-/**/
-
 // int AggPort::LacpTxSM::runTxSM(AggPort& port, bool singleStep)
 int AggPort::LacpTxSM::run(AggPort& port, bool singleStep)
 {
@@ -214,13 +205,13 @@ bool AggPort::LacpTxSM::transmitLacpdu(AggPort& port)
     if (port.pIss && port.pIss->getOperational())  // Transmit frame only if MAC won't immediately discard
 	{
 		unsigned long long mySA = port.pIss->getMacAddress();
-		shared_ptr<Lacpdu> pMyLacpdu = std::make_shared<Lacpdu>();
+		shared_ptr<Lacpdu> pMyLacpdu = makeSdu<Lacpdu>();
 		prepareLacpdu(port, *pMyLacpdu);
 		unique_ptr<Frame> myFrame = make_unique<Frame>(port.lacpDestinationAddress, mySA, (shared_ptr<Sdu>)pMyLacpdu);
 		port.pIss->Request(move(myFrame));
 		success = true;
 
-		if ((SimLog::Debug > 4))
+		if ((SimLog::Trace<4>()))
 		{
 			// SimLog::logFile << "Time " << SimLog::Time << ":  Transmit LACPDU" 
 			SimLog::logFile << "Time " << SimLog::Time << ":  Transmit LACPDUv" << (short)port.actorLacpVersion
@@ -232,7 +223,7 @@ bool AggPort::LacpTxSM::transmitLacpdu(AggPort& port)
 	} 
 	else 
 	{
-		if ((SimLog::Debug > 9))
+		if ((SimLog::Trace<9>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Can't transmit LACPDU from down port " << hex << port.pIss->getMacAddress() << dec
 				<< "    txCount = " << port.txCount << "/" << port.txLimit << "  txLimitTimer = " << port.txLimitTimer << "/" << port.txLimitInterval << endl;
@@ -289,7 +280,7 @@ void AggPort::LacpTxSM::prepareLacpdu(AggPort& port, Lacpdu& myLacpdu)
 			myLacpdu.actorPortConversationMaskState.actorPartnerSync = port.actorPartnerSync;
 			myLacpdu.actorPortConversationMaskState.DWC = port.actorDWC;
 			myLacpdu.actorPortConversationMaskState.PSI = false;      //TODO: Not relevant ?
-			myLacpdu.actorPortConversationMask = port.portOperConversationMask;
+			myLacpdu.pActorPortConversationMask = std::allocate_shared<ConvMask>(PoolAllocator<ConvMask>(), port.portOperConversationMask);
 		}
 		/**/
 	}
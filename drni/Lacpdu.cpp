@@ -16,11 +16,46 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Lacpdu.h"
+#include "Snapshot.h"
+#include "PduCodec.h"
+
+
+enum LacpduTlvTypes { TERMINATOR_TLV = 0, ACTOR_INFORMATION_TLV, PARTNER_INFORMATION_TLV, COLLECTOR_INFORMATION_TLV,
+	PORT_ALGORITHM_TLV, PORT_CONVERSATION_ID_DIGEST_TLV, PORT_CONVERSATION_MASK_1_TLV, PORT_CONVERSATION_MASK_2_TLV,
+	PORT_CONVERSATION_MASK_3_TLV, PORT_CONVERSATION_MASK_4_TLV, PORT_CONVERSATION_SERVICE_MAPPING_TLV };
+
+static const unsigned char ActorInformationLength = 20;       // TLV Information_Length includes the type and length octets
+static const unsigned char CollectorInformationLength = 16;
+static const unsigned char PortAlgorithmLength = 6;
+static const unsigned char PortConversationIdDigestLength = 20;
+static const unsigned char PortConversationMask1Length = 131;
+static const unsigned char PortConversationMaskLength = 130;
+static const unsigned char ServiceMappingDigestLength = 18;
+static const int MaskTlvCids = ConvMask::NumBits / 4;         // Conversation IDs in each Port Conversation Mask TLV
 
 
 Lacpdu::Lacpdu()
 	: Sdu(SlowProtocolsEthertype, LacpduSubType)
 {
+	VersionNumber = 1;
+	actorSystem.id = 0;
+	actorKey = 0;
+	actorPort.id = 0;
+	actorState.state = 0;
+	partnerSystem.id = 0;
+	partnerKey = 0;
+	partnerPort.id = 0;
+	partnerState.state = 0;
+	collectorMaxDelay = 0;
+	portAlgorithmTlv = false;
+	actorPortAlgorithm = LagAlgorithms::UNSPECIFIED;
+	portConversationIdDigestTlv = false;
+	linkNumberID = 0;
+	actorConversationLinkListDigest.fill(0);
+	portConversationServiceMappingDigestTlv = false;
+	actorConversationServiceMappingDigest.fill(0);
+	portConversationMaskTlvs = false;
+	actorPortConversationMaskState.state = 0;
 }
 
 
@@ -36,3 +71,230 @@ const Lacpdu& Lacpdu::getLacpdu(Frame& LacpFrame)        // Returns a constant r
 	return((const Lacpdu&)LacpFrame.getNextSdu());
 //	return ((const Lacpdu&)*(LacpFrame.pNextSdu));
 }
+
+size_t Lacpdu::encode(unsigned char* buffer, size_t bufferSize) const
+{
+	PduWriter pdu(buffer, bufferSize);
+	pdu.put8((unsigned char)subType);
+	pdu.put8(VersionNumber);
+
+	pdu.put8(ACTOR_INFORMATION_TLV);
+	pdu.put8(ActorInformationLength);
+	pdu.put64(actorSystem.id);                 // System Priority and System
+	pdu.put16(actorKey);
+	pdu.put32(actorPort.id);                   // Port Priority and Port
+	pdu.put8(actorState.state);
+	pdu.putZeros(3);
+
+	pdu.put8(PARTNER_INFORMATION_TLV);
+	pdu.put8(ActorInformationLength);
+	pdu.put64(partnerSystem.id);
+	pdu.put16(partnerKey);
+	pdu.put32(partnerPort.id);
+	pdu.put8(partnerState.state);
+	pdu.putZeros(3);
+
+	pdu.put8(COLLECTOR_INFORMATION_TLV);
+	pdu.put8(CollectorInformationLength);
+	pdu.put16(collectorMaxDelay);
+	pdu.putZeros(12);
+
+	if (VersionNumber >= 2)
+	{
+		if (portAlgorithmTlv)
+		{
+			pdu.put8(PORT_ALGORITHM_TLV);
+			pdu.put8(PortAlgorithmLength);
+			pdu.put32(actorPortAlgorithm);
+		}
+		if (portConversationIdDigestTlv)
+		{
+			pdu.put8(PORT_CONVERSATION_ID_DIGEST_TLV);
+			pdu.put8(PortConversationIdDigestLength);
+			pdu.put16(linkNumberID);
+			pdu.putBytes(actorConversationLinkListDigest.data(), actorConversationLinkListDigest.size());
+		}
+		if (portConversationMaskTlvs && pActorPortConversationMask)
+		{
+			for (int tlv = 0; tlv < 4; tlv++)
+			{
+				pdu.put8(PORT_CONVERSATION_MASK_1_TLV + tlv);
+				if (tlv == 0)
+				{
+					pdu.put8(PortConversationMask1Length);
+					pdu.put8(actorPortConversationMaskState.state);
+				}
+				else
+					pdu.put8(PortConversationMaskLength);
+				if (unsigned char* pMask = pdu.reserve(MaskTlvCids / 8))
+					pActorPortConversationMask->getOctets(pMask, tlv * MaskTlvCids, MaskTlvCids);
+			}
+		}
+		if (portConversationServiceMappingDigestTlv)
+		{
+			pdu.put8(PORT_CONVERSATION_SERVICE_MAPPING_TLV);
+			pdu.put8(ServiceMappingDigestLength);
+			pdu.putBytes(actorConversationServiceMappingDigest.data(), actorConversationServiceMappingDigest.size());
+		}
+	}
+
+	pdu.put8(TERMINATOR_TLV);
+	pdu.put8(0);
+	if (pdu.length() < MinEncodedLength)
+		pdu.putZeros(MinEncodedLength - pdu.length());   // Reserved octets
+
+	return (pdu.ok() ? pdu.length() : 0);
+}
+
+bool Lacpdu::decode(const unsigned char* buffer, size_t length)
+{
+	PduReader pdu(buffer, length);
+	if (pdu.get8() != LacpduSubType)
+		return (false);
+	VersionNumber = pdu.get8();
+
+	portAlgorithmTlv = false;
+	portConversationIdDigestTlv = false;
+	portConversationServiceMappingDigestTlv = false;
+	portConversationMaskTlvs = false;
+	pActorPortConversationMask = nullptr;
+
+	bool actorTlv = false;
+	bool partnerTlv = false;
+	int maskTlvs = 0;                                // Bit for each Port Conversation Mask TLV received
+	shared_ptr<ConvMask> pMask = nullptr;
+
+	while (pdu.ok())
+	{
+		unsigned char tlvType = pdu.get8();
+		unsigned char tlvLength = pdu.get8();
+		if (!pdu.ok() || (tlvType == TERMINATOR_TLV))
+			break;
+		if (tlvLength < 2)
+			return (false);
+		const unsigned char* pValue = pdu.skip(tlvLength - 2);
+		if (!pValue)
+			return (false);
+		PduReader tlv(pValue, tlvLength - 2);
+
+		switch (tlvType)
+		{
+		case ACTOR_INFORMATION_TLV:
+		case PARTNER_INFORMATION_TLV:
+		{
+			if (tlvLength != ActorInformationLength)
+				return (false);
+			bool actor = (tlvType == ACTOR_INFORMATION_TLV);
+			(actor ? actorSystem : partnerSystem).id = tlv.get64();
+			(actor ? actorKey : partnerKey) = tlv.get16();
+			(actor ? actorPort : partnerPort).id = tlv.get32();
+			(actor ? actorState : partnerState).state = tlv.get8();
+			actorTlv |= actor;
+			partnerTlv |= !actor;
+			break;
+		}
+		case COLLECTOR_INFORMATION_TLV:
+			collectorMaxDelay = tlv.get16();
+			break;
+		case PORT_ALGORITHM_TLV:
+			portAlgorithmTlv = (tlvLength == PortAlgorithmLength);
+			actorPortAlgorithm = (LagAlgorithms)tlv.get32();
+			break;
+		case PORT_CONVERSATION_ID_DIGEST_TLV:
+			portConversationIdDigestTlv = (tlvLength == PortConversationIdDigestLength);
+			linkNumberID = tlv.get16();
+			tlv.getBytes(actorConversationLinkListDigest.data(), actorConversationLinkListDigest.size());
+			break;
+		case PORT_CONVERSATION_SERVICE_MAPPING_TLV:
+			portConversationServiceMappingDigestTlv = (tlvLength == ServiceMappingDigestLength);
+			tlv.getBytes(actorConversationServiceMappingDigest.data(), actorConversationServiceMappingDigest.size());
+			break;
+		case PORT_CONVERSATION_MASK_1_TLV:
+		case PORT_CONVERSATION_MASK_2_TLV:
+		case PORT_CONVERSATION_MASK_3_TLV:
+		case PORT_CONVERSATION_MASK_4_TLV:
+		{
+			int maskTlv = tlvType - PORT_CONVERSATION_MASK_1_TLV;
+			if (maskTlv == 0)
+				actorPortConversationMaskState.state = tlv.get8();
+			if (const unsigned char* pOctets = tlv.skip(MaskTlvCids / 8))
+			{
+				if (!pMask)
+					pMask = std::allocate_shared<ConvMask>(PoolAllocator<ConvMask>());
+				pMask->setOctets(pOctets, maskTlv * MaskTlvCids, MaskTlvCids);
+				maskTlvs |= (1 << maskTlv);
+			}
+			break;
+		}
+		default:                                     // Ignore TLVs from later versions
+			break;
+		}
+	}
+
+	if (maskTlvs == 0x0f)
+	{
+		portConversationMaskTlvs = true;
+		pActorPortConversationMask = pMask;
+	}
+	return (actorTlv && partnerTlv);
+}
+
+void Lacpdu::saveState(Snapshot& snap) const
+{
+	Sdu::saveState(snap);
+	snap.put(VersionNumber);
+	snap.put(actorSystem);
+	snap.put(actorKey);
+	snap.put(actorPort);
+	snap.put(actorState);
+	snap.put(partnerSystem);
+	snap.put(partnerKey);
+	snap.put(partnerPort);
+	snap.put(partnerState);
+	snap.put(collectorMaxDelay);
+	snap.put(portAlgorithmTlv);
+	snap.put(actorPortAlgorithm);
+	snap.put(portConversationIdDigestTlv);
+	snap.put(linkNumberID);
+	snap.put(actorConversationLinkListDigest);
+	snap.put(portConversationServiceMappingDigestTlv);
+	snap.put(actorConversationServiceMappingDigest);
+	snap.put(portConversationMaskTlvs);
+	snap.put(actorPortConversationMaskState);
+	snap.put((bool)pActorPortConversationMask);
+	if (pActorPortConversationMask)
+		snap.put(*pActorPortConversationMask);
+}
+
+void Lacpdu::restoreState(Snapshot& snap)
+{
+	Sdu::restoreState(snap);
+	snap.get(VersionNumber);
+	snap.get(actorSystem);
+	snap.get(actorKey);
+	snap.get(actorPort);
+	snap.get(actorState);
+	snap.get(partnerSystem);
+	snap.get(partnerKey);
+	snap.get(partnerPort);
+	snap.get(partnerState);
+	snap.get(collectorMaxDelay);
+	snap.get(portAlgorithmTlv);
+	snap.get(actorPortAlgorithm);
+	snap.get(portConversationIdDigestTlv);
+	snap.get(linkNumberID);
+	snap.get(actorConversationLinkListDigest);
+	snap.get(portConversationServiceMappingDigestTlv);
+	snap.get(actorConversationServiceMappingDigest);
+	snap.get(portConversationMaskTlvs);
+	snap.get(actorPortConversationMaskState);
+	bool maskPresent = false;
+	snap.get(maskPresent);
+	pActorPortConversationMask = nullptr;
+	if (maskPresent)
+	{
+		shared_ptr<ConvMask> pMask = std::allocate_shared<ConvMask>(PoolAllocator<ConvMask>());
+		snap.get(*pMask);
+		pActorPortConversationMask = pMask;
+	}
+}
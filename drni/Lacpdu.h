@@ -17,6 +17,7 @@ limitations under the License.
 #pragma once
 // #include "Frame.h"
 #include "Mac.h"
+#include "ConvMask.h"
 // #include "Aggregator.h"
 #include "AggPort.h"
 
@@ -26,6 +27,11 @@ limitations under the License.
 *     The Link Aggregation Control Protocol Data Unit (Lacpdu) class inherits the Sdu base class.  An Lacdpu 
 *         object is generated by the LACP Transmit State Machine (LacpTxSM) of an AggPort in a LinkAgg shim,
 *         propagated in Frame objects, and consumed by the LACP Receive State Machine (LacpRxSM).
+*     The fields are a flat, fixed layout.  The Port Conversation Mask TLVs (4096 bits) are rarely present, so the mask
+*         is held out of line and pActorPortConversationMask is nullptr unless portConversationMaskTlvs is true.
+*     encode and decode convert between a Lacpdu and its IEEE Std 802.1AX wire format (from the Subtype octet to the
+*         end of the PDU, i.e. the MAC client data following the Slow Protocols EtherType).  encode writes to a buffer 
+*         supplied by the caller and decode reads the fields in place, so neither allocates (apart from a received mask).
 */
 
 class Lacpdu : public Sdu
@@ -37,6 +43,11 @@ public:
 
 	static const Lacpdu& getLacpdu(Frame& LacpFrame);      // Returns a constant reference to the Lacpdu
 
+	static const size_t MinEncodedLength = 110;            // Version 1 LACPDU, and shortest encoding of any version
+	static const size_t MaxEncodedLength = 625;            // Version 2 LACPDU with all TLVs
+	size_t encode(unsigned char* buffer, size_t bufferSize) const;   // Returns octets written, or 0 if buffer too small
+	bool decode(const unsigned char* buffer, size_t length);         // Returns false if not a valid LACPDU
+
 	unsigned char VersionNumber;
 
 	sysId actorSystem;
@@ -70,7 +81,10 @@ public:
 	//     Port Conversation Mask TLVs (Only present in AX-2104 long LACPDU exchanges)
 	bool portConversationMaskTlvs;
 	AggPortConversationMaskState actorPortConversationMaskState;
-	std::bitset<4096> actorPortConversationMask;
+	shared_ptr<const ConvMask> pActorPortConversationMask;
 	/**/
+
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
 };
 
@@ -16,12 +16,25 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "LinkAgg.h"
+#include "Snapshot.h"
 #include "DistributedRelay.h"
+#include "LinkMapCache.h"
+#include "Md5.h"
+
+#if defined(__SSE4_2__) || defined(__AVX__)          // Every processor with AVX also has the SSE4.2 CRC32 instruction
+#define LINKAGG_CRC32C
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <nmmintrin.h>
+#endif
+#endif
 
 
 LinkAgg::LinkAgg(unsigned short device, unsigned char version)
 	: Component(ComponentTypes::LINK_AGG), devNum(device), LacpVersion(version)
 {
+	lastTransitionTime = SimLog::Time;
 //	cout << "LagShim Constructor called." << endl;
 }
 
@@ -35,14 +48,15 @@ LinkAgg::~LinkAgg()
 
 void LinkAgg::reset()
 {
+	lastTransitionTime = SimLog::Time;
 	for (auto& pPort : pAggPorts)              // For each Aggregation Port:
 	{
 		pPort->reset();
 
-		if (SimLog::Debug > 12)
+		if (SimLog::Trace<12>())
 		{
 			AggPort& port = *pPort;
-			SimLog::logFile << "Time " << SimLog::Time << ":  Sys " << hex << port.get_aAggActorSystemID()
+			SimLog::logFile << "Time " << SimLog::Time << ":  Sys " << hex << port.get_aAggPortActorSystemID()
 				<< ":  Port " << hex << port.get_aAggPortActorPort() << dec
 				<< ": RxSM " << port.RxSmState << " MuxSM " << port.MuxSmState
 				<< " PerSM " << port.PerSmState << " TxSM " << port.TxSmState
@@ -63,24 +77,14 @@ void LinkAgg::reset()
 
 void LinkAgg::timerTick()
 {
-	if (!suspended)
-	{
-		for (auto& pPort : pAggPorts)              // For each Aggregation Port:
-		{
-			pPort->timerTick();
-		}
-		for (auto& pDR : pDistRelays)              // For each Aggregation Port:
-		{
-			if (pDR) pDR->timerTick();
-		}
-	}
+	// Nothing to do:  the Aggregation Port and Distributed Relay timers hold their expiry Time (see Timer.h),
+	//    so they do not need to be decremented each Time increment
 }
 
 
 void LinkAgg::run(bool singleStep)
 {
 	unsigned short nPorts = (unsigned short)pAggPorts.size();
-	unique_ptr<Frame> pTempFrame = nullptr;
 
 	if (!suspended)       
 	{
@@ -92,30 +96,11 @@ void LinkAgg::run(bool singleStep)
 		//       and Dist Relay Gw/Agg and TXSM and distribute after Mux and selection.
 		//       Goal to have LACP respond to DR_SOLO - DR_PAIRED transitions before update home state and txDRCPDU
 
+		size_t maxBurst = singleStep ? 1 : Iss::MaxBurst;       // Frames taken from each queue in one pass
+
 		// Collect
-		for (unsigned short i = 0; i < nPorts; i++)              // For each Aggregation Port:
-		{
-			pTempFrame = move(pAggPorts[i]->pIss->Indication());   // Get ingress frame, if available, from ISS
-			if (pTempFrame)                                        // If there is an ingress frame
-			{
-				if (SimLog::Debug > 5)
-				{
-					SimLog::logFile << "Time " << SimLog::Time << ":  Lag in Device:Port " << hex << pAggPorts[i]->actorAdminSystem.addrMid
-						<< ":" << pAggPorts[i]->actorPort.num << " receiving frame ";
-					pTempFrame->PrintFrameHeader();
-					SimLog::logFile << dec << endl;
-				}
-				if ((pTempFrame->MacDA == pAggPorts[i]->lacpDestinationAddress) &&   // if frame has proper DA and contains an LACPDU
-					(pTempFrame->getNextEtherType() == SlowProtocolsEthertype) && (pTempFrame->getNextSubType() == LacpduSubType))
-				{
-					pAggPorts[i]->pRxLacpFrame = move(pTempFrame);                   // then pass to LACP RxSM
-				}
-				else if (collectFrame(*pAggPorts[i], *pTempFrame))                   // else verify this frame can be collected through this AggPort
-				{															         //    and send it up stack through the selected Aggregator
-					pAggregators[pAggPorts[i]->actorPortAggregatorIndex]->indications.push(move(pTempFrame));
-				}
-			}
-		}
+		publishForwarding();                                     // Pick up changes made since the last run (e.g. by management)
+		runDataPlane(true, maxBurst);
 
 		// Check for administrative changes to Aggregator configuration
 		LinkAgg::LacpSelection::adminAggregatorUpdate(pAggPorts, pAggregators);
@@ -141,9 +126,9 @@ void LinkAgg::run(bool singleStep)
 			if (pAggPorts[i]->actorLacpVersion == 1)  // If actor is v1 then run Periodic state machine
 				transitions += AggPort::LacpPeriodicSM::run(*pAggPorts[i], true);
 
-			if ((transitions && (SimLog::Debug > 8)) || (SimLog::Debug > 12))
+			if ((transitions && (SimLog::Trace<8>())) || (SimLog::Trace<12>()))
 			{
-				SimLog::logFile << "Time " << SimLog::Time << ":  Sys " << hex << pAggPorts[i]->get_aAggActorSystemID()
+				SimLog::logFile << "Time " << SimLog::Time << ":  Sys " << hex << pAggPorts[i]->get_aAggPortActorSystemID()
 					<< ":  Port " << hex << pAggPorts[i]->get_aAggPortActorPort() << dec
 					<< ": RxSM " << pAggPorts[i]->RxSmState << " MuxSM " << pAggPorts[i]->MuxSmState
 					<< " PerSM " << pAggPorts[i]->PerSmState << " TxSM " << pAggPorts[i]->TxSmState
@@ -160,33 +145,89 @@ void LinkAgg::run(bool singleStep)
 //			transitions += AggPort::LacpTxSM::runTxSM(*pAggPorts[i], true);
 			transitions += AggPort::LacpTxSM::run(*pAggPorts[i], true);
 		}
+		if (transitions)
+			lastTransitionTime = SimLog::Time;
 
 		// Distribute
-		for (unsigned short i = 0; i < nPorts; i++)              // For each Aggregator:
+		publishForwarding();                                     // Distribute with the results of this run of the control plane
+		runDataPlane(false, maxBurst);
+	}
+}
+
+int LinkAgg::nextEventTime() const
+{
+	int nextTime = SimLog::EndOfTime;
+
+	if (!suspended)
+	{
+		if (SimLog::Time <= lastTransitionTime + SimLog::SettleTime)   // Keep running while state machines settle
+			return (SimLog::Time);                                     //    (e.g. Selection Logic results are not counted as transitions)
+		for (auto& pPort : pAggPorts)                                  // Timer expiries and change flags of each Aggregation Port
+			nextTime = std::min(nextTime, pPort->nextEventTime());
+		for (auto& pAgg : pAggregators)                                // Queued frames and change flags of each Aggregator
+			nextTime = std::min(nextTime, pAgg->nextEventTime());
+		for (auto& pDR : pDistRelays)
 		{
-			if (pAggregators[i]->getEnabled() && !pAggregators[i]->requests.empty())  // If there is an egress frame at Aggregator
-			{
-				pTempFrame = move(pAggregators[i]->requests.front());   // Get egress frame
-				pAggregators[i]->requests.pop();
-				if (pTempFrame)                                         // Shouldn't be necessary since already tested that there was a frame
-				{
-					if (SimLog::Debug > 5)
-					{
-						SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << pAggregators[i]->actorAdminSystem.addrMid
-							<< ":" << pAggregators[i]->aggregatorIdentifier << " transmitting frame ";
-						pTempFrame->PrintFrameHeader();
-						SimLog::logFile << dec << endl;
-					}
-					shared_ptr<AggPort> pEgressPort = distributeFrame(*pAggregators[i], *pTempFrame);   // get egress Aggregation Port
-					if (pEgressPort)
-					{
-						pEgressPort->pIss->Request(move(pTempFrame));     //    Send frame through egress Aggregation Port
-					}
-				}
-			}
+			if (pDR) nextTime = std::min(nextTime, pDR->nextEventTime());
 		}
+	}
+	return (nextTime);
+}
 
+void LinkAgg::saveState(Snapshot& snap) const
+{
+	snap.put(suspended);
+	snap.put(LacpVersion);
+	snap.put(devNum);
+	snap.put(lastTransitionTime);
 
+	snap.put(pAggPorts.size());
+	for (auto& pPort : pAggPorts)
+	{
+		pPort->saveState(snap);
+	}
+	snap.put(pAggregators.size());
+	for (auto& pAgg : pAggregators)
+	{
+		pAgg->saveState(snap, pAggPorts);
+	}
+	snap.put(pDistRelays.size());
+	for (auto& pDR : pDistRelays)
+	{
+		snap.put((size_t)(pDR != nullptr));
+		if (pDR)
+			pDR->saveState(snap);
+	}
+}
+
+void LinkAgg::restoreState(Snapshot& snap)
+{
+	snap.get(suspended);
+	snap.get(LacpVersion);
+	snap.get(devNum);
+	snap.get(lastTransitionTime);
+	std::atomic_store(&pForwarding, shared_ptr<const Forwarding>());   // Rebuilt from the restored state by the next run
+
+	if (!snap.match(pAggPorts.size()))
+		return;
+	for (auto& pPort : pAggPorts)
+	{
+		pPort->restoreState(snap);
+	}
+	if (!snap.match(pAggregators.size()))
+		return;
+	for (auto& pAgg : pAggregators)
+	{
+		pAgg->restoreState(snap, pAggPorts);
+	}
+	if (!snap.match(pDistRelays.size()))
+		return;
+	for (auto& pDR : pDistRelays)
+	{
+		if (!snap.match((size_t)(pDR != nullptr)))
+			return;
+		if (pDR)
+			pDR->restoreState(snap);
 	}
 }
 
@@ -223,10 +264,9 @@ bool LinkAgg::configDistRelay(unsigned short distRelayIndex, unsigned short numA
 				pAggregators[distRelayIndex]->operDrniKey = adminDrniKey;
 
 				pAggregators[distRelayIndex]->set_convLinkMap(Aggregator::convLinkMaps::EIGHT_LINK_SPREAD);
-				pAggregators[distRelayIndex]->set_aAggConversationListDigest(convLinkMapEightLinkSpreadDigest);
 				pAggregators[distRelayIndex]->set_aAggPortAlgorithm(LagAlgorithms::C_VID);
 //				pAggregators[distRelayIndex]->set_aAggConvServiceMappingDigest(nullDigest);
-				pAggregators[distRelayIndex]->set_aAggPartnerAdminConversationListDigest(convLinkMapEightLinkSpreadDigest);
+				pAggregators[distRelayIndex]->set_aAggPartnerAdminConversationListDigest(Aggregator::linkMapDigest(Aggregator::convLinkMaps::EIGHT_LINK_SPREAD));
 				pAggregators[distRelayIndex]->set_aAggPartnerAdminPortAlgorithm(LagAlgorithms::C_VID);
 				pAggregators[distRelayIndex]->set_aAggPartnerAdminConvServiceMappingDigest(nullDigest);
 			}
@@ -243,7 +283,7 @@ bool LinkAgg::configDistRelay(unsigned short distRelayIndex, unsigned short numA
 			if (px < (distRelayIndex + numAggPorts))          // config DRNI Aggregation Ports
 			{
 				pAggPorts[px]->actorAdminSystem = pAggregators[distRelayIndex]->actorAdminSystem;
-				pAggPorts[px]->actorAdminPortKey = pAggregators[distRelayIndex]->actorAdminAggregatorKey;
+				pAggPorts[px]->set_aAggPortActorAdminKey(pAggregators[distRelayIndex]->actorAdminAggregatorKey);   // Sets change flag so oper key follows
 
 				pAggPorts[px]->set_aAggPortLinkNumberID(firstLinkNumber + px - distRelayIndex);;  // Sequentially number DRNI links
 			}
@@ -291,8 +331,10 @@ void LinkAgg::resetCSDC()
 		agg.operDiscardWrongConversation = (agg.adminDiscardWrongConversation == adminValues::FORCE_TRUE);
 
 		agg.activeLagLinks.clear();
-		agg.conversationLinkVector.fill(0);
-		agg.conversationPortVector.fill(0);
+		agg.pConversations = nullptr;
+		agg.changedConversations.clear();
+		agg.updateAllConversations = true;
+		agg.changeForwarding = true;
 
 		agg.changeActorDistAlg = false;
 		agg.changeConvLinkList = false;
@@ -375,7 +417,7 @@ void LinkAgg::updateMask(Aggregator& agg)
 
 void LinkAgg::debugUpdateMask(Aggregator& thisAgg, std::string routine)
 {
-	if (SimLog::Debug > 7)
+	if (SimLog::Trace<7>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time
 			<< ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -400,7 +442,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 	//     Aggregator to use the partnerAdmin... values (including port that is DEFAULTED, is version 1 (?), 
 	//     or did not receive the proper V2 TLVs from the partner.
 
-	if ((SimLog::Debug > 7) && port.changePartnerOperDistAlg)
+	if ((SimLog::Trace<7>()) && port.changePartnerOperDistAlg)
 	{
 		SimLog::logFile << "Time " << SimLog::Time
 			<< ":   Device:Aggregator " << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
@@ -421,7 +463,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 			agg.partnerConversationServiceMappingDigest = agg.partnerAdminConversationServiceMappingDigest;
 			agg.changeDistAlg = true;
 			// Could optimize further processing by only setting change flag if new values differ from old values.
-			if ((SimLog::Debug > 3))
+			if ((SimLog::Trace<3>()))
 			{
 				SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 					<< " setting default partner algorithm on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -434,7 +476,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 			agg.partnerConversationServiceMappingDigest = port.partnerOperConversationServiceMappingDigest;
 			agg.changeDistAlg = true;
 			// Could optimize further processing by only setting change flag if new values differ from old values.
-			if ((SimLog::Debug > 3))
+			if ((SimLog::Trace<3>()))
 			{
 				SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorAdminSystem.addrMid << ":" << port.actorPort.num
 					<< " setting partner's algorithm on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -447,6 +489,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 
 void LinkAgg::updateActorDistributionAlgorithm(Aggregator& thisAgg)
 {
+	thisAgg.updateActorConversationLinkListDigest();
 	for (auto lagPortIndex : thisAgg.lagPorts)      //   walk list of Aggregation Ports on the LAG
 	{
 		AggPort& port = *(pAggPorts[lagPortIndex]);
@@ -457,7 +500,7 @@ void LinkAgg::updateActorDistributionAlgorithm(Aggregator& thisAgg)
 		if (port.actorOperPortState.sync)   //     If the AggPort is attached to Aggregator
 		{
 			port.NTT = true;                //         then communicate change to partner
-			if (SimLog::Debug > 6)
+			if (SimLog::Trace<6>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 					<< ":" << port.actorPort.num << " NTT: Change actor dist algorithm on Link " << dec << port.LinkNumberID
@@ -519,13 +562,14 @@ void LinkAgg::compareDistributionAlgorithms(Aggregator& thisAgg)
 	thisAgg.operDiscardWrongConversation = ((thisAgg.adminDiscardWrongConversation == adminValues::FORCE_TRUE) ||
 		((thisAgg.adminDiscardWrongConversation == adminValues::AUTO) && !differentDistAlg));
 	thisAgg.changeCSDC |= ((oldDWC != thisAgg.operDiscardWrongConversation) && !thisAgg.activeLagLinks.empty());
+	thisAgg.updateAllConversations |= (oldDWC != thisAgg.operDiscardWrongConversation);   // Collection masks change for all Conversation IDs
 
 
 	//TODO:  report to management if any "differentXXX" flags are set
 	//TODO:  Set differentPortConversationDigests if actor and partner Link Numbers don't match 
 	//         (are they guaranteed to be stable by the time actor.sync and partner.sync?)
 	//         (will changes to actor or partner set the change distribution algorithms flag?)
-	if (SimLog::Debug > 6)
+	if (SimLog::Trace<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time
 			<< ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -539,7 +583,7 @@ void LinkAgg::compareDistributionAlgorithms(Aggregator& thisAgg)
 
 void LinkAgg::updateActiveLinks(Aggregator& thisAgg)
 {
-	std::list<unsigned short> newActiveLinkList;  // Build a new list of the link numbers active on the LAG
+	IdList newActiveLinkList;                       // Build a new list of the link numbers active on the LAG
 	for (auto lagPortIndex : thisAgg.lagPorts)      //   from list of Aggregation Ports on the LAG
 	{
 		AggPort& port = *(pAggPorts[lagPortIndex]);
@@ -560,12 +604,12 @@ void LinkAgg::updateActiveLinks(Aggregator& thisAgg)
 			else
 				port.LinkNumberID = port.adminLinkNumberID;
 
-			newActiveLinkList.push_back(port.LinkNumberID);      // Add its Link Number to the new active link list  
+			newActiveLinkList.insert(port.LinkNumberID);         // Add its Link Number to the new active link list (kept in ascending order)
 
 			if (oldLinkNumberID != port.LinkNumberID)
 			{
 				port.NTT = true;
-				if (SimLog::Debug > 6)
+				if (SimLog::Trace<6>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 						<< ":" << port.actorPort.num << " NTT: Link Number changing to  " << dec << port.LinkNumberID << endl;
@@ -574,7 +618,6 @@ void LinkAgg::updateActiveLinks(Aggregator& thisAgg)
 		}
 	}
 
-	newActiveLinkList.sort();                       // Put list of link numbers in ascending order 
 	if (thisAgg.activeLagLinks != newActiveLinkList)  // If the active links have changed
 	{
 		thisAgg.activeLagLinks = newActiveLinkList;   // Save the new list of active link numbers
@@ -587,16 +630,24 @@ void LinkAgg::updateConversationPortVector(Aggregator& thisAgg)
 {
 	if (thisAgg.activeLagLinks.empty())         // If there are no links active on the LAG 
 	{
-		thisAgg.conversationLinkVector.fill(0);          // Clear all Conversation ID to Link associations; 
-		thisAgg.conversationPortVector.fill(0);          // Clear all Conversation ID to Port associations; 
+		thisAgg.pConversations = nullptr;                // Clear all Conversation ID to Link and Port associations;
+		thisAgg.changedConversations.clear();
+		thisAgg.updateAllConversations = true;           // Masks no longer match the conversationPortVector
+		thisAgg.changeForwarding = true;
 		// Don't need to update conversation masks because disableCollectingDistributing will clear masks when links go inactive
 	}
 	else                                        // Otherwise there are active links on the LAG
 	{
-		thisAgg.updateConversationLinkVector(thisAgg.activeLagLinks, thisAgg.conversationLinkVector);           // Create new Conversation ID to Link associations
+		if (!thisAgg.pConversations)                     // Conversation ID vectors start all zero when the LAG gets active links
+		{
+			thisAgg.pConversations = make_unique<Aggregator::ConversationVectors>();
+			thisAgg.changeForwarding = true;
+		}
+		Aggregator::ConversationVectors& conv = *thisAgg.pConversations;
+		conv.pConversationLinkVector = thisAgg.conversationLinkTable(thisAgg.activeLagLinks);   // Get new Conversation ID to Link associations
+		const std::array<unsigned short, 4096>& conversationLinkVector = *conv.pConversationLinkVector;
 
-		std::array<unsigned short, 4096> newConvPortVector;  // Create temporary new CID to Port vector
-		newConvPortVector.fill(0);                           // Clear new Conversation ID to Port associations; 
+		std::map<unsigned short, unsigned short> linkPorts;  // Port Number for the Link Number of each port that can carry conversations
 		for (auto lagPortIndex : thisAgg.lagPorts)
 		{
 			AggPort& port = *(pAggPorts[lagPortIndex]);
@@ -604,60 +655,117 @@ void LinkAgg::updateConversationPortVector(Aggregator& thisAgg)
 			if (port.actorOperPortState.collecting && (port.portSelected == AggPort::selectedVals::SELECTED)
 				&& (port.LinkNumberID > 0))
 			{
-				for (unsigned short cid = 0; cid < 4096; cid++)
-				{
-					if (thisAgg.conversationLinkVector[cid] == port.LinkNumberID)
-					{
-						newConvPortVector[cid] = port.actorPort.num;
-					}
-				}
+				linkPorts[port.LinkNumberID] = port.actorPort.num;
 			}
 		}
 
-		if (thisAgg.conversationPortVector != newConvPortVector)
+		//  Make a single pass through the Conversation IDs, updating the Port for each and remembering
+		//     which Conversation IDs changed so only those need to be updated in the conversation masks.
+		unsigned short lastLink = 0;                         // Consecutive Conversation IDs usually map to the same link,
+		unsigned short lastPort = 0;                         //    so remember the last lookup
+		bool changed = false;
+		for (unsigned short cid = 0; cid < 4096; cid++)
+		{
+			unsigned short link = conversationLinkVector[cid];
+			if (link != lastLink)
+			{
+				auto linkPort = linkPorts.find(link);
+				lastPort = (linkPort != linkPorts.end()) ? linkPort->second : 0;
+				lastLink = link;
+			}
+			unsigned short portNum = (link > 0) ? lastPort : 0;
+
+			if (conv.conversationPortVector[cid] != portNum)
+			{
+				conv.conversationPortVector[cid] = portNum;
+				if (!thisAgg.updateAllConversations)
+					thisAgg.changedConversations.push_back(cid);
+				changed = true;
+			}
+		}
+		if (thisAgg.changedConversations.size() >= 4096)     // If change list has grown too long just update all Conversation IDs
+		{
+			thisAgg.changedConversations.clear();
+			thisAgg.updateAllConversations = true;
+		}
+
+		if (changed)
 		{
-			thisAgg.conversationPortVector = newConvPortVector;
 			thisAgg.changeCSDC = true;
 		}
 	}
 
-	if (SimLog::Debug > 4)
+	if (SimLog::Trace<4>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid
 			<< ":" << thisAgg.aggregatorIdentifier << dec << " ConvLinkMap = ";
-		for (int k = 0; k < 16; k++) SimLog::logFile << "  " << thisAgg.conversationLinkVector[k];
+		for (int k = 0; k < 16; k++) SimLog::logFile << "  " << thisAgg.get_conversationLink(k);
 		SimLog::logFile << endl;
 	}
 }
 
 void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 {
+	//  Only the mask bits of Conversation IDs in changedConversations (those whose conversationPortVector entry changed since
+	//     the masks were last updated) need to change.  All Conversation IDs are updated for a port if its masks were cleared 
+	//     by the Mux machine, or if it became able (or unable) to carry conversations, and for all ports if the Aggregator
+	//     requires it (e.g. change in Discard Wrong Conversation).
+	bool allConversations = thisAgg.updateAllConversations;
+	Aggregator::ConversationVectors* pConv = thisAgg.pConversations.get();   // Null if no active links (no Conversation ID has a port)
+	for (auto lagPortIndex : thisAgg.lagPorts)
+	{
+		AggPort& port = *(pAggPorts[lagPortIndex]);
+
+		unsigned short maskPortNum = 0;                 // Conversation IDs with this port number in conversationPortVector are in masks
+		if (port.actorOperPortState.collecting && (port.portSelected == AggPort::selectedVals::SELECTED))
+			maskPortNum = port.actorPort.num;
+		port.convMaskUpdateAll = thisAgg.updateAllConversations || !port.convMasksCurrent || (port.convMaskPortNum != maskPortNum);
+		port.convMaskPortNum = maskPortNum;
+		allConversations |= port.convMaskUpdateAll;
+	}
+
+	if (pConv && allConversations)                      // No Conversation ID is distributed while the masks are being changed
+		pConv->conversationEgressPort.fill(nullptr);
+	else if (pConv)
+		for (auto convID : thisAgg.changedConversations)
+			pConv->conversationEgressPort[convID] = nullptr;
+
 	for (auto lagPortIndex : thisAgg.lagPorts)      //   from list of Aggregation Ports on the LAG
 	{
 		AggPort& port = *(pAggPorts[lagPortIndex]);
 
 		port.actorDWC = thisAgg.operDiscardWrongConversation;  // Update port's copy of DWC
 
-		for (int convID = 0; convID < 4096; convID++)   //    for all conversation ID values.
+		if (port.convMaskUpdateAll)
 		{
-			bool passConvID = (port.actorOperPortState.collecting && (port.portSelected == AggPort::selectedVals::SELECTED) &&
-				(thisAgg.conversationPortVector[convID] == port.actorPort.num) && (port.actorPort.num > 0));
-				// Determine if link is active and the conversation ID maps to this port number
+			if (pConv && (port.convMaskPortNum > 0))                   // If link is active then distribute all conversation IDs
+				port.portOperConversationMask.assignEqual(pConv->conversationPortVector, port.convMaskPortNum);
+			else                                                       //    that map to this port number
+				port.portOperConversationMask.reset();
+
+			// Turn off distribution and collection if convID is moving between links.
+			port.distributionConversationMask = port.distributionConversationMask & port.portOperConversationMask;  
+			port.collectionConversationMask = port.collectionConversationMask & port.portOperConversationMask;      
+		}
+		else
+		{
+			for (auto convID : thisAgg.changedConversations)   //    for changed conversation ID values.
+			{
+				bool passConvID = (pConv && (port.convMaskPortNum > 0) && (pConv->conversationPortVector[convID] == port.convMaskPortNum));
 
-			port.portOperConversationMask[convID] = passConvID;       // If so then distribute this conversation ID. 
+				port.portOperConversationMask[convID] = passConvID;
+				port.distributionConversationMask[convID] = port.distributionConversationMask[convID] && passConvID;
+				port.collectionConversationMask[convID] = port.collectionConversationMask[convID] && passConvID;
+			}
 		}
 
-		if (SimLog::Debug > 4)
+		if (SimLog::Trace<4>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorAdminSystem.addrMid
 				<< ":" << port.actorPort.num << " Link " << dec << port.LinkNumberID << "   ConvMask = ";
 			for (int k = 0; k < 16; k++) SimLog::logFile << "  " << port.portOperConversationMask[k];
 			SimLog::logFile << endl;
 		}
-
-		// Turn off distribution and collection if convID is moving between links.
-		port.distributionConversationMask = port.distributionConversationMask & port.portOperConversationMask;  
-		port.collectionConversationMask = port.collectionConversationMask & port.portOperConversationMask;      
 	}
 
 	//  Before just cleared distribution/collection masks for Conversation IDs where the port's link number did not match the conversationLinkVector.
@@ -667,13 +775,27 @@ void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 	{
 		AggPort& port = *(pAggPorts[lagPortIndex]);
 
-		port.distributionConversationMask = port.portOperConversationMask;         // Set distribution mask to the new value
-
 		//TODO:  I think I need more qualification here.  Don't want to collectionConversationMask.set() if not collecting (and SELECTED and partner.sync?)
-		if (thisAgg.operDiscardWrongConversation)                                  // If enforcing Conversation-sensitive Collection
-			port.collectionConversationMask = port.portOperConversationMask;       //    then make collection mask the same as the distribution mask
+		if (port.convMaskUpdateAll)
+		{
+			port.distributionConversationMask = port.portOperConversationMask;         // Set distribution mask to the new value
+
+			if (thisAgg.operDiscardWrongConversation)                                  // If enforcing Conversation-sensitive Collection
+				port.collectionConversationMask = port.portOperConversationMask;       //    then make collection mask the same as the distribution mask
+			else
+				port.collectionConversationMask.set();                                 // Otherwise make collection mask true for all conversation IDs
+		}
 		else
-			port.collectionConversationMask.set();                                 // Otherwise make collection mask true for all conversation IDs
+		{
+			for (auto convID : thisAgg.changedConversations)
+			{
+				port.distributionConversationMask[convID] = port.portOperConversationMask[convID];
+				port.collectionConversationMask[convID] = 
+					!thisAgg.operDiscardWrongConversation || port.portOperConversationMask[convID];
+			}
+		}
+		port.convMasksCurrent = true;
+		port.changeForwarding = true;
 
 		/*     
 		// AX-2014 only
@@ -690,6 +812,36 @@ void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 		}
 		/**/
 	}
+
+	//  When all masks are updated, set the egress port for each Conversation ID to the port that has it in its
+	//     distribution mask.  Lets distributeFrame find the egress port without walking the lagPorts list.
+	for (auto lagPortIndex : thisAgg.lagPorts)
+	{
+		AggPort* pPort = pAggPorts[lagPortIndex].get();
+
+		if (!pConv)                                     // No port has any Conversation ID in its masks
+			break;
+		else if (allConversations)
+		{
+			const ConvMask& portMask = pPort->portOperConversationMask;
+			for (int convID = portMask.nextSet(0); convID < ConvMask::NumBits; convID = portMask.nextSet(convID + 1))
+			{
+				pConv->conversationEgressPort[convID] = pPort;
+			}
+		}
+		else
+		{
+			for (auto convID : thisAgg.changedConversations)
+			{
+				if (pPort->portOperConversationMask[convID])
+					pConv->conversationEgressPort[convID] = pPort;
+			}
+		}
+	}
+
+	thisAgg.changedConversations.clear();
+	thisAgg.updateAllConversations = false;
+	thisAgg.changeForwarding = true;
 }
 
 void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
@@ -708,7 +860,7 @@ void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
 		thisAgg.operational = false;                // Set Aggregator ISS to not operational
 		//TODO:  flush aggregator request queue?
 
-		cout << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
+		SimLog::console << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
 			<< " is DOWN" << dec << endl;
 		if (SimLog::Time > 0)
 		{
@@ -720,11 +872,11 @@ void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
 	{
 		thisAgg.operational = true;                 // Set Aggregator ISS is operational
 
-		cout << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
+		SimLog::console << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
 			<< " is UP with Link numbers:  " << dec;
 		for (auto link : thisAgg.activeLagLinks)
-			cout << link << "  ";
-		cout << dec << endl;
+			SimLog::console << link << "  ";
+		SimLog::console << dec << endl;
 		if (SimLog::Time > 0)
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -737,8 +889,21 @@ void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
 }
 
 /**/
+shared_ptr<const std::array<unsigned short, 4096>> Aggregator::conversationLinkTable(const IdList& links)
+{
+	unsigned long long adminMapId = (selectedconvLinkMap == Aggregator::convLinkMaps::ADMIN_TABLE) ? adminLinkMapId : 0;
+	shared_ptr<const LinkMapCache::LinkVector> pTable = LinkMapCache::find((int)selectedconvLinkMap, adminMapId, links);
+	if (!pTable)                                                 // If no LAG has had this map and set of links
+	{
+		shared_ptr<LinkMapCache::LinkVector> pNewTable = make_shared<LinkMapCache::LinkVector>();
+		updateConversationLinkVector(links, *pNewTable);         //    then compute the table and share it
+		pTable = LinkMapCache::insert((int)selectedconvLinkMap, adminMapId, links, pNewTable);
+	}
+	return (pTable);
+}
+
 //void LinkAgg::updateConversationLinkVector(Aggregator& thisAgg, std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
-void Aggregator::updateConversationLinkVector(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
+void Aggregator::updateConversationLinkVector(const IdList& links, std::array<unsigned short, 4096>& convLinkVector)
 {
 	switch (selectedconvLinkMap)
 	{
@@ -757,23 +922,23 @@ void Aggregator::updateConversationLinkVector(std::list<unsigned short>& links,
 	}
 }
 
-//void LinkAgg::linkMap_EightLinkSpread(Aggregator& thisAgg, std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
-void Aggregator::linkMap_EightLinkSpread(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
-{
-	const int nLinks = 8;  // Must be a power of two
-	const int nRows = 8;   // Must be a power of two
-	const unsigned short convLinkPriorityList[nRows][nLinks] =
-	{
-		{ 0, 3, 6, 5, 1, 2, 7, 4 },
-		{ 1, 2, 7, 4, 0, 3, 6, 5 },
-		{ 2, 5, 0, 7, 3, 4, 1, 6 },
-		{ 3, 4, 1, 6, 2, 5, 0, 7 },
-		{ 4, 7, 2, 1, 5, 6, 3, 0 },
-		{ 5, 6, 3, 0, 4, 7, 2, 1 },
-		{ 6, 1, 4, 3, 7, 0, 5, 2 },
-		{ 7, 0, 5, 2, 6, 1, 4, 3 }
-	};
+static const int nLinks = 8;  // Must be a power of two
+static const int nRows = 8;   // Must be a power of two
+static const unsigned short convLinkPriorityList[nRows][nLinks] =   // Link Numbers modulo nLinks, in priority order for each row
+{
+	{ 0, 3, 6, 5, 1, 2, 7, 4 },
+	{ 1, 2, 7, 4, 0, 3, 6, 5 },
+	{ 2, 5, 0, 7, 3, 4, 1, 6 },
+	{ 3, 4, 1, 6, 2, 5, 0, 7 },
+	{ 4, 7, 2, 1, 5, 6, 3, 0 },
+	{ 5, 6, 3, 0, 4, 7, 2, 1 },
+	{ 6, 1, 4, 3, 7, 0, 5, 2 },
+	{ 7, 0, 5, 2, 6, 1, 4, 3 }
+};
 
+//void LinkAgg::linkMap_EightLinkSpread(Aggregator& thisAgg, std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
+void Aggregator::linkMap_EightLinkSpread(const IdList& links, std::array<unsigned short, 4096>& convLinkVector)
+{
 	std::array<unsigned short, nLinks> activeLinkNumbers = { 0 };
 
 	// First, put the Aggregator's activeLagLinks list to an array, nlinks long, where the position in the array
@@ -811,7 +976,7 @@ void Aggregator::linkMap_EightLinkSpread(std::list<unsigned short>& links, std::
 /**/
 
 //void LinkAgg::linkMap_EvenOdd(Aggregator& thisAgg, std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
-void Aggregator::linkMap_EvenOdd(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
+void Aggregator::linkMap_EvenOdd(const IdList& links, std::array<unsigned short, 4096>& convLinkVector)
 {
 	if (links.empty())              // If there are no active links
 	{
@@ -830,7 +995,7 @@ void Aggregator::linkMap_EvenOdd(std::list<unsigned short>& links, std::array<un
 }
 
 //void LinkAgg::linkMap_ActiveStandby(Aggregator& thisAgg, std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
-void Aggregator::linkMap_ActiveStandby(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
+void Aggregator::linkMap_ActiveStandby(const IdList& links, std::array<unsigned short, 4096>& convLinkVector)
 {
 	if (links.empty())              // If there are no active links
 	{
@@ -845,7 +1010,7 @@ void Aggregator::linkMap_ActiveStandby(std::list<unsigned short>& links, std::ar
 }
 
 //void LinkAgg::linkMap_AdminTable(Aggregator& thisAgg, std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
-void Aggregator::linkMap_AdminTable(std::list<unsigned short>& links, std::array<unsigned short, 4096>& convLinkVector)
+void Aggregator::linkMap_AdminTable(const IdList& links, std::array<unsigned short, 4096>& convLinkVector)
 {
 	convLinkVector.fill(0);                           // Start with  conversationLinkVector is all zero
 	for (const auto& entry : adminConversationLinkMap)         // For each entry in the administered adminConversationLinkMap table (std::map)
@@ -853,7 +1018,7 @@ void Aggregator::linkMap_AdminTable(std::list<unsigned short>& links, std::array
 		unsigned short convID = entry.first;                       //    Get the conversation ID.
 		for (const auto& link : entry.second)                      //    Walk the prioritized list of desired links for that conversation ID.
 		{
-			if (isInList(link, links))            //    If the desired link is active on the Aggregator
+			if (links.contains(link))             //    If the desired link is active on the Aggregator
 			{
 				convLinkVector[convID] = link;        //        then put that link number in the conversationLinkVector
 				break;
@@ -862,88 +1027,321 @@ void Aggregator::linkMap_AdminTable(std::list<unsigned short>& links, std::array
 	}
 }
 
-// Is there really no standard library routine to test if a value is in a list?
-//bool LinkAgg::isInList(unsigned short val, const std::list<unsigned short>& thisList)
-bool Aggregator::isInList(unsigned short val, const std::list<unsigned short>& thisList)
+/*
+*   The Conversation Link List digest is the MD5 fingerprint of aAggConversationAdminLink[] taken as 4096 consecutive elements,
+*     each the prioritized list of Link Numbers for a Conversation ID followed by the Conversation ID, all as two octet values.
+*   The fixed maps have the digest of the admin table that gives the same Conversation ID to Link Number mapping when
+*     the Link Numbers are 1 through 8.
+*/
+std::array<unsigned char, 16> Aggregator::conversationLinkListDigest(const std::map<unsigned short, std::list<unsigned short>>& linkMap)
+{
+	Md5 md5;
+	auto entry = linkMap.begin();
+	for (unsigned short cid = 0; cid < 4096; cid++)
+	{
+		if ((entry != linkMap.end()) && (entry->first == cid))
+		{
+			for (auto link : entry->second)
+				md5.put16(link);
+			entry++;
+		}
+		md5.put16(cid);
+	}
+	return (md5.digest());
+}
+
+std::map<unsigned short, std::list<unsigned short>> Aggregator::fixedLinkMap(Aggregator::convLinkMaps linkMap)
 {
-	bool inList = false;
-	for (auto& listVal : thisList)
+	std::map<unsigned short, std::list<unsigned short>> table;
+	std::list<unsigned short> ascending = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	std::list<unsigned short> descending = { 8, 7, 6, 5, 4, 3, 2, 1 };
+	for (unsigned short cid = 0; (cid < 4096) && (linkMap != Aggregator::convLinkMaps::ADMIN_TABLE); cid++)
 	{
-		if (listVal == val)
+		if (linkMap == Aggregator::convLinkMaps::ACTIVE_STANDBY)
+			table[cid] = ascending;                                   // Lowest Link Number is active
+		else if (linkMap == Aggregator::convLinkMaps::EVEN_ODD)
+			table[cid] = (cid % 2) ? descending : ascending;          // Even to lowest Link Number, odd to highest
+		else
 		{
-			inList = true;
-			break;
+			std::list<unsigned short>& links = table[cid];
+			for (int j = 0; j < nLinks; j++)
+				links.push_back(convLinkPriorityList[cid % nRows][j] ? convLinkPriorityList[cid % nRows][j] : nLinks);
 		}
 	}
-	return (inList);
+	return (table);
+}
+
+std::array<unsigned char, 16> Aggregator::linkMapDigest(Aggregator::convLinkMaps linkMap)
+{
+	static const std::array<std::array<unsigned char, 16>, 4> digests =    // Indexed by convLinkMaps
+	{
+		conversationLinkListDigest(fixedLinkMap(Aggregator::convLinkMaps::ADMIN_TABLE)),
+		conversationLinkListDigest(fixedLinkMap(Aggregator::convLinkMaps::ACTIVE_STANDBY)),
+		conversationLinkListDigest(fixedLinkMap(Aggregator::convLinkMaps::EVEN_ODD)),
+		conversationLinkListDigest(fixedLinkMap(Aggregator::convLinkMaps::EIGHT_LINK_SPREAD))
+	};
+	return (digests[linkMap]);
 }
+
+void Aggregator::updateActorConversationLinkListDigest()
+{
+	if (adminLinkMapDigestStale)                       // Only recompute the admin table digest if the table has changed
+	{
+		actorAdminConversationLinkListDigest = conversationLinkListDigest(adminConversationLinkMap);
+		adminLinkMapDigestStale = false;
+	}
+	if (selectedconvLinkMap == Aggregator::convLinkMaps::ADMIN_TABLE)
+		actorConversationLinkListDigest = actorAdminConversationLinkListDigest;
+	else
+		actorConversationLinkListDigest = linkMapDigest(selectedconvLinkMap);
+}
+
 /**/
 
 
-bool LinkAgg::collectFrame(AggPort& thisPort, Frame& thisFrame)  // const??
+shared_ptr<const Forwarding> LinkAgg::getForwarding() const
 {
-	bool collect = (thisPort.actorOperPortState.distributing);   // always return false if port not distributing (collecting ??)
-	unsigned short convID = frameConvID(thisPort.actorOperPortAlgorithm, thisFrame);
+	return (std::atomic_load(&pForwarding));
+}
 
-	if (collect && thisPort.actorDWC)                            // if collecting but Discard Wrong Conversation is set
+void LinkAgg::publishForwarding()
+{
+	//  Only the control plane replaces pForwarding, so this thread can read it without atomic_load.
+	//  Rebuild if a port's masks or an Aggregator's egress ports changed (the change flags) or if any other variable the
+	//     data plane uses differs from the current Forwarding.  Otherwise leave the current Forwarding in place.
+	shared_ptr<const Forwarding> pOld = pForwarding;
+	if (pOld && ((pOld->ports.size() != pAggPorts.size()) || (pOld->aggregators.size() != pAggregators.size())))
+		pOld = nullptr;
+	bool changed = !pOld;
+	for (unsigned short i = 0; !changed && (i < pAggPorts.size()); i++)
 	{
-		collect = thisPort.collectionConversationMask[convID];   // then verify this Conversation ID can be received through this AggPort
+		const AggPort& port = *pAggPorts[i];
+		const Forwarding::PortEntry& entry = pOld->ports[i];
+		changed = port.changeForwarding ||
+			(entry.aggregatorIndex != ((port.actorPortAggregatorIndex < pAggregators.size()) ? port.actorPortAggregatorIndex : 0)) ||
+			(entry.distributing != (bool)port.actorOperPortState.distributing) ||
+			(entry.discardWrongConversation != port.actorDWC) || (entry.algorithm != port.actorOperPortAlgorithm) ||
+			(entry.lacpDestinationAddress != port.lacpDestinationAddress) || (entry.device != port.actorAdminSystem.addrMid) ||
+			(entry.portNumber != port.actorPort.num) || (entry.linkNumber != port.LinkNumberID);
 	}
-	if (SimLog::Debug > 6)
+	for (unsigned short a = 0; !changed && (a < pAggregators.size()); a++)
 	{
-		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << thisPort.actorAdminSystem.addrMid
-			<< ":" << thisPort.actorPort.num << " Link " << dec << thisPort.LinkNumberID << "  DWC " << thisPort.actorDWC << hex;
-		if (collect)
+		const Aggregator& agg = *pAggregators[a];
+		const Forwarding::AggregatorEntry& entry = pOld->aggregators[a];
+		changed = agg.changeForwarding || (entry.enabled != agg.getEnabled()) || (entry.algorithm != agg.actorPortAlgorithm) ||
+			(entry.device != agg.actorAdminSystem.addrMid) || (entry.aggregatorIdentifier != agg.aggregatorIdentifier);
+	}
+	if (!changed)
+		return;
+
+	shared_ptr<Forwarding> pNew = make_shared<Forwarding>();
+	pNew->ports.resize(pAggPorts.size());
+	pNew->aggregators.resize(pAggregators.size());
+	std::map<const AggPort*, unsigned short> portIndex;      // Position in pAggPorts (plus one), for new egress tables
+	for (unsigned short i = 0; i < pAggPorts.size(); i++)
+	{
+		AggPort& port = *pAggPorts[i];
+		Forwarding::PortEntry& entry = pNew->ports[i];
+		entry.aggregatorIndex = (port.actorPortAggregatorIndex < pAggregators.size()) ? port.actorPortAggregatorIndex : 0;
+		entry.distributing = port.actorOperPortState.distributing;
+		entry.discardWrongConversation = port.actorDWC;
+		entry.algorithm = port.actorOperPortAlgorithm;
+		entry.lacpDestinationAddress = port.lacpDestinationAddress;
+		entry.device = port.actorAdminSystem.addrMid;
+		entry.portNumber = port.actorPort.num;
+		entry.linkNumber = port.LinkNumberID;
+		if (pOld && !port.changeForwarding)
 		{
-			SimLog::logFile << " collecting ConvID " << convID << dec << endl;
+			entry.pCollectionMask = pOld->ports[i].pCollectionMask;
+			entry.pDistributionMask = pOld->ports[i].pDistributionMask;
 		}
 		else
 		{
-			SimLog::logFile << " discarding ingress ConvID " << convID << dec << endl;
+			entry.pCollectionMask = std::allocate_shared<ConvMask>(PoolAllocator<ConvMask>(), port.collectionConversationMask);
+			entry.pDistributionMask = std::allocate_shared<ConvMask>(PoolAllocator<ConvMask>(), port.portOperConversationMask);
+			port.changeForwarding = false;
+		}
+		portIndex[&port] = i + 1;
+	}
+	for (unsigned short a = 0; a < pAggregators.size(); a++)
+	{
+		Aggregator& agg = *pAggregators[a];
+		Forwarding::AggregatorEntry& entry = pNew->aggregators[a];
+		entry.enabled = agg.getEnabled();
+		entry.algorithm = agg.actorPortAlgorithm;
+		entry.device = agg.actorAdminSystem.addrMid;
+		entry.aggregatorIdentifier = agg.aggregatorIdentifier;
+		if (pOld && !agg.changeForwarding)
+		{
+			entry.pEgressPorts = pOld->aggregators[a].pEgressPorts;
+		}
+		else if (agg.pConversations)
+		{
+			shared_ptr<Forwarding::EgressTable> pEgressPorts = make_shared<Forwarding::EgressTable>();
+			for (int cid = 0; cid < 4096; cid++)
+			{
+				AggPort* pPort = agg.pConversations->conversationEgressPort[cid];
+				(*pEgressPorts)[cid] = pPort ? portIndex[pPort] : 0;
+			}
+			entry.pEgressPorts = pEgressPorts;
 		}
+		agg.changeForwarding = false;
 	}
 
-	return (collect);
+	std::atomic_store(&pForwarding, shared_ptr<const Forwarding>(pNew));
 }
 
+void LinkAgg::runDataPlane(bool collecting, size_t maxBurst)
+{
+	shared_ptr<const Forwarding> pFwd = std::atomic_load(&pForwarding);
+	const Forwarding& fwd = *pFwd;
+	unsigned short nAggregators = (unsigned short)fwd.aggregators.size();
 
-shared_ptr<AggPort> LinkAgg::distributeFrame(Aggregator& thisAgg, Frame& thisFrame)
+	if (!pDataPlane && (SimLog::DataPlaneThreads > 1) && (nAggregators > 1))
+		pDataPlane = make_unique<DataPlane>(SimLog::DataPlaneThreads);
+
+	if (!pDataPlane || (nAggregators <= 1))                   // Run in this thread, in AggPort (or Aggregator) order
+	{
+		if (collecting)
+			for (unsigned short i = 0; i < fwd.ports.size(); i++)
+				collect(fwd, i, maxBurst, rxBurst);
+		else
+			for (unsigned short a = 0; a < nAggregators; a++)
+				distribute(fwd, a, maxBurst);
+	}
+	else                                                      // One task for each Aggregator and the AggPorts attached to it
+	{
+		if (rxBursts.size() < nAggregators)
+			rxBursts.resize(nAggregators);
+		pDataPlane->run(nAggregators, [this, &fwd, collecting, maxBurst](size_t task)
+		{
+			if (collecting)
+			{
+				for (unsigned short i = 0; i < fwd.ports.size(); i++)
+					if (fwd.ports[i].aggregatorIndex == task)
+						collect(fwd, i, maxBurst, rxBursts[task]);
+			}
+			else
+			{
+				distribute(fwd, (unsigned short)task, maxBurst);
+			}
+		});
+	}
+}
+
+void LinkAgg::collect(const Forwarding& fwd, unsigned short portIndex, size_t maxBurst, std::vector<unique_ptr<Frame>>& burst)
 {
-	shared_ptr<AggPort> pEgressPort = nullptr;
-	unsigned short convID = frameConvID(thisAgg.actorPortAlgorithm, thisFrame);
+	AggPort& port = *pAggPorts[portIndex];
+	const Forwarding::PortEntry& entry = fwd.ports[portIndex];
 
-	// Checking conversation mask of each port on lag is inefficient for this implementation, but ensures will  
-	//   not send a frame during a transient when the conversation ID of the frame is moving between ports. 
-	//   In this simulation will never be attempting to transmit during such a transient, 
-	//   but if distribution was handled by a different thread (or in hardware) it could happen.
-	// It would also be possible to create an array of port IDs (or port pointers) per Conversation ID 
-	//   that was set to null when updating conversation masks and set to appropriate port when all masks updated.
-	//   This would be more efficient for this simulation but not done since not as described in standard.
-	for (auto lagPortIndex : thisAgg.lagPorts)
+	port.pIss->IndicationBurst(burst, maxBurst);              // Get ingress frames, if available, from ISS
+	for (auto& pTempFrame : burst)                            // For each ingress frame
 	{
-		if (pAggPorts[lagPortIndex]->portOperConversationMask[convID])    // will be false if port not distributing or inappropriate port for this convID
+		if (SimLog::Trace<5>())
+		{
+			SimLog::logFile << "Time " << SimLog::Time << ":  Lag in Device:Port " << hex << entry.device
+				<< ":" << entry.portNumber << " receiving frame ";
+			pTempFrame->PrintFrameHeader();
+			SimLog::logFile << dec << endl;
+		}
+		if ((pTempFrame->MacDA == entry.lacpDestinationAddress) &&   // if frame has proper DA and contains an LACPDU
+			(pTempFrame->getNextEtherType() == SlowProtocolsEthertype) && (pTempFrame->getNextSubType() == LacpduSubType))
 		{
-			pEgressPort = pAggPorts[lagPortIndex];
+			port.pRxLacpFrame = move(pTempFrame);                     // then pass to LACP RxSM
+		}                                                             //    (a newer LACPDU in the same burst supersedes an older one)
+		else if (collectFrame(fwd, portIndex, *pTempFrame))           // else verify this frame can be collected through this AggPort
+		{                                                             //    and send it up stack through the selected Aggregator
+			pAggregators[entry.aggregatorIndex]->indications.push(move(pTempFrame));
 		}
 	}
-	if (SimLog::Debug > 6)
-	{
-		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorAdminSystem.addrMid
-			<< ":" << thisAgg.aggregatorIdentifier;
+	burst.clear();
+}
 
-		if (pEgressPort)
+void LinkAgg::distribute(const Forwarding& fwd, unsigned short aggIndex, size_t maxBurst)
+{
+	Aggregator& agg = *pAggregators[aggIndex];
+	const Forwarding::AggregatorEntry& entry = fwd.aggregators[aggIndex];
+
+	for (size_t burst = 0; (burst < maxBurst) &&              // While there are egress frames at Aggregator
+		entry.enabled && !agg.requests.empty(); burst++)
+	{
+		unique_ptr<Frame> pTempFrame = move(agg.requests.front());   // Get egress frame
+		agg.requests.pop();
+		if (pTempFrame)                                           // Shouldn't be necessary since already tested that there was a frame
 		{
-			SimLog::logFile << " distributing ConvID " << convID 
-				<< "  to Port " << pEgressPort->actorAdminSystem.addrMid << ":" << pEgressPort->actorPort.num
-				<< " Link " << dec << pEgressPort->LinkNumberID << dec << endl;
+			if (SimLog::Trace<5>())
+			{
+				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << entry.device
+					<< ":" << entry.aggregatorIdentifier << " transmitting frame ";
+				pTempFrame->PrintFrameHeader();
+				SimLog::logFile << dec << endl;
+			}
+			int egressPort = distributeFrame(fwd, aggIndex, *pTempFrame);   // get egress Aggregation Port
+			if (egressPort >= 0)
+			{
+				pAggPorts[egressPort]->pIss->Request(move(pTempFrame));     //    Send frame through egress Aggregation Port
+			}
 		}
-		else
+	}
+}
+
+bool LinkAgg::collectFrame(const Forwarding& fwd, unsigned short portIndex, Frame& thisFrame) const
+{
+	const Forwarding::PortEntry& port = fwd.ports[portIndex];
+	bool collect = port.distributing;                            // always return false if port not distributing (collecting ??)
+	unsigned short convID = frameConvID(port.algorithm, thisFrame);
+
+	if (collect && port.discardWrongConversation)                // if collecting but Discard Wrong Conversation is set
+	{
+		collect = (*port.pCollectionMask)[convID];               // then verify this Conversation ID can be received through this AggPort
+	}
+	if (SimLog::Trace<6>())
+	{
+		TraceRecord record = { SimLog::Time, TRACE_DISCARD_INGRESS, port.device, port.portNumber,
+			port.linkNumber, convID, 0, 0, port.discardWrongConversation };
+		if (collect)
+			record.event = TRACE_COLLECT_FRAME;
+		SimLog::trace(record);
+	}
+
+	return (collect);
+}
+
+
+int LinkAgg::distributeFrame(const Forwarding& fwd, unsigned short aggIndex, Frame& thisFrame) const
+{
+	const Forwarding::AggregatorEntry& agg = fwd.aggregators[aggIndex];
+	unsigned short convID = frameConvID(agg.algorithm, thisFrame);
+
+	// The egress port comes from a table of ports per Conversation ID that is cleared when updating conversation masks
+	//   and set to the appropriate port when all masks are updated, so a frame is never sent while its Conversation ID 
+	//   is moving between ports.  The table is taken from the Aggregator's conversationEgressPort when the Forwarding
+	//   is published, so distribution (possibly in another thread) never sees a partially updated table.
+	// The port's conversation mask is still checked because the Mux machine clears the masks of a port that
+	//   stops distributing without updating the table.  The port must also still be attached to this Aggregator, so 
+	//   the data plane of one Aggregator never touches the AggPorts of another.
+	int egressPort = agg.pEgressPorts ? (int)(*agg.pEgressPorts)[convID] - 1 : -1;
+	if ((egressPort >= 0) &&                                     // will be false if port not distributing or inappropriate port for this convID
+		(!(*fwd.ports[egressPort].pDistributionMask)[convID] || (fwd.ports[egressPort].aggregatorIndex != aggIndex)))
+	{
+		egressPort = -1;
+	}
+	if (SimLog::Trace<6>())
+	{
+		TraceRecord record = { SimLog::Time, TRACE_DISCARD_EGRESS, agg.device, agg.aggregatorIdentifier,
+			0, convID, 0, 0, false };
+		if (egressPort >= 0)
 		{
-			SimLog::logFile << " discarding egress ConvID " << convID << dec << endl;
+			const Forwarding::PortEntry& port = fwd.ports[egressPort];
+			record.event = TRACE_DISTRIBUTE_FRAME;
+			record.link = port.linkNumber;
+			record.peerDevice = port.device;
+			record.peerComponent = port.portNumber;
 		}
+		SimLog::trace(record);
 	}
 
-	return (pEgressPort);
+	return (egressPort);
 }
 
 
@@ -951,30 +1349,111 @@ unsigned short LinkAgg::frameConvID(LagAlgorithms algorithm, Frame& thisFrame)
 {
 	unsigned short convID = 0;
 
+	if (thisFrame.getCachedConvID(algorithm, convID))            // Frame already classified with this algorithm
+		return (convID);
+
 	switch (algorithm)
 	{
 	case LagAlgorithms::C_VID:
 		if (thisFrame.getNextEtherType() == CVlanEthertype)
 		{
-//			convID = ((VlanTag&)(thisFrame.getNextSdu())).Vtag.id;
-			convID = (VlanTag::getVlanTag(thisFrame)).Vtag.id;
-			
+			convID = thisFrame.getOuterVid();
 		}
 		break;
 	case LagAlgorithms::S_VID:
 		if (thisFrame.getNextEtherType() == SVlanEthertype)
 		{
-//			convID = ((VlanTag&)(thisFrame.getNextSdu())).Vtag.id;
-			convID = (VlanTag::getVlanTag(thisFrame)).Vtag.id;
+			convID = thisFrame.getOuterVid();
 		}
 		break;
-	default:  // includes 	LagAlgorithms::UNSPECIFIED
+	case LagAlgorithms::I_SID:
+	{
+		const Sdu* pTag = &thisFrame.getNextSdu();
+		if (pTag->getEtherType() == SVlanEthertype)               // I-Tag may follow a B-Tag
+			pTag = &pTag->getNextSdu();
+		if (pTag->getEtherType() == ITagEthertype)
+		{
+			convID = (ITag::getITag(*pTag)).Itag.sid & 0x0fff;   // Default I-SID to Conversation ID map is the low 12 bits
+		}
+		break;
+	}
+	case LagAlgorithms::ECMP_FLOW_HASH:
+		convID = flowHash(thisFrame);
+		break;
+	default:  // includes 	LagAlgorithms::UNSPECIFIED and TE_SID
 		convID = macAddrHash(thisFrame);
 		break;
 	}
+	thisFrame.cacheConvID(algorithm, convID);
 	return (convID);
 }
 
+static unsigned int crc32cWord(unsigned int crc, unsigned int word)   // CRC32C (Castagnoli) over 4 bytes, least significant first
+{
+#if defined(LINKAGG_CRC32C)
+	return (_mm_crc32_u32(crc, word));
+#else
+	static const std::array<unsigned int, 256> table = []
+	{
+		std::array<unsigned int, 256> entries;
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			unsigned int entry = i;
+			for (int bit = 0; bit < 8; bit++)
+				entry = (entry >> 1) ^ ((entry & 1) ? 0x82f63b78 : 0);   // Reflected Castagnoli polynomial
+			entries[i] = entry;
+		}
+		return (entries);
+	}();
+
+	for (int i = 0; i < 4; i++)
+	{
+		crc = table[(crc ^ word) & 0xff] ^ (crc >> 8);
+		word >>= 8;
+	}
+	return (crc);
+#endif
+}
+
+/*
+ *  flowHash calculates a 12-bit hash of the DA and SA fields of the input frame, the identifiers of any VLAN tags
+ *     or I-Tag, and the addresses, protocol and ports of a FlowSdu.  Frames between the same pair of MAC addresses
+ *     are spread across Conversation IDs by flow.  The hardware CRC32C instruction is used when available, and
+ *     the table driven calculation gives the same result when it is not.
+/**/
+unsigned short LinkAgg::flowHash(Frame& thisFrame)
+{
+	unsigned int crc = 0xffffffff;
+
+	crc = crc32cWord(crc, (unsigned int)thisFrame.MacDA);
+	crc = crc32cWord(crc, (unsigned int)(((thisFrame.MacDA >> 32) & 0xffff) | ((thisFrame.MacSA >> 16) & 0xffff0000)));
+	crc = crc32cWord(crc, (unsigned int)thisFrame.MacSA);
+
+	const Sdu* pSdu = &thisFrame.getNextSdu();
+	while (true)
+	{
+		unsigned short type = pSdu->getEtherType();
+		if ((type == CVlanEthertype) || (type == SVlanEthertype))
+			crc = crc32cWord(crc, ((const VlanTag&)(*pSdu)).Vtag.id);
+		else if (type == ITagEthertype)
+			crc = crc32cWord(crc, (ITag::getITag(*pSdu)).Itag.sid);
+		else
+			break;
+		pSdu = &pSdu->getNextSdu();
+	}
+	if (pSdu->getEtherType() == Ipv4Ethertype)
+	{
+		const FlowSdu& flow = FlowSdu::getFlowSdu(*pSdu);
+		crc = crc32cWord(crc, flow.sourceIp);
+		crc = crc32cWord(crc, flow.destinationIp);
+		crc = crc32cWord(crc, ((unsigned int)flow.sourcePort << 16) | flow.destinationPort);
+		crc = crc32cWord(crc, flow.protocol);
+	}
+	crc = ~crc;
+
+	return ((unsigned short)((crc ^ (crc >> 12) ^ (crc >> 24)) & 0x0fff));   // Fold to 12 bits
+}
+
 /*
  *  macAddrHash calculates 12-bit 1's complement sum of the DA and SA fields of the input frame
 /**/
@@ -998,7 +1477,7 @@ unsigned short LinkAgg::macAddrHash(Frame& thisFrame)
 	hash = (~hash) & 0x0fff;                 // Take 1's complement
 
 	/*
-	if (SimLog::Debug > 9)   
+	if (SimLog::Trace<9>())   
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   DA " << hex << thisFrame.MacDA
 			<< "  SA " << thisFrame.MacSA << "  sum " << sum << "  hash "
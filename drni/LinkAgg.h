@@ -16,6 +16,7 @@ limitations under the License.
 
 #pragma once
 #include "AggPort.h"
+#include "DataPlane.h"
 // #include "Aggregator.h"
 // #include "DistributedRelay.h"
 
@@ -41,16 +42,28 @@ public:
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	int nextEventTime() const;
+	void saveState(Snapshot& snap) const;
+	void restoreState(Snapshot& snap);
 
 //	bool LinkAgg::configDistRelay(unsigned short distRelayIndex, unsigned short numAggPorts, unsigned short numIrp, 
 //		sysId drniAggId, unsigned short defaultDrniKey, unsigned short firstLinkNum);
 	bool configDistRelay(unsigned short distRelayIndex, unsigned short numAggPorts, unsigned short numIrp,
 		sysId drniAggId, unsigned short defaultDrniKey, unsigned short firstLinkNum);
 
+	shared_ptr<const Forwarding> getForwarding() const;     // Forwarding most recently published by the control plane
+
 	static unsigned short frameConvID(LagAlgorithms algorithm, Frame& thisFrame);  // const??
 	static unsigned short macAddrHash(Frame& thisFrame);
+	static unsigned short flowHash(Frame& thisFrame);
 
 private:
+	int lastTransitionTime;      // Time of most recent LACP state machine transition (used by nextEventTime)
+	std::vector<unique_ptr<Frame>> rxBurst;     // Re-used for each burst of ingress Frames
+	shared_ptr<const Forwarding> pForwarding;   // Swapped with std::atomic_store, so data plane threads can keep using the old one
+	unique_ptr<DataPlane> pDataPlane;           // Threads running collection and distribution when SimLog::DataPlaneThreads > 1
+	std::vector<std::vector<unique_ptr<Frame>>> rxBursts;   // Ingress Frames of each data plane task
+
 	void resetCSDC();
 	void runCSDC();
 	void updatePartnerDistributionAlgorithm(AggPort& port);
@@ -74,9 +87,20 @@ private:
 	bool isInList(unsigned short val, const std::list<unsigned short>& thisList);
 	/**/
 
-	bool collectFrame(AggPort& thisPort, Frame& thisFrame);  // const??
+	/*
+	*   The data plane only reads the AggPorts and Aggregators through a Forwarding (see DataPlane.h).
+	*       publishForwarding replaces pForwarding if anything in it has changed since it was published.
+	*       collect and distribute each move one burst of frames at an AggPort or Aggregator, and only touch the queues of
+	*       that AggPort or Aggregator and (when distributing) the AggPorts attached to the Aggregator, so the data plane
+	*       of different Aggregators can run in different threads.
+	*/
+	void publishForwarding();
+	void collect(const Forwarding& fwd, unsigned short portIndex, size_t maxBurst, std::vector<unique_ptr<Frame>>& burst);
+	void distribute(const Forwarding& fwd, unsigned short aggIndex, size_t maxBurst);
+	void runDataPlane(bool collecting, size_t maxBurst);    // Collect at all AggPorts, or distribute at all Aggregators
+	bool collectFrame(const Forwarding& fwd, unsigned short portIndex, Frame& thisFrame) const;
 //	shared_ptr<AggPort> LinkAgg::distributeFrame(Aggregator& thisAgg, Frame& thisFrame);
-	shared_ptr<AggPort> distributeFrame(Aggregator& thisAgg, Frame& thisFrame);
+	int distributeFrame(const Forwarding& fwd, unsigned short aggIndex, Frame& thisFrame) const;   // Egress AggPort index, or -1
 
 //	static class LacpSelection
 	class LacpSelection
@@ -87,11 +111,60 @@ private:
 		static void adminAggregatorUpdate(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators);
 
 	private:
-		static int findMatchingAggregator(int thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts);
+		/*
+		*   SelectionIndex holds hash indexes of the AggPorts by partner (System ID, Port ID), and of the Aggregators by
+		*     LAG ID (actor and partner System ID and Key) and by actor System ID and Key, so runSelection finds moved
+		*     partners and matching or available Aggregators without scanning every AggPort for each port it selects.
+		*     It is built the first time a run of runSelection needs it (most runs have no port to select), and is
+		*     updated when runSelection changes the partner half of an Aggregator's LAG ID.  The other fields it is keyed 
+		*     on (partner information, actor keys) only change outside runSelection.  Each entry lists AggPort or Aggregator
+		*     indexes in ascending order, so using the index gives the same result as a linear scan.
+		*/
+		class SelectionIndex
+		{
+		public:
+			SelectionIndex(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators);
+
+			const std::vector<unsigned short>& portsWithPartner(const AggPort& port);      // Same partner System and Port as port
+			const std::vector<unsigned short>& aggregatorsWithLagid(const AggPort& port);  // Aggregator LAG ID same as port
+			const std::vector<unsigned short>& aggregatorsWithKey(const AggPort& port);    // Aggregator actor System and Key same as port
+			void setAggregatorPartner(unsigned short ax, unsigned long long partnerSystem, unsigned short partnerKey);
+
+		private:
+			struct Key
+			{
+				unsigned long long systemA;
+				unsigned long long systemB;
+				unsigned long keyA;
+				unsigned long keyB;
+				bool operator== (const Key& other) const;
+			};
+			struct KeyHash
+			{
+				size_t operator() (const Key& key) const;
+			};
+			typedef std::unordered_map<Key, std::vector<unsigned short>, KeyHash> Table;
+
+			std::vector<shared_ptr<AggPort>>& pAggPorts;
+			std::vector<shared_ptr<Aggregator>>& pAggregators;
+			bool built;
+			Table partnerPorts;
+			Table lagidAggregators;
+			Table keyAggregators;
+			const std::vector<unsigned short> none;
+
+			void build();
+			static Key lagidKey(const Aggregator& agg);
+			static const std::vector<unsigned short>& find(const Table& table, const Key& key, const std::vector<unsigned short>& none);
+		};
+
+		static int findMatchingAggregator(int thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts,
+			std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index);
 		static bool matchAggregatorLagid(AggPort& port, Aggregator& agg);
 		static bool allowableAggregator(AggPort& port, Aggregator& agg);
 		static void clearAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts);
-		static int findAvailableAggregator(AggPort& thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators);
+		static int findAvailableAggregator(AggPort& thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts, 
+			std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index);
 		static bool activeAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts);
 	};
 
@@ -0,0 +1,123 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "LinkChannel.h"
+#include "Snapshot.h"
+
+
+LinkChannel::LinkChannel()
+	: head(0), tail(0)
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "LinkChannel::Capacity must be a power of two");
+	drops = 0;
+}
+
+LinkChannel::~LinkChannel()
+{
+	clear();
+}
+
+bool LinkChannel::push(unique_ptr<Frame> pFrame, int time)
+{
+	size_t pushed = tail.load(std::memory_order_relaxed);
+	if (pushed - head.load(std::memory_order_acquire) >= Capacity)   // Consumer has not yet freed a slot
+	{
+		drops++;
+		return (false);
+	}
+	Slot& slot = ring[pushed & (Capacity - 1)];
+	slot.time = time;
+	slot.pFrame = move(pFrame);
+	tail.store(pushed + 1, std::memory_order_release);               // Slot is visible to the consumer once tail passes it
+	return (true);
+}
+
+unique_ptr<Frame> LinkChannel::pop(int before)
+{
+	size_t popped = head.load(std::memory_order_relaxed);
+	if (popped == tail.load(std::memory_order_acquire))
+		return (nullptr);
+	Slot& slot = ring[popped & (Capacity - 1)];
+	if (slot.time >= before)
+		return (nullptr);
+	unique_ptr<Frame> pFrame = move(slot.pFrame);
+	head.store(popped + 1, std::memory_order_release);               // Slot can be re-used by the producer once head passes it
+	return (pFrame);
+}
+
+bool LinkChannel::arrived(int before) const
+{
+	size_t popped = head.load(std::memory_order_relaxed);
+	return ((popped != tail.load(std::memory_order_acquire)) && (ring[popped & (Capacity - 1)].time < before));
+}
+
+int LinkChannel::frontTime() const
+{
+	size_t popped = head.load(std::memory_order_relaxed);
+	if (popped == tail.load(std::memory_order_acquire))
+		return (SimLog::EndOfTime);
+	return (ring[popped & (Capacity - 1)].time);
+}
+
+bool LinkChannel::empty() const
+{
+	return (head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire));
+}
+
+void LinkChannel::clear()
+{
+	size_t pushed = tail.load(std::memory_order_acquire);
+	for (size_t i = head.load(std::memory_order_relaxed); i != pushed; i++)
+		ring[i & (Capacity - 1)].pFrame = nullptr;
+	head.store(pushed, std::memory_order_release);
+}
+
+unsigned long long LinkChannel::getDrops() const
+{
+	return (drops);
+}
+
+void LinkChannel::saveState(Snapshot& snap) const
+{
+	size_t popped = head.load(std::memory_order_acquire);
+	size_t pushed = tail.load(std::memory_order_acquire);
+	snap.put(drops);
+	snap.put(pushed - popped);
+	for (size_t i = popped; i != pushed; i++)
+	{
+		snap.put(ring[i & (Capacity - 1)].time);
+		Frame::saveFrame(snap, ring[i & (Capacity - 1)].pFrame);
+	}
+}
+
+void LinkChannel::restoreState(Snapshot& snap)
+{
+	size_t savedCount = 0;
+
+	clear();
+	head.store(0, std::memory_order_relaxed);
+	tail.store(0, std::memory_order_relaxed);
+	snap.get(drops);
+	snap.get(savedCount);
+	savedCount = std::min(savedCount, Capacity);
+	for (size_t i = 0; (i < savedCount) && snap.good(); i++)
+	{
+		snap.get(ring[i].time);
+		ring[i].pFrame = Frame::restoreFrame(snap);
+	}
+	tail.store(savedCount, std::memory_order_release);
+}
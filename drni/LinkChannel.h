@@ -0,0 +1,72 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Frame.h"
+
+class Snapshot;
+
+
+/*
+*   Class LinkChannel carries Frames in one direction of a Link between two Macs (see Mac::Connect), from Mac::Transmit
+*       of one Mac to the indications queue of the other.  Each Mac owns the channel it receives on, so a Link is the
+*       pair of channels of its two Macs.
+*   The channel is a lock-free single-producer/single-consumer ring buffer.  Only the transmitting Mac pushes and only
+*       the receiving Mac pops, so the Devices at each end of a Link can run in different threads without locks.
+*       The producer writes a slot and then advances tail, and the consumer moves the Frame out of a slot and then
+*       advances head, so each side only needs to read the other side's index.
+*   Each Frame is stamped with the Time it was delivered to the Link partner (the transmit Time plus the link delay).
+*       The receiving Mac only takes Frames delivered before the current Time, so it receives the same Frames whether
+*       the other Device has already transmitted in the current Time increment or not.  
+*   The ring has a fixed Capacity.  A Mac transmits at most one Frame per Time increment, and its partner takes all
+*       delivered Frames each Time increment (see Mac::Receive), so the ring never holds more than a few Frames.
+*       A Frame pushed to a full ring is discarded and counted.
+*   clear, saveState and restoreState touch both ends of the ring, so are only used while neither Device is running.
+*/
+
+class LinkChannel
+{
+public:
+	LinkChannel();
+	~LinkChannel();
+	LinkChannel(LinkChannel& copySource) = delete;             // Disable copy constructor
+	LinkChannel& operator= (const LinkChannel&) = delete;      // Disable assignment operator
+
+	static const size_t Capacity = 16;                     // Must be a power of two
+
+	bool push(unique_ptr<Frame> pFrame, int time);         // Producer:  Returns false, and discards the Frame, if ring is full
+	unique_ptr<Frame> pop(int before);                     // Consumer:  Front Frame if delivered before Time before, else nullptr
+	bool arrived(int before) const;                        // Consumer:  True if pop(before) would return a Frame
+	int frontTime() const;                                 // Consumer:  Delivery Time of the front Frame (EndOfTime if empty)
+	bool empty() const;
+	void clear();                                          // Discards all Frames in the ring (not counted as drops)
+	unsigned long long getDrops() const;
+
+	void saveState(Snapshot& snap) const;                  // Copy Frames (with delivery Time) to or from a Snapshot
+	void restoreState(Snapshot& snap);
+
+private:
+	struct Slot
+	{
+		int time;
+		unique_ptr<Frame> pFrame;
+	};
+
+	std::array<Slot, Capacity> ring;
+	std::atomic<size_t> head;                              // Count of Frames popped (written only by the consumer)
+	std::atomic<size_t> tail;                              // Count of Frames pushed (written only by the producer)
+	unsigned long long drops;                              // Written only by the producer
+};
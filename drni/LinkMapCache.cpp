@@ -0,0 +1,90 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "LinkMapCache.h"
+
+
+std::unordered_map<LinkMapCache::Key, shared_ptr<const LinkMapCache::LinkVector>, LinkMapCache::KeyHash> LinkMapCache::tables;
+std::mutex LinkMapCache::cacheMutex;
+unsigned long long LinkMapCache::nextAdminMapId = 1;      // Zero is used for the fixed (not administered) maps
+unsigned long long LinkMapCache::hits = 0;
+unsigned long long LinkMapCache::misses = 0;
+
+
+bool LinkMapCache::Key::operator== (const Key& other) const
+{
+	return ((linkMap == other.linkMap) && (adminMapId == other.adminMapId) && (links == other.links));
+}
+
+size_t LinkMapCache::KeyHash::operator() (const Key& key) const
+{
+	size_t hash = std::hash<unsigned long long>()((key.adminMapId << 8) ^ (unsigned long long)key.linkMap);
+	for (auto link : key.links)
+		hash = (hash * 31) + link;
+	return (hash);
+}
+
+shared_ptr<const LinkMapCache::LinkVector> LinkMapCache::find(int linkMap, unsigned long long adminMapId, const IdList& links)
+{
+	Key key = { linkMap, adminMapId, links };
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	auto entry = tables.find(key);
+	if (entry == tables.end())
+	{
+		misses++;
+		return (nullptr);
+	}
+	hits++;
+	return (entry->second);
+}
+
+shared_ptr<const LinkMapCache::LinkVector> LinkMapCache::insert(int linkMap, unsigned long long adminMapId, const IdList& links,
+	shared_ptr<const LinkVector> pTable)
+{
+	Key key = { linkMap, adminMapId, links };
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	if (tables.size() >= MaxEntries)
+		tables.clear();                                    // Tables still in use are kept by their users
+	auto entry = tables.emplace(key, pTable);              // Keeps the existing table if another thread got there first
+	return (entry.first->second);
+}
+
+unsigned long long LinkMapCache::newAdminMapId()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return (nextAdminMapId++);
+}
+
+void LinkMapCache::clear()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	tables.clear();
+	hits = 0;
+	misses = 0;
+}
+
+unsigned long long LinkMapCache::getHits()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return (hits);
+}
+
+unsigned long long LinkMapCache::getMisses()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return (misses);
+}
@@ -0,0 +1,65 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "IdList.h"
+
+
+/*
+*   Class LinkMapCache holds the Conversation ID to Link Number tables (conversationLinkVector) computed by
+*       Aggregator::updateConversationLinkVector, so a LAG that returns to a set of active links it has had before
+*       (or that another LAG already has) shares the existing table rather than computing a new one.
+*   A table is identified by the conversation link map (Aggregator::convLinkMaps), the sorted list of active Link
+*       Numbers, and for ADMIN_TABLE an identifier of the contents of the Aggregator's adminConversationLinkMap
+*       (newAdminMapId() gives a new identifier each time an administered map is set or restored).
+*   Tables are immutable once inserted and are shared through shared_ptr, so a table stays valid for as long as any
+*       Aggregator or Distributed Relay uses it, even after the cache is cleared.  When the cache holds MaxEntries tables
+*       it is cleared before the next insert.  The cache is shared by all threads, under a lock.
+*/
+
+class LinkMapCache
+{
+public:
+	typedef std::array<unsigned short, 4096> LinkVector;
+	static const size_t MaxEntries = 1024;
+
+	static shared_ptr<const LinkVector> find(int linkMap, unsigned long long adminMapId, const IdList& links);   // nullptr if not cached
+	static shared_ptr<const LinkVector> insert(int linkMap, unsigned long long adminMapId, const IdList& links,
+		shared_ptr<const LinkVector> pTable);                     // Returns the cached table (an equal one if already there)
+	static unsigned long long newAdminMapId();
+	static void clear();
+	static unsigned long long getHits();
+	static unsigned long long getMisses();
+
+private:
+	struct Key
+	{
+		int linkMap;
+		unsigned long long adminMapId;
+		IdList links;
+		bool operator== (const Key& other) const;
+	};
+	struct KeyHash
+	{
+		size_t operator() (const Key& key) const;
+	};
+
+	static std::unordered_map<Key, shared_ptr<const LinkVector>, KeyHash> tables;
+	static std::mutex cacheMutex;
+	static unsigned long long nextAdminMapId;
+	static unsigned long long hits;
+	static unsigned long long misses;
+};
@@ -0,0 +1,108 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "LogWriter.h"
+
+
+
+LogWriter::LogWriter(std::string fileName, std::ios_base::openmode mode)
+	: fileName(fileName), mode(mode)
+{
+	stopWriter = false;
+}
+
+LogWriter::~LogWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopWriter = true;
+	}
+	blockReady.notify_one();
+	if (writer.joinable())
+		writer.join();
+}
+
+void LogWriter::submit(std::string&& block)
+{
+	if (block.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		blocks.push(move(block));
+		if (!writer.joinable())
+			writer = std::thread(&LogWriter::writerLoop, this);
+	}
+	blockReady.notify_one();
+}
+
+void LogWriter::writerLoop()
+{
+	file.open(fileName, mode);
+
+	std::unique_lock<std::mutex> lock(queueMutex);
+	while (true)
+	{
+		blockReady.wait(lock, [this] { return (stopWriter || !blocks.empty()); });
+		while (!blocks.empty())
+		{
+			std::string block = move(blocks.front());
+			blocks.pop();
+			lock.unlock();                                  // Don't hold up threads submitting blocks while writing
+			file.write(block.data(), block.size());
+			lock.lock();
+		}
+		if (stopWriter)
+			break;
+	}
+	file.flush();
+}
+
+
+
+LogBuffer::LogBuffer(LogWriter& writer)
+	: writer(writer), block(BlockSize)
+{
+	setp(block.data(), block.data() + block.size());
+}
+
+LogBuffer::~LogBuffer()
+{
+	submitBlock();
+}
+
+LogBuffer::int_type LogBuffer::overflow(int_type ch)
+{
+	submitBlock();
+	if (!traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+	return (traits_type::not_eof(ch));
+}
+
+int LogBuffer::sync()
+{
+	return (0);
+}
+
+void LogBuffer::submitBlock()
+{
+	writer.submit(std::string(pbase(), pptr()));
+	setp(block.data(), block.data() + block.size());
+}
@@ -0,0 +1,74 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+
+/*
+*   Class LogWriter writes blocks of output to a file from a background thread, so the threads generating the output
+*       never wait for the file.  The file is opened (and the thread started) when the first block is submitted.
+*       Any blocks not yet written when the LogWriter is destroyed are written before the thread is stopped.
+*   Class LogBuffer is a stream buffer that collects output in blocks of BlockSize characters and submits each full block
+*       to a LogWriter.  Flushing the stream (e.g. with endl) does not write to the file, so a message costs only copying
+*       the characters to the buffer.  Each thread has its own LogBuffer for the logFile, and any partial block is submitted
+*       when the thread exits.
+*/
+
+class LogWriter
+{
+public:
+	LogWriter(std::string fileName, std::ios_base::openmode mode = std::ios_base::out);
+	~LogWriter();
+	LogWriter(LogWriter& copySource) = delete;             // Disable copy constructor
+	LogWriter& operator= (const LogWriter&) = delete;      // Disable assignment operator
+
+	void submit(std::string&& block);                      // Queue a block to be written to the file
+
+private:
+	std::string fileName;
+	std::ios_base::openmode mode;
+	std::ofstream file;
+	std::thread writer;
+	std::mutex queueMutex;
+	std::condition_variable blockReady;
+	std::queue<std::string> blocks;
+	bool stopWriter;
+
+	void writerLoop();
+};
+
+
+class LogBuffer : public std::streambuf
+{
+public:
+	static const size_t BlockSize = 64 * 1024;
+
+	LogBuffer(LogWriter& writer);
+	~LogBuffer();                                          // Submits any partial block
+	LogBuffer(LogBuffer& copySource) = delete;             // Disable copy constructor
+	LogBuffer& operator= (const LogBuffer&) = delete;      // Disable assignment operator
+
+protected:
+	int_type overflow(int_type ch) override;               // Called when the block is full
+	int sync() override;                                   // Flush does not write to file
+
+private:
+	LogWriter& writer;
+	std::vector<char> block;
+
+	void submitBlock();
+};
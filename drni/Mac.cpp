@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Mac.h"
+#include "Snapshot.h"
+#include "Partition.h"
 
 /**/
 Iss::Iss()
@@ -45,6 +47,50 @@ bool Iss::getOperational() const
 {
 	return enabled;
 }
+
+size_t Iss::IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max)
+{
+	size_t count = 0;
+	while (count < max)
+	{
+		unique_ptr<Frame> pFrame = Indication();
+		if (!pFrame)
+			break;
+		frames.push_back(std::move(pFrame));
+		count++;
+	}
+	return (count);
+}
+
+void Iss::RequestBurst(std::vector<unique_ptr<Frame>>& frames)
+{
+	for (auto& pFrame : frames)
+	{
+		Request(std::move(pFrame));
+	}
+	frames.clear();
+}
+
+size_t Iss::popBurst(FrameQueue& queue, std::vector<unique_ptr<Frame>>& frames, size_t max)
+{
+	size_t count = 0;
+	while ((count < max) && !queue.empty())
+	{
+		frames.push_back(std::move(queue.front()));
+		queue.pop();
+		count++;
+	}
+	return (count);
+}
+
+void Iss::pushBurst(FrameQueue& queue, std::vector<unique_ptr<Frame>>& frames)
+{
+	for (auto& pFrame : frames)
+	{
+		pFrame->TimeStamp = SimLog::Time;   // Use frame time stamp to measure residence time in queue
+		queue.push(std::move(pFrame));
+	}
+}
 /**/
 
 
@@ -84,7 +130,40 @@ unique_ptr<Frame> IssQ::Indication()
 		}
 }
 
-iLinkHalf::iLinkHalf(std::queue<unique_ptr<Frame>>& req, std::queue<unique_ptr<Frame>>& ind, unsigned long long addr)
+size_t IssQ::IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max)
+{
+	return (popBurst(indications, frames, max));
+}
+
+void IssQ::RequestBurst(std::vector<unique_ptr<Frame>>& frames)
+{
+	if (getOperational())
+		pushBurst(requests, frames);  // Requests sent to a non-operational ISS will be discarded.
+	frames.clear();
+}
+
+void IssQ::setQueueDepth(size_t depth)
+{
+	requests.setDepth(depth);
+	indications.setDepth(depth);
+}
+
+size_t IssQ::getQueueDepth() const
+{
+	return (requests.getDepth());
+}
+
+unsigned long long IssQ::getDroppedRequests() const
+{
+	return (requests.getDrops());
+}
+
+unsigned long long IssQ::getDroppedIndications() const
+{
+	return (indications.getDrops());
+}
+
+iLinkHalf::iLinkHalf(FrameQueue& req, FrameQueue& ind, unsigned long long addr)
 	: requests(req), indications(ind), macAddress(addr)
 {
 	std::cout << "    iLinkHalf Constructor called." << std::endl;
@@ -125,6 +204,20 @@ unique_ptr<Frame> iLinkHalf::Indication()
 	}
 }
 
+size_t iLinkHalf::IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max)
+{
+	return (popBurst(indications, frames, max));
+}
+
+void iLinkHalf::RequestBurst(std::vector<unique_ptr<Frame>>& frames)
+{
+	if (getOperational())
+	{
+		pushBurst(requests, frames);  // Requests sent to a non-operational ISS will be discarded.
+	}
+	frames.clear();
+}
+
 iLink::iLink(unsigned long long EastAddr, unsigned long long WestAddr)   
 {
 	std::cout << "iLink Constructor called." << std::endl;
@@ -132,8 +225,8 @@ iLink::iLink(unsigned long long EastAddr, unsigned long long WestAddr)
 	if (!WestAddr)
 		WestAddr = EastAddr;
 
-	pEastToWestQueue = make_unique<std::queue<unique_ptr<Frame>>>();
-	pWestToEastQueue = make_unique<std::queue<unique_ptr<Frame>>>();
+	pEastToWestQueue = make_unique<FrameQueue>();
+	pWestToEastQueue = make_unique<FrameQueue>();
 
 	pEast = make_shared<iLinkHalf>(*pEastToWestQueue, *pWestToEastQueue, EastAddr);
 	pWest = make_shared<iLinkHalf>(*pWestToEastQueue, *pEastToWestQueue, WestAddr);
@@ -183,6 +276,11 @@ void Component::setSuspended(bool val)
 	suspended = val;
 }
 
+int Component::nextEventTime() const
+{
+	return (SimLog::Time);       // Unless the derived class knows better, assume there is work to do every Time increment
+}
+
 /**/
 
 
@@ -193,6 +291,7 @@ Mac::Mac()
 	macAddress = defaultOUI;
 //	macId.id = 0;
 	linkPartner = nullptr;
+	txFrameCount = 0;
 //	std::cout << "Mac Constructor called" << std::endl;
 };
 
@@ -203,6 +302,7 @@ Mac::Mac(unsigned short dev, unsigned short sap)
 	macAddress = defaultOUI + (dev * 0x10000) + sap;
 	macId.dev = dev;
 	macId.sap = sap;
+	txFrameCount = 0;
 //	std::cout << "Mac Constructor called:  device = " << macId.dev << "  sapId = " << macId.sap << std::endl;
 }
 
@@ -230,7 +330,7 @@ void Mac::setEnabled(bool val)
 
 bool Mac::getOperational() const
 {
-	return (enabled && linkPartner && linkPartner->enabled);
+	return (enabled && ((linkPartner && linkPartner->enabled) || (pRemote && pRemote->partnerUp)));
 }
 
 void Mac::Request(unique_ptr<Frame> pFrameIn)
@@ -254,6 +354,20 @@ unique_ptr<Frame> Mac::Indication()
 	}
 }
 
+size_t Mac::IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max)
+{
+	if (suspended)
+		return (0);
+	return (popBurst(indications, frames, max));
+}
+
+void Mac::RequestBurst(std::vector<unique_ptr<Frame>>& frames)
+{
+	if (getOperational() && !suspended)
+		pushBurst(requests, frames);  // Requests sent to a non-operational ISS will be discarded.
+	frames.clear();
+}
+
 void Mac::setAdminPointToPoint(adminValues val)
 {
 	adminPointToPoint = val;
@@ -302,12 +416,29 @@ unsigned long Mac::getMacId() const
 	return macId.id;
 }
 
+unsigned long long Mac::getTxFrameCount() const
+{
+	return txFrameCount;
+}
+
+const Histogram& Mac::getQueueResidence() const
+{
+	return queueResidence;
+}
+
+void Mac::clearStats()
+{
+	txFrameCount = 0;
+	queueResidence.clear();
+}
+
 void Mac::reset()
 {
 	while (!requests.empty())        // Flush all frames in flight
 		requests.pop();
 	while (!indications.empty())     // Flush all frames already delivered 
 		indications.pop();
+	arrivals.clear();
 }
 
 void Mac::timerTick()
@@ -326,6 +457,27 @@ void Mac::run(bool singleStep)
 	}
 }
 
+int Mac::nextEventTime() const
+{
+	int nextTime = SimLog::EndOfTime;
+
+	if (!suspended)
+	{
+		if (!indications.empty())                               // If frames waiting to be picked up by client
+			nextTime = SimLog::Time;                            //    then client needs to run now
+		else if (!requests.empty())                             // If frames waiting to be transmitted
+		{
+			if (getOperational() && !pRemote)
+				nextTime = std::max(SimLog::Time, (requests.front())->TimeStamp + linkDelay);  // Frame delivered after link delay
+			else
+				nextTime = SimLog::Time;                        //    else requests will be sent to another Partition or flushed now
+		}
+		if (!arrivals.empty())                                  // Frames are received the Time increment after delivery
+			nextTime = std::min(nextTime, std::max(SimLog::Time, arrivals.frontTime() + 1));
+	}
+	return (nextTime);
+}
+
 
 void Mac::Transmit()
 {
@@ -333,14 +485,25 @@ void Mac::Transmit()
 	{
 		if (getOperational())
 		{
-			unsigned short txTime = (requests.front())->TimeStamp;
-			if (SimLog::Time >= (txTime + linkDelay))
+			int txTime = (requests.front())->TimeStamp;
+			if (pRemote)    // Partner in another Partition:  send now, with the Time it would be delivered on a local Link
+			{
+				int deliveryTime = std::max(std::max(SimLog::Time, txTime + linkDelay), pRemote->lastDelivery + 1);
+				pRemote->outbound.push_back(std::make_pair(deliveryTime, std::move(requests.front())));
+				requests.pop();
+				pRemote->lastDelivery = deliveryTime;
+				txFrameCount++;
+				queueResidence.add(deliveryTime - txTime);
+			}
+			else if (SimLog::Time >= (txTime + linkDelay))
 			{
 				unique_ptr<Frame> pTempFrame = std::move(requests.front());     // move the pointer to the frame from the requests queue to the temp variable
 				requests.pop();                                                 // pop the null pointer left on the queue after the move
 				if (linkPartner && linkPartner->enabled && !(linkPartner->suspended))
 				{
-					linkPartner->indications.push(std::move(pTempFrame));       // push the pointer to the frame onto the other MAC indications queue
+					linkPartner->arrivals.push(std::move(pTempFrame), SimLog::Time);   // push the frame onto the other MAC arrivals channel
+					txFrameCount++;
+					queueResidence.add(SimLog::Time - txTime);
 				}
 			}
 		}
@@ -355,15 +518,24 @@ void Mac::Transmit()
 }
 
 
+void Mac::Receive()
+{
+	while (unique_ptr<Frame> pFrame = arrivals.pop(SimLog::Time))    // Frames the partner delivered in earlier Time increments
+	{
+		indications.push(std::move(pFrame));
+	}
+}
+
+
 void Mac::Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay)
 {
-	if (macA->linkPartner) Disconnect(macA);
-	if (macB->linkPartner) Disconnect(macB);
+	if (macA->linkPartner || macA->pRemote) Disconnect(macA);
+	if (macB->linkPartner || macB->pRemote) Disconnect(macB);
 
-	if (SimLog::Debug > 0) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
+	if (SimLog::Trace<0>()) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
 		<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 		<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
-	cout << endl << "Time " << SimLog::Time << ":    ***** Connecting  " 
+	SimLog::console << endl << "Time " << SimLog::Time << ":    ***** Connecting  " 
 		<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 		<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
 
@@ -377,10 +549,10 @@ void Mac::Disconnect(shared_ptr<Mac> macA)
 {
 	if (macA->linkPartner)
 	{
-		if (SimLog::Debug > 0) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
+		if (SimLog::Trace<0>()) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
 			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 			<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
-		cout << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
+		SimLog::console << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
 			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 			<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
 
@@ -398,8 +570,93 @@ void Mac::Disconnect(shared_ptr<Mac> macA)
 //			macA->indications.pop();
 		macA->linkPartner = nullptr;             // clear this Mac's link
 	}
+	if (macA->pRemote)                           // Partition reports the Link down to the other Partition
+	{
+		while (!(macA->requests.empty()))
+			macA->requests.pop();
+		macA->pRemote = nullptr;
+	}
 }
 
 
+/**/
+
+void Iss::saveState(Snapshot& snap) const
+{
+	snap.put(enabled);
+	snap.put(operPointToPoint);
+	snap.put(adminPointToPoint);
+}
 
+void Iss::restoreState(Snapshot& snap)
+{
+	snap.get(enabled);
+	snap.get(operPointToPoint);
+	snap.get(adminPointToPoint);
+}
+
+void IssQ::saveState(Snapshot& snap) const
+{
+	Iss::saveState(snap);
+	requests.saveState(snap);
+	indications.saveState(snap);
+}
+
+void IssQ::restoreState(Snapshot& snap)
+{
+	Iss::restoreState(snap);
+	requests.restoreState(snap);
+	indications.restoreState(snap);
+}
+
+void iLinkHalf::saveState(Snapshot& snap) const
+{
+	Iss::saveState(snap);
+	snap.put(macAddress);
+}
 
+void iLinkHalf::restoreState(Snapshot& snap)
+{
+	Iss::restoreState(snap);
+	snap.get(macAddress);
+}
+
+void iLink::saveState(Snapshot& snap) const
+{
+	pEastToWestQueue->saveState(snap);
+	pWestToEastQueue->saveState(snap);
+	pEast->saveState(snap);
+	pWest->saveState(snap);
+}
+
+void iLink::restoreState(Snapshot& snap)
+{
+	pEastToWestQueue->restoreState(snap);
+	pWestToEastQueue->restoreState(snap);
+	pEast->restoreState(snap);
+	pWest->restoreState(snap);
+}
+
+void Mac::saveState(Snapshot& snap) const
+{
+	IssQ::saveState(snap);
+	snap.put(suspended);
+	snap.put(macAddress);
+	snap.put(macId);
+	snap.putMac(linkPartner.get());
+	snap.put(linkDelay);
+	arrivals.saveState(snap);
+	// txFrameCount and queueResidence are statistics (see Stats.h), so are not saved
+}
+
+void Mac::restoreState(Snapshot& snap)
+{
+	IssQ::restoreState(snap);
+	snap.get(suspended);
+	snap.get(macAddress);
+	snap.get(macId);
+	linkPartner = snap.getMac();
+	snap.get(linkDelay);
+	arrivals.restoreState(snap);
+	// txFrameCount and queueResidence are statistics (see Stats.h), so are not saved
+}
@@ -15,7 +15,11 @@ limitations under the License.
 */
 
 #pragma once
-#include "Frame.h"
+#include "FrameQueue.h"
+#include "LinkChannel.h"
+#include "Stats.h"
+
+class RemoteLink;
 // #include "queue.h"
 
 
@@ -50,7 +54,19 @@ public:
 	virtual unique_ptr<Frame> Indication() = 0;            // Returns an Indication (ingress frame) to client; Returns nullptr if no indication
 	virtual void Request(unique_ptr<Frame> pFrameIn) = 0;  // Accepts a Request f (egress frame) from client
 
+	// Burst variants move a batch of frames in one call.  The client owns (and re-uses) the vector, so no allocation is needed.
+	//     The default implementations call Indication/Request once per frame; classes with queues override them.
+	virtual size_t IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max);  // Appends up to max Indications to frames; Returns number appended
+	virtual void RequestBurst(std::vector<unique_ptr<Frame>>& frames);                  // Accepts all Requests in frames; Leaves frames empty
+	static const size_t MaxBurst = 32;                     // Most frames a client takes from an Iss in one pass when not single-stepping
+
+	void saveState(Snapshot& snap) const;                  // Copy variables to or from a Snapshot (see Snapshot.h)
+	void restoreState(Snapshot& snap);
+
 protected:
+	static size_t popBurst(FrameQueue& queue, std::vector<unique_ptr<Frame>>& frames, size_t max);
+	static void pushBurst(FrameQueue& queue, std::vector<unique_ptr<Frame>>& frames);
+
 	bool enabled;         // Read-only by the client;  the derived class determines when/how this variable is set/cleared.
 	bool operPointToPoint;    // Read-only by the client;  the derived class determines when/how this variable is set/cleared.
 	adminValues adminPointToPoint;  // Not accessible by the client;  the derived class determines when/how this variable is set/cleared.
@@ -59,6 +75,7 @@ protected:
 
 /*
 *  IssQ is a variant of an Iss that provides indication and request queues at the SAP.
+*    The queues are bounded (see FrameQueue), so Frames arriving at a full queue are discarded and counted.
 */
 
 class IssQ : public Iss
@@ -71,10 +88,20 @@ public:
 
 	virtual void Request(unique_ptr<Frame> pFrameIn) override;
 	virtual unique_ptr<Frame> Indication() override;
+	virtual size_t IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max) override;
+	virtual void RequestBurst(std::vector<unique_ptr<Frame>>& frames) override;
+
+	void setQueueDepth(size_t depth);                      // Sets the maximum number of Frames in each of the request and indication queues
+	size_t getQueueDepth() const;
+	unsigned long long getDroppedRequests() const;         // Frames discarded because the request queue was full
+	unsigned long long getDroppedIndications() const;      // Frames discarded because the indication queue was full
+
+	void saveState(Snapshot& snap) const;                  // Copy Iss variables and queued Frames to or from a Snapshot
+	void restoreState(Snapshot& snap);
 
 protected:         
-	std::queue<unique_ptr<Frame>> requests;     
-	std::queue<unique_ptr<Frame>> indications;
+	FrameQueue requests;     
+	FrameQueue indications;
 };
 
 class iLinkHalf : public Iss
@@ -82,19 +109,23 @@ class iLinkHalf : public Iss
 	friend class iLink;
 
 public:
-	iLinkHalf(std::queue<unique_ptr<Frame>>& req, std::queue<unique_ptr<Frame>>& ind, unsigned long long addr = 0);
+	iLinkHalf(FrameQueue& req, FrameQueue& ind, unsigned long long addr = 0);
 	~iLinkHalf();
 	iLinkHalf(iLinkHalf& copySource) = delete;             // Disable copy constructor
 	iLinkHalf& operator= (const iLinkHalf&) = delete;      // Disable assignment operator
 
 	virtual void Request(unique_ptr<Frame> pFrameIn) override;
 	virtual unique_ptr<Frame> Indication() override;
+	virtual size_t IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max) override;
+	virtual void RequestBurst(std::vector<unique_ptr<Frame>>& frames) override;
 	virtual unsigned long long getMacAddress() const;
 
+	void saveState(Snapshot& snap) const;                  // Copy Iss variables to or from a Snapshot (queues are saved by the iLink)
+	void restoreState(Snapshot& snap);
 
 protected:
-	std::queue<unique_ptr<Frame>>& requests;
-	std::queue<unique_ptr<Frame>>& indications;
+	FrameQueue& requests;
+	FrameQueue& indications;
 	unsigned long long macAddress;
 
 };
@@ -107,18 +138,20 @@ public:
 	iLink(iLink& copySource) = delete;             // Disable copy constructor
 	iLink& operator= (const iLink&) = delete;      // Disable assignment operator
 
-	unique_ptr<std::queue<unique_ptr<Frame>>> pEastToWestQueue;
-	unique_ptr<std::queue<unique_ptr<Frame>>> pWestToEastQueue;
+	unique_ptr<FrameQueue> pEastToWestQueue;
+	unique_ptr<FrameQueue> pWestToEastQueue;
 
 	shared_ptr<iLinkHalf> pEast;
 	shared_ptr<iLinkHalf> pWest;
 
+	void saveState(Snapshot& snap) const;                  // Copy queued Frames and both halves to or from a Snapshot
+	void restoreState(Snapshot& snap);
 };
 
 
 union macIdentifier
 {
-	unsigned long id;
+	unsigned int id;                     // 32 bits, so sap and dev cover all of it
 	struct
 	{
 		unsigned short sap;
@@ -148,6 +181,11 @@ public:
 	virtual void timerTick() = 0;              // Decrements any timers associated with this component (when not suspended).
 	virtual void run(bool singleStep) = 0;     // Executes operational methods of the component (when not suspended).
 
+	virtual int nextEventTime() const;         // Earliest Time the component needs to run again (SimLog::Time if busy).
+	//     Default assumes the component is always busy.  Called after a Time increment by the Simulation scheduler.
+	virtual void saveState(Snapshot& snap) const = 0;    // Copies operational and administrative variables to a Snapshot
+	virtual void restoreState(Snapshot& snap) = 0;       // Copies them back from a Snapshot (see Snapshot.h)
+
 protected:
 	ComponentTypes type;      // Read-only by the simulation;  set by the constructor
 	bool suspended;           // Read-write by the simulation;  inhibits timerTick() and run() operations
@@ -164,6 +202,11 @@ protected:
 *      Frames across those Links.  Per the IEEE 802 Client/Service model, a service request from a client at the SAP
 *      of one MAC results in a service indication (with identical parameters) provided to the client at the SAP of the
 *      connected MAC after a Link specific time delay.
+*   Transmit puts a Frame, when the link delay has passed, on the arrivals channel of the connected MAC (see LinkChannel.h)
+*      and Receive (called when the Device's timers are ticked) moves it to the indications queue in the next Time 
+*      increment.  Since neither touches the queues of the other MAC, Devices can transmit and receive in parallel.
+*   A Mac connected to a Mac in another Partition (see Partition.h) has a RemoteLink rather than a linkPartner.
+*      Transmit then sends each Frame as soon as it is requested, stamped with the Time it will be delivered.
 *   The Mac class inherits both an enabled (from IssQ) and suspended (from Component) variable.  
 *      A Mac will not transmit or receive while suspended (however it may continue to receive when in a suspended Device).
 *          Being suspended does not automatically make a Mac non-operational.
@@ -173,6 +216,8 @@ protected:
 
 class Mac : public Component, public IssQ
 {
+	friend class Partition;
+
 public:
 	Mac();
 	Mac(unsigned short dev, unsigned short sap);
@@ -182,6 +227,8 @@ public:
 
 	virtual void Request(unique_ptr<Frame> pFrameIn) override;
 	virtual unique_ptr<Frame> Indication() override;
+	virtual size_t IndicationBurst(std::vector<unique_ptr<Frame>>& frames, size_t max) override;
+	virtual void RequestBurst(std::vector<unique_ptr<Frame>>& frames) override;
 	virtual bool getOperational() const override;
 	virtual void setEnabled(bool val);                    // Provides administrative control over the enabled parameter
 	virtual void setAdminPointToPoint(adminValues val);   // Provides administrative control over the operPointToPoint parameter
@@ -190,13 +237,20 @@ public:
 	virtual unsigned short getSapId() const;              // Identifies this SAP (unique within a Device)
 	virtual unsigned short getDevNum() const;             // Identifies the Device containing this MAC
 	virtual unsigned long getMacId() const;               // Union of the Device Number and SAP Identifier
+	unsigned long long getTxFrameCount() const;           // Frames transmitted to the link partner
+	const Histogram& getQueueResidence() const;           // Time from request to delivery to the link partner, for each Frame
+	void clearStats();
 	virtual void updateMacSystemId(unsigned long long value);
 
 	virtual void reset() override;
 	virtual void timerTick() override;
 	virtual void run(bool singleStep) override;
+	virtual int nextEventTime() const override;    // Time of next frame delivery, or SimLog::Time if indications waiting for client
+	virtual void saveState(Snapshot& snap) const override;
+	virtual void restoreState(Snapshot& snap) override;
 
 	virtual void Transmit();       
+	void Receive();                // Moves Frames delivered by the link partner before this Time increment to indications
 	  
 	static void Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay = 0);
 	static void Disconnect(shared_ptr<Mac> macA);
@@ -206,6 +260,10 @@ protected:
 	macIdentifier macId;
 
 	shared_ptr<Mac> linkPartner;
+	shared_ptr<RemoteLink> pRemote;  // Instead of linkPartner when the partner is in another Partition (see Partition.h)
 	unsigned short linkDelay;
+	LinkChannel arrivals;          // Frames transmitted by the link partner, not yet received
+	unsigned long long txFrameCount;
+	Histogram queueResidence;
 };
 
@@ -0,0 +1,142 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "Md5.h"
+
+
+static const unsigned int md5Shift[64] =
+{
+	7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+	5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+	4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+	6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+static const unsigned int md5Sine[64] =         // floor(abs(sin(i + 1)) * 2^32)
+{
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+
+Md5::Md5()
+{
+	restart();
+}
+
+void Md5::restart()
+{
+	state = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+	totalLength = 0;
+	blockLength = 0;
+}
+
+void Md5::transform(const unsigned char* pBlock)
+{
+	unsigned int word[16];
+	for (int i = 0; i < 16; i++)                             // Words of the block are little endian
+		word[i] = pBlock[i * 4] | (pBlock[i * 4 + 1] << 8) | (pBlock[i * 4 + 2] << 16) | ((unsigned int)pBlock[i * 4 + 3] << 24);
+
+	unsigned int a = (unsigned int)state[0];
+	unsigned int b = (unsigned int)state[1];
+	unsigned int c = (unsigned int)state[2];
+	unsigned int d = (unsigned int)state[3];
+	for (int i = 0; i < 64; i++)
+	{
+		unsigned int f;
+		int g;
+		if (i < 16)
+		{
+			f = (b & c) | (~b & d);
+			g = i;
+		}
+		else if (i < 32)
+		{
+			f = (d & b) | (~d & c);
+			g = (5 * i + 1) % 16;
+		}
+		else if (i < 48)
+		{
+			f = b ^ c ^ d;
+			g = (3 * i + 5) % 16;
+		}
+		else
+		{
+			f = c ^ (b | ~d);
+			g = (7 * i) % 16;
+		}
+		unsigned int sum = a + f + md5Sine[i] + word[g];
+		a = d;
+		d = c;
+		c = b;
+		b = b + ((sum << md5Shift[i]) | (sum >> (32 - md5Shift[i])));
+	}
+	state[0] = (unsigned int)(state[0] + a);
+	state[1] = (unsigned int)(state[1] + b);
+	state[2] = (unsigned int)(state[2] + c);
+	state[3] = (unsigned int)(state[3] + d);
+}
+
+void Md5::update(const unsigned char* data, size_t length)
+{
+	totalLength += length;
+	while (length > 0)
+	{
+		size_t count = std::min(length, block.size() - blockLength);
+		memcpy(block.data() + blockLength, data, count);
+		blockLength += count;
+		data += count;
+		length -= count;
+		if (blockLength == block.size())
+		{
+			transform(block.data());
+			blockLength = 0;
+		}
+	}
+}
+
+void Md5::put16(unsigned short value)
+{
+	unsigned char octets[2] = { (unsigned char)(value >> 8), (unsigned char)value };
+	update(octets, sizeof(octets));
+}
+
+std::array<unsigned char, 16> Md5::digest()
+{
+	unsigned long long bitLength = totalLength * 8;
+	unsigned char pad = 0x80;                                // Pad with a one bit, then zeros to 56 octets of the last block
+	update(&pad, 1);
+	pad = 0;
+	while (blockLength != 56)
+		update(&pad, 1);
+	unsigned char lengthOctets[8];                           // then the length in bits, least significant octet first
+	for (int i = 0; i < 8; i++)
+		lengthOctets[i] = (unsigned char)(bitLength >> (8 * i));
+	update(lengthOctets, sizeof(lengthOctets));
+
+	std::array<unsigned char, 16> result;
+	for (int i = 0; i < 16; i++)
+		result[i] = (unsigned char)(state[i / 4] >> (8 * (i % 4)));
+	restart();
+	return (result);
+}
@@ -0,0 +1,43 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+
+/*
+*   Class Md5 computes the 16 octet MD5 fingerprint of IETF RFC 1321, used by 802.1AX for the Conversation
+*       Link List digest (Aggregator::conversationLinkListDigest).  Data is added with update() (in as many pieces
+*       as convenient) and the fingerprint is returned by digest(), after which the Md5 starts over.
+*/
+
+class Md5
+{
+public:
+	Md5();
+
+	void update(const unsigned char* data, size_t length);
+	void put16(unsigned short value);                     // Adds a two octet value, most significant octet first
+	std::array<unsigned char, 16> digest();
+
+private:
+	std::array<unsigned long, 4> state;
+	unsigned long long totalLength;                       // Octets added so far
+	std::array<unsigned char, 64> block;                  // Partial block waiting for more data
+	size_t blockLength;
+
+	void restart();
+	void transform(const unsigned char* pBlock);
+};
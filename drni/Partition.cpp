@@ -0,0 +1,265 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "Partition.h"
+
+
+
+Transport::~Transport()
+{
+}
+
+void MemoryTransport::createPair(shared_ptr<Transport>& pEndA, shared_ptr<Transport>& pEndB)
+{
+	shared_ptr<Channel> pAtoB = make_shared<Channel>();
+	shared_ptr<Channel> pBtoA = make_shared<Channel>();
+
+	shared_ptr<MemoryTransport> pA = make_shared<MemoryTransport>();
+	pA->pOutbound = pAtoB;
+	pA->pInbound = pBtoA;
+	shared_ptr<MemoryTransport> pB = make_shared<MemoryTransport>();
+	pB->pOutbound = pBtoA;
+	pB->pInbound = pAtoB;
+
+	pEndA = pA;
+	pEndB = pB;
+}
+
+void MemoryTransport::send(const Snapshot& message)
+{
+	unique_ptr<Snapshot> pCopy = make_unique<Snapshot>();
+	pCopy->copy(message);
+	{
+		std::lock_guard<std::mutex> lock(pOutbound->channelMutex);
+		pOutbound->messages.push(std::move(pCopy));
+	}
+	pOutbound->ready.notify_one();
+}
+
+bool MemoryTransport::receive(Snapshot& message)
+{
+	std::unique_lock<std::mutex> lock(pInbound->channelMutex);
+	pInbound->ready.wait(lock, [this] { return (!pInbound->messages.empty()); });
+	message.copy(*(pInbound->messages.front()));
+	pInbound->messages.pop();
+	return (true);
+}
+
+StreamTransport::StreamTransport(std::istream& inStream, std::ostream& outStream)
+	: in(inStream), out(outStream)
+{
+}
+
+void StreamTransport::send(const Snapshot& message)
+{
+	message.write(out);
+	out.flush();
+}
+
+bool StreamTransport::receive(Snapshot& message)
+{
+	return (message.read(in));
+}
+
+
+
+RemoteLink::RemoteLink(unsigned short id)
+	: linkId(id)
+{
+	partnerUp = false;                       // Until the other Partition reports
+	lastDelivery = SimLog::Time - 1;
+}
+
+
+
+Partition::Partition(std::vector<unique_ptr<Device>>& devices, unsigned int threads)
+	: simulation(devices, threads)
+{
+	messagesSent = 0;
+	framesSent = 0;
+	windows = 0;
+}
+
+size_t Partition::addNeighbour(shared_ptr<Transport> pTransport)
+{
+	Neighbour neighbour;
+	neighbour.pTransport = pTransport;
+	neighbour.lookahead = MaxLookahead;
+	neighbour.receivedThrough = SimLog::Time - 1;   // Neither Partition has run yet
+	neighbours.push_back(std::move(neighbour));
+	return (neighbours.size() - 1);
+}
+
+void Partition::connectRemote(shared_ptr<Mac> mac, size_t neighbour, unsigned short linkId, unsigned short delay)
+{
+	Neighbour& thisNeighbour = neighbours[neighbour];
+
+	Mac::Disconnect(mac);
+	if (SimLog::Trace<0>()) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
+		<< hex << "  MAC " << mac->macId.dev << ":" << mac->macId.sap << " to remote Link " << linkId << " *****" << dec << endl;
+	SimLog::console << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
+		<< hex << "  MAC " << mac->macId.dev << ":" << mac->macId.sap << " to remote Link " << linkId << " *****" << dec << endl;
+
+	shared_ptr<RemoteLink> pLink = make_shared<RemoteLink>(linkId);
+	mac->pRemote = pLink;
+	mac->linkDelay = delay;
+
+	auto index = thisNeighbour.linkIndex.find(linkId);
+	if (index != thisNeighbour.linkIndex.end())      // Reconnecting a Link replaces its Mac and RemoteLink
+	{
+		if (thisNeighbour.links[index->second].first->pRemote == thisNeighbour.links[index->second].second)
+			thisNeighbour.links[index->second].first->pRemote = nullptr;
+		thisNeighbour.links[index->second] = std::make_pair(mac, pLink);
+	}
+	else
+	{
+		thisNeighbour.linkIndex[linkId] = thisNeighbour.links.size();
+		thisNeighbour.links.push_back(std::make_pair(mac, pLink));
+	}
+	thisNeighbour.lookahead = std::min(thisNeighbour.lookahead, delay + 1);
+}
+
+bool Partition::run(int endTime)
+{
+	while (SimLog::Time < endTime)
+	{
+		int windowEnd = endTime;
+		for (auto& neighbour : neighbours)
+		{
+			while ((neighbour.receivedThrough + neighbour.lookahead) < SimLog::Time)   // Frames the neighbour may yet send
+			{                                                                          //    could be received now
+				if (!receiveMessage(neighbour))
+					return (false);
+			}
+			windowEnd = std::min(windowEnd, neighbour.receivedThrough + neighbour.lookahead + 1);
+		}
+
+		deliverFrames(windowEnd);
+		simulation.run(windowEnd);
+		windows++;
+
+		for (auto& neighbour : neighbours)
+			sendMessage(neighbour);
+	}
+	return (true);
+}
+
+Simulation& Partition::getSimulation()
+{
+	return (simulation);
+}
+
+unsigned long long Partition::getMessagesSent() const
+{
+	return (messagesSent);
+}
+
+unsigned long long Partition::getFramesSent() const
+{
+	return (framesSent);
+}
+
+unsigned long long Partition::getWindows() const
+{
+	return (windows);
+}
+
+void Partition::sendMessage(Neighbour& neighbour)
+{
+	//  A message holds the last Time increment run, then for each Link:  its identifier, whether its Mac is enabled,
+	//     and the Frames sent since the last message, each preceded by its delivery Time.
+	message.clear();
+	message.put(SimLog::Time - 1);
+	message.put(neighbour.links.size());
+	for (auto& link : neighbour.links)
+	{
+		Mac& mac = *link.first;
+		RemoteLink& remote = *link.second;
+		message.put(remote.linkId);
+		message.put((bool)(mac.enabled && (mac.pRemote == link.second)));
+		message.put(remote.outbound.size());
+		for (auto& sent : remote.outbound)
+		{
+			message.put(sent.first);
+			Frame::saveFrame(message, sent.second);
+		}
+		framesSent += remote.outbound.size();
+		remote.outbound.clear();
+	}
+	neighbour.pTransport->send(message);
+	messagesSent++;
+}
+
+bool Partition::receiveMessage(Neighbour& neighbour)
+{
+	if (!neighbour.pTransport->receive(message))
+		return (false);
+
+	int through = 0;
+	size_t links = 0;
+	message.get(through);
+	message.get(links);
+	for (size_t i = 0; message.good() && (i < links); i++)
+	{
+		unsigned short linkId = 0;
+		bool up = false;
+		size_t frames = 0;
+		message.get(linkId);
+		message.get(up);
+		message.get(frames);
+
+		auto index = neighbour.linkIndex.find(linkId);
+		shared_ptr<RemoteLink> pLink = (index != neighbour.linkIndex.end()) ? neighbour.links[index->second].second : nullptr;
+		if (pLink && (pLink->partnerUp != up))
+		{
+			pLink->partnerUp = up;
+			simulation.schedule(SimLog::Time, []() {});   // Run all Devices, as after Mac::Connect, since Mac::getOperational changed
+		}
+		for (size_t f = 0; message.good() && (f < frames); f++)
+		{
+			int deliveryTime = 0;
+			message.get(deliveryTime);
+			unique_ptr<Frame> pFrame = Frame::restoreFrame(message);
+			if (pLink && pFrame)                      // Frames for a Link not connected here are discarded
+				pLink->inbound.push_back(std::make_pair(deliveryTime, std::move(pFrame)));
+		}
+	}
+	if (!message.good())
+		return (false);
+	neighbour.receivedThrough = through;
+	return (true);
+}
+
+void Partition::deliverFrames(int windowEnd)
+{
+	//  A Frame delivered at Time t is received at t + 1, so Frames delivered before windowEnd - 1 are received in this window.
+	//     As in Mac::Transmit, a Frame is discarded if the Mac is not enabled or is suspended.
+	for (auto& neighbour : neighbours)
+	{
+		for (auto& link : neighbour.links)
+		{
+			Mac& mac = *link.first;
+			RemoteLink& remote = *link.second;
+			while (!remote.inbound.empty() && (remote.inbound.front().first < (windowEnd - 1)))
+			{
+				if (mac.enabled && !mac.suspended && (mac.pRemote == link.second))
+					mac.arrivals.push(std::move(remote.inbound.front().second), remote.inbound.front().first);
+				remote.inbound.pop_front();
+			}
+		}
+	}
+}
@@ -0,0 +1,155 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Simulation.h"
+#include "Snapshot.h"
+
+
+/*
+*   Class Transport carries messages between two Partitions.  A message is a Snapshot used as a buffer (put and get).
+*       send never blocks, and receive blocks until the next message arrives.  receive returns false if the Transport
+*       has failed (e.g. the other end closed it), in which case no more messages will arrive.
+*   MemoryTransport connects two Partitions in the same process (e.g. in different threads), much as a shared memory
+*       ring would connect two processes on one host.  createPair makes the two ends.
+*   StreamTransport connects two Partitions through a pair of streams, so they can be in different processes or on
+*       different hosts (e.g. with streams over pipes or TCP sockets).  Messages are written length prefixed.
+*/
+
+class Transport
+{
+public:
+	virtual ~Transport();
+
+	virtual void send(const Snapshot& message) = 0;
+	virtual bool receive(Snapshot& message) = 0;
+};
+
+class MemoryTransport : public Transport
+{
+public:
+	static void createPair(shared_ptr<Transport>& pEndA, shared_ptr<Transport>& pEndB);
+
+	virtual void send(const Snapshot& message) override;
+	virtual bool receive(Snapshot& message) override;
+
+private:
+	struct Channel                                          // Messages in one direction
+	{
+		std::mutex channelMutex;
+		std::condition_variable ready;
+		std::queue<unique_ptr<Snapshot>> messages;
+	};
+
+	shared_ptr<Channel> pOutbound;
+	shared_ptr<Channel> pInbound;
+};
+
+class StreamTransport : public Transport
+{
+public:
+	StreamTransport(std::istream& inStream, std::ostream& outStream);
+
+	virtual void send(const Snapshot& message) override;
+	virtual bool receive(Snapshot& message) override;
+
+private:
+	std::istream& in;
+	std::ostream& out;
+};
+
+
+/*
+*   Class RemoteLink is one end of a Link whose Macs are in different Partitions.  It takes the place of linkPartner
+*       in the Mac (see Mac::Transmit), and holds the Frames passing between the Mac and the Partition.
+*/
+
+class RemoteLink
+{
+public:
+	RemoteLink(unsigned short id);
+
+	unsigned short linkId;                                  // Identifies the Link in messages between the two Partitions
+	bool partnerUp;                                         // Other Mac is enabled, as last reported by its Partition
+	int lastDelivery;                                       // Delivery Time of the last Frame transmitted on the Link
+	std::vector<std::pair<int, unique_ptr<Frame>>> outbound;   // Frames transmitted (with delivery Time) since the last message
+	std::deque<std::pair<int, unique_ptr<Frame>>> inbound;     // Frames from the other Mac (with delivery Time) not yet due
+};
+
+
+/*
+*   Class Partition runs a subset of the Devices of a network, so that a large network can be spread across several
+*       processes or hosts.  Each Partition has its own Simulation, and exchanges messages with each neighbour
+*       (another Partition that has Links to this one) through a Transport.
+*   A Link between Macs in different Partitions is connected with connectRemote, in both Partitions, with the same
+*       link identifier and delay.  A Mac on such a Link sends each Frame as soon as it is requested, stamped with the
+*       Time it would have been delivered to its link partner (the same Time as if the Link were local), and the
+*       Partition collects them into a message to the neighbour.
+*   Synchronization is conservative.  A Frame is not received until at least the link delay plus one Time increment after
+*       it was sent, so a Partition can run that far (its lookahead) past the last Time increment a neighbour has
+*       reported without missing a Frame from the neighbour.  run() repeatedly:
+*           -- waits for messages from every neighbour until it has their Frames for the current Time increment,
+*           -- moves Frames that become due before the next wait onto the arrivals channels of their Macs,
+*           -- runs its Simulation to the end of the window allowed by the neighbours' lookahead, and
+*           -- sends each neighbour a message with the Frames sent on their Links and whether each Mac is enabled.
+*       The lookahead of a neighbour is its smallest link delay plus one, but no more than MaxLookahead so the
+*       arrivals channel of a Mac is never given more Frames than it can hold (longer delays still apply in full).
+*   All Partitions must add their neighbours at the same Time and run to the same endTime.  Actions to be executed in a
+*       Partition's Devices are put on its Simulation event queue (getSimulation().schedule).
+*   Compared with running all Devices in one Simulation, a Mac learns that a remote partner has been enabled or
+*       disabled a lookahead later (or earlier), and a Frame sent on a remote Link is not discarded if its own Mac is
+*       disabled before the Frame's delivery Time.  Links to other Partitions are not part of a Snapshot.
+*/
+
+class Partition
+{
+public:
+	Partition(std::vector<unique_ptr<Device>>& devices, unsigned int threads = SimLog::Threads);
+	Partition(Partition& copySource) = delete;             // Disable copy constructor
+	Partition& operator= (const Partition&) = delete;      // Disable assignment operator
+
+	static const int MaxLookahead = (LinkChannel::Capacity / 2) - 1;
+
+	size_t addNeighbour(shared_ptr<Transport> pTransport);  // Returns index of neighbour
+	void connectRemote(shared_ptr<Mac> mac, size_t neighbour, unsigned short linkId, unsigned short delay = 0);
+	bool run(int endTime);                                  // Returns false if the Transport to a neighbour failed
+	Simulation& getSimulation();
+
+	unsigned long long getMessagesSent() const;
+	unsigned long long getFramesSent() const;               // Frames sent to neighbours on remote Links
+	unsigned long long getWindows() const;                  // Number of times the Simulation was run between messages
+
+private:
+	struct Neighbour
+	{
+		shared_ptr<Transport> pTransport;
+		std::vector<std::pair<shared_ptr<Mac>, shared_ptr<RemoteLink>>> links;
+		std::map<unsigned short, size_t> linkIndex;         // Position in links of each link identifier
+		int lookahead;                                      // Time increments this Partition can run past receivedThrough
+		int receivedThrough;                                // Last Time increment the neighbour has sent all its Frames for
+	};
+
+	Simulation simulation;
+	std::vector<Neighbour> neighbours;
+	Snapshot message;                                       // Re-used for every message sent and received
+	unsigned long long messagesSent;
+	unsigned long long framesSent;
+	unsigned long long windows;
+
+	bool receiveMessage(Neighbour& neighbour);
+	void sendMessage(Neighbour& neighbour);
+	void deliverFrames(int windowEnd);                      // Move Frames received before windowEnd to their Macs
+};
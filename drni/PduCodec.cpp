@@ -0,0 +1,289 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "PduCodec.h"
+#include "Lacpdu.h"
+#include "Drcpdu.h"
+
+
+size_t PduCodec::encodeFrame(const Frame& frame, unsigned char* buffer, size_t bufferSize)
+{
+	PduWriter out(buffer, bufferSize);
+	out.put48(frame.MacDA);
+	out.put48(frame.MacSA);
+
+	const Sdu* pSdu = &frame.getNextSdu();
+	while (pSdu->getEtherType() != 0)
+	{
+		unsigned short etherType = pSdu->getEtherType();
+		out.put16(etherType);
+		if ((etherType == CVlanEthertype) || (etherType == SVlanEthertype))
+		{
+			out.put16(((const VlanTag*)pSdu)->Vtag.tci);
+			pSdu = &pSdu->getNextSdu();
+			continue;
+		}
+
+		size_t pduLength = 0;
+		if (!out.ok())
+			return (0);
+		if ((etherType == SlowProtocolsEthertype) && (pSdu->getSubType() == LacpduSubType))
+			pduLength = ((const Lacpdu*)pSdu)->encode(out.reserve(0), out.remaining());
+		else if ((etherType == DrniEthertype) && (pSdu->getSubType() == DrcpduSubType))
+			pduLength = ((const Drcpdu*)pSdu)->encode(out.reserve(0), out.remaining());
+		else
+			break;                                            // No wire format for the contents of this Sdu
+		if (pduLength == 0)
+			return (0);
+		out.reserve(pduLength);
+		break;
+	}
+
+	if (out.length() < MinFrameLength)
+		out.putZeros(MinFrameLength - out.length());
+	return (out.ok() ? out.length() : 0);
+}
+
+unique_ptr<Frame> PduCodec::decodeFrame(const unsigned char* buffer, size_t length, int time)
+{
+	static const int MaxTags = 4;
+	std::array<shared_ptr<VlanTag>, MaxTags> tags;
+	int numTags = 0;
+
+	PduReader in(buffer, length);
+	unsigned long long frameDA = in.get48();
+	unsigned long long frameSA = in.get48();
+	unsigned short etherType = in.get16();
+	while (((etherType == CVlanEthertype) || (etherType == SVlanEthertype)) && (numTags < MaxTags))
+	{
+		vlanControlWord tag;
+		tag.tci = in.get16();
+		tags[numTags] = makeSdu<VlanTag>(etherType, (unsigned short)tag.id, (unsigned short)tag.pri, (bool)tag.de);
+		tags[numTags]->TimeStamp = time;
+		numTags++;
+		etherType = in.get16();
+	}
+	if (!in.ok())
+		return (nullptr);
+
+	size_t dataLength = in.remaining();
+	const unsigned char* pData = in.skip(dataLength);
+	unsigned char subType = (dataLength > 0) ? pData[0] : 0;
+	shared_ptr<Sdu> pSdu = nullptr;
+	if ((etherType == SlowProtocolsEthertype) && (subType == LacpduSubType))
+	{
+		shared_ptr<Lacpdu> pLacpdu = makeSdu<Lacpdu>();
+		if (!pLacpdu->decode(pData, dataLength))
+			return (nullptr);
+		pSdu = pLacpdu;
+	}
+	else if ((etherType == DrniEthertype) && (subType == DrcpduSubType))
+	{
+		shared_ptr<Drcpdu> pDrcpdu = makeSdu<Drcpdu>();
+		if (!pDrcpdu->decode(pData, dataLength))
+			return (nullptr);
+		pSdu = pDrcpdu;
+	}
+	else if (etherType == SlowProtocolsEthertype)
+	{
+		pSdu = makeSdu<Sdu>(etherType, subType);
+	}
+	else
+	{
+		pSdu = makeSdu<Sdu>(etherType);
+	}
+	pSdu->TimeStamp = time;
+
+	unique_ptr<Frame> pFrame = make_unique<Frame>(frameDA, frameSA, pSdu);
+	while (numTags > 0)
+		pFrame = pFrame->InsertTag(tags[--numTags]);
+	pFrame->TimeStamp = time;
+	return (pFrame);
+}
+
+
+/*
+*   pcap file format:  a 24 octet file header followed by a 16 octet header and the frame octets for each record.
+*       Header fields are in the byte order of the machine that wrote the file, which is detected from the magic number.
+*/
+
+static const unsigned long PcapMagic = 0xa1b2c3d4;
+static const unsigned long PcapMagicSwapped = 0xd4c3b2a1;
+static const unsigned long PcapLinkTypeEthernet = 1;
+
+static void putPcapWord(std::ostream& pcap, unsigned long value)
+{
+	unsigned int word = (unsigned int)value;                // Four octets in native byte order
+	pcap.write((const char*)&word, sizeof(word));
+}
+
+static bool getPcapWord(std::istream& pcap, bool swapped, unsigned long& value)
+{
+	unsigned char bytes[4];
+	if (!pcap.read((char*)bytes, sizeof(bytes)))
+		return (false);
+	unsigned int word;
+	memcpy(&word, bytes, sizeof(word));
+	if (swapped)
+		word = ((word >> 24) & 0xff) | ((word >> 8) & 0xff00) | ((word << 8) & 0xff0000) | ((word << 24) & 0xff000000);
+	value = word;
+	return (true);
+}
+
+void PduCodec::writePcapHeader(std::ostream& pcap)
+{
+	putPcapWord(pcap, PcapMagic);
+	putPcapWord(pcap, 0x00040002);                          // Version 2.4 (two 16 bit fields, minor version first in a native word)
+	putPcapWord(pcap, 0);                                   // Time zone offset
+	putPcapWord(pcap, 0);                                   // Timestamp accuracy
+	putPcapWord(pcap, 65535);                               // Snapshot length
+	putPcapWord(pcap, PcapLinkTypeEthernet);
+}
+
+bool PduCodec::writePcapRecord(std::ostream& pcap, const Frame& frame, int time)
+{
+	std::array<unsigned char, MaxFrameLength> buffer;
+	size_t length = encodeFrame(frame, buffer.data(), buffer.size());
+	if (length == 0)
+		return (false);
+
+	putPcapWord(pcap, time / TicksPerSecond);
+	putPcapWord(pcap, (time % TicksPerSecond) * (1000000 / TicksPerSecond));
+	putPcapWord(pcap, length);
+	putPcapWord(pcap, length);
+	pcap.write((const char*)buffer.data(), length);
+	return (true);
+}
+
+bool PduCodec::readPcapHeader(std::istream& pcap, bool& swapped)
+{
+	unsigned long magic = 0;
+	if (!getPcapWord(pcap, false, magic) || ((magic != PcapMagic) && (magic != PcapMagicSwapped)))
+		return (false);
+	swapped = (magic == PcapMagicSwapped);
+
+	unsigned long header[5];                                // Version, time zone, accuracy, snapshot length, link type
+	for (auto& field : header)
+		if (!getPcapWord(pcap, swapped, field))
+			return (false);
+	return (header[4] == PcapLinkTypeEthernet);
+}
+
+unique_ptr<Frame> PduCodec::readPcapRecord(std::istream& pcap, bool swapped, int& time, bool& valid)
+{
+	unsigned long seconds = 0, microseconds = 0, includedLength = 0, originalLength = 0;
+	if (!getPcapWord(pcap, swapped, seconds) || !getPcapWord(pcap, swapped, microseconds) ||
+		!getPcapWord(pcap, swapped, includedLength) || !getPcapWord(pcap, swapped, originalLength))
+		return (nullptr);
+
+	std::array<unsigned char, MaxFrameLength> buffer;
+	size_t length = std::min((size_t)includedLength, buffer.size());
+	if (!pcap.read((char*)buffer.data(), length))
+		return (nullptr);
+	if (includedLength > length)
+		pcap.ignore(includedLength - length);
+
+	time = (int)(seconds * TicksPerSecond + microseconds / (1000000 / TicksPerSecond));
+	unique_ptr<Frame> pFrame = decodeFrame(buffer.data(), length, time);
+	valid = (pFrame != nullptr);
+	if (!valid)
+		pFrame = make_unique<Frame>();                      // Placeholder so the caller can continue with the next record
+	return (pFrame);
+}
+
+
+PcapPort::PcapPort(unsigned long long macAddress, std::istream* pReplay, std::ostream* pCapture)
+	: macAddress(macAddress), pReplay(pReplay), pCapture(pCapture)
+{
+	enabled = true;
+	swapped = false;
+	timeOffset = 0;
+	nextTime = SimLog::EndOfTime;
+	replayedFrames = 0;
+	invalidFrames = 0;
+
+	if (pCapture)
+		PduCodec::writePcapHeader(*pCapture);
+	if (pReplay && PduCodec::readPcapHeader(*pReplay, swapped))
+	{
+		readNext();
+		if (pNextFrame)                                     // First captured Frame is available immediately
+		{
+			timeOffset = SimLog::Time - nextTime;
+			nextTime = SimLog::Time;
+		}
+	}
+}
+
+PcapPort::~PcapPort()
+{
+}
+
+void PcapPort::readNext()
+{
+	pNextFrame = nullptr;
+	nextTime = SimLog::EndOfTime;
+	int time = 0;
+	bool valid = false;
+	while (unique_ptr<Frame> pFrame = PduCodec::readPcapRecord(*pReplay, swapped, time, valid))
+	{
+		if (valid)
+		{
+			pNextFrame = std::move(pFrame);
+			nextTime = time + timeOffset;
+			return;
+		}
+		invalidFrames++;
+	}
+}
+
+unsigned long long PcapPort::getMacAddress() const
+{
+	return (macAddress);
+}
+
+unique_ptr<Frame> PcapPort::Indication()
+{
+	if (!pNextFrame || (nextTime > SimLog::Time))
+		return (nullptr);
+
+	unique_ptr<Frame> pFrame = std::move(pNextFrame);
+	replayedFrames++;
+	readNext();
+	return (pFrame);
+}
+
+void PcapPort::Request(unique_ptr<Frame> pFrameIn)
+{
+	if (pCapture && pFrameIn)
+		PduCodec::writePcapRecord(*pCapture, *pFrameIn, SimLog::Time);
+}
+
+int PcapPort::nextFrameTime() const
+{
+	return (nextTime);
+}
+
+unsigned long long PcapPort::getReplayedFrames() const
+{
+	return (replayedFrames);
+}
+
+unsigned long long PcapPort::getInvalidFrames() const
+{
+	return (invalidFrames);
+}
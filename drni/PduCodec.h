@@ -0,0 +1,153 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Mac.h"
+
+
+/*
+*   Classes PduWriter and PduReader write and read the big endian fields of a PDU in a byte buffer owned by the caller.
+*       They are used by the wire format encoders and decoders of the PDUs (Lacpdu::encode, Drcpdu::decode, ...).
+*       Neither allocates memory or throws:  writing or reading past the end of the buffer sets a flag (ok() is false),
+*       writes are discarded, and reads return zero.
+*
+*   Class PduCodec converts a whole Frame (destination and source addresses, VLAN tags, and an LACPDU or DRCPDU)
+*       to and from an Ethernet frame (without FCS), and writes and reads those frames as the records of a pcap
+*       capture file.  Sdus that have no wire format in the simulation (e.g. TestSdu) are encoded as just their EtherType.
+*       A pcap timestamp is SimLog::Time converted at TicksPerSecond (AggPort::fastPeriodicTime, one second in LACP).
+*       The TimeStamps of a decoded Frame and its Sdus are the capture time.
+*
+*   Class PcapPort is an Iss that replays a capture file:  Indication() provides each captured Frame once SimLog::Time
+*       reaches its capture time (relative to the first Frame, which is available when the PcapPort is created).
+*       Frames requested of the PcapPort are written to a capture file, if one is given, and discarded.  Attaching a
+*       PcapPort to an Aggregation Port (AggPort::pIss) or a Distributed Relay IRP runs the captured LACPDUs or DRCPDUs
+*       through LacpRxSM or DrcpRxSM.  The PcapPort is not a Component, so the Simulation scheduler does not know when
+*       its Frames arrive;  use nextFrameTime() to schedule them, or run with Simulation::tick().
+*/
+
+class PduWriter
+{
+public:
+	PduWriter(unsigned char* buffer, size_t size) : pStart(buffer), pNext(buffer), pEnd(buffer + size), overflow(false) {}
+
+	void put8(unsigned char value) { if (unsigned char* p = reserve(1)) p[0] = value; }
+	void put16(unsigned short value) { if (unsigned char* p = reserve(2)) { p[0] = (unsigned char)(value >> 8); p[1] = (unsigned char)value; } }
+	void put32(unsigned long value) { put16((unsigned short)(value >> 16)); put16((unsigned short)value); }
+	void put64(unsigned long long value) { put32((unsigned long)(value >> 32)); put32((unsigned long)value); }
+	void put48(unsigned long long value) { put16((unsigned short)(value >> 32)); put32((unsigned long)value); }
+	void putBytes(const unsigned char* bytes, size_t count) { if (unsigned char* p = reserve(count)) memcpy(p, bytes, count); }
+	void putZeros(size_t count) { if (unsigned char* p = reserve(count)) memset(p, 0, count); }
+	unsigned char* reserve(size_t count)             // Returns pointer to the next count bytes, or nullptr if no room
+	{
+		if (overflow || ((size_t)(pEnd - pNext) < count))
+		{
+			overflow = true;
+			return (nullptr);
+		}
+		unsigned char* p = pNext;
+		pNext += count;
+		return (p);
+	}
+	size_t length() const { return (pNext - pStart); }
+	size_t remaining() const { return (pEnd - pNext); }
+	bool ok() const { return (!overflow); }
+
+private:
+	unsigned char* pStart;
+	unsigned char* pNext;
+	unsigned char* pEnd;
+	bool overflow;
+};
+
+class PduReader
+{
+public:
+	PduReader(const unsigned char* buffer, size_t size) : pNext(buffer), pEnd(buffer + size), underflow(false) {}
+
+	unsigned char get8() { const unsigned char* p = skip(1); return (p ? p[0] : 0); }
+	unsigned short get16() { const unsigned char* p = skip(2); return (p ? (unsigned short)((p[0] << 8) | p[1]) : 0); }
+	unsigned long get32() { unsigned long high = get16(); return ((high << 16) | get16()); }
+	unsigned long long get64() { unsigned long long high = get32(); return ((high << 32) | get32()); }
+	unsigned long long get48() { unsigned long long high = get16(); return ((high << 32) | get32()); }
+	void getBytes(unsigned char* bytes, size_t count) { if (const unsigned char* p = skip(count)) memcpy(bytes, p, count); }
+	const unsigned char* skip(size_t count)          // Returns pointer to the next count bytes, or nullptr if not that many
+	{
+		if (underflow || (remaining() < count))
+		{
+			underflow = true;
+			return (nullptr);
+		}
+		const unsigned char* p = pNext;
+		pNext += count;
+		return (p);
+	}
+	size_t remaining() const { return (pEnd - pNext); }
+	bool ok() const { return (!underflow); }
+
+private:
+	const unsigned char* pNext;
+	const unsigned char* pEnd;
+	bool underflow;
+};
+
+
+class PduCodec
+{
+public:
+	static const size_t MinFrameLength = 60;         // Ethernet frame without FCS
+	static const size_t MaxFrameLength = 1522;
+	static const int TicksPerSecond = 2000;
+
+	static size_t encodeFrame(const Frame& frame, unsigned char* buffer, size_t bufferSize);   // Returns octets written, or 0 if no room
+	static unique_ptr<Frame> decodeFrame(const unsigned char* buffer, size_t length, int time); // Returns nullptr if not a valid frame
+	//     Frame and Sdu TimeStamps are set to time
+
+	static void writePcapHeader(std::ostream& pcap);
+	static bool writePcapRecord(std::ostream& pcap, const Frame& frame, int time);  // Returns false if Frame could not be encoded
+	static bool readPcapHeader(std::istream& pcap, bool& swapped);                   // Returns false if not an Ethernet pcap file
+	static unique_ptr<Frame> readPcapRecord(std::istream& pcap, bool swapped, int& time, bool& valid);   // nullptr at end of file
+};
+
+
+class PcapPort : public Iss
+{
+public:
+	PcapPort(unsigned long long macAddress, std::istream* pReplay, std::ostream* pCapture = nullptr);
+	~PcapPort();
+	PcapPort(PcapPort& copySource) = delete;             // Disable copy constructor
+	PcapPort& operator= (const PcapPort&) = delete;      // Disable assignment operator
+
+	virtual unsigned long long getMacAddress() const override;
+	virtual unique_ptr<Frame> Indication() override;               // Next captured Frame, if SimLog::Time has reached its time
+	virtual void Request(unique_ptr<Frame> pFrameIn) override;     // Written to the capture file (if any) and discarded
+
+	int nextFrameTime() const;                          // Time of the next captured Frame, or SimLog::EndOfTime if none
+	unsigned long long getReplayedFrames() const;
+	unsigned long long getInvalidFrames() const;        // Records that could not be decoded (skipped)
+
+private:
+	unsigned long long macAddress;
+	std::istream* pReplay;
+	std::ostream* pCapture;
+	bool swapped;                                       // Replay file has the opposite byte order
+	int timeOffset;                                     // Added to the capture time of a record to give SimLog::Time
+	unique_ptr<Frame> pNextFrame;
+	int nextTime;
+	unsigned long long replayedFrames;
+	unsigned long long invalidFrames;
+
+	void readNext();
+};
@@ -0,0 +1,97 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "Pool.h"
+
+
+thread_local Pool::FreeLists Pool::localFree;
+std::array<Pool::FreeBlock*, Pool::NumSizes> Pool::sharedFree = {};
+std::mutex Pool::sharedMutex;
+
+Pool::FreeLists::FreeLists()
+{
+	pFirst.fill(nullptr);
+}
+
+Pool::FreeLists::~FreeLists()
+{
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	for (size_t i = 0; i < NumSizes; i++)
+	{
+		while (pFirst[i])                    // Move each block to the shared free list for its size
+		{
+			FreeBlock* pBlock = pFirst[i];
+			pFirst[i] = pBlock->pNext;
+			pBlock->pNext = sharedFree[i];
+			sharedFree[i] = pBlock;
+		}
+	}
+}
+
+void* Pool::allocate(size_t size)
+{
+	if (size > MaxBlockSize)
+		return (::operator new(size));
+
+	size_t sizeIndex = (size > 0) ? ((size - 1) / BlockAlignment) : 0;
+	FreeBlock*& pFirst = localFree.pFirst[sizeIndex];
+	if (!pFirst)
+		pFirst = refill(sizeIndex);
+
+	FreeBlock* pBlock = pFirst;
+	pFirst = pBlock->pNext;
+	return (pBlock);
+}
+
+void Pool::deallocate(void* pBlock, size_t size)
+{
+	if (!pBlock)
+		return;
+	if (size > MaxBlockSize)
+	{
+		::operator delete(pBlock);
+		return;
+	}
+
+	size_t sizeIndex = (size > 0) ? ((size - 1) / BlockAlignment) : 0;
+	FreeBlock* pFree = static_cast<FreeBlock*>(pBlock);
+	pFree->pNext = localFree.pFirst[sizeIndex];
+	localFree.pFirst[sizeIndex] = pFree;
+}
+
+Pool::FreeBlock* Pool::refill(size_t sizeIndex)
+{
+	std::lock_guard<std::mutex> lock(sharedMutex);
+
+	FreeBlock* pList = sharedFree[sizeIndex];
+	if (pList)                                     // Take all of the shared free blocks of this size
+	{
+		sharedFree[sizeIndex] = nullptr;
+		return (pList);
+	}
+
+	size_t blockSize = (sizeIndex + 1) * BlockAlignment;   // Otherwise carve a new chunk into blocks
+	size_t numBlocks = ChunkSize / blockSize;
+	char* pChunk = static_cast<char*>(::operator new(ChunkSize));
+	for (size_t i = numBlocks; i > 0; i--)
+	{
+		FreeBlock* pBlock = reinterpret_cast<FreeBlock*>(pChunk + ((i - 1) * blockSize));
+		pBlock->pNext = pList;
+		pList = pBlock;
+	}
+	return (pList);
+}
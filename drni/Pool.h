@@ -0,0 +1,91 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+/*
+*   Class Pool is a block allocator for the objects that are created and destroyed for every frame in the simulation
+*       (Frame headers and Sdus).  Requests are rounded up to a multiple of BlockAlignment bytes, and each size has
+*       a free list of blocks.  Blocks are carved from large chunks obtained from the heap, so after the first few frames
+*       the simulation no longer allocates from the heap for frames.  Requests larger than MaxBlockSize go to the heap.
+*   Each thread has its own free lists so no lock is needed to allocate or free a block.  A block freed by a different
+*       thread than allocated it simply joins the free list of the freeing thread.  When a thread exits its free
+*       blocks are moved to shared free lists that are used (under a lock) before any new chunk is allocated.
+*       Chunks are never returned to the heap.
+*   Objects allocated from the Pool must not have static storage duration.
+*
+*   Class template PoolAllocator is a standard library allocator using the Pool.  It is intended for use with
+*       std::allocate_shared, so the shared_ptr control block is allocated from the Pool along with the object.
+*       The functions makeSdu (in Frame.h) should be used rather than std::make_shared to create Sdus.
+*/
+
+class Pool
+{
+public:
+	static const size_t BlockAlignment = 16;
+	static const size_t MaxBlockSize = 2048;
+
+	static void* allocate(size_t size);
+	static void deallocate(void* pBlock, size_t size);
+
+private:
+	static const size_t NumSizes = MaxBlockSize / BlockAlignment;
+	static const size_t ChunkSize = 64 * 1024;
+
+	struct FreeBlock
+	{
+		FreeBlock* pNext;
+	};
+
+	struct FreeLists
+	{
+		FreeLists();
+		~FreeLists();                                     // Moves all free blocks to the shared free lists
+		std::array<FreeBlock*, NumSizes> pFirst;
+	};
+
+	static thread_local FreeLists localFree;              // Free lists of the current thread
+	static std::array<FreeBlock*, NumSizes> sharedFree;   // Free blocks left by threads that have exited
+	static std::mutex sharedMutex;
+
+	static FreeBlock* refill(size_t sizeIndex);           // Get a list of free blocks from the shared free list or a new chunk
+};
+
+
+template <class T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+	PoolAllocator() {}
+	template <class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		static_assert(alignof(T) <= Pool::BlockAlignment, "PoolAllocator:  type alignment exceeds Pool::BlockAlignment");
+		return (static_cast<T*>(Pool::allocate(n * sizeof(T))));
+	}
+	void deallocate(T* p, size_t n)
+	{
+		Pool::deallocate(p, n * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator== (const PoolAllocator<T>&, const PoolAllocator<U>&) { return (true); }
+template <class T, class U>
+bool operator!= (const PoolAllocator<T>&, const PoolAllocator<U>&) { return (false); }
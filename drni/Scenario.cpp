@@ -0,0 +1,567 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "Scenario.h"
+
+
+static LinkAgg* findLinkAgg(Device& device)
+{
+	for (auto& pComp : device.pComponents)
+		if (pComp->getCompType() == ComponentTypes::LINK_AGG)
+			return ((LinkAgg*)pComp.get());
+	return (nullptr);
+}
+
+static EndStn* findEndStn(Device& device)
+{
+	for (auto& pComp : device.pComponents)
+		if (pComp->getCompType() == ComponentTypes::END_STATION)
+			return ((EndStn*)pComp.get());
+	return (nullptr);
+}
+
+
+
+Scenario::Scenario()
+{
+	duration = -1;
+}
+
+bool Scenario::loadFile(const std::string& fileName)
+{
+	std::ifstream file(fileName);
+	if (!file)
+	{
+		error = "cannot open " + fileName;
+		return (false);
+	}
+	return (load(file));
+}
+
+bool Scenario::load(std::istream& in)
+{
+	topology.clear();
+	distRelays.clear();
+	events.clear();
+	duration = -1;
+	error.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(in, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+		std::istringstream tokens(line);
+		std::string keyword;
+		if (!(tokens >> keyword))
+			continue;                                          // Blank line
+		if (!parseStatement(tokens, keyword))
+		{
+			error = "line " + std::to_string(lineNumber) + ":  " + error;
+			return (false);
+		}
+	}
+
+	std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return (a.time < b.time); });
+	return (true);
+}
+
+const std::string& Scenario::getError() const
+{
+	return (error);
+}
+
+bool Scenario::hasTopology() const
+{
+	return (!topology.empty());
+}
+
+size_t Scenario::getEventCount() const
+{
+	return (events.size());
+}
+
+int Scenario::getDuration() const
+{
+	if (duration >= 0)
+		return (duration);
+	return (events.empty() ? 0 : (events.back().time + 1));
+}
+
+void Scenario::build(std::vector<unique_ptr<Device>>& devices) const
+{
+	for (auto& spec : topology)
+	{
+		unique_ptr<Device> pDev = make_unique<Device>(spec.macs);
+		if (spec.bridge)
+			pDev->createBridge(CVlanEthertype);
+		else
+			pDev->createEndStation();
+		devices.push_back(move(pDev));
+	}
+
+	for (auto& spec : distRelays)                      // As in drni.cpp, with two DRNI Aggregation Ports and two Intra-Relay Ports
+	{
+		LinkAgg& lag = *findLinkAgg(*devices[spec.dev]);
+		int numDrniPorts = 2;
+		int numIrp = 2;
+		int drniMacIndex = spec.mac;
+		sysId adminDrniId;
+		adminDrniId.id = 0;                            // DRNI uses ID from DRNI System with the lowest ID
+
+		//  Key for Aggregator supporting DRNI needs to be unique in system.  Make unique between systems as well for testing purposes.
+		unsigned short aggKey = (defaultActorKey & 0xf000) | ((spec.dev * 0x100) & 0x0f00) | ((drniMacIndex + 1) & 0x00ff);
+		lag.pAggregators[drniMacIndex]->set_aAggActorAdminKey(aggKey);
+
+		shared_ptr<DistributedRelay> pDR = make_shared<DistributedRelay>(adminDrniId.id, aggKey);
+		lag.pDistRelays[drniMacIndex] = pDR;
+		lag.configDistRelay(drniMacIndex, numDrniPorts, numIrp, adminDrniId, aggKey, spec.firstLinkNum);
+
+		if (topology[spec.dev].bridge)
+		{
+			Bridge& bridge = (Bridge&)*(devices[spec.dev]->pComponents[0]);  // Assumes Bridge is first component in device.
+			bridge.bPorts[drniMacIndex]->pIss = pDR;
+			for (int px = drniMacIndex + 1; px < drniMacIndex + numDrniPorts + numIrp; px++)
+				bridge.bPorts[px]->pIss = nullptr;
+		}
+		else
+		{
+			findEndStn(*devices[spec.dev])->pIss = pDR;
+		}
+	}
+}
+
+bool Scenario::run(std::vector<unique_ptr<Device>>& devices, unsigned int threads) const
+{
+	Simulation sim(devices, threads);
+	int start = SimLog::Time;
+	bool complete = true;
+
+	for (auto& event : events)
+	{
+		const Action& action = event.action;
+		sim.schedule(start + event.time, [&devices, &complete, &action]() {
+			if (!action(devices))
+				complete = false;
+		});
+	}
+	sim.run(start + getDuration());
+	return (complete);
+}
+
+bool Scenario::parseStatement(std::istringstream& tokens, const std::string& keyword)
+{
+	if ((keyword == "bridges") || (keyword == "stations"))
+	{
+		int count = 0;
+		DeviceSpec spec;
+		spec.bridge = (keyword == "bridges");
+		spec.macs = 0;
+		if (!(tokens >> count >> spec.macs) || (count <= 0) || (spec.macs <= 0))
+		{
+			error = keyword + " needs a count and a number of Macs";
+			return (false);
+		}
+		for (int i = 0; i < count; i++)
+			topology.push_back(spec);
+		return (true);
+	}
+	if (keyword == "distRelay")
+	{
+		std::string target;
+		unsigned long long firstLinkNum = 0;
+		std::string linkToken;
+		DistRelaySpec spec;
+		size_t mac = 0;
+		if (!(tokens >> target >> linkToken) || !parseMac(target, spec.dev, mac) || !parseNumber(linkToken, firstLinkNum))
+		{
+			error = "distRelay needs <dev>.<mac> and a first Link Number";
+			return (false);
+		}
+		if ((spec.dev >= topology.size()) || ((mac + 4) > (size_t)topology[spec.dev].macs))
+		{
+			error = "distRelay needs four Macs of a Device built by the scenario, starting at " + target;
+			return (false);
+		}
+		spec.mac = (int)mac;
+		spec.firstLinkNum = (unsigned short)firstLinkNum;
+		distRelays.push_back(spec);
+		return (true);
+	}
+	if (keyword == "at")
+	{
+		int time = -1;
+		if (!(tokens >> time) || (time < 0))
+		{
+			error = "at needs a Time (zero or more)";
+			return (false);
+		}
+		return (parseEvent(time, tokens));
+	}
+	if (keyword == "run")
+	{
+		if (!(tokens >> duration) || (duration < 0))
+		{
+			error = "run needs a duration (zero or more)";
+			return (false);
+		}
+		return (true);
+	}
+	error = "unknown statement " + keyword;
+	return (false);
+}
+
+bool Scenario::parseEvent(int time, std::istringstream& tokens)
+{
+	std::string verb;
+	tokens >> verb;
+	Action action = nullptr;
+
+	if (verb == "connect")
+	{
+		std::string tokenA, tokenB;
+		size_t devA = 0, macA = 0, devB = 0, macB = 0;
+		unsigned short delay = 0;
+		if (!(tokens >> tokenA >> tokenB) || !parseMac(tokenA, devA, macA) || !parseMac(tokenB, devB, macB))
+		{
+			error = "connect needs two Macs (<dev>.<mac>)";
+			return (false);
+		}
+		tokens >> delay;
+		action = [devA, macA, devB, macB, delay](std::vector<unique_ptr<Device>>& devices) {
+			if ((devA >= devices.size()) || (devB >= devices.size()) ||
+				(macA >= devices[devA]->pMacs.size()) || (macB >= devices[devB]->pMacs.size()))
+				return (false);
+			Mac::Connect(devices[devA]->pMacs[macA], devices[devB]->pMacs[macB], delay);
+			return (true);
+		};
+	}
+	else if (verb == "disconnect")
+	{
+		std::string token;
+		size_t dev = 0, mac = 0;
+		if (!(tokens >> token) || !parseMac(token, dev, mac))
+		{
+			error = "disconnect needs a Mac (<dev>.<mac>)";
+			return (false);
+		}
+		action = [dev, mac](std::vector<unique_ptr<Device>>& devices) {
+			if ((dev >= devices.size()) || (mac >= devices[dev]->pMacs.size()))
+				return (false);
+			Mac::Disconnect(devices[dev]->pMacs[mac]);
+			return (true);
+		};
+	}
+	else if ((verb == "disconnectAll") || (verb == "reset"))
+	{
+		bool isReset = (verb == "reset");
+		size_t dev = 0;
+		bool allDevices = !(tokens >> dev);
+		action = [isReset, dev, allDevices](std::vector<unique_ptr<Device>>& devices) {
+			if (!allDevices && (dev >= devices.size()))
+				return (false);
+			for (size_t i = 0; i < devices.size(); i++)
+			{
+				if (allDevices || (i == dev))
+				{
+					if (isReset)
+						devices[i]->reset();
+					else
+						devices[i]->disconnect();
+				}
+			}
+			return (true);
+		};
+	}
+	else if ((verb == "port") || (verb == "aggregator") || (verb == "distRelay"))
+	{
+		std::string target, attribute, value;
+		size_t dev = 0, index = 0;
+		bool allIndexes = false;
+		if (!(tokens >> target >> attribute >> value))
+		{
+			error = verb + " needs <dev>.<index>, an attribute and a value";
+			return (false);
+		}
+		size_t dot = target.find('.');
+		if ((verb == "aggregator") && (dot != std::string::npos) && (target.substr(dot + 1) == "*"))
+		{
+			unsigned long long devNumber = 0;
+			allIndexes = parseNumber(target.substr(0, dot), devNumber);
+			dev = (size_t)devNumber;
+		}
+		if (!allIndexes && !parseMac(target, dev, index))
+		{
+			error = verb + " needs <dev>.<index>, not " + target;
+			return (false);
+		}
+		action = parseSetting(verb, dev, index, allIndexes, attribute, value);
+		if (!action)
+			return (false);
+	}
+	else if (verb == "send")
+	{
+		size_t dev = 0;
+		unsigned short vid = 0;
+		if (!(tokens >> dev))
+		{
+			error = "send needs an End Station Device";
+			return (false);
+		}
+		bool tagged = (bool)(tokens >> vid);
+		action = [dev, tagged, vid](std::vector<unique_ptr<Device>>& devices) {
+			EndStn* pStation = (dev < devices.size()) ? findEndStn(*devices[dev]) : nullptr;
+			if (!pStation)
+				return (false);
+			if (tagged)
+				pStation->generateTestFrame(makeSdu<VlanTag>(CVlanEthertype, vid));
+			else
+				pStation->generateTestFrame();
+			return (true);
+		};
+	}
+	else if (verb == "flow")
+	{
+		size_t dev = 0, destination = 0;
+		double rate = 0;
+		unsigned int burst = 1;
+		std::string timing;
+		if (!(tokens >> dev >> destination >> rate) || (rate <= 0))
+		{
+			error = "flow needs End Station Devices for source and destination, and a rate";
+			return (false);
+		}
+		if (tokens >> burst)
+			tokens >> timing;
+		bool poisson = (timing == "poisson");
+		action = [dev, destination, rate, burst, poisson](std::vector<unique_ptr<Device>>& devices) {
+			EndStn* pStation = (dev < devices.size()) ? findEndStn(*devices[dev]) : nullptr;
+			EndStn* pDestination = (destination < devices.size()) ? findEndStn(*devices[destination]) : nullptr;
+			if (!pStation || !pDestination)
+				return (false);
+			FlowProfile profile(pDestination->SystemId.addr, rate);
+			profile.burst = burst;
+			profile.timing = poisson ? FlowProfile::Timing::POISSON : FlowProfile::Timing::CBR;
+			profile.start = SimLog::Time;
+			profile.seed = (unsigned int)(dev + 1);
+			pStation->traffic.addFlow(profile);
+			return (true);
+		};
+	}
+	else if (verb == "print")
+	{
+		std::string text;
+		std::getline(tokens >> std::ws, text);
+		action = [text](std::vector<unique_ptr<Device>>& devices) {
+			SimLog::console << endl << "Time " << SimLog::Time << ":    " << text << endl;
+			if (SimLog::Trace<0>())
+				SimLog::logFile << endl << "Time " << SimLog::Time << ":    " << text << endl;
+			return (true);
+		};
+	}
+	else
+	{
+		error = "unknown event " + verb;
+		return (false);
+	}
+
+	Event event;
+	event.time = time;
+	event.action = action;
+	events.push_back(event);
+	return (true);
+}
+
+Scenario::Action Scenario::parseSetting(const std::string& object, size_t dev, size_t index, bool allIndexes,
+	const std::string& attribute, const std::string& value)
+{
+	//  Attribute names are those of the set_ routines, less the set_aAggPort, set_aAgg, set_a or set_ prefix
+	typedef std::function<void(AggPort&, unsigned long long)> PortSetter;
+	typedef std::function<void(Aggregator&, unsigned long long)> AggSetter;
+	typedef std::function<void(DistributedRelay&, unsigned long long)> RelaySetter;
+	static const std::map<std::string, PortSetter> portSetters = {
+		{ "ActorSystemID", [](AggPort& p, unsigned long long v) { p.set_aAggPortActorSystemID(v); } },
+		{ "ActorSystemPriority", [](AggPort& p, unsigned long long v) { p.set_aAggPortActorSystemPriority((unsigned short)v); } },
+		{ "ActorAdminKey", [](AggPort& p, unsigned long long v) { p.set_aAggPortActorAdminKey((unsigned short)v); } },
+		{ "PartnerAdminSystemID", [](AggPort& p, unsigned long long v) { p.set_aAggPortPartnerAdminSystemID(v); } },
+		{ "PartnerAdminSystemPriority", [](AggPort& p, unsigned long long v) { p.set_aAggPortPartnerAdminSystemPriority((unsigned short)v); } },
+		{ "PartnerAdminKey", [](AggPort& p, unsigned long long v) { p.set_aAggPortPartnerAdminKey((unsigned short)v); } },
+		{ "ActorPort", [](AggPort& p, unsigned long long v) { p.set_aAggPortActorPort((unsigned short)v); } },
+		{ "ActorPortPriority", [](AggPort& p, unsigned long long v) { p.set_aAggPortActorPortPriority((unsigned short)v); } },
+		{ "PartnerAdminPort", [](AggPort& p, unsigned long long v) { p.set_aAggPortPartnerAdminPort((unsigned short)v); } },
+		{ "PartnerAdminPortPriority", [](AggPort& p, unsigned long long v) { p.set_aAggPortPartnerAdminPortPriority((unsigned short)v); } },
+		{ "ActorAdminState", [](AggPort& p, unsigned long long v) { p.set_aAggPortActorAdminState((unsigned char)v); } },
+		{ "LinkNumberID", [](AggPort& p, unsigned long long v) { p.set_aAggPortLinkNumberID((unsigned short)v); } },
+		{ "WTRTime", [](AggPort& p, unsigned long long v) { p.set_aAggPortWTRTime((unsigned short)v); } },
+		{ "ProtocolDA", [](AggPort& p, unsigned long long v) { p.set_aAggPortProtocolDA(v); } },
+	};
+	static const std::map<std::string, AggSetter> aggSetters = {
+		{ "ActorSystemID", [](Aggregator& a, unsigned long long v) { a.set_aAggActorSystemID(v); } },
+		{ "ActorSystemPriority", [](Aggregator& a, unsigned long long v) { a.set_aAggActorSystemPriority((unsigned short)v); } },
+		{ "ActorAdminKey", [](Aggregator& a, unsigned long long v) { a.set_aAggActorAdminKey((unsigned short)v); } },
+		{ "AdminState", [](Aggregator& a, unsigned long long v) { a.set_aAggAdminState(v != 0); } },
+		{ "CollectorMaxDelay", [](Aggregator& a, unsigned long long v) { a.set_aCollectorMaxDelay((unsigned short)v); } },
+		{ "PortAlgorithm", [](Aggregator& a, unsigned long long v) { a.set_aAggPortAlgorithm((LagAlgorithms)v); } },
+		{ "PartnerAdminPortAlgorithm", [](Aggregator& a, unsigned long long v) { a.set_aAggPartnerAdminPortAlgorithm((LagAlgorithms)v); } },
+		{ "AdminDiscardWrongConversation", [](Aggregator& a, unsigned long long v) { a.set_aAggAdminDiscardWrongConversation((adminValues)v); } },
+		{ "convLinkMap", [](Aggregator& a, unsigned long long v) { a.set_convLinkMap((Aggregator::convLinkMaps)v); } },
+	};
+	static const std::map<std::string, RelaySetter> relaySetters = {
+		{ "homeAdminGatewayAlgorithm", [](DistributedRelay& d, unsigned long long v) { d.set_homeAdminGatewayAlgorithm((LagAlgorithms)v); } },
+		{ "homeAdminCscdGatewayControl", [](DistributedRelay& d, unsigned long long v) { d.set_homeAdminCscdGatewayControl(v != 0); } },
+		{ "DrcpDeltaEncoding", [](DistributedRelay& d, unsigned long long v) { d.set_DrcpDeltaEncoding(v != 0); } },
+	};
+
+	if (object == "distRelay" && ((attribute == "homeAdminGatewayEnable") || (attribute == "homeAdminGatewayPreference")))
+	{
+		ConvMask mask;
+		if (!parseMask(value, mask))
+		{
+			error = attribute + " needs a mask (all, none, even or odd), not " + value;
+			return (nullptr);
+		}
+		bool enable = (attribute == "homeAdminGatewayEnable");
+		return ([dev, index, enable, mask](std::vector<unique_ptr<Device>>& devices) {
+			LinkAgg* pLag = (dev < devices.size()) ? findLinkAgg(*devices[dev]) : nullptr;
+			if (!pLag || (index >= pLag->pDistRelays.size()) || !pLag->pDistRelays[index])
+				return (false);
+			if (enable)
+				pLag->pDistRelays[index]->set_homeAdminGatewayEnable(mask);
+			else
+				pLag->pDistRelays[index]->set_homeAdminGatewayPreference(mask);
+			return (true);
+		});
+	}
+
+	unsigned long long number = 0;
+	if (!parseValue(value, number))
+	{
+		error = "cannot use " + value + " as a value for " + attribute;
+		return (nullptr);
+	}
+
+	if (object == "port")
+	{
+		auto setter = portSetters.find(attribute);
+		if (setter != portSetters.end())
+		{
+			PortSetter set = setter->second;
+			return ([dev, index, set, number](std::vector<unique_ptr<Device>>& devices) {
+				LinkAgg* pLag = (dev < devices.size()) ? findLinkAgg(*devices[dev]) : nullptr;
+				if (!pLag || (index >= pLag->pAggPorts.size()))
+					return (false);
+				set(*pLag->pAggPorts[index], number);
+				return (true);
+			});
+		}
+	}
+	else if (object == "aggregator")
+	{
+		auto setter = aggSetters.find(attribute);
+		if (setter != aggSetters.end())
+		{
+			AggSetter set = setter->second;
+			return ([dev, index, allIndexes, set, number](std::vector<unique_ptr<Device>>& devices) {
+				LinkAgg* pLag = (dev < devices.size()) ? findLinkAgg(*devices[dev]) : nullptr;
+				if (!pLag || (!allIndexes && (index >= pLag->pAggregators.size())))
+					return (false);
+				for (size_t i = 0; i < pLag->pAggregators.size(); i++)
+					if (allIndexes || (i == index))
+						set(*pLag->pAggregators[i], number);
+				return (true);
+			});
+		}
+	}
+	else
+	{
+		auto setter = relaySetters.find(attribute);
+		if (setter != relaySetters.end())
+		{
+			RelaySetter set = setter->second;
+			return ([dev, index, set, number](std::vector<unique_ptr<Device>>& devices) {
+				LinkAgg* pLag = (dev < devices.size()) ? findLinkAgg(*devices[dev]) : nullptr;
+				if (!pLag || (index >= pLag->pDistRelays.size()) || !pLag->pDistRelays[index])
+					return (false);
+				set(*pLag->pDistRelays[index], number);
+				return (true);
+			});
+		}
+	}
+	error = "unknown " + object + " attribute " + attribute;
+	return (nullptr);
+}
+
+bool Scenario::parseNumber(const std::string& token, unsigned long long& value)
+{
+	if (token.empty() || !isdigit((unsigned char)token[0]))
+		return (false);
+	size_t used = 0;
+	value = std::stoull(token, &used, 0);                    // Decimal, or hexadecimal with 0x
+	return (used == token.size());
+}
+
+bool Scenario::parseValue(const std::string& token, unsigned long long& value)
+{
+	static const std::map<std::string, unsigned long long> names = {
+		{ "false", 0 }, { "true", 1 },
+		{ "FORCE_FALSE", adminValues::FORCE_FALSE }, { "FORCE_TRUE", adminValues::FORCE_TRUE }, { "AUTO", adminValues::AUTO },
+		{ "NONE", LagAlgorithms::NONE }, { "UNSPECIFIED", LagAlgorithms::UNSPECIFIED }, { "C_VID", LagAlgorithms::C_VID },
+		{ "S_VID", LagAlgorithms::S_VID }, { "I_SID", LagAlgorithms::I_SID }, { "TE_SID", LagAlgorithms::TE_SID },
+		{ "ECMP_FLOW_HASH", LagAlgorithms::ECMP_FLOW_HASH },
+		{ "ADMIN_TABLE", Aggregator::ADMIN_TABLE }, { "ACTIVE_STANDBY", Aggregator::ACTIVE_STANDBY },
+		{ "EVEN_ODD", Aggregator::EVEN_ODD }, { "EIGHT_LINK_SPREAD", Aggregator::EIGHT_LINK_SPREAD },
+		{ "defaultActorKey", defaultActorKey }, { "unusedAggregatorKey", unusedAggregatorKey },
+	};
+
+	auto name = names.find(token);
+	if (name != names.end())
+	{
+		value = name->second;
+		return (true);
+	}
+	return (parseNumber(token, value));
+}
+
+bool Scenario::parseMac(const std::string& token, size_t& dev, size_t& index)
+{
+	size_t dot = token.find('.');
+	unsigned long long devNumber = 0;
+	unsigned long long indexNumber = 0;
+	if ((dot == std::string::npos) || !parseNumber(token.substr(0, dot), devNumber) || !parseNumber(token.substr(dot + 1), indexNumber))
+		return (false);
+	dev = (size_t)devNumber;
+	index = (size_t)indexNumber;
+	return (true);
+}
+
+bool Scenario::parseMask(const std::string& token, ConvMask& mask)
+{
+	mask.reset();
+	if (token == "all")
+		mask.set();
+	else if ((token == "even") || (token == "odd"))
+	{
+		for (size_t cid = (token == "even") ? 0 : 1; cid < 4096; cid += 2)
+			mask.set(cid);
+	}
+	else if (token != "none")
+		return (false);
+	return (true);
+}
@@ -0,0 +1,104 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Simulation.h"
+
+
+/*
+*   Class Scenario is a test scenario read from a text file, so a new scenario can be run without rebuilding
+*       (e.g. "drni -scenario dualHoming.txt").  The file is parsed once by load(), and run() puts every event on the
+*       event queue of a Simulation, so running costs nothing per Time increment beyond the Simulation itself.
+*   A file has one statement per line.  Tokens are separated by white space and '#' starts a comment.
+*       Devices are numbered in the order they are created, and a Mac or port is given as <dev>.<index>.
+*       Topology statements (optional; without them the scenario runs on Devices built by the caller):
+*           bridges <count> <macs>                  Add count Devices with a C-VLAN Bridge and macs Macs
+*           stations <count> <macs>                 Add count Devices with an End Station and macs Macs
+*           distRelay <dev>.<mac> <firstLinkNum>    Make a Distributed Relay with two DRNI Aggregation Ports and two
+*                                                      Intra-Relay Ports, starting at Mac mac (as in drni.cpp)
+*       Event statements, at a Time relative to the start of the run:
+*           at <time> connect <dev>.<mac> <dev>.<mac> [delay]
+*           at <time> disconnect <dev>.<mac>
+*           at <time> disconnectAll [dev]           Disconnect all Macs of one Device (or of all Devices)
+*           at <time> reset [dev]                   Reset one Device (or all Devices)
+*           at <time> port <dev>.<port> <attribute> <value>
+*           at <time> aggregator <dev>.<agg> <attribute> <value>     (agg "*" for every Aggregator of the Device)
+*           at <time> distRelay <dev>.<index> <attribute> <value>
+*           at <time> send <dev> [vid]              Generate a test frame from an End Station (C-VLAN tagged if vid given)
+*           at <time> flow <dev> <destDev> <rate> [burst] [poisson]   Start a flow of test frames (see TrafficGen.h)
+*           at <time> print <text>                  Write text to the console and logFile
+*       End statement:
+*           run <duration>                          Time increments to run (default:  just past the last event)
+*   Attributes are the 802.1AX managed objects without their prefix (e.g. "port 0.3 WTRTime 10" calls
+*       set_aAggPortWTRTime(10)).  Values are numbers (decimal or 0x hexadecimal), enumeration names (C_VID, AUTO,
+*       EVEN_ODD, ...), true or false, or for Conversation ID masks:  all, none, even or odd.
+*   Events may be listed in any order.  load() sorts them by Time, keeping the file order of events at the same Time.
+*       load() returns false if a statement cannot be parsed, with the line and reason in getError().  run() returns
+*       false if the Devices do not have all the Devices, Macs, ports and Distributed Relays the events refer to.
+*/
+
+class Scenario
+{
+public:
+	Scenario();
+	Scenario(Scenario& copySource) = delete;             // Disable copy constructor
+	Scenario& operator= (const Scenario&) = delete;      // Disable assignment operator
+
+	bool load(std::istream& in);
+	bool loadFile(const std::string& fileName);
+	const std::string& getError() const;
+
+	bool hasTopology() const;
+	void build(std::vector<unique_ptr<Device>>& devices) const;   // Add the Devices of the topology statements
+	bool run(std::vector<unique_ptr<Device>>& devices, unsigned int threads = SimLog::Threads) const;
+	size_t getEventCount() const;
+	int getDuration() const;
+
+private:
+	typedef std::function<bool(std::vector<unique_ptr<Device>>&)> Action;   // Returns false if a Device is missing
+
+	struct Event
+	{
+		int time;
+		Action action;
+	};
+	struct DeviceSpec
+	{
+		bool bridge;
+		int macs;
+	};
+	struct DistRelaySpec
+	{
+		size_t dev;
+		int mac;
+		unsigned short firstLinkNum;
+	};
+
+	std::vector<DeviceSpec> topology;
+	std::vector<DistRelaySpec> distRelays;
+	std::vector<Event> events;
+	int duration;                                        // -1 if no run statement
+	std::string error;
+
+	bool parseStatement(std::istringstream& tokens, const std::string& keyword);
+	bool parseEvent(int time, std::istringstream& tokens);
+	Action parseSetting(const std::string& object, size_t dev, size_t index, bool allIndexes,
+		const std::string& attribute, const std::string& value);
+	static bool parseNumber(const std::string& token, unsigned long long& value);
+	static bool parseValue(const std::string& token, unsigned long long& value);   // Number, name or true/false
+	static bool parseMac(const std::string& token, size_t& dev, size_t& index);   // <dev>.<index>
+	static bool parseMask(const std::string& token, ConvMask& mask);
+};
@@ -0,0 +1,270 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "Simulation.h"
+
+
+
+Simulation::Simulation(std::vector<unique_ptr<Device>>& devices, unsigned int threads)
+	: Devices(devices), nextDevice(0)
+{
+	eventSequence = 0;
+	activeTicks = 0;
+	idleTicks = 0;
+	idleDeviceRuns = 0;
+	actionTime = SimLog::Time;
+	phase = 0;
+	phaseTime = SimLog::Time;
+	busyWorkers = 0;
+	stopWorkers = false;
+	logFlags = SimLog::logFile.flags();
+	consoleFlags = SimLog::console.flags();
+
+	if (threads > 1)
+	{
+		for (size_t i = 0; i < Devices.size(); i++)
+		{
+			outputs.push_back(make_unique<DeviceOutput>());
+		}
+		for (unsigned int i = 1; i < threads; i++)      // The calling thread is also used to run Devices
+		{
+			workers.push_back(std::thread(&Simulation::workerLoop, this));
+		}
+	}
+}
+
+Simulation::~Simulation()
+{
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		stopWorkers = true;
+	}
+	phaseStart.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	while (!events.empty())          // Discard any actions that were never reached
+		events.pop();
+}
+
+bool Simulation::LaterEvent::operator()(const SimEvent& a, const SimEvent& b) const
+{
+	if (a.time != b.time)
+		return (a.time > b.time);
+	else
+		return (a.sequence > b.sequence);
+}
+
+void Simulation::schedule(int time, std::function<void()> action)
+{
+	SimEvent thisEvent;
+	thisEvent.time = time;
+	thisEvent.sequence = eventSequence++;
+	thisEvent.action = action;
+	events.push(thisEvent);
+}
+
+unsigned long long Simulation::getActiveTicks() const
+{
+	return (activeTicks);
+}
+
+unsigned long long Simulation::getIdleTicks() const
+{
+	return (idleTicks);
+}
+
+unsigned long long Simulation::getIdleDeviceRuns() const
+{
+	return (idleDeviceRuns);
+}
+
+unsigned int Simulation::getThreads() const
+{
+	return ((unsigned int)workers.size() + 1);
+}
+
+void Simulation::executeActions()
+{
+	while (!events.empty() && (events.top().time <= SimLog::Time))
+	{
+		std::function<void()> action = events.top().action;    // Copy action and remove from queue before executing
+		events.pop();                                           //    so the action can schedule further actions
+		action();
+		actionTime = SimLog::Time;
+	}
+}
+
+int Simulation::nextEventTime() const
+{
+	int nextTime = SimLog::EndOfTime;
+
+	if (!events.empty())
+		nextTime = events.top().time;
+	for (auto& pDev : Devices)
+	{
+		nextTime = std::min(nextTime, pDev->nextEventTime());
+		if (nextTime <= SimLog::Time)      // No need to look further if something to do now
+			break;
+	}
+	return (nextTime);
+}
+
+void Simulation::tick()
+{
+	if (SimLog::Trace<1>())
+		SimLog::logFile << "*" << endl;
+
+	//  Run all state machines in all devices that are not quiescent, and transmit from any MAC with frames to transmit
+	findDeviceRuns();
+	runDevices();
+
+	activeTicks++;
+	SimLog::Time++;
+}
+
+void Simulation::run(int endTime)
+{
+	int settleEnd = SimLog::Time;
+
+	while (SimLog::Time < endTime)
+	{
+		int nextTime = std::min(endTime, nextEventTime());
+
+		if (nextTime <= SimLog::Time)                       // If there is an event at this Time
+		{
+			settleEnd = SimLog::Time + SimLog::SettleTime;  //    then keep running after it until state machines settle
+		}
+		else if (SimLog::Time > settleEnd)                  // Otherwise if settled 
+		{
+			idleTicks += nextTime - SimLog::Time;          //    then skip directly to the next event, since timers
+			SimLog::Time = nextTime;                        //    hold their expiry Time and need no work while idle
+			continue;
+		}
+
+		executeActions();
+		tick();
+	}
+}
+
+void Simulation::findDeviceRuns()
+{
+	deviceEventTimes.resize(Devices.size(), SimLog::Time);     // Devices added since last Time increment start out active
+	deviceRuns.resize(Devices.size());
+
+	for (size_t i = 0; i < Devices.size(); i++)
+	{
+		if ((SimLog::Time <= actionTime + SimLog::SettleTime) || (Devices[i]->nextEventTime() <= SimLog::Time))
+			deviceEventTimes[i] = SimLog::Time;
+		deviceRuns[i] = (SimLog::Time <= deviceEventTimes[i] + SimLog::SettleTime);
+		if (!deviceRuns[i])
+			idleDeviceRuns++;
+	}
+}
+
+void Simulation::runDevices()
+{
+	if (workers.empty() || (outputs.size() != Devices.size()))     // Run serially if single threaded or Devices added since created
+	{
+		for (size_t i = 0; i < Devices.size(); i++)
+		{
+			Devices[i]->timerTick();     // Decrement timers
+			if (deviceRuns[i])
+				Devices[i]->run(true);   // Run device with single-step true
+			Devices[i]->transmit();
+		}
+		return;
+	}
+
+	std::streambuf* pLogBuf = SimLog::logFile.rdbuf();      // Save the calling thread's output streams
+	std::streambuf* pConsoleBuf = SimLog::console.rdbuf();
+	logFlags = SimLog::logFile.flags();
+	consoleFlags = SimLog::console.flags();
+
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		nextDevice = 0;
+		busyWorkers = (unsigned int)workers.size();
+		phaseTime = SimLog::Time;
+		phase++;
+	}
+	phaseStart.notify_all();
+
+	runPhase();                                              // Calling thread runs Devices along with the workers
+
+	{
+		std::unique_lock<std::mutex> lock(poolMutex);        // Barrier:  wait for all workers to finish the phase
+		phaseDone.wait(lock, [this] { return (busyWorkers == 0); });
+	}
+
+	SimLog::logFile.rdbuf(pLogBuf);                          // Restore the calling thread's output streams
+	SimLog::console.rdbuf(pConsoleBuf);
+	SimLog::logFile.flags(logFlags);
+	SimLog::console.flags(consoleFlags);
+
+	for (auto& pOutput : outputs)                            // Copy buffered output in Device order
+	{
+		SimLog::logFile << pOutput->log.str();
+		SimLog::console << pOutput->console.str();
+		pOutput->log.str("");
+		pOutput->console.str("");
+	}
+}
+
+void Simulation::runPhase()
+{
+	size_t i;
+	while ((i = nextDevice++) < Devices.size())
+	{
+		SimLog::logFile.rdbuf(&outputs[i]->log);
+		SimLog::console.rdbuf(&outputs[i]->console);
+		SimLog::logFile.flags(logFlags);
+		SimLog::console.flags(consoleFlags);
+
+		Devices[i]->timerTick();     // Decrement timers
+		if (deviceRuns[i])
+			Devices[i]->run(true);   // Run device with single-step true
+		Devices[i]->transmit();
+	}
+}
+
+void Simulation::workerLoop()
+{
+	unsigned long long lastPhase = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(poolMutex);
+			phaseStart.wait(lock, [this, lastPhase] { return (stopWorkers || (phase != lastPhase)); });
+			if (stopWorkers)
+				return;
+			lastPhase = phase;
+			SimLog::Time = phaseTime;
+		}
+
+		runPhase();
+
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			busyWorkers--;
+		}
+		phaseDone.notify_one();
+	}
+}
@@ -0,0 +1,112 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Device.h"
+
+
+/*
+*   Class Simulation is a discrete-event scheduler that drives a set of Devices.
+*       Rather than single-stepping every Device through every Time increment, SimLog::Time jumps directly
+*       to the next Time at which something can happen:
+*           -- an action on the event queue (e.g. Mac::Connect, Mac::Disconnect, or a management change)
+*                 that was scheduled by a test, or
+*           -- a protocol event (timer expiry or frame delivery) reported by a Device's nextEventTime().
+*       At each event Time all Devices are run through a complete Time increment (timerTick, run, transmit).
+*       A Device receives the Frames its link partners transmitted in earlier Time increments (see LinkChannel.h),
+*       so the order in which Devices are run within a Time increment does not matter.
+*       Between events the Devices are idle, and since protocol timers hold their expiry Time (see Timer.h) nothing
+*       needs to be done to advance Time to the next event, however far away it is.  This produces the same
+*       behavior as single-stepping, but the cost is proportional to protocol activity rather than to Time.
+*   Within a Time increment that has an event, a Device is only run if it has an event of its own (its nextEventTime()
+*       is the current Time), or had one in the last SettleTime increments.  Other Devices are quiescent, so only their
+*       timers are advanced.  All Devices are run for SettleTime increments after actions are executed, since an action 
+*       can change a Device in ways that nextEventTime() does not report.
+*   If created with more than one thread, the timerTick, run and transmit of all Devices are spread across a pool of
+*       threads, with each thread taking the next Device not yet run.  Devices only interact through the lock-free
+*       channels of the Links between their Macs, so the threads only wait for each other (the barrier) once,
+*       at the end of each Time increment.
+*       Log and console output generated while running a Device is buffered per Device and written out in
+*       Device order after the barrier, so the output does not depend on the number of threads.
+*       Since SimLog::Time is per-thread, the workers take the Time of the calling thread at the start of each phase.
+*/
+/**/
+class Simulation
+{
+public:
+	Simulation(std::vector<unique_ptr<Device>>& devices, unsigned int threads = SimLog::Threads);
+	~Simulation();
+	Simulation(Simulation& copySource) = delete;             // Disable copy constructor
+	Simulation& operator= (const Simulation&) = delete;      // Disable assignment operator
+
+	void schedule(int time, std::function<void()> action);  // Put an action on the event queue to be executed at Time
+	void run(int endTime);                                   // Run the simulation until SimLog::Time reaches endTime
+	void tick();                                             // Run all Devices through one Time increment
+
+	unsigned long long getActiveTicks() const;               // Number of Time increments in which state machines were run
+	unsigned long long getIdleTicks() const;                 // Number of Time increments skipped (no Device run)
+	unsigned long long getIdleDeviceRuns() const;            // Number of times a quiescent Device was not run in an active Time increment
+	unsigned int getThreads() const;                         // Number of threads running Devices (including the calling thread)
+
+private:
+	struct SimEvent
+	{
+		int time;
+		unsigned long long sequence;                         // Preserves scheduling order of actions at the same Time
+		std::function<void()> action;
+	};
+	struct LaterEvent                                        // Orders the event queue with the earliest event on top
+	{
+		bool operator()(const SimEvent& a, const SimEvent& b) const;
+	};
+
+	std::vector<unique_ptr<Device>>& Devices;
+	std::priority_queue<SimEvent, std::vector<SimEvent>, LaterEvent> events;
+	unsigned long long eventSequence;
+	unsigned long long activeTicks;
+	unsigned long long idleTicks;
+	unsigned long long idleDeviceRuns;
+	int actionTime;                                          // Time the most recent actions were executed
+	std::vector<int> deviceEventTimes;                       // Time of most recent event in each Device
+	std::vector<char> deviceRuns;                            // Whether each Device is run in the current Time increment
+
+	struct DeviceOutput                                      // Output generated while running a Device in a worker thread
+	{
+		std::stringbuf log;
+		std::stringbuf console;
+	};
+
+	std::vector<std::thread> workers;                        // Threads in addition to the calling thread
+	std::vector<unique_ptr<DeviceOutput>> outputs;
+	std::mutex poolMutex;
+	std::condition_variable phaseStart;
+	std::condition_variable phaseDone;
+	unsigned long long phase;                                // Incremented to start each parallel run phase
+	int phaseTime;                                           // SimLog::Time of the calling thread in the current phase
+	unsigned int busyWorkers;                                // Workers that have not finished the current phase
+	bool stopWorkers;
+	std::atomic<size_t> nextDevice;                          // Index of next Device to be run in the current phase
+	std::ios_base::fmtflags logFlags;                        // Format of the logFile and console at the start of the phase
+	std::ios_base::fmtflags consoleFlags;
+
+	void executeActions();                                   // Execute all actions scheduled at or before SimLog::Time
+	int nextEventTime() const;                               // Earliest of the next action and the next event of every Device
+	void findDeviceRuns();                                   // Determine which Devices have an event or are settling after one
+	void runDevices();                                       // timerTick and transmit all Devices and run the active ones, in parallel when there are workers
+	void runPhase();                                         // Run Devices until there are none left in the current phase
+	void workerLoop();
+};
+/**/
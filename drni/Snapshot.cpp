@@ -0,0 +1,315 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Snapshot.h"
+#include "IdList.h"
+#include "Device.h"
+#include "Stats.h"
+
+
+static const unsigned long SnapshotMagic = 0x44524e32;   // "DRN2":  changes whenever the layout of any saveState changes
+
+Snapshot::Snapshot()
+{
+	readPos = 0;
+	valid = true;
+}
+
+Snapshot::~Snapshot()
+{
+}
+
+void Snapshot::save(const std::vector<unique_ptr<Device>>& devices)
+{
+	data.clear();
+	indexMacs(devices);
+
+	put(SnapshotMagic);
+	put(SimLog::Time);
+	put(devices.size());
+	for (auto& pDev : devices)
+	{
+		pDev->saveState(*this);
+	}
+	macIndex.clear();
+	macs.clear();
+}
+
+bool Snapshot::restore(std::vector<unique_ptr<Device>>& devices)
+{
+	readPos = 0;
+	valid = true;
+	indexMacs(devices);
+
+	unsigned long magic = 0;
+	get(magic);
+	valid = valid && (magic == SnapshotMagic);
+	get(SimLog::Time);
+	if (match(devices.size()))
+	{
+		for (auto& pDev : devices)
+		{
+			if (!valid)
+				break;
+			pDev->restoreState(*this);
+		}
+	}
+	valid = valid && (readPos == data.size());
+	macs.clear();
+
+	NetStats::clear(devices);
+	return (valid);
+}
+
+bool Snapshot::writeFile(const std::string& fileName) const
+{
+	std::ofstream file(fileName, std::ios::binary);
+	file.write(data.data(), data.size());
+	return (file.good());
+}
+
+bool Snapshot::readFile(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	if (!file)
+		return (false);
+	std::streamsize length = file.tellg();
+	file.seekg(0);
+	data.resize((size_t)length);
+	file.read(data.data(), length);
+	return (file.good());
+}
+
+void Snapshot::copy(const Snapshot& source)
+{
+	data = source.data;
+	readPos = 0;
+	valid = true;
+}
+
+bool Snapshot::write(std::ostream& out) const
+{
+	unsigned long long length = data.size();
+	out.write((const char*)&length, sizeof(length));
+	out.write(data.data(), data.size());
+	return (out.good());
+}
+
+bool Snapshot::read(std::istream& in)
+{
+	unsigned long long length = 0;
+	in.read((char*)&length, sizeof(length));
+	data.resize(in.good() ? (size_t)length : 0);
+	in.read(data.data(), data.size());
+	readPos = 0;
+	valid = in.good();
+	return (valid);
+}
+
+void Snapshot::clear()
+{
+	data.clear();
+	readPos = 0;
+	valid = true;
+}
+
+size_t Snapshot::size() const
+{
+	return (data.size());
+}
+
+void Snapshot::put(const std::list<unsigned short>& values)
+{
+	put(values.size());
+	for (auto value : values)
+		put(value);
+}
+
+void Snapshot::get(std::list<unsigned short>& values)
+{
+	size_t count = 0;
+	get(count);
+	values.clear();
+	for (size_t i = 0; valid && (i < count); i++)
+	{
+		unsigned short value = 0;
+		get(value);
+		values.push_back(value);
+	}
+}
+
+void Snapshot::put(const std::vector<unsigned short>& values)
+{
+	put(values.size());
+	for (auto value : values)
+		put(value);
+}
+
+void Snapshot::get(std::vector<unsigned short>& values)
+{
+	size_t count = 0;
+	get(count);
+	values.clear();
+	for (size_t i = 0; valid && (i < count); i++)
+	{
+		unsigned short value = 0;
+		get(value);
+		values.push_back(value);
+	}
+}
+
+void Snapshot::put(const IdList& values)
+{
+	put(values.size());
+	for (auto value : values)
+		put(value);
+}
+
+void Snapshot::get(IdList& values)
+{
+	size_t count = 0;
+	get(count);
+	values.clear();
+	for (size_t i = 0; valid && (i < count); i++)
+	{
+		unsigned short value = 0;
+		get(value);
+		values.insert(value);
+	}
+}
+
+void Snapshot::put(const std::map<unsigned short, std::list<unsigned short>>& values)
+{
+	put(values.size());
+	for (auto& entry : values)
+	{
+		put(entry.first);
+		put(entry.second);
+	}
+}
+
+void Snapshot::get(std::map<unsigned short, std::list<unsigned short>>& values)
+{
+	size_t count = 0;
+	get(count);
+	values.clear();
+	for (size_t i = 0; valid && (i < count); i++)
+	{
+		unsigned short key = 0;
+		get(key);
+		get(values[key]);
+	}
+}
+
+template <class T> void Snapshot::putRuns(const std::array<T, 4096>& cidVector)
+{
+	size_t start = 0;
+	while (start < cidVector.size())
+	{
+		size_t end = start + 1;
+		while ((end < cidVector.size()) && (cidVector[end] == cidVector[start]))
+			end++;
+		put((unsigned short)(end - start));
+		put(cidVector[start]);
+		start = end;
+	}
+}
+
+template <class T> void Snapshot::getRuns(std::array<T, 4096>& cidVector)
+{
+	size_t start = 0;
+	while (valid && (start < cidVector.size()))
+	{
+		unsigned short run = 0;
+		T value = 0;
+		get(run);
+		get(value);
+		if ((run == 0) || (start + run > cidVector.size()))
+		{
+			valid = false;
+			break;
+		}
+		std::fill(cidVector.begin() + start, cidVector.begin() + start + run, value);
+		start += run;
+	}
+}
+
+void Snapshot::putVector(const std::array<unsigned short, 4096>& cidVector)
+{
+	putRuns(cidVector);
+}
+
+void Snapshot::getVector(std::array<unsigned short, 4096>& cidVector)
+{
+	getRuns(cidVector);
+}
+
+void Snapshot::putVector(const std::array<unsigned char, 4096>& cidVector)
+{
+	putRuns(cidVector);
+}
+
+void Snapshot::getVector(std::array<unsigned char, 4096>& cidVector)
+{
+	getRuns(cidVector);
+}
+
+void Snapshot::indexMacs(const std::vector<unique_ptr<Device>>& devices)
+{
+	macIndex.clear();
+	macs.clear();
+	for (auto& pDev : devices)
+	{
+		for (auto& pMac : pDev->pMacs)
+		{
+			macIndex[pMac.get()] = macs.size();
+			macs.push_back(pMac);
+		}
+	}
+}
+
+void Snapshot::putMac(const Mac* pMac)
+{
+	size_t index = macs.size();                  // Mac not in the Devices (e.g. null) is recorded as one past the last
+	auto entry = macIndex.find(pMac);
+	if (entry != macIndex.end())
+		index = entry->second;
+	put(index);
+}
+
+shared_ptr<Mac> Snapshot::getMac()
+{
+	size_t index = 0;
+	get(index);
+	if (index < macs.size())
+		return (macs[index]);
+	return (nullptr);
+}
+
+bool Snapshot::match(size_t expected)
+{
+	size_t count = 0;
+	get(count);
+	valid = valid && (count == expected);
+	return (valid);
+}
+
+bool Snapshot::good() const
+{
+	return (valid);
+}
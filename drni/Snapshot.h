@@ -0,0 +1,112 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+class Device;
+class Mac;
+class IdList;
+
+
+/*
+*   Class Snapshot holds the complete state of a network of Devices in a compact binary form, so that many scenarios
+*       (e.g. different failures) can start from the same converged network without re-running convergence.
+*   save() records SimLog::Time and, for every Device, the operational and administrative variables of each Component,
+*       Mac, Aggregator, Aggregation Port and Distributed Relay:  state machine states, timers, conversation masks and
+*       vectors, change flags, and the Frames in every queue (Mac request and indication queues, in flight on a Link).
+*   restore() writes that state back into Devices that were built by the same code as those saved (the same Components,
+*       Macs, ports and Distributed Relays in the same order, attached the same way).  The structure itself (which
+*       Components exist and the Iss pointers between them) is not part of the Snapshot, but Links between Macs are,
+*       so a Snapshot can be restored into the Devices it was taken from or into a newly built copy of them.
+*       restore() returns false if the Devices do not match the Snapshot, in which case they are partially restored
+*       and should be reset.  Statistics (Stats.h) are not part of the Snapshot and are cleared by restore().
+*   A Snapshot must be taken and restored between Simulation runs, since actions on a Simulation event queue are not
+*       part of it.  It can be written to and read from a file, to support starting from a converged network saved by
+*       an earlier run.  Restoring changes the read position of a Snapshot, so threads restoring the same state in
+*       parallel (see Sweep.h) each restore from their own copy.
+*   put and get can also be used directly, without save and restore, to build messages (see Partition.h), which can be
+*       sent through a stream with write and read.
+*   The saveState and restoreState routines of each class use put and get to copy their variables in order.
+*       Variables that are trivially copyable (integers, enums, unions, arrays, ConvMask, Timer) are copied as bytes,
+*       and Conversation ID vectors are run length encoded since they typically hold a few long runs of one value.
+*/
+
+class Snapshot
+{
+public:
+	Snapshot();
+	~Snapshot();
+	Snapshot(Snapshot& copySource) = delete;             // Disable copy constructor
+	Snapshot& operator= (const Snapshot&) = delete;      // Disable assignment operator
+
+	void save(const std::vector<unique_ptr<Device>>& devices);   // Replace contents with the state of devices
+	bool restore(std::vector<unique_ptr<Device>>& devices);      // Returns false if devices don't match the Snapshot
+	bool writeFile(const std::string& fileName) const;
+	bool readFile(const std::string& fileName);
+	void copy(const Snapshot& source);                           // Replace contents with those of source
+	bool write(std::ostream& out) const;                         // Length prefixed contents, so a stream can carry many Snapshots
+	bool read(std::istream& in);                                 // Replace contents with the next Snapshot written to the stream
+	void clear();                                                // Remove contents (e.g. to put a new message)
+	size_t size() const;                                         // Bytes in Snapshot
+
+	template <class T> void put(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Snapshot::put copies variables as bytes");
+		const char* pBytes = (const char*)&value;
+		data.insert(data.end(), pBytes, pBytes + sizeof(T));
+	}
+	template <class T> void get(T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Snapshot::get copies variables as bytes");
+		if (readPos + sizeof(T) > data.size())
+		{
+			valid = false;
+			return;
+		}
+		memcpy(&value, &data[readPos], sizeof(T));
+		readPos += sizeof(T);
+	}
+	void put(const std::list<unsigned short>& values);
+	void get(std::list<unsigned short>& values);
+	void put(const std::vector<unsigned short>& values);
+	void get(std::vector<unsigned short>& values);
+	void put(const IdList& values);
+	void get(IdList& values);
+	void put(const std::map<unsigned short, std::list<unsigned short>>& values);
+	void get(std::map<unsigned short, std::list<unsigned short>>& values);
+	void putVector(const std::array<unsigned short, 4096>& cidVector);   // Run length encoded Conversation ID vectors
+	void getVector(std::array<unsigned short, 4096>& cidVector);
+	void putVector(const std::array<unsigned char, 4096>& cidVector);
+	void getVector(std::array<unsigned char, 4096>& cidVector);
+
+	void putMac(const Mac* pMac);                      // A Mac is recorded as its position in the Devices
+	shared_ptr<Mac> getMac();
+	bool match(size_t expected);                       // Reads a count or size and checks it is as expected
+	bool good() const;                                 // False if the Devices being restored did not match the Snapshot
+
+private:
+	std::vector<char> data;
+	size_t readPos;
+	bool valid;
+	std::map<const Mac*, size_t> macIndex;             // Position of each Mac in the Devices (while saving)
+	std::vector<shared_ptr<Mac>> macs;                 // Mac at each position (while restoring)
+
+	void indexMacs(const std::vector<unique_ptr<Device>>& devices);
+
+	template <class T> void putRuns(const std::array<T, 4096>& cidVector);
+	template <class T> void getRuns(std::array<T, 4096>& cidVector);
+};
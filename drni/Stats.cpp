@@ -0,0 +1,227 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Device.h"
+#include "Stats.h"
+
+
+
+Histogram::Histogram()
+{
+	clear();
+}
+
+void Histogram::clear()
+{
+	buckets.fill(0);
+	samples = 0;
+	sum = 0;
+	minSample = 0;
+	maxSample = 0;
+}
+
+void Histogram::add(int sample)
+{
+	sample = std::max(0, sample);
+
+	int bucket = 0;
+	for (unsigned int value = (unsigned int)sample; (value != 0) && (bucket < NumBuckets - 1); value >>= 1)
+		bucket++;
+	buckets[bucket]++;
+
+	if ((samples == 0) || (sample < minSample))
+		minSample = sample;
+	if ((samples == 0) || (sample > maxSample))
+		maxSample = sample;
+	samples++;
+	sum += sample;
+}
+
+void Histogram::merge(const Histogram& other)
+{
+	if (other.samples == 0)
+		return;
+	for (int bucket = 0; bucket < NumBuckets; bucket++)
+		buckets[bucket] += other.buckets[bucket];
+	if ((samples == 0) || (other.minSample < minSample))
+		minSample = other.minSample;
+	if ((samples == 0) || (other.maxSample > maxSample))
+		maxSample = other.maxSample;
+	samples += other.samples;
+	sum += other.sum;
+}
+
+unsigned long long Histogram::count() const
+{
+	return (samples);
+}
+
+int Histogram::min() const
+{
+	return (minSample);
+}
+
+int Histogram::max() const
+{
+	return (maxSample);
+}
+
+double Histogram::mean() const
+{
+	if (samples == 0)
+		return (0);
+	return ((double)sum / samples);
+}
+
+int Histogram::percentile(double fraction) const
+{
+	unsigned long long target = (unsigned long long)(fraction * samples);
+	unsigned long long atOrBelow = 0;
+
+	for (int bucket = 0; bucket < NumBuckets; bucket++)
+	{
+		atOrBelow += buckets[bucket];
+		if ((atOrBelow > 0) && (atOrBelow >= target))
+			return (std::min(bucketLimit(bucket), maxSample));
+	}
+	return (maxSample);
+}
+
+unsigned long long Histogram::bucketCount(int bucket) const
+{
+	return (buckets[bucket]);
+}
+
+int Histogram::bucketLimit(int bucket)
+{
+	if (bucket >= NumBuckets - 1)
+		return (0x7fffffff);
+	return ((1 << bucket) - 1);
+}
+
+
+
+FlowStats::FlowStats()
+{
+	clear();
+}
+
+void FlowStats::clear()
+{
+	received = 0;
+	lost = 0;
+	duplicated = 0;
+	reordered = 0;
+	longestGap = 0;
+	latency.clear();
+	nextSequence = -1;             // Nothing received yet
+	lastRxTime = 0;
+	missing.clear();
+}
+
+void FlowStats::record(int sequenceNumber, int timeSent)
+{
+	if (received > 0)
+		longestGap = std::max(longestGap, SimLog::Time - lastRxTime);
+	received++;
+	lastRxTime = SimLog::Time;
+	latency.add(SimLog::Time - timeSent);
+
+	if (nextSequence < 0)                             // First frame from this source
+	{
+		nextSequence = sequenceNumber + 1;
+	}
+	else if (sequenceNumber >= nextSequence)          // In sequence, or after a gap
+	{
+		for (int skipped = nextSequence; skipped < sequenceNumber; skipped++)
+		{
+			lost++;
+			missing.insert(skipped);
+			if (missing.size() > MaxMissing)
+				missing.erase(missing.begin());
+		}
+		nextSequence = sequenceNumber + 1;
+	}
+	else if (missing.erase(sequenceNumber))           // Arrived after a later frame
+	{
+		lost--;
+		reordered++;
+	}
+	else                                              // Already received
+	{
+		duplicated++;
+	}
+}
+
+void FlowStats::merge(const FlowStats& other)
+{
+	received += other.received;
+	lost += other.lost;
+	duplicated += other.duplicated;
+	reordered += other.reordered;
+	longestGap = std::max(longestGap, other.longestGap);
+	latency.merge(other.latency);
+}
+
+
+
+NetStats::NetStats(const std::vector<unique_ptr<Device>>& devices)
+{
+	for (auto& pDev : devices)
+	{
+		for (auto& pComp : pDev->pComponents)
+		{
+			if (pComp->getCompType() == ComponentTypes::LINK_AGG)
+			{
+				for (auto& pPort : ((LinkAgg&)*pComp).pAggPorts)
+					distributingDelay.merge(pPort->getDistributingDelay());
+			}
+			else if (pComp->getCompType() == ComponentTypes::END_STATION)
+			{
+				testFrames.merge(((EndStn&)*pComp).getFlowStats());
+			}
+		}
+		for (auto& pMac : pDev->pMacs)
+		{
+			queueResidence.merge(pMac->getQueueResidence());
+		}
+	}
+}
+
+void NetStats::clear(const std::vector<unique_ptr<Device>>& devices)
+{
+	for (auto& pDev : devices)
+	{
+		for (auto& pComp : pDev->pComponents)
+		{
+			if (pComp->getCompType() == ComponentTypes::LINK_AGG)
+			{
+				for (auto& pPort : ((LinkAgg&)*pComp).pAggPorts)
+					pPort->clearStats();
+			}
+			else if (pComp->getCompType() == ComponentTypes::END_STATION)
+			{
+				((EndStn&)*pComp).clearStats();
+			}
+		}
+		for (auto& pMac : pDev->pMacs)
+		{
+			pMac->clearStats();
+		}
+	}
+}
@@ -0,0 +1,115 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+class Device;
+
+
+/*
+*   Class Histogram counts integer samples (e.g. a number of Time increments) in buckets whose size doubles:
+*       bucket 0 counts samples of zero, and bucket b counts samples from 2^(b-1) to (2^b)-1.
+*       The exact minimum, maximum and mean are kept as well, so a bound such as "no failover took more than N
+*       Time increments" can be checked exactly, while percentiles are resolved to a bucket.
+*/
+
+class Histogram
+{
+public:
+	Histogram();
+
+	static const int NumBuckets = 32;
+
+	void add(int sample);                        // Negative samples are counted as zero
+	void merge(const Histogram& other);
+	void clear();
+
+	unsigned long long count() const;
+	int min() const;                             // Zero if no samples
+	int max() const;
+	double mean() const;
+	int percentile(double fraction) const;       // Upper limit of the bucket containing the given fraction of samples (at most max)
+	unsigned long long bucketCount(int bucket) const;
+	static int bucketLimit(int bucket);          // Largest sample counted in bucket
+
+private:
+	std::array<unsigned long long, NumBuckets> buckets;
+	unsigned long long samples;
+	long long sum;
+	int minSample;
+	int maxSample;
+};
+
+
+/*
+*   Class FlowStats tracks the sequence numbers (TestSdu::scratchPad) of the test frames received from one flow
+*       (a source station, or a flow of a traffic generator), and their latency (from TestSdu::timeSent).
+*       A sequence number that is skipped is counted as lost, unless it arrives later, in which case it is counted
+*       as reordered instead.  A sequence number that is received again is counted as duplicated.
+*       The longest gap between consecutive test frames is the data plane outage (e.g. failover time) seen by the flow.
+*   A source that generates a test frame when its own link is down skips a sequence number, so frames that were never
+*       transmitted during a failover are included in the lost frames.
+*   FlowStats can be merged to give the totals for a set of flows, in which case the longest gap is the longest of any flow.
+*/
+
+class FlowStats
+{
+public:
+	FlowStats();
+
+	unsigned long long received;
+	unsigned long long lost;
+	unsigned long long duplicated;
+	unsigned long long reordered;
+	int longestGap;                              // Longest Time between consecutive test frames received
+	Histogram latency;                           // Time from generating each test frame to receiving it
+
+	void record(int sequenceNumber, int timeSent);   // Record a test frame received at SimLog::Time
+	void merge(const FlowStats& other);
+	void clear();
+
+private:
+	static const size_t MaxMissing = 1024;       // Oldest missing sequence numbers are forgotten (and stay lost)
+
+	int nextSequence;                            // Next sequence number expected
+	int lastRxTime;
+	std::set<int> missing;                       // Sequence numbers skipped that could still be reordered
+};
+
+
+/*
+*   Class NetStats collects the statistics of a set of Devices:
+*       -- distributingDelay:  Time from an Aggregation Port becoming operational (e.g. after Mac::Connect) to
+*             distributing, for every Aggregation Port in every LinkAgg.
+*       -- queueResidence:  Time between a Frame being requested at a Mac and being delivered to its link partner
+*             (the Mac::Request TimeStamp to Mac::Transmit, including the link delay), for every Mac.
+*       -- testFrames:  test frames received by every End Station, merged over all sources.
+*   The statistics of each Component can also be queried directly (AggPort::getDistributingDelay, Mac::getQueueResidence,
+*       EndStn::getFlowStats).  Statistics accumulate until cleared with NetStats::clear.
+*/
+
+class NetStats
+{
+public:
+	NetStats(const std::vector<unique_ptr<Device>>& devices);
+
+	Histogram distributingDelay;
+	Histogram queueResidence;
+	FlowStats testFrames;
+
+	static void clear(const std::vector<unique_ptr<Device>>& devices);
+};
@@ -0,0 +1,128 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Sweep.h"
+
+
+
+Sweep::Sweep(Builder builder, const Snapshot& baseline)
+	: build(builder), baseline(baseline), nextScenario(0)
+{
+	duration = 0;
+	logFlags = SimLog::logFile.flags();
+	consoleFlags = SimLog::console.flags();
+}
+
+Sweep::~Sweep()
+{
+}
+
+void Sweep::add(std::string name, Perturbation perturbation)
+{
+	unique_ptr<Scenario> pScenario = make_unique<Scenario>();
+	pScenario->name = name;
+	pScenario->perturbation = perturbation;
+	scenarios.push_back(std::move(pScenario));
+}
+
+size_t Sweep::size() const
+{
+	return (scenarios.size());
+}
+
+std::vector<unique_ptr<Benchmark::Result>> Sweep::run(int runDuration, unsigned int threads)
+{
+	std::vector<unique_ptr<Benchmark::Result>> results;
+
+	duration = runDuration;
+	nextScenario = 0;
+	threads = std::max(1u, std::min(threads, (unsigned int)scenarios.size()));
+	logFlags = SimLog::logFile.flags();
+	consoleFlags = SimLog::console.flags();
+
+	std::streambuf* pLogBuf = SimLog::logFile.rdbuf();   // Save the calling thread's output streams
+	std::streambuf* pConsoleBuf = SimLog::console.rdbuf();
+	std::streambuf* pCoutBuf = cout.rdbuf();
+	int saveTime = SimLog::Time;
+
+	SimLog::logFile.rdbuf(nullptr);                      // Discard output from building (and later destroying) the
+	SimLog::console.rdbuf(nullptr);                      //    networks, since there is one per thread
+	cout.rdbuf(nullptr);
+	std::vector<unique_ptr<Topology>> nets;
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		nets.push_back(build());
+	}
+	cout.rdbuf(pCoutBuf);
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < threads; i++)           // The calling thread also runs scenarios
+	{
+		workers.push_back(std::thread(&Sweep::runScenarios, this, std::ref(*nets[i])));
+	}
+	runScenarios(*nets[0]);
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	SimLog::logFile.rdbuf(nullptr);
+	SimLog::console.rdbuf(nullptr);
+	cout.rdbuf(nullptr);
+	nets.clear();
+	cout.rdbuf(pCoutBuf);
+
+	SimLog::Time = saveTime;                             // Restore the calling thread's Time and output streams
+	SimLog::logFile.rdbuf(pLogBuf);
+	SimLog::console.rdbuf(pConsoleBuf);
+	SimLog::logFile.flags(logFlags);
+	SimLog::console.flags(consoleFlags);
+
+	for (auto& pScenario : scenarios)                    // Copy buffered output in scenario order
+	{
+		SimLog::logFile << pScenario->log.str();
+		SimLog::console << pScenario->console.str();
+		pScenario->log.str("");
+		pScenario->console.str("");
+		results.push_back(std::move(pScenario->pResult));
+	}
+	return (results);
+}
+
+void Sweep::runScenarios(Topology& net)
+{
+	Snapshot start;                                      // Each thread restores from its own copy of the baseline
+	start.copy(baseline);
+
+	size_t i;
+	while ((i = nextScenario++) < scenarios.size())
+	{
+		Scenario& scenario = *scenarios[i];
+		SimLog::logFile.rdbuf(&scenario.log);
+		SimLog::console.rdbuf(&scenario.console);
+		SimLog::logFile.flags(logFlags);
+		SimLog::console.flags(consoleFlags);
+
+		if (start.restore(net.Devices))
+		{
+			Simulation sim(net.Devices, 1);
+			scenario.perturbation(net, sim);
+			scenario.pResult = make_unique<Benchmark::Result>(Benchmark::measure(net, sim, scenario.name, SimLog::Time + duration));
+		}
+	}
+}
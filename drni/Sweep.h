@@ -0,0 +1,72 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include "Benchmark.h"
+#include "Snapshot.h"
+
+
+/*
+*   Class Sweep runs a list of perturbations (e.g. disconnect a Link, change an administrative variable) of one converged
+*       network, each as an independent scenario that starts from the same baseline Snapshot (see Snapshot.h).
+*   Each perturbation is a routine that schedules actions on the scenario's Simulation (or makes changes directly) at
+*       the start Time of the baseline.  The scenario is then run for a duration, and its Result (see Benchmark.h)
+*       records the convergence and frame loss statistics gathered.
+*   The scenarios are spread across a pool of threads.  Before starting the threads, a copy of the network is built for
+*       each thread (with the same routine that built the baseline network), and each thread restores the baseline into
+*       its copy for every scenario it runs.  SimLog::Time is per-thread, so the scenarios do not interfere, and each
+*       scenario runs its Simulation single threaded.
+*   Results are returned in the order the perturbations were added, and log and console output of each scenario is
+*       buffered and written out in that order after all scenarios are done, so the output does not depend on the number
+*       of threads.  A scenario whose network does not match the baseline has a null Result.
+*/
+
+class Sweep
+{
+public:
+	typedef std::function<unique_ptr<Topology>()> Builder;
+	typedef std::function<void(Topology& net, Simulation& sim)> Perturbation;
+
+	Sweep(Builder builder, const Snapshot& baseline);
+	~Sweep();
+	Sweep(Sweep& copySource) = delete;             // Disable copy constructor
+	Sweep& operator= (const Sweep&) = delete;      // Disable assignment operator
+
+	void add(std::string name, Perturbation perturbation);
+	size_t size() const;                           // Number of perturbations
+	std::vector<unique_ptr<Benchmark::Result>> run(int duration, unsigned int threads = std::thread::hardware_concurrency());
+
+private:
+	struct Scenario
+	{
+		std::string name;
+		Perturbation perturbation;
+		unique_ptr<Benchmark::Result> pResult;
+		std::stringbuf log;                        // Output generated while running the scenario
+		std::stringbuf console;
+	};
+
+	Builder build;
+	const Snapshot& baseline;
+	std::vector<unique_ptr<Scenario>> scenarios;
+	std::atomic<size_t> nextScenario;              // Index of next scenario to be run
+	int duration;
+	std::ios_base::fmtflags logFlags;              // Format of the logFile and console of the calling thread
+	std::ios_base::fmtflags consoleFlags;
+
+	void runScenarios(Topology& net);              // Run scenarios until there are none left
+};
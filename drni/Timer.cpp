@@ -0,0 +1,53 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Timer.h"
+
+
+
+Timer::Timer()
+{
+	deadline = -1;
+}
+
+Timer& Timer::operator= (int increments)
+{
+	if (increments > 0)
+		deadline = SimLog::Time + increments;
+	else
+		deadline = -1;
+	return (*this);
+}
+
+Timer::operator int() const
+{
+	if (deadline > SimLog::Time)
+		return (deadline - SimLog::Time);
+	else
+		return (0);
+}
+
+int Timer::expiry() const
+{
+	//  Assumes called after the Time increment, i.e. before the state machines run in the next Time increment.
+	//     A timer that reaches zero in that Time increment is an event then (the state machines see it expire).
+	if (deadline >= SimLog::Time)
+		return (deadline);
+	else
+		return (SimLog::EndOfTime);      // A timer that is not running does not generate an event
+}
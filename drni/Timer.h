@@ -0,0 +1,43 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+
+/*
+*   Class Timer is a protocol timer (e.g. currentWhileTimer or DrcpTxWhen) that counts down one per Time increment.
+*       It is used like the int it replaces:  assigning a number of Time increments starts the timer (zero stops it), and
+*       reading it gives the Time increments remaining (zero when expired or not running).
+*   Rather than being decremented every Time increment, the Timer holds the Time at which it expires (its deadline),
+*       so no work is needed to advance Time, and the Time of the next expiry is known without stepping through the
+*       intervening Time increments.  A Timer started with a value of N during a Time increment reads zero N Time
+*       increments later, as it would if decremented by a timerTick at the start of each Time increment.
+*   A Timer keeps running while the component that owns it is suspended.
+*/
+
+class Timer
+{
+public:
+	Timer();                                 // Not running
+
+	Timer& operator= (int increments);       // Start the timer to expire after increments Time increments (0 stops it)
+	operator int() const;                    // Time increments remaining, or 0 if expired or not running
+	int expiry() const;                      // Time at which timer will reach zero, or SimLog::EndOfTime if already zero
+
+private:
+	int deadline;
+};
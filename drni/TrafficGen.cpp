@@ -0,0 +1,200 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "TrafficGen.h"
+#include "Snapshot.h"
+
+
+FlowProfile::FlowProfile(unsigned long long destination, double frameRate)
+{
+	firstDA = destination;
+	countDA = 1;
+	firstSA = 0;
+	countSA = 1;
+	firstVid = 0;
+	countVid = 1;
+	firstPriority = 0;
+	countPriority = 1;
+	rate = frameRate;
+	burst = 1;
+	timing = Timing::CBR;
+	start = 0;
+	stop = SimLog::EndOfTime;
+	seed = 1;
+}
+
+
+
+TrafficGen::TrafficGen()
+{
+}
+
+TrafficGen::~TrafficGen()
+{
+}
+
+size_t TrafficGen::addFlow(const FlowProfile& profile)
+{
+	FlowProfile thisProfile = profile;
+	thisProfile.countDA = std::max(1u, thisProfile.countDA);           // A count of zero is taken as a single value
+	thisProfile.countSA = std::max(1u, thisProfile.countSA);
+	thisProfile.countVid = std::max((unsigned short)1, thisProfile.countVid);
+	thisProfile.countPriority = std::max((unsigned short)1, thisProfile.countPriority);
+	thisProfile.burst = std::max(1u, thisProfile.burst);
+
+	FlowState state;
+	state.sequenceNumber = 0;
+	state.random = (thisProfile.seed % 2147483647) ? (thisProfile.seed % 2147483647) : 1;
+	if (thisProfile.rate > 0)
+	{
+		state.nextBurst = std::max(SimLog::Time, thisProfile.start);
+		if (thisProfile.timing == FlowProfile::Timing::POISSON)
+			state.nextBurst += burstGap(thisProfile, state);
+	}
+	else
+	{
+		state.nextBurst = SimLog::EndOfTime;                           // Never sends
+	}
+
+	profiles.push_back(thisProfile);
+	states.push_back(state);
+	return (profiles.size() - 1);
+}
+
+void TrafficGen::clearFlows()
+{
+	profiles.clear();
+	states.clear();
+}
+
+size_t TrafficGen::getFlowCount() const
+{
+	return (profiles.size());
+}
+
+const FlowProfile& TrafficGen::getFlow(size_t flow) const
+{
+	return (profiles[flow]);
+}
+
+unsigned long long TrafficGen::getFramesGenerated(size_t flow) const
+{
+	return (states[flow].sequenceNumber);
+}
+
+unsigned long long TrafficGen::flowId(unsigned long long stationAddr, size_t flow)
+{
+	return (((unsigned long long)(flow + 1) << 48) | stationAddr);   // Never zero, and distinct from any MAC address
+}
+
+double TrafficGen::burstGap(const FlowProfile& profile, FlowState& state)
+{
+	double meanGap = profile.burst / profile.rate;
+	if (profile.timing == FlowProfile::Timing::CBR)
+		return (meanGap);
+
+	state.random = (unsigned int)(((unsigned long long)state.random * 48271) % 2147483647);   // minstd_rand
+	double uniform = (state.random - 1) / 2147483646.0;                // In [0, 1)
+	return (-meanGap * std::log(1.0 - uniform));                      // Exponentially distributed gap
+}
+
+unique_ptr<Frame> TrafficGen::makeFrame(const FlowProfile& profile, FlowState& state, unsigned long long stationAddr, size_t flow)
+{
+	//  Each range is stepped by the sequence number, so ranges with counts that have no common factor cover every combination
+	unsigned int seq = state.sequenceNumber;
+	unsigned long long destination = profile.firstDA + (seq % profile.countDA);
+	unsigned long long source = (profile.firstSA ? profile.firstSA : stationAddr) + (seq % profile.countSA);
+	unsigned short priority = profile.firstPriority + (seq % profile.countPriority);
+
+	shared_ptr<Sdu> pSdu = makeSdu<TestSdu>(state.sequenceNumber, flowId(stationAddr, flow), SimLog::Time);
+	unique_ptr<Frame> pFrame = make_unique<Frame>(destination, source, pSdu);
+	if (profile.firstVid)
+	{
+		unsigned short vid = profile.firstVid + (seq % profile.countVid);
+		pFrame = pFrame->InsertTag(makeSdu<VlanTag>(CVlanEthertype, vid, priority));
+	}
+	else
+	{
+		pFrame->Priority = priority;
+	}
+	pFrame->TimeStamp = SimLog::Time;
+	return (pFrame);
+}
+
+void TrafficGen::generate(Iss& iss, unsigned long long stationAddr)
+{
+	bool operational = iss.getOperational();     // As generateTestFrame:  no frames if the Iss would discard them
+	size_t generated = 0;
+
+	for (size_t flow = 0; flow < profiles.size(); flow++)
+	{
+		const FlowProfile& profile = profiles[flow];
+		FlowState& state = states[flow];
+		while ((state.nextBurst < (SimLog::Time + 1)) && (state.nextBurst < profile.stop) && (generated < MaxBatch))
+		{
+			for (unsigned int i = 0; i < profile.burst; i++)
+			{
+				if (operational)
+					batch.push_back(makeFrame(profile, state, stationAddr, flow));
+				state.sequenceNumber++;          // Frames not sent are counted as lost by the receiver
+			}
+			generated += profile.burst;
+			state.nextBurst += burstGap(profile, state);
+		}
+	}
+	if (!batch.empty())
+		iss.RequestBurst(batch);                 // Leaves batch empty
+}
+
+int TrafficGen::nextEventTime() const
+{
+	int nextTime = SimLog::EndOfTime;
+
+	for (size_t flow = 0; flow < profiles.size(); flow++)
+	{
+		if (states[flow].nextBurst < profiles[flow].stop)
+			nextTime = std::min(nextTime, std::max(SimLog::Time, (int)states[flow].nextBurst));
+	}
+	return (nextTime);
+}
+
+void TrafficGen::saveState(Snapshot& snap) const
+{
+	snap.put(profiles.size());
+	for (size_t flow = 0; flow < profiles.size(); flow++)
+	{
+		snap.put(profiles[flow]);
+		snap.put(states[flow]);
+	}
+}
+
+void TrafficGen::restoreState(Snapshot& snap)
+{
+	size_t count = 0;
+	snap.get(count);
+	profiles.clear();
+	states.clear();
+	for (size_t flow = 0; snap.good() && (flow < count); flow++)
+	{
+		FlowProfile profile;
+		FlowState state;
+		snap.get(profile);
+		snap.get(state);
+		profiles.push_back(profile);
+		states.push_back(state);
+	}
+}
@@ -0,0 +1,106 @@
+/*
+Copyright 2020 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include "Mac.h"
+
+
+/*
+*   Struct FlowProfile describes a flow of test frames offered by an End Station (see EndStn::addFlow).
+*       Successive frames of the flow step through ranges of destination and source address, VLAN Identifier and
+*       priority, so one flow can spread over many Conversation IDs (see LinkAgg::frameConvID).  A range with a count
+*       of one is a single value.  A source address of zero is the End Station's own address, and a VLAN Identifier
+*       of zero sends untagged frames (with the priority in the Frame rather than a C-VLAN tag).
+*   Frames leave in bursts of burst frames.  Bursts start at a mean of rate / burst per Time increment, either evenly
+*       spaced (CBR) or as a Poisson process (exponentially distributed gaps), from Time start until Time stop.
+*/
+
+struct FlowProfile
+{
+	enum class Timing { CBR, POISSON };
+
+	unsigned long long firstDA;
+	unsigned int countDA;
+	unsigned long long firstSA;                  // Zero for the End Station's address
+	unsigned int countSA;
+	unsigned short firstVid;                     // Zero for untagged frames
+	unsigned short countVid;
+	unsigned short firstPriority;
+	unsigned short countPriority;
+	double rate;                                 // Mean frames per Time increment
+	unsigned int burst;                          // Frames sent together
+	Timing timing;
+	int start;
+	int stop;
+	unsigned int seed;                           // Seed for the Poisson process
+
+	FlowProfile(unsigned long long destination = defaultDA, double frameRate = 1.0);
+};
+
+
+/*
+*   Class TrafficGen generates the frames of the flows of an End Station.  EndStn::run calls generate each Time
+*       increment the End Station is run, and EndStn::nextEventTime reports the start of the next burst, so an idle
+*       generator costs nothing between bursts.
+*   Each frame carries a TestSdu with the flow's sequence number, the flow identifier (flowId) and the Time it was
+*       generated, so a receiving End Station can track the loss, reordering and latency of each flow (see FlowStats).
+*       A sequence number is used even if the frame is discarded because the End Station's Iss is not operational,
+*       so those frames count as lost.
+*   The frames of a Time increment are built into a batch that is handed to the Iss with one RequestBurst.  The batch
+*       vector is kept between Time increments, and Frames and Sdus come from the Pool (see Pool.h), so generating
+*       traffic does not allocate from the heap.  At most MaxBatch frames are generated in a Time increment;
+*       bursts that are due beyond that are delayed to the following Time increments.
+*   Flows are administrative, so they are kept by reset() and are part of a Snapshot along with the generator state.
+*/
+
+class TrafficGen
+{
+public:
+	TrafficGen();
+	~TrafficGen();
+	TrafficGen(TrafficGen& copySource) = delete;             // Disable copy constructor
+	TrafficGen& operator= (const TrafficGen&) = delete;      // Disable assignment operator
+
+	static const size_t MaxBatch = 256;
+
+	size_t addFlow(const FlowProfile& profile);               // Returns index of the flow
+	void clearFlows();
+	size_t getFlowCount() const;
+	const FlowProfile& getFlow(size_t flow) const;
+	unsigned long long getFramesGenerated(size_t flow) const;
+	static unsigned long long flowId(unsigned long long stationAddr, size_t flow);   // TestSdu::flowId of a flow
+
+	void generate(Iss& iss, unsigned long long stationAddr);  // Send all frames due in this Time increment
+	int nextEventTime() const;                                // Time the next burst is due (EndOfTime if none)
+
+	void saveState(Snapshot& snap) const;
+	void restoreState(Snapshot& snap);
+
+private:
+	struct FlowState
+	{
+		double nextBurst;                        // Time the next burst is due (Time increment is the integer part)
+		int sequenceNumber;                      // Also the number of frames generated
+		unsigned int random;                     // State of the flow's random number generator
+	};
+
+	std::vector<FlowProfile> profiles;
+	std::vector<FlowState> states;
+	std::vector<unique_ptr<Frame>> batch;                     // Re-used for the frames of each Time increment
+
+	static double burstGap(const FlowProfile& profile, FlowState& state);    // Time from one burst to the next
+	unique_ptr<Frame> makeFrame(const FlowProfile& profile, FlowState& state, unsigned long long stationAddr, size_t flow);
+};
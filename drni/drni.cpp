@@ -38,15 +38,52 @@ limitations under the License.
 #include "Device.h"
 #include "Mac.h"
 #include "Frame.h"
+#include "Simulation.h"
+#include "Benchmark.h"
+#include "Scenario.h"
 
 using namespace std;
 
-int main()
+int main(int argc, char* argv[])
 {
+	if ((argc == 3) && (std::string(argv[1]) == "-decode"))   // Convert a binary trace file to text on the console
+	{
+		std::ifstream binaryTrace(argv[2], std::ios_base::in | std::ios_base::binary);
+		SimLog::decodeTrace(binaryTrace, cout);
+		return (0);
+	}
+	if ((argc >= 2) && (std::string(argv[1]) == "-benchmark"))   // Run the benchmark workloads and write results to the console
+	{
+		int scale = (argc >= 3) ? std::max(1, atoi(argv[2])) : 1;
+		std::ostream results(cout.rdbuf());
+		Benchmark::run(scale, results);
+		return (0);
+	}
+
 	//	SimLog::logFile << System::DateTime::Now;
 	//	SimLog::logFile << asctime_s(); 
 	SimLog::logFile << endl;
 	SimLog::Debug = 8; // 6 9
+	SimLog::Threads = 1;   // std::thread::hardware_concurrency();
+	SimLog::DataPlaneThreads = 1;   // More than one to collect and distribute the frames of each Aggregator in parallel
+	SimLog::BinaryTrace = false;   // true to write per-frame messages to "Drni trace.bin" rather than the logFile
+	if ((argc == 3) && (std::string(argv[1]) == "-scenario"))   // Build the Devices of a scenario file and run it
+	{
+		Scenario scenario;
+		if (!scenario.loadFile(argv[2]) || !scenario.hasTopology())
+		{
+			cout << "Scenario " << argv[2] << ":  " << (scenario.getError().empty() ? "no bridges or stations" : scenario.getError()) << endl;
+			return (1);
+		}
+		std::vector<unique_ptr<Device>> Devices;
+		scenario.build(Devices);
+		SimLog::Time = 0;
+		bool complete = scenario.run(Devices);
+		Devices.clear();
+		if (!complete)
+			cout << "Scenario " << argv[2] << ":  an event refers to a Device, Mac or port that does not exist" << endl;
+		return (complete ? 0 : 1);
+	}
 
 //	void send8Frames(EndStn& source);
 
@@ -74,7 +111,7 @@ int main()
 
 
 	cout << "*** Start of program ***" << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "*** Start of program ***" << endl << endl;
 
 
@@ -90,7 +127,7 @@ int main()
 	int endStnMacCnt = 4;
 
 	cout << "   Building Devices:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "   Building Devices:  " << endl << endl;
 
 	for (int dev = 0; dev < brgCnt + endStnCnt; dev++)
@@ -113,7 +150,7 @@ int main()
 	//  Run the simulation
 	//
 	cout << endl << "   Running Simulation:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "   Running Simulation (with Debug level " << SimLog::Debug << "):  " << endl << endl;
 
 	SimLog::Time = 0;
@@ -138,7 +175,7 @@ int main()
 	//
 	/**/
 	cout << endl << "    Configure Distributed Relays" << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "    Configure Distributed Relays" << endl << endl;
 
 	sysId adminDrniId;
@@ -229,13 +266,13 @@ int main()
 	//
 
 	cout << endl << "    Cleaning up devices:" << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "    Cleaning up devices:" << endl << endl;
 
 	Devices.clear();
 
 	cout << endl << "*** End of program ***" << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << "*** End of program ***" << endl << endl;
 
 	return 0;
@@ -248,7 +285,7 @@ void send9Frames(EndStn & source)
 	source.generateTestFrame();                                                  // create and transmit un-tagged test frame
 	for (unsigned short vid = 0; vid < 8; vid++)
 	{
-		shared_ptr<VlanTag> pVtag = make_shared<VlanTag>(CVlanEthertype, vid);   // create C-VLAN Tag
+		shared_ptr<VlanTag> pVtag = makeSdu<VlanTag>(CVlanEthertype, vid);   // create C-VLAN Tag
 		source.generateTestFrame(pVtag);                                         // create and transmit C-VLAN-tagged test frame
 	}
 }
@@ -265,16 +302,16 @@ void printLinkMap(std::vector<unique_ptr<Device>> & Devices)
 				cout << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << pAgg->actorAdminSystem.addrMid
 					<< ":" << pAgg->get_aAggID() << "     DWC = " << pAgg->get_aAggOperDiscardWrongConversation()
 					<< endl << "     Actor   PortAlg = 0x" << pAgg->get_aAggPortAlgorithm() << "  CDigest = ";
-				for (auto& val : pAgg->get_aAggOperConversationListDigest()) cout << val;
+				for (auto val : pAgg->get_aAggOperConversationListDigest()) cout << setw(2) << setfill('0') << (int)val << setfill(' ');
 				cout << endl << "     Partner PortAlg = 0x" << pAgg->get_aAggPartnerPortAlgorithm() << "  CDigest = ";
-				for (auto& val : pAgg->get_aAggPartnerOperConversationListDigest()) cout << val;
+				for (auto val : pAgg->get_aAggPartnerOperConversationListDigest()) cout << setw(2) << setfill('0') << (int)val << setfill(' ');
 				cout << endl << dec << "                ConvID->Link list" << " { ";
 				for (int i = 0; i < 8; i++)
 				{
 					cout << pAgg->get_conversationLink(i) << "  ";
 				}
 				cout << "}" << endl;
-				if (SimLog::Debug > 0)
+				if (SimLog::Trace<0>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << pAgg->actorAdminSystem.addrMid
 						<< ":" << pAgg->get_aAggID()
@@ -307,9 +344,10 @@ void PrintList(std::list<unsigned short> & input)
 void basicLagTest(std::vector<unique_ptr<Device>> & Devices)
 {
 	int start = SimLog::Time;
+	Simulation sim(Devices);
 
 	cout << endl << endl << "   Basic LAG Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Basic LAG Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -320,75 +358,64 @@ void basicLagTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);  // alias to LinkAgg shim of bridge b00
 	dev0Lag.pAggPorts[0]->set_aAggPortWTRTime(30);                  // temp: set WTR timer on bridge:port b00:100
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-
-		//  Make or break connections
-
-		if (SimLog::Time == start + 10)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Connect two Bridges
-		// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
-		if (SimLog::Time == start + 100)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[1]), 5);   // Second link between same Bridges
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:101 on Aggregator b01:200.
-		if (SimLog::Time == start + 200)
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[2]), 5);   // Third link between same Bridges
-		// Link 3 comes up with AggPort b00:102 on Aggregator b00:200 and AggPort b01:102 on Aggregator b01:200.
-
-		if (SimLog::Time == start + 300)
-			Mac::Disconnect((Devices[0]->pMacs[0]));                           // Take down first link
-		// Link 1 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:102 and b00:103 remain up on Aggregator b00:200
-		if (SimLog::Time == start + 400)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Reconnect first link between same Bridges
-		// Link 1 comes back up with one or two (depending on coupled/uncoupled MUX) LACPDU exchanges.
-
-		if (SimLog::Time == start + 500)
-			Mac::Disconnect((Devices[0]->pMacs[1]));                           // Take down second link
-		// Link 2 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:100 and b00:102 remain up on Aggregator b00:200
-		if (SimLog::Time == start + 600)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[3]), 5);   // Move one end of link to a different port on second bridge
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:103 on Aggregator b01:200.
-		// AggPort b01:100 gets kicked off Aggregator b01:200 since the partner moved to a new port (port_moved signal in RxSM)
-
-
-		if (SimLog::Time == start + 700)
-			Mac::Connect((Devices[0]->pMacs[4]), (Devices[2]->pMacs[0]), 5);   // Connect link between first and third bridges
-		// Link 1 of new LAG comes up with AggPort b00:104 on Aggregator b00:204 and AggPort b02:100 on Aggregator b02:200.
-		if (SimLog::Time == start + 800)
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[2]->pMacs[2]), 5);   // Connect another link between first and third bridges
-		// Link 3 comes up with AggPort b00:105 on Aggregator b00:204 and AggPort b02:102 on b02:200
-		// AggPorts b00:102 and b00:103 move to Aggregator b00:201, so both ends of LAG temporarily non-operational.
-		//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
-
-		if (SimLog::Time == start + 990)
-		{
-			dev0Lag.pAggPorts[0]->set_aAggPortWTRTime(0);                  // temp: restore default WTR timer on bridge:port b00:100
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
-
-
-		//  Run all state machines in all devices
+	//  Make or break connections
+
+	sim.schedule(start + 10, [&]() {
+		Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Connect two Bridges
+	});
+	// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
+	sim.schedule(start + 100, [&]() {
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[1]), 5);   // Second link between same Bridges
+	});
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:101 on Aggregator b01:200.
+	sim.schedule(start + 200, [&]() {
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[2]), 5);   // Third link between same Bridges
+	});
+	// Link 3 comes up with AggPort b00:102 on Aggregator b00:200 and AggPort b01:102 on Aggregator b01:200.
+
+	sim.schedule(start + 300, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[0]));                           // Take down first link
+	});
+	// Link 1 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:102 and b00:103 remain up on Aggregator b00:200
+	sim.schedule(start + 400, [&]() {
+		Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Reconnect first link between same Bridges
+	});
+	// Link 1 comes back up with one or two (depending on coupled/uncoupled MUX) LACPDU exchanges.
+
+	sim.schedule(start + 500, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[1]));                           // Take down second link
+	});
+	// Link 2 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:100 and b00:102 remain up on Aggregator b00:200
+	sim.schedule(start + 600, [&]() {
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[3]), 5);   // Move one end of link to a different port on second bridge
+	});
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:103 on Aggregator b01:200.
+	// AggPort b01:100 gets kicked off Aggregator b01:200 since the partner moved to a new port (port_moved signal in RxSM)
+
+
+	sim.schedule(start + 700, [&]() {
+		Mac::Connect((Devices[0]->pMacs[4]), (Devices[2]->pMacs[0]), 5);   // Connect link between first and third bridges
+	});
+	// Link 1 of new LAG comes up with AggPort b00:104 on Aggregator b00:204 and AggPort b02:100 on Aggregator b02:200.
+	sim.schedule(start + 800, [&]() {
+		Mac::Connect((Devices[0]->pMacs[5]), (Devices[2]->pMacs[2]), 5);   // Connect another link between first and third bridges
+	});
+	// Link 3 comes up with AggPort b00:105 on Aggregator b00:204 and AggPort b02:102 on b02:200
+	// AggPorts b00:102 and b00:103 move to Aggregator b00:201, so both ends of LAG temporarily non-operational.
+	//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
+
+	sim.schedule(start + 990, [&]() {
+		dev0Lag.pAggPorts[0]->set_aAggPortWTRTime(0);                  // temp: restore default WTR timer on bridge:port b00:100
 		for (auto& pDev : Devices)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
-
-		SimLog::Time++;
-	}
+	//  Run all state machines in all devices until the end of the test
+	sim.run(start + 1000);
 }
 
 /*
@@ -399,7 +426,7 @@ void preferredAggregatorTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);  // alias to LinkAgg shim of bridge b00
 
 	cout << endl << endl << "   Preferred Aggregator Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Preferred Aggregator Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -409,7 +436,7 @@ void preferredAggregatorTest(std::vector<unique_ptr<Device>> & Devices)
 
 	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -486,7 +513,7 @@ void lagLoopbackTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   LAG Loopback Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   LAG Loopback Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -496,7 +523,7 @@ void lagLoopbackTest(std::vector<unique_ptr<Device>> & Devices)
 
 	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -585,7 +612,7 @@ void nonAggregatablePortTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev1Lag = (LinkAgg&)*(Devices[1]->pComponents[1]);
 
 	cout << endl << endl << "   non-Aggregatable (Solitary) Port Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   non-Aggregatable (Solitary) Port Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -669,7 +696,7 @@ void nonAggregatablePortTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -682,7 +709,7 @@ void limitedAggregatorsTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 
 	cout << endl << endl << "   Limited Aggregator (fewer Aggregators than AggPorts) Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Limited Aggregator (fewer Aggregators than AggPorts) Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -784,7 +811,7 @@ void limitedAggregatorsTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -798,7 +825,7 @@ void dualHomingTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 
 	cout << endl << endl << "   Dual-Homing Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Dual-Homing Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -882,7 +909,7 @@ void dualHomingTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -895,7 +922,7 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   802.1AXbk Hierarchical LAG Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   802.1AXbk Hierarchical LAG Tests:  " << endl << endl;
 
 	// This test uses two Bridges (Devices 0 and 1) and two End Stations (Devices 3 and 4).
@@ -916,11 +943,13 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>> & Devices)
 
 			unsigned short sysNum = 0;       // This is a single system device
 			unsigned char lacpVersion = 2;  // Outer LinkAgg shim will be version 2
-			shared_ptr<AggPort> pAggPort = make_shared<AggPort>(lacpVersion, sysNum, 0x200 + px);    // Create an AggPort/Aggregator pair
+			shared_ptr<AggPort> pAggPort = make_shared<AggPort>(lacpVersion, sysNum, 0x200 + px);    // Create an AggPort
+			shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>(lacpVersion, sysNum, 0x200 + px);   //    and an Aggregator
 			pAggPort->set_aAggPortProtocolDA(NearestCustomerBridgeDA);                       // Outer LinkAgg AggPort uses Nearest Customer Bridge DA for LACPDUs
-			pAggPort->assignActorSystem(station.SystemId);                    // Assign Aggregation Port/Aggregator to this End Station
+			pAggPort->assignActorSystem(station.SystemId);                    // Assign Aggregation Port and Aggregator to this End Station
+			pAggregator->assignActorSystem(station.SystemId);
 			pAggPort->pIss = innerLag.pAggregators[px];                            // Attach the inner LinkAgg Aggregator to this outer AggPort
-			pOuterLag->pAggregators.push_back(pAggPort);                        // Put Aggregator in the Device's outer LinkAgg shim
+			pOuterLag->pAggregators.push_back(pAggregator);                     // Put Aggregator in the Device's outer LinkAgg shim
 			pOuterLag->pAggPorts.push_back(pAggPort);                           // Put Aggregation Port in the Device's outer LinkAgg shim
 			pOuterLag->pDistRelays.push_back(nullptr);
 			if (px == 0)
@@ -929,8 +958,8 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>> & Devices)
 			}
 			else
 			{
-				pAggPort->set_aAggActorAdminKey(unusedAggregatorKey);          // Set Admin key of other outer Aggregators to value not shared with any AggPort
-				innerLag.pAggPorts[px]->set_aAggActorAdminKey(defaultActorKey);    // Set Admin key of other inner Aggregators to default value
+				pAggregator->set_aAggActorAdminKey(unusedAggregatorKey);       // Set Admin key of other outer Aggregators to value not shared with any AggPort
+				innerLag.pAggregators[px]->set_aAggActorAdminKey(defaultActorKey); // Set Admin key of other inner Aggregators to default value
 			}
 		}
 		Devices[sx]->pComponents.push_back(move(pOuterLag));                // Put outer Link Agg shim in Device's Components vector
@@ -1004,7 +1033,7 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>> & Devices)
 		}
 
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -1024,7 +1053,7 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>> & Devices)
 			}
 			else
 			{
-				innerLag.pAggPorts[px]->set_aAggActorAdminKey(unusedAggregatorKey);    // Set Admin key of other inner Aggregators to value not shared with any AggPort
+				innerLag.pAggregators[px]->set_aAggActorAdminKey(unusedAggregatorKey); // Set Admin key of other inner Aggregators to value not shared with any AggPort
 			}
 		}
 		Devices[sx]->pComponents.pop_back();   // remove outerLag from Device's Components vector and let it disappear
@@ -1043,7 +1072,7 @@ void distributionTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev2LinkAgg = (LinkAgg&)*(Devices[2]->pComponents[1]);
 
 	cout << endl << endl << "   Distribution Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distribution Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -1157,7 +1186,6 @@ void distributionTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 700)
 		{
-			std::array<unsigned char, 16> AdminTableDigest = { "ADMIN_TABLE    " };
 			std::list<unsigned short> portList;
 
 			// Set link distribution to admin-table in Bridge 0 Aggregator
@@ -1172,9 +1200,6 @@ void distributionTest(std::vector<unique_ptr<Device>> & Devices)
 				pAgg->set_aAggConversationAdminLink(5, portList = { 1 });
 				pAgg->set_aAggConversationAdminLink(6, portList = { 1, 0 });
 				pAgg->set_aAggConversationAdminLink(7, portList = { 3, 1, 2 });
-
-				//   set the digest for admin-table (should be calculated MD5 of the ConversationAdminLink map)
-				pAgg->set_aAggConversationListDigest(AdminTableDigest);
 				//   set the admin-table as the selected convLinkMap
 				pAgg->set_convLinkMap(Aggregator::convLinkMaps::ADMIN_TABLE);
 			}
@@ -1215,7 +1240,7 @@ void distributionTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -1225,11 +1250,12 @@ void distributionTest(std::vector<unique_ptr<Device>> & Devices)
 void waitToRestoreTest(std::vector<unique_ptr<Device>> & Devices)
 {
 	int start = SimLog::Time;
+	Simulation sim(Devices);
 	// aliases
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 
 	cout << endl << endl << "   Wait-To-Restore Timer Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Wait-To-Restore Timer Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -1237,233 +1263,204 @@ void waitToRestoreTest(std::vector<unique_ptr<Device>> & Devices)
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Time == start + 1)
-		{   // Set waitToRestoreTime of all AggPorts in Bridge 0 to 30
-			for (auto pPort : dev0Lag.pAggPorts)
-			{
-				pPort->set_aAggPortWTRTime(30);
-			}
-			// Set AggPorts 6 and 7 of Bridge 0 for dual-homing
-			//     (Change Aggregator 6 and AggPorts 6 and 7 to a new key,
-			//      and disable Aggregator 7)
-			dev0Lag.pAggregators[6]->set_aAggActorAdminKey(defaultActorKey + 0x100);
-			dev0Lag.pAggPorts[6]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
-			dev0Lag.pAggPorts[7]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
-			dev0Lag.pAggregators[7]->setEnabled(false);
-		}
-
-		//  Make or break connections
-
-		if (SimLog::Time == start + 10)
-		{   // Create three links between Bridge 0 and End Station 3.
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Links 1, 2 and 3 come up in a LAG on Aggregators b00:200 and e03:200.
-
-		if (SimLog::Time == start + 10)
-		{   // Dual home Bridges 0 to Bridges 1 and 2.
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
-		}
-		// Link 7 comes up in a LAG on Aggregators b00:206 and b01:206.
-		// Link 8 has no available Aggregators.
-
-		if (SimLog::Time == start + 100)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
-
-		if (SimLog::Time == start + 115)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
-
-		if (SimLog::Time == start + 120)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Link 3 goes down again.
-
-		if (SimLog::Time == start + 125)
-		{
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Link 3, re-starting WTR timer.
-
-		// Link 2 should re-join LAG at around time 155 (time 115 plus WTR plus a LACPDU round trip time)
-		// Link 3 should re-join LAG at around time 165
-
-		if (SimLog::Time == start + 200)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
-
-		if (SimLog::Time == start + 215)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
-		// Links 2 and 3 rejoin about time 255
-
-		if (SimLog::Time == start + 230)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[0]));
-		}
-		// Disconnect Link 1.
-
-		if (SimLog::Time == start + 250)
-		{
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
-		}
-		// Reconnect Link 1, starting WTR timer.
-		// Link 1 rejoins about time 290
-
-
-		if (SimLog::Time == start + 300)
-			Mac::Disconnect((Devices[0]->pMacs[6]));
-		// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
-
-		if (SimLog::Time == start + 350)
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
-		// Reconnect Link 7, taking over LAG when WTR timer expires.
-
-		if (SimLog::Time == start + 400)
-			Mac::Disconnect((Devices[0]->pMacs[7]));
-		// Link 8 goes down, to no effect.
-
-		if (SimLog::Time == start + 450)
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
-		// Reconnect Link 8, still no effect.
-
-		// So have links 1, 2, and 3 between bridge 0 and end station 3,
-		//   and link 7 between bridge 0 and 1, with link 8 having no available aggregators on bridge 0.
-
-		if (SimLog::Time == start + 500)
-		{	// Set waitToRestoreTime of all AggPorts in Bridge 0 to 30 with non-revertive mode
-			for (auto pPort : dev0Lag.pAggPorts)
-			{
-				pPort->set_aAggPortWTRTime(30 | 0x8000);
-			}
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
-		// AggPorts b00:101 and b00:102 set non-revertive
-
-		if (SimLog::Time == start + 515)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
-
-		if (SimLog::Time == start + 520)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Link 3 goes down again.
-
-		if (SimLog::Time == start + 525)
-		{
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Link 3, re-starting WTR timer.
-
-		// Links 2 and 3 do not re-join because non-revertive
-
-		if (SimLog::Time == start + 600)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down so still have just Link 1 in LAG between Bridge 0 and End Station 3.
-
-		if (SimLog::Time == start + 615)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
-
-		if (SimLog::Time == start + 630)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[0]));
-		}
-		// Disconnect Link 1, setting non-revertive.
-		// Now all links are non-revertive so all get set to revertive, but link 1 set non-revertive
-		//    again because it is still down.
-		// Links 2 and 3 come up around time 655.
+	sim.schedule(start + 1, [&]() {   // Set waitToRestoreTime of all AggPorts in Bridge 0 to 30
+		for (auto pPort : dev0Lag.pAggPorts)
+		{
+			pPort->set_aAggPortWTRTime(30);
+		}
+		// Set AggPorts 6 and 7 of Bridge 0 for dual-homing
+		//     (Change Aggregator 6 and AggPorts 6 and 7 to a new key,
+		//      and disable Aggregator 7)
+		dev0Lag.pAggregators[6]->set_aAggActorAdminKey(defaultActorKey + 0x100);
+		dev0Lag.pAggPorts[6]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
+		dev0Lag.pAggPorts[7]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
+		dev0Lag.pAggregators[7]->setEnabled(false);
+	});
+
+	//  Make or break connections
+
+	sim.schedule(start + 10, [&]() {   // Create three links between Bridge 0 and End Station 3.
+		Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Links 1, 2 and 3 come up in a LAG on Aggregators b00:200 and e03:200.
+
+	sim.schedule(start + 10, [&]() {   // Dual home Bridges 0 to Bridges 1 and 2.
+		Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
+		Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
+	});
+	// Link 7 comes up in a LAG on Aggregators b00:206 and b01:206.
+	// Link 8 has no available Aggregators.
+
+	sim.schedule(start + 100, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[1]));
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
+
+	sim.schedule(start + 115, [&]() {
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Reconnect Links 2 and 3, starting WTR timers.
+
+	sim.schedule(start + 120, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Link 3 goes down again.
+
+	sim.schedule(start + 125, [&]() {
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Reconnect Link 3, re-starting WTR timer.
+
+	// Link 2 should re-join LAG at around time 155 (time 115 plus WTR plus a LACPDU round trip time)
+	// Link 3 should re-join LAG at around time 165
+
+	sim.schedule(start + 200, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[1]));
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
+
+	sim.schedule(start + 215, [&]() {
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Reconnect Links 2 and 3, starting WTR timers.
+	// Links 2 and 3 rejoin about time 255
+
+	sim.schedule(start + 230, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[0]));
+	});
+	// Disconnect Link 1.
+
+	sim.schedule(start + 250, [&]() {
+		Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
+	});
+	// Reconnect Link 1, starting WTR timer.
+	// Link 1 rejoins about time 290
+
+
+	sim.schedule(start + 300, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[6]));
+	});
+	// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
+
+	sim.schedule(start + 350, [&]() {
+		Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
+	});
+	// Reconnect Link 7, taking over LAG when WTR timer expires.
+
+	sim.schedule(start + 400, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[7]));
+	});
+	// Link 8 goes down, to no effect.
+
+	sim.schedule(start + 450, [&]() {
+		Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
+	});
+	// Reconnect Link 8, still no effect.
+
+	// So have links 1, 2, and 3 between bridge 0 and end station 3,
+	//   and link 7 between bridge 0 and 1, with link 8 having no available aggregators on bridge 0.
+
+	sim.schedule(start + 500, [&]() {	// Set waitToRestoreTime of all AggPorts in Bridge 0 to 30 with non-revertive mode
+		for (auto pPort : dev0Lag.pAggPorts)
+		{
+			pPort->set_aAggPortWTRTime(30 | 0x8000);
+		}
+		Mac::Disconnect((Devices[0]->pMacs[1]));
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
+	// AggPorts b00:101 and b00:102 set non-revertive
+
+	sim.schedule(start + 515, [&]() {
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Reconnect Links 2 and 3, starting WTR timers.
+
+	sim.schedule(start + 520, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Link 3 goes down again.
+
+	sim.schedule(start + 525, [&]() {
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Reconnect Link 3, re-starting WTR timer.
+
+	// Links 2 and 3 do not re-join because non-revertive
+
+	sim.schedule(start + 600, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[1]));
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Links 2 and 3 go down so still have just Link 1 in LAG between Bridge 0 and End Station 3.
+
+	sim.schedule(start + 615, [&]() {
+		Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
+		Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+	});
+	// Reconnect Links 2 and 3, starting WTR timers.
+
+	sim.schedule(start + 630, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[0]));
+	});
+	// Disconnect Link 1, setting non-revertive.
+	// Now all links are non-revertive so all get set to revertive, but link 1 set non-revertive
+	//    again because it is still down.
+	// Links 2 and 3 come up around time 655.
+
+	sim.schedule(start + 650, [&]() {
+		Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
+	});
+	// Reconnect Link 1, starting WTR timer.
+	// Link 1 still non-revertive, so does not become active (i.e. not sync, collecting, or distributing).
+
+
+	sim.schedule(start + 700, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[6]));
+	});
+	// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
+
+	sim.schedule(start + 750, [&]() {
+		Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
+	});
+	// Reconnect Link 7, to no effect because AggPort b00:106 is non-revertive.
+
+	sim.schedule(start + 800, [&]() {
+		Mac::Disconnect((Devices[0]->pMacs[7]));
+	});
+	// Link 8 goes down, causing both AggPorts b00:106 and b00:107 to be set revertive, and Link 7 comes up.
+
+	sim.schedule(start + 850, [&]() {
+		Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
+	});
+	// Reconnect Link 8, no effect.
 
-		if (SimLog::Time == start + 650)
-		{
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
-		}
-		// Reconnect Link 1, starting WTR timer.
-		// Link 1 still non-revertive, so does not become active (i.e. not sync, collecting, or distributing).
 
-
-		if (SimLog::Time == start + 700)
-			Mac::Disconnect((Devices[0]->pMacs[6]));
-		// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
-
-		if (SimLog::Time == start + 750)
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
-		// Reconnect Link 7, to no effect because AggPort b00:106 is non-revertive.
-
-		if (SimLog::Time == start + 800)
-			Mac::Disconnect((Devices[0]->pMacs[7]));
-		// Link 8 goes down, causing both AggPorts b00:106 and b00:107 to be set revertive, and Link 7 comes up.
-
-		if (SimLog::Time == start + 850)
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
-		// Reconnect Link 8, no effect.
-
-
-		if (SimLog::Time == start + 990)
-		{   // Restore all default values
-			for (auto pAgg : dev0Lag.pAggregators)
-			{
-				pAgg->set_aAggActorAdminKey(defaultActorKey);
-				pAgg->setEnabled(true);
-			}
-			for (auto pPort : dev0Lag.pAggPorts)
-			{
-				pPort->set_aAggPortWTRTime(0);
-			}
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
-
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+	sim.schedule(start + 990, [&]() {   // Restore all default values
+		for (auto pAgg : dev0Lag.pAggregators)
+		{
+			pAgg->set_aAggActorAdminKey(defaultActorKey);
+			pAgg->setEnabled(true);
+		}
+		for (auto pPort : dev0Lag.pAggPorts)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);       // Run device with single-step true
+			pPort->set_aAggPortWTRTime(0);
 		}
-
-		//  Transmit from any MAC with frames to transmit
 		for (auto& pDev : Devices)
 		{
-			pDev->transmit();
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	//  Run all state machines in all devices until the end of the test
+	sim.run(start + 1000);
 
 }
 
@@ -1477,10 +1474,10 @@ void adminVariableTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev1LinkAgg = (LinkAgg&)*(Devices[1]->pComponents[1]);
 	LinkAgg& dev2LinkAgg = (LinkAgg&)*(Devices[2]->pComponents[1]);
 
-	unsigned short savedKey = dev0LinkAgg.pAggPorts[1]->get_aAggActorAdminKey();
+	unsigned short savedKey = dev0LinkAgg.pAggregators[1]->get_aAggActorAdminKey();
 
 	cout << endl << endl << "   Writing Administrative Variables Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Writing Administrative Variables Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -1518,29 +1515,31 @@ void adminVariableTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 200)
 		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggActorAdminKey(0x0246);           // change aggregator key
+			dev0LinkAgg.pAggregators[1]->set_aAggActorAdminKey(0x0246);        // change aggregator key
 		}
 
 		if (SimLog::Time == start + 300)
 		{
-			dev0LinkAgg.pAggPorts[2]->set_aAggActorSystemPriority(0x0135);     // change aggregator SysID (which changes LAG ID)
+			dev0LinkAgg.pAggregators[2]->set_aAggActorSystemPriority(0x0135);     // change aggregator SysID (which changes LAG ID)
+			dev0LinkAgg.pAggPorts[2]->set_aAggPortActorSystemPriority(0x0135);    //    and the SysID of its port
 		}
 
 		if (SimLog::Time == start + 400)
 		{
 			dev0LinkAgg.pAggPorts[1]->set_aAggPortActorAdminKey(savedKey);     // restore port key
-			dev0LinkAgg.pAggPorts[1]->set_aAggActorAdminKey(savedKey);         // restore aggregator key
-			dev0LinkAgg.pAggPorts[2]->set_aAggActorSystemPriority(0);          // restore aggregator SysID (which changes LAG ID)
+			dev0LinkAgg.pAggregators[1]->set_aAggActorAdminKey(savedKey);      // restore aggregator key
+			dev0LinkAgg.pAggregators[2]->set_aAggActorSystemPriority(0);       // restore aggregator SysID (which changes LAG ID)
+			dev0LinkAgg.pAggPorts[2]->set_aAggPortActorSystemPriority(0);      //    and the SysID of its port
 		}
 
 		/*
 				if (SimLog::Time == start + 450)                 // Patch up this link until Selection Logic bug is fixed
 				{
-					dev0LinkAgg.pAggPorts[3]->setEnabled(false);
+					dev0LinkAgg.pAggregators[3]->setEnabled(false);
 				}
 				if (SimLog::Time == start + 454)
 				{
-					dev0LinkAgg.pAggPorts[3]->setEnabled(true);
+					dev0LinkAgg.pAggregators[3]->setEnabled(true);
 				}
 		/**/
 
@@ -1551,7 +1550,7 @@ void adminVariableTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 600)
 		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortAlgorithm(LagAlgorithms::C_VID);       // change port algorithm
+			dev0LinkAgg.pAggregators[1]->set_aAggPortAlgorithm(LagAlgorithms::C_VID);    // change port algorithm
 		}
 
 		if (SimLog::Time == start + 630)
@@ -1566,7 +1565,7 @@ void adminVariableTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 800)
 		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortAlgorithm(LagAlgorithms::UNSPECIFIED); // restore port algorithm
+			dev0LinkAgg.pAggregators[1]->set_aAggPortAlgorithm(LagAlgorithms::UNSPECIFIED); // restore port algorithm
 		}
 
 		if (SimLog::Time == start + 830)
@@ -1605,7 +1604,7 @@ void adminVariableTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -1618,7 +1617,7 @@ void drniToDrniTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay (EndStn-DRNI to Bridge-DRNI) Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay (EndStn-DRNI to Bridge-DRNI) Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -1634,7 +1633,7 @@ void drniToDrniTest(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -1688,7 +1687,7 @@ void drniToDrniTest(std::vector<unique_ptr<Device>> & Devices)
 		if (SimLog::Time == start + 100)
 		{
 			cout << "   Time:  " << SimLog::Time << "  sending first frame" << endl;
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << "   Time:  " << SimLog::Time << "  sending first frame" << endl;
 			dev3EndStn.generateTestFrame();                                                  // create and transmit un-tagged test frame
 		}
@@ -1696,7 +1695,7 @@ void drniToDrniTest(std::vector<unique_ptr<Device>> & Devices)
 		if (SimLog::Time == start + 200)
 		{
 			cout << "   Time:  " << SimLog::Time << "  sending return frame" << endl;
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << "   Time:  " << SimLog::Time << "  sending return frame" << endl;
 			dev4EndStn.generateTestFrame();                                                  // create and transmit un-tagged test frame
 		}
@@ -1736,7 +1735,7 @@ void drniToDrniTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -1749,7 +1748,7 @@ void distRelayTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay (EndStn to Bridge-DRNI) Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay (EndStn to Bridge-DRNI) Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -1765,7 +1764,7 @@ void distRelayTest(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -1835,7 +1834,7 @@ void distRelayTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -1849,7 +1848,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay Partner Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay Partner Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -1865,14 +1864,14 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
 
 		if (SimLog::Time == start + 10)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect End Station 4 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[4]->pMacs[0]), (Devices[1]->pMacs[4]), 5);   // Connect End Station 4 to DRNI System 1
 			// Link 3 comes up
@@ -1880,7 +1879,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 100)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect End Station 3 to DRNI System 0  " << endl;
 			Mac::Connect((Devices[3]->pMacs[1]), (Devices[0]->pMacs[5]), 5);   // Connect End Station  3 to DRNI System 0
 			// Link 2 comes up
@@ -1888,7 +1887,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 200)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect IRPs -- DRNI System 0 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);   // Connect IRPs -- DRNI System 0 to DRNI System 1
 			// DRNI System 1 changes ID/Key so link to End Station 4 goes down.  Does not come back up because partner restricted.
@@ -1896,7 +1895,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 300)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disconnect End Station 3 from DRNI System 0  " << endl;
 			Mac::Disconnect((Devices[3]->pMacs[1]));                           // Disconnect End Station 3 DRNI System 0
 			// Link to End Station 3 on DRNI System 0 goes down which allows Link 3 to End Station 4 to come up on DRNI System 1
@@ -1904,7 +1903,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 400)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect End Station 3 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[3]->pMacs[0]), (Devices[1]->pMacs[5]), 5);   // Connect End Station 3 to DRNI System 1
 			// Link cannot come up because DRNI Aggregator is occupied
@@ -1912,7 +1911,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 500)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Re-Connect End Station 3 to DRNI System 0  " << endl;
 			Mac::Connect((Devices[3]->pMacs[1]), (Devices[0]->pMacs[5]), 5);   // Re-Connect End Station  3 to DRNI System 0
 			// Forces Link to End Station 4 down which allows Link to End Station 3 to come up on DRNI System 1
@@ -1920,7 +1919,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 600)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disconnect End Station 3 from DRNI System 0  " << endl;
 			Mac::Disconnect((Devices[3]->pMacs[1]));                           // Disconnect End Station 3 DRNI System 0
 			// Link to End Station 3 goes down on DRNI System 0
@@ -1929,7 +1928,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 700)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disconnect IRC Link  " << endl;
 			Mac::Disconnect((Devices[0]->pMacs[6]));                           // Disconnect IRC Link
 			// DRNI System 1 ID/Key change so both links go down, Link to End Station 4 comes back up
@@ -1937,13 +1936,13 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 745)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disonnect End Station 3 from DRNI System 1  " << endl;
 			Mac::Disconnect((Devices[3]->pMacs[0]));                           // Disconnect End Station 3 from DRNI System 1
 		}
 		if (SimLog::Time == start + 755)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect End Station 3 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[3]->pMacs[0]), (Devices[1]->pMacs[5]), 5);   // Connect End Station 3 to DRNI System 1
 			// Link cannot come up because DRNI Aggregator is occupied
@@ -1954,7 +1953,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 800)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Re-Connect IRC Link  " << endl;
 			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);   // Re-connect IRPs -- DRNI System 0 to DRNI System 1
 			// DRNI System 1 changes ID/Key so link to End Station 4 goes down and comes back up
@@ -1962,7 +1961,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 900)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Dual home End Station 3 to DRNI System 0  " << endl;
 			Mac::Connect((Devices[3]->pMacs[1]), (Devices[0]->pMacs[5]), 5);   // Dual home End Station  3 to DRNI System 0
 			// Forces Link to End Station 4 down which allows Link to End Station 3 to come up on DRNI System 1
@@ -1991,7 +1990,7 @@ void drniPartnerTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -2005,7 +2004,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay Partner Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay Partner Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -2021,14 +2020,14 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
 
 		if (SimLog::Time == start + 10)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect End Station 4 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[4]->pMacs[0]), (Devices[1]->pMacs[4]), 5);   // Connect End Station 4 to DRNI System 1
 			// Link should come up
@@ -2036,7 +2035,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 100)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect different End Station 3 to same DRNI System 1  " << endl;
 			Mac::Connect((Devices[3]->pMacs[0]), (Devices[1]->pMacs[5]), 5);   // Connect different End Station 3 to same DRNI System 1
 			// Link cannot come up because DRNI Aggregator is occupied
@@ -2044,7 +2043,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 200)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Connect IRPs -- DRNI System 0 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);   // Connect IRPs -- DRNI System 0 to DRNI System 1
 			// DRNI System 1 changes ID/Key so link to End Station 4 goes down and comes back up
@@ -2052,7 +2051,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 300)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Dual home End Station 3 to DRNI System 0  " << endl;
 			Mac::Connect((Devices[3]->pMacs[1]), (Devices[0]->pMacs[5]), 5);   // Dual home End Station  3 to DRNI System 0
 			// Link doesn't come up because even though connected to DRNI System with lowest ID (which should therefore select the partner),
@@ -2062,7 +2061,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 		/*
 		if (SimLog::Time == start + 340)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disonnect End Station 3 from DRNI System 1  " << endl;
 			Mac::Disconnect((Devices[3]->pMacs[0]));                           // Disconnect End Station 3 from DRNI System 1
 		}
@@ -2070,7 +2069,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 400)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disonnect both End Stations from DRNI System 1  " << endl;
 			Mac::Disconnect((Devices[1]->pMacs[4]));                           // Disconnect both links to DRNI System 1
 			Mac::Disconnect((Devices[1]->pMacs[5]));                           // Disconnect both links to DRNI System 1
@@ -2078,7 +2077,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 500)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Re-Connect End Station 4 to DRNI System 1  " << endl;
 			Mac::Connect((Devices[4]->pMacs[0]), (Devices[1]->pMacs[4]), 5);   // Re-Connect an End Station 4 to DRNI System 1
 			// 
@@ -2086,21 +2085,21 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 600)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Re-Connect different End Station 3 to same DRNI System 1  " << endl;
 			Mac::Connect((Devices[3]->pMacs[0]), (Devices[1]->pMacs[5]), 5);   // Re-Connect different End Station  3 to same DRNI System 1
 		}
 
 		if (SimLog::Time == start + 700)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Disconnect IRC Link  " << endl;
 			Mac::Disconnect((Devices[0]->pMacs[6]));                           // Disconnect IRC Link
 		}
 
 		if (SimLog::Time == start + 800)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << ":  Re-Connect IRC Link  " << endl;
 			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);   // Re-connect IRPs -- DRNI System 0 to DRNI System 1
 		}
@@ -2129,7 +2128,7 @@ void drniPartnerTestOld(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -2143,7 +2142,7 @@ void drniGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay Gateway Selection Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay Gateway Selection Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -2153,10 +2152,10 @@ void drniGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev0LinkAgg = (LinkAgg&)*(Devices[0]->pComponents[1]);
 	LinkAgg& dev1LinkAgg = (LinkAgg&)*(Devices[1]->pComponents[1]);
 
-	std::bitset<4096> tempGwEn0;
-	std::bitset<4096> tempGwEn1;
-	std::bitset<4096> tempGwPref0;
-	std::bitset<4096> tempGwPref1;
+	ConvMask tempGwEn0;
+	ConvMask tempGwEn1;
+	ConvMask tempGwPref0;
+	ConvMask tempGwPref1;
 
 	for (auto& pDev : Devices)
 	{
@@ -2166,7 +2165,7 @@ void drniGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -2330,7 +2329,7 @@ void drniGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -2343,7 +2342,7 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay CSCD Gateway Selection Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay CSCD Gateway Selection Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -2354,10 +2353,10 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 	LinkAgg& dev0LinkAgg = (LinkAgg&)*(Devices[0]->pComponents[1]);
 	LinkAgg& dev1LinkAgg = (LinkAgg&)*(Devices[1]->pComponents[1]);
 
-	std::bitset<4096> tempGwEn0;
-	std::bitset<4096> tempGwEn1;
-	std::bitset<4096> tempGwPref0;
-	std::bitset<4096> tempGwPref1;
+	ConvMask tempGwEn0;
+	ConvMask tempGwEn1;
+	ConvMask tempGwPref0;
+	ConvMask tempGwPref1;
 
 	for (auto& pDev : Devices)
 	{
@@ -2367,7 +2366,7 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -2409,27 +2408,27 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 100)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Connecting IRP  *****  " << endl;
 			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 10);   // Connect IRPs -- DRNI System 0 to DRNI System 1 with long delay
 		}
 		if (SimLog::Time == start + 160)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  DRCPDU from b00 discarded  *****  " << endl;
 			(Devices[0]->pMacs[6])->reset();                                    // Lose DRCPDU from b00
 		}
 
 		if (SimLog::Time == start + 200)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Set dev0 homeAdminCscdGatewayControl to TRUE  *****  " << endl;
 			dev0LinkAgg.pDistRelays[4]->set_homeAdminCscdGatewayControl(true);
 		}
 
 		if (SimLog::Time == start + 240)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Connect four Aggregation Links  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[0]), (Devices[0]->pMacs[4]), 2);   // Connect Aggregation Links with short delay
 			Mac::Connect((Devices[5]->pMacs[1]), (Devices[0]->pMacs[5]), 2);
@@ -2439,50 +2438,50 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 300)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 1:  Link 3 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[2]);                             // Event 1: Link 3 down
 		}
 		if (SimLog::Time == start + 330)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 2:  Link 1 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[0]);                             // Event 2: Link 1 down
 		}
 		if (SimLog::Time == start + 335)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 3:  Link 1 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[0]), (Devices[0]->pMacs[4]), 2);   // Event 3: Link 1 up
 		}
 		if (SimLog::Time == start + 365)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Restore initial conditions:  Link 3 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[2]), (Devices[1]->pMacs[4]), 2);   // Restore initial conditions: Link 3 up
 		}
 
 		if (SimLog::Time == start + 400)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 1:  Link 3 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[2]);                             // Event 1: Link 3 down
 		}
 		if (SimLog::Time == start + 402)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 2:  Link 1 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[0]);                             // Event 2: Link 1 down
 		}
 		if (SimLog::Time == start + 407)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 3:  Link 1 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[0]), (Devices[0]->pMacs[4]), 2);   // Event 3: Link 1 up
 		}
 		if (SimLog::Time == start + 465)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Set initial conditions for next test:  Link 4 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[3]);                             // Set initial conditions for next test: Link 4 down
 		}
@@ -2490,58 +2489,58 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 
 		if (SimLog::Time == start + 500)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 1:  Link 4 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[3]), (Devices[1]->pMacs[5]), 2);   // Event 1: Link 4 up
 		}
 		if (SimLog::Time == start + 530)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 2:  Link 1 down  *****  " << endl;
 			Mac::Disconnect(Devices[0]->pMacs[4]);
 			Mac::Disconnect(Devices[5]->pMacs[0]);                             // Event 2: Link 1 down
 		}
 		if (SimLog::Time == start + 535)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 3:  Link 1 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[0]), (Devices[0]->pMacs[4]), 2);   // Event 3: Link 1 up
 		}
 		if (SimLog::Time == start + 565)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Restore initial conditions:  Link 4 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[3]);                             // Restore initial conditions: Link 4 down
 		}
 
 		if (SimLog::Time == start + 600)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 1:  Link 4 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[3]), (Devices[1]->pMacs[5]), 2);   // Event 1: Link 4 up
 		}
 		if (SimLog::Time == start + 602)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 2:  Link 1 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[0]);                             // Event 2: Link 1 down
 		}
 		if (SimLog::Time == start + 607)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Event 3:  Link 1 up  *****  " << endl;
 			Mac::Connect((Devices[5]->pMacs[0]), (Devices[0]->pMacs[4]), 2);   // Event 3: Link 1 up
 		}
 		if (SimLog::Time == start + 665)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Restore initial conditions:  Link 4 down  *****  " << endl;
 			Mac::Disconnect(Devices[5]->pMacs[3]);                             // Restore initial conditions: Link 4 down
 		}
 
 		if (SimLog::Time == start + 750)
 		{
-			if (SimLog::Debug > 0)
+			if (SimLog::Trace<0>())
 				SimLog::logFile << endl << "Time " << SimLog::Time << "  *****  Disconnecting IRP  *****  " << endl;
 			Mac::Disconnect(Devices[0]->pMacs[6]);                             // Disconnect IRPs 
 		}
@@ -2570,7 +2569,7 @@ void drniCscdGatewaySelectionTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -2583,7 +2582,7 @@ void drniAdminChangesTest(std::vector<unique_ptr<Device>> & Devices)
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   Distributed Relay Admin changes Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::Trace<0>())
 		SimLog::logFile << endl << endl << "   Distributed Relay Admin changes Tests:  " << endl << endl;
 
 	Bridge& dev0Bridge = (Bridge&)*(Devices[0]->pComponents[0]);
@@ -2602,7 +2601,7 @@ void drniAdminChangesTest(std::vector<unique_ptr<Device>> & Devices)
 	for (int i = 0; i < 1000; i++)
 		//	for (int i = 0; i < 1000; i++)
 	{
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 
 		//  Make or break connections
@@ -2616,6 +2615,7 @@ void drniAdminChangesTest(std::vector<unique_ptr<Device>> & Devices)
 		if (SimLog::Time == start + 100)
 		{
 			dev1LinkAgg.pAggregators[4]->set_aAggActorSystemID(0x0000123456780000);
+			dev1LinkAgg.pAggPorts[4]->set_aAggPortActorSystemID(0x0000123456780000);
 		}
 
 
@@ -2642,7 +2642,7 @@ void drniAdminChangesTest(std::vector<unique_ptr<Device>> & Devices)
 			pDev->transmit();
 		}
 
-		if (SimLog::Debug > 1)
+		if (SimLog::Trace<1>())
 			SimLog::logFile << "*" << endl;
 		SimLog::Time++;
 	}
@@ -3,6 +3,7 @@
 // stdafx.obj will contain the pre-compiled type information
 
 #include "stdafx.h"
+#include "LogWriter.h"
 
 
 SimLog::SimLog()
@@ -14,9 +15,100 @@ SimLog::~SimLog()
 }
 
 // SimLog;  // init globals: Time and logfile
-int SimLog::Time = 0;
+thread_local int SimLog::Time = 0;
 int SimLog::Debug = 0;
-std::ofstream SimLog::logFile("Drni output.txt");
+unsigned int SimLog::Threads = 1;
+unsigned int SimLog::DataPlaneThreads = 1;
+bool SimLog::BinaryTrace = false;
+LogWriter SimLog::logWriter("Drni output.txt");
+LogWriter SimLog::traceWriter("Drni trace.bin", std::ios_base::out | std::ios_base::binary);
+thread_local LogBuffer SimLog::logBuffer(SimLog::logWriter);
+thread_local LogBuffer SimLog::traceBuffer(SimLog::traceWriter);
+thread_local std::ostream SimLog::logFile(&SimLog::logBuffer);
+thread_local std::ostream SimLog::console(std::cout.rdbuf());
+
+void SimLog::trace(const TraceRecord& record)
+{
+	if (!BinaryTrace)
+	{
+		formatTrace(logFile, record);
+		return;
+	}
+
+	unsigned char bytes[TraceRecordSize];                  // Little-endian fields in TraceRecord order
+	unsigned int time = (unsigned int)record.time;
+	for (int i = 0; i < 4; i++)
+		bytes[i] = (unsigned char)(time >> (8 * i));
+	bytes[4] = (unsigned char)record.event;
+	unsigned short fields[6] = { record.device, record.component, record.link, record.convID,
+		record.peerDevice, record.peerComponent };
+	for (int i = 0; i < 6; i++)
+	{
+		bytes[5 + (2 * i)] = (unsigned char)fields[i];
+		bytes[6 + (2 * i)] = (unsigned char)(fields[i] >> 8);
+	}
+	bytes[17] = record.flag;
+	traceBuffer.sputn((const char*)bytes, TraceRecordSize);
+}
+
+void SimLog::decodeTrace(std::istream& binaryTrace, std::ostream& text)
+{
+	std::vector<TraceRecord> records;
+	unsigned char bytes[TraceRecordSize];
+
+	while (binaryTrace.read((char*)bytes, TraceRecordSize))
+	{
+		TraceRecord record;
+		record.time = (int)(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24));
+		record.event = (TraceEvents)bytes[4];
+		unsigned short fields[6];
+		for (int i = 0; i < 6; i++)
+			fields[i] = (unsigned short)(bytes[5 + (2 * i)] | (bytes[6 + (2 * i)] << 8));
+		record.device = fields[0];
+		record.component = fields[1];
+		record.link = fields[2];
+		record.convID = fields[3];
+		record.peerDevice = fields[4];
+		record.peerComponent = fields[5];
+		record.flag = (bytes[17] != 0);
+		records.push_back(record);
+	}
+
+	//  Records are written to the file in blocks from each thread, so put them back in order.  Each device is run by
+	//     only one thread in a Time increment, so the order of records for a device at a Time is preserved.
+	std::stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b)
+		{ return ((a.time < b.time) || ((a.time == b.time) && (a.device < b.device))); });
+
+	for (auto& record : records)
+		formatTrace(text, record);
+}
+
+void SimLog::formatTrace(std::ostream& text, const TraceRecord& record)
+{
+	text << "Time " << record.time;
+	switch (record.event)
+	{
+	case TRACE_COLLECT_FRAME:
+	case TRACE_DISCARD_INGRESS:
+		text << ":   Device:Port " << hex << record.device << ":" << record.component
+			<< " Link " << dec << record.link << "  DWC " << record.flag << hex;
+		if (record.event == TRACE_COLLECT_FRAME)
+			text << " collecting ConvID ";
+		else
+			text << " discarding ingress ConvID ";
+		text << record.convID << dec << endl;
+		break;
+	case TRACE_DISTRIBUTE_FRAME:
+		text << ":   Device:Aggregator " << hex << record.device << ":" << record.component
+			<< " distributing ConvID " << record.convID << "  to Port " << record.peerDevice << ":" << record.peerComponent
+			<< " Link " << dec << record.link << endl;
+		break;
+	case TRACE_DISCARD_EGRESS:
+		text << ":   Device:Aggregator " << hex << record.device << ":" << record.component
+			<< " discarding egress ConvID " << record.convID << dec << endl;
+		break;
+	}
+}
 
 
 // TODO: reference any additional headers you need in STDAFX.H
@@ -22,7 +22,20 @@
 #include <list>
 #include <bitset>
 #include <map>
+#include <unordered_map>
+#include <set>
 #include <string>
+#include <functional>
+#include <algorithm>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <type_traits>
 
 
 using std::cout;
@@ -39,18 +52,85 @@ using std::move;
 /*
 *   Class SimLog contains static variables to have global scope in the simulation:
 *      -- Time:  Each time increment is one single-step of the simulation.  No direct correlation to any unit of real time.
-*      -- logFile:  a text file for messages regarding events in the simulation.
+*             Time is per-thread, so independent Simulations (e.g. the scenarios of a Sweep) can run in parallel threads.
+*      -- logFile:  a text file for messages regarding events in the simulation.  The file is written by a background
+*             thread (see LogWriter) so generating a message never waits for the file.
+*      -- console:  messages to the console window that are generated while running state machines.
+*             Both logFile and console are per-thread streams.  In the main thread they write directly to the
+*             text file and the console window.  A thread running a Device in parallel with other Devices
+*             redirects them to a buffer that is copied to the file or console in Device order after each
+*             Time increment, so the output is the same as when Devices are run one at a time.
+*             Time is only changed between Time increments, while no Devices are running, so needs no protection.
+*      -- EndOfTime:  a Time value later than any Time the simulation will reach (i.e. no event pending).
+*      -- SettleTime:  Time increments a component keeps running after a state machine transition before it is
+*             considered idle.  Covers signals (e.g. Selected) that are set without a transition being counted.
+*      -- Debug:  messages at a level are written to the logFile if Debug is greater than the level.
+*             Messages are guarded by Trace<level>() rather than testing Debug directly.  Trace is false at compile time
+*             for levels at or above MaxDebug, so the compiler removes the messages (and the test of Debug) entirely.  
+*             MaxDebug is set by the SIMLOG_MAX_DEBUG preprocessor definition (the Release configurations keep only
+*             the test progress messages of levels 0 and 1), and defaults to compiling in all messages.
+*      -- trace:  writes a TraceRecord to the logFile.  Used for the messages generated for every frame, so the
+*             message is just a few stores unless (and until) it is formatted.
+*             If BinaryTrace is true the record is not formatted but written as TraceRecordSize bytes to the binary
+*             trace file "Drni trace.bin" instead.  decodeTrace converts a binary trace file to the logFile text,
+*             ordered by Time and device (run "drni -decode <file>").
 */
 /**/
+class LogWriter;
+class LogBuffer;
+
+#ifndef SIMLOG_MAX_DEBUG
+#define SIMLOG_MAX_DEBUG 100
+#endif
+
+enum TraceEvents { TRACE_COLLECT_FRAME, TRACE_DISCARD_INGRESS, TRACE_DISTRIBUTE_FRAME, TRACE_DISCARD_EGRESS };
+
+struct TraceRecord
+{
+	int time;
+	TraceEvents event;
+	unsigned short device;            // addrMid of System ID
+	unsigned short component;         // Port number (COLLECT_FRAME, DISCARD_INGRESS) or Aggregator Identifier
+	unsigned short link;              // Link Number ID
+	unsigned short convID;
+	unsigned short peerDevice;        // addrMid of System ID of egress port (DISTRIBUTE_FRAME)
+	unsigned short peerComponent;     // Port number of egress port (DISTRIBUTE_FRAME)
+	bool flag;                        // Discard Wrong Conversation (COLLECT_FRAME, DISCARD_INGRESS)
+};
+
 class SimLog
 {
 public:
 	SimLog();
 	~SimLog();
 
-	static int Time;
-	static std::ofstream logFile;
+	static thread_local int Time;
+	static thread_local std::ostream logFile;
+	static thread_local std::ostream console;
 	static int Debug;
+	static unsigned int Threads;          // Number of threads a Simulation uses to run Devices in parallel
+	static unsigned int DataPlaneThreads; // Number of threads a LinkAgg uses to collect and distribute frames (see LinkAgg::run)
+	static const int EndOfTime = 0x7fffffff;
+	static const int SettleTime = 2;
+
+	static const int MaxDebug = SIMLOG_MAX_DEBUG;
+
+	template <int Level> static bool Trace()
+	{
+		return ((Level < MaxDebug) && (Debug > Level));
+	}
+	static bool BinaryTrace;              // Write TraceRecords to the binary trace file rather than the logFile
+	static const int TraceRecordSize = 18;
+	static void trace(const TraceRecord& record);
+	static void decodeTrace(std::istream& binaryTrace, std::ostream& text);
+
+private:
+	static LogWriter logWriter;           // The text file shared by the logFile streams of all threads
+	static LogWriter traceWriter;         // The binary trace file
+	static thread_local LogBuffer logBuffer;
+	static thread_local LogBuffer traceBuffer;
+
+	static void formatTrace(std::ostream& text, const TraceRecord& record);
 };
 /**/
 
@@ -60,12 +140,16 @@ enum LagAlgorithms { NONE = 0, UNSPECIFIED = 0x0080c200, C_VID, S_VID, I_SID, TE
 
 const unsigned short CVlanEthertype = 0x8100;
 const unsigned short SVlanEthertype = 0x88a8;
+const unsigned short ITagEthertype = 0x88e7;
 const unsigned short SlowProtocolsEthertype = 0x8809;
 const unsigned char LacpduSubType = 0x01;
 const unsigned short DrniEthertype = 0x8952;
 const unsigned char DrcpduSubType = 0x01;
 const unsigned short PlaypenEthertypeA = 0x88b5;  // IEEE Std 802a-2003 Local Experimental Ethertype 1
 const unsigned short PlaypenEthertypeB = 0x88b6;  // IEEE Std 802a-2003 Local Experimental Ethertype 2
+const unsigned short Ipv4Ethertype = 0x0800;
+const unsigned char TcpProtocol = 6;
+const unsigned char UdpProtocol = 17;
 
 const long long NearestCustomerBridgeDA = 0x0180c2000000; 
 const long long SlowProtocolsDA         = 0x0180c2000002;
@@ -90,5 +174,6 @@ const unsigned long long defaultOUI = 0x24a600000000;   // Local individual (uni
 const unsigned long long defaultBrdgAddr = 0x24a60b000000;   // OUI for Bridges:  top two hex digits after OUI expected to be device number
 const unsigned long long defaultEndStnAddr = 0x24a60e000000;   // OUI for End Stations:  top two hex digits after OUI expected to be device number
 const unsigned long long defaultDA = 0x30be00ffffff;   // Local group (multicast) address
+const unsigned long long groupAddressBit = 0x010000000000;   // Individual/Group bit (least significant bit of first octet)
 
 /**/